@@ -1,11 +1,13 @@
 #include "gprat_c.hpp"
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
 namespace py = pybind11;
 
 /**
- * @brief Adds classes `GP_data`, `Hyperparameters`, `GP` to Python module.
+ * @brief Adds classes `GP_data`, `Hyperparameters`, `LBFGSParams`, `PCGParams`, `StochasticParams`, `TLRParams`,
+ *        `RFFParams`, `Multistart_result`, `GP`, `OptimizerSession` to Python module.
  */
 void init_gprat(py::module &m)
 {
@@ -45,6 +47,99 @@ void init_gprat(py::module &m)
         .def_readwrite("opt_iter", &gprat_hyper::AdamParams::opt_iter)
         .def("__repr__", &gprat_hyper::AdamParams::repr);
 
+    // Set hyperparameters to default values in `LBFGSParams` class, unless
+    // specified.
+    py::class_<gprat_hyper::LBFGSParams>(m, "LBFGSParams")
+        .def(py::init<int, int, double, double, int>(),
+             py::arg("max_iter") = 30,
+             py::arg("history_size") = 6,
+             py::arg("gradient_tolerance") = 1e-5,
+             py::arg("armijo") = 1e-4,
+             py::arg("max_line_search") = 20)
+        .def_readwrite("max_iter", &gprat_hyper::LBFGSParams::max_iter)
+        .def_readwrite("history_size", &gprat_hyper::LBFGSParams::history_size)
+        .def_readwrite("gradient_tolerance", &gprat_hyper::LBFGSParams::gradient_tolerance)
+        .def_readwrite("armijo", &gprat_hyper::LBFGSParams::armijo)
+        .def_readwrite("max_line_search", &gprat_hyper::LBFGSParams::max_line_search)
+        .def("__repr__", &gprat_hyper::LBFGSParams::repr);
+
+    // Set parameters to default values in `PCGParams` class, unless
+    // specified.
+    py::class_<gprat_hyper::PCGParams>(m, "PCGParams")
+        .def(py::init<int, double, int, bool>(),
+             py::arg("max_iter") = 1000,
+             py::arg("tolerance") = 1e-8,
+             py::arg("preconditioner_rank") = 20,
+             py::arg("regenerate_tiles") = false)
+        .def_readwrite("max_iter", &gprat_hyper::PCGParams::max_iter)
+        .def_readwrite("tolerance", &gprat_hyper::PCGParams::tolerance)
+        .def_readwrite("preconditioner_rank", &gprat_hyper::PCGParams::preconditioner_rank)
+        .def_readwrite("regenerate_tiles", &gprat_hyper::PCGParams::regenerate_tiles)
+        .def("__repr__", &gprat_hyper::PCGParams::repr);
+
+    // Set parameters to default values in `StochasticParams` class, unless
+    // specified.
+    py::class_<gprat_hyper::StochasticParams>(m, "StochasticParams")
+        .def(py::init<int, double, int, bool, unsigned int>(),
+             py::arg("n_probes") = 16,
+             py::arg("max_iter") = 100,
+             py::arg("tolerance") = 1e-6,
+             py::arg("regenerate_tiles") = false,
+             py::arg("seed") = 0)
+        .def_readwrite("n_probes", &gprat_hyper::StochasticParams::n_probes)
+        .def_readwrite("max_iter", &gprat_hyper::StochasticParams::max_iter)
+        .def_readwrite("tolerance", &gprat_hyper::StochasticParams::tolerance)
+        .def_readwrite("regenerate_tiles", &gprat_hyper::StochasticParams::regenerate_tiles)
+        .def_readwrite("seed", &gprat_hyper::StochasticParams::seed)
+        .def("__repr__", &gprat_hyper::StochasticParams::repr);
+
+    // Set parameters to default values in `TLRParams` class, unless
+    // specified.
+    py::class_<gprat_hyper::TLRParams>(m, "TLRParams")
+        .def(py::init<double, int>(), py::arg("tolerance") = 1e-8, py::arg("max_rank") = 0)
+        .def_readwrite("tolerance", &gprat_hyper::TLRParams::tolerance)
+        .def_readwrite("max_rank", &gprat_hyper::TLRParams::max_rank)
+        .def("__repr__", &gprat_hyper::TLRParams::repr);
+
+    // Set parameters to default values in `RFFParams` class, unless
+    // specified.
+    py::class_<gprat_hyper::RFFParams>(m, "RFFParams")
+        .def(py::init<int, unsigned int>(), py::arg("n_features") = 256, py::arg("seed") = 0)
+        .def_readwrite("n_features", &gprat_hyper::RFFParams::n_features)
+        .def_readwrite("seed", &gprat_hyper::RFFParams::seed)
+        .def("__repr__", &gprat_hyper::RFFParams::repr);
+
+    // Precision of the tiles of the covariance matrix on the CPU
+    py::enum_<gprat::Precision>(m, "Precision")
+        .value("fp64", gprat::Precision::fp64, "All tiles in FP64")
+        .value("mixed",
+               gprat::Precision::mixed,
+               "Off-diagonal tiles in FP32, diagonal tiles in FP64, with iterative refinement in FP64")
+        .value("fp32", gprat::Precision::fp32, "All tiles in FP32, results in FP64");
+
+    // Inducing point approximations of the sparse GP methods
+    py::enum_<gprat::Approximation>(m, "Approximation")
+        .value("sor", gprat::Approximation::sor, "Subset of regressors")
+        .value("dtc", gprat::Approximation::dtc, "Deterministic training conditional")
+        .value("fitc", gprat::Approximation::fitc, "Fully independent training conditional");
+
+    // Combinations of the local experts predictions
+    py::enum_<gprat::Expert_combination>(m, "Expert_combination")
+        .value("poe", gprat::Expert_combination::poe, "Product of experts")
+        .value("gpoe", gprat::Expert_combination::gpoe, "Generalized product of experts")
+        .value("bcm", gprat::Expert_combination::bcm, "Bayesian committee machine")
+        .value("rbcm", gprat::Expert_combination::rbcm, "Robust Bayesian committee machine");
+
+    // Result of `GP.optimize_multistart`
+    py::class_<gprat::Multistart_result>(m, "Multistart_result", "Result of optimizations from several initial values.")
+        .def_readonly("best_params",
+                      &gprat::Multistart_result::best_params,
+                      "Optimized lengthscale, vertical lengthscale and noise variance of the best optimization")
+        .def_readonly("best_index",
+                      &gprat::Multistart_result::best_index,
+                      "Index of the optimization with the lowest final loss")
+        .def_readonly("losses", &gprat::Multistart_result::losses, "Loss values of each iteration per optimization");
+
     // Initializes Gaussian Process with `GP` class. Sets default parameters for
     // squared exponential kernel, number of regressors and trainable, unless
     // specified. Instance object has full access to parameters for squared
@@ -54,16 +149,23 @@ void init_gprat(py::module &m)
     py::class_<gprat::GP>(m, "GP")
 
         // CPU constructor
-        .def(
-            py::init<std::vector<double>, std::vector<double>, int, int, int, std::vector<double>, std::vector<bool>>(),
-            py::arg("input_data"),
-            py::arg("output_data"),
-            py::arg("n_tiles"),
-            py::arg("n_tile_size"),
-            py::arg("n_reg") = 8,
-            py::arg("kernel_params") = std::vector<double>{ 1.0, 1.0, 0.1 },
-            py::arg("trainable") = std::vector<bool>{ true, true, true },
-            R"pbdoc(
+        .def(py::init<std::vector<double>,
+                      std::vector<double>,
+                      int,
+                      int,
+                      int,
+                      std::vector<double>,
+                      std::vector<bool>,
+                      gprat::Precision>(),
+             py::arg("input_data"),
+             py::arg("output_data"),
+             py::arg("n_tiles"),
+             py::arg("n_tile_size"),
+             py::arg("n_reg") = 8,
+             py::arg("kernel_params") = std::vector<double>{ 1.0, 1.0, 0.1 },
+             py::arg("trainable") = std::vector<bool>{ true, true, true },
+             py::arg("precision") = gprat::Precision::fp64,
+             R"pbdoc(
 Create Gaussian Process including its data, hyperparameters, and target. By
 default, the calculations are performed on the CPU. Setting at least gpu_id or
 n_streams to a value enables computations on the GPU.
@@ -78,6 +180,8 @@ Parameters:
         {1.0, 1.0, 0.1}
     trainable (list): List of booleans for trainable hyperparameters. Default is
         {true, true, true}.
+    precision (Precision): Precision of the tiles of the covariance matrix,
+        used by predictions, loss and optimization. Default is Precision.fp64.
     gpu_id (int): ID of the GPU to use. Default is 0.
     n_units (int): Number of streams/queues for GPU computation. Default is 1.
              )pbdoc")
@@ -125,6 +229,31 @@ Parameters:
         .def("__repr__", &gprat::GP::repr)
         .def("get_input_data", &gprat::GP::get_training_input)
         .def("get_output_data", &gprat::GP::get_training_output)
+        .def("append_observations",
+             &gprat::GP::append_observations,
+             py::arg("new_input"),
+             py::arg("new_output"),
+             R"pbdoc(
+Append new observations to the training data. The cached factorization of the
+covariance matrix is extended by the new tile rows instead of recomputed.
+
+Parameters:
+    new_input (list): New input values continuing the input series.
+    new_output (list): New output values, a multiple of the tile size.
+             )pbdoc")
+        .def("slide_window",
+             &gprat::GP::slide_window,
+             py::arg("new_input"),
+             py::arg("new_output"),
+             R"pbdoc(
+Slide the training window over new observations. The new observations are
+appended and the same number of oldest observations is dropped. The cached
+factorization of the covariance matrix is updated instead of recomputed.
+
+Parameters:
+    new_input (list): New input values continuing the input series.
+    new_output (list): New output values, a multiple of the tile size.
+             )pbdoc")
         .def("predict", &gprat::GP::predict, py::arg("test_data"), py::arg("m_tiles"), py::arg("m_tile_size"))
         .def("predict_with_uncertainty",
              &gprat::GP::predict_with_uncertainty,
@@ -137,6 +266,238 @@ Parameters:
              py::arg("m_tiles"),
              py::arg("m_tile_size"))
         .def("optimize", &gprat::GP::optimize, py::arg("AdamParams"))
+        .def("optimize_multistart",
+             &gprat::GP::optimize_multistart,
+             py::arg("initial_params_list"),
+             py::arg("AdamParams"),
+             R"pbdoc(
+Optimize the hyperparameters concurrently from several initial values. The
+optimizations share the distance tiles of the training data. Afterwards, the
+kernel hyperparameters are set to the result with the lowest final loss.
+
+Parameters:
+    initial_params_list (list): Initial [lengthscale, vertical_lengthscale,
+        noise_variance] of each optimization.
+    AdamParams (AdamParams): Hyperparameters of the Adam optimizer.
+
+Returns:
+    Multistart_result: Best hyperparameters and losses of all optimizations.
+             )pbdoc")
+        .def("optimize_lbfgs",
+             &gprat::GP::optimize_lbfgs,
+             py::arg("LBFGSParams"),
+             R"pbdoc(
+Optimize the hyperparameters with L-BFGS on the unconstrained hyperparameters.
+Each iteration performs a line search, every trial evaluation factorizes the
+covariance matrix once.
+
+Parameters:
+    LBFGSParams (LBFGSParams): Hyperparameters of the L-BFGS optimizer.
+
+Returns:
+    list: Losses of the initial hyperparameters and of each iteration.
+             )pbdoc")
         .def("optimize_step", &gprat::GP::optimize_step, py::arg("AdamParams"), py::arg("iter"))
-        .def("compute_loss", &gprat::GP::calculate_loss);
+        .def("compute_loss", &gprat::GP::calculate_loss)
+        .def(
+            "evaluate_loss_grid",
+            [](gprat::GP &gp, const std::vector<std::vector<double>> &params_list)
+            {
+                // Hand the losses to NumPy without a copy, the capsule owns the vector
+                auto losses = new std::vector<double>(gp.evaluate_loss_grid(params_list));
+                py::capsule owner(losses, [](void *p) { delete static_cast<std::vector<double> *>(p); });
+                return py::array_t<double>(static_cast<py::ssize_t>(losses->size()), losses->data(), owner);
+            },
+            py::arg("params_list"),
+            R"pbdoc(
+Compute the loss for several hyperparameters. The covariance matrices of all
+candidates are assembled from the same distance tiles and factorized in one
+task graph. The hyperparameters of the GP are not changed.
+
+Parameters:
+    params_list (list): [lengthscale, vertical_lengthscale, noise_variance]
+        of each candidate.
+
+Returns:
+    numpy.ndarray: Loss of each candidate.
+             )pbdoc")
+        .def("loss_and_gradient",
+             &gprat::GP::loss_and_gradient,
+             py::arg("params"),
+             py::arg("unconstrained") = false,
+             R"pbdoc(
+Compute the loss and its gradients for given hyperparameters from a single
+factorization. The hyperparameters of the GP are not changed.
+
+Parameters:
+    params (list): Lengthscale, vertical lengthscale and noise variance.
+    unconstrained (bool): Whether params and gradients refer to the
+        unconstrained hyperparameters of the softplus transformation.
+
+Returns:
+    tuple: Loss and list of gradients w.r.t. the three hyperparameters.
+             )pbdoc")
+        .def("set_inducing_points",
+             &gprat::GP::set_inducing_points,
+             py::arg("n_inducing"),
+             py::arg("kmeans_iterations") = 0,
+             R"pbdoc(
+Select the inducing points of the sparse approximations from the feature
+vectors of the training input.
+
+Parameters:
+    n_inducing (int): Number of inducing points.
+    kmeans_iterations (int): Number of k-means iterations refining the evenly
+        strided feature vectors. Default is 0.
+             )pbdoc")
+        .def("get_inducing_points",
+             &gprat::GP::get_inducing_points,
+             "Returns the inducing points, row-major n_inducing x n_reg")
+        .def("calculate_sparse_loss",
+             &gprat::GP::calculate_sparse_loss,
+             py::arg("approximation"),
+             "Calculate the loss of an inducing point approximation")
+        .def("optimize_sparse",
+             &gprat::GP::optimize_sparse,
+             py::arg("AdamParams"),
+             py::arg("approximation"),
+             R"pbdoc(
+Optimize the hyperparameters of an inducing point approximation with Adam. Each
+iteration takes O(N * M^2) operations for M inducing points.
+
+Parameters:
+    AdamParams (AdamParams): Hyperparameters of the Adam optimizer.
+    approximation (Approximation): Inducing point approximation.
+
+Returns:
+    list: Loss values of each iteration.
+             )pbdoc")
+        .def("predict_sparse_with_uncertainty",
+             &gprat::GP::predict_sparse_with_uncertainty,
+             py::arg("test_data"),
+             py::arg("m_tiles"),
+             py::arg("m_tile_size"),
+             py::arg("approximation"))
+        .def("predict_pcg",
+             &gprat::GP::predict_pcg,
+             py::arg("test_data"),
+             py::arg("m_tiles"),
+             py::arg("m_tile_size"),
+             py::arg("pcg_params"),
+             R"pbdoc(
+Predict output for test input with preconditioned conjugate gradients instead
+of the Cholesky decomposition of the covariance matrix.
+
+Parameters:
+    test_data (list): Test input data.
+    m_tiles (int): Number of test tiles.
+    m_tile_size (int): Size of each test tile.
+    pcg_params (PCGParams): Parameters of the solver.
+
+Returns:
+    list: Predictions.
+             )pbdoc")
+        .def("calculate_stochastic_loss",
+             &gprat::GP::calculate_stochastic_loss,
+             py::arg("stochastic_params"),
+             "Estimate the loss with block conjugate gradients and stochastic Lanczos quadrature")
+        .def("optimize_stochastic",
+             &gprat::GP::optimize_stochastic,
+             py::arg("AdamParams"),
+             py::arg("stochastic_params"),
+             R"pbdoc(
+Optimize the hyperparameters with Adam and stochastic estimates of the loss and
+its gradients. Only matrix-multi-vector products with the covariance matrix are
+required, new probe vectors are drawn in every iteration.
+
+Parameters:
+    AdamParams (AdamParams): Hyperparameters of the Adam optimizer.
+    stochastic_params (StochasticParams): Parameters of the estimation.
+
+Returns:
+    list: Estimated loss values of each iteration.
+             )pbdoc")
+        .def("calculate_tlr_loss",
+             &gprat::GP::calculate_tlr_loss,
+             py::arg("tlr_params"),
+             "Calculate the loss with the tile low-rank Cholesky decomposition")
+        .def("predict_tlr",
+             &gprat::GP::predict_tlr,
+             py::arg("test_data"),
+             py::arg("m_tiles"),
+             py::arg("m_tile_size"),
+             py::arg("tlr_params"),
+             R"pbdoc(
+Predict output for test input with the tile low-rank Cholesky decomposition.
+The off-diagonal tiles are compressed to low rank and recompressed after each
+update.
+
+Parameters:
+    test_data (list): Test input data.
+    m_tiles (int): Number of test tiles.
+    m_tile_size (int): Size of each test tile.
+    tlr_params (TLRParams): Parameters of the compression.
+
+Returns:
+    list: Predictions.
+             )pbdoc")
+        .def("tlr_ranks",
+             &gprat::GP::tlr_ranks,
+             py::arg("tlr_params"),
+             "Ranks of the tiles of the tile low-rank Cholesky factor in row-major order")
+        .def("set_random_features",
+             &gprat::GP::set_random_features,
+             py::arg("rff_params"),
+             R"pbdoc(
+Switches to the random Fourier feature approximation. While enabled, predict,
+predict_with_uncertainty, calculate_loss and optimize use a Bayesian linear
+regression on random features of the squared exponential kernel. The features
+are drawn once from the seed and stay fixed during the optimization. The
+operations that are only defined for the exact GP raise a ValueError while
+enabled.
+
+Parameters:
+    rff_params (RFFParams): Parameters of the random features, zero features
+        switch back to the exact GP.
+             )pbdoc")
+        .def("set_local_experts",
+             &gprat::GP::set_local_experts,
+             py::arg("enabled"),
+             py::arg("combination") = gprat::Expert_combination::rbcm,
+             R"pbdoc(
+Switches to the local experts approximation. While enabled, predict,
+predict_with_uncertainty, calculate_loss and optimize treat each training tile
+as an independent expert. Each optimizer iteration takes O(N * n_tile_size^2)
+operations. The operations that are only defined for the exact GP raise a
+ValueError while enabled.
+
+Parameters:
+    enabled (bool): Whether to use the local experts instead of the exact GP.
+    combination (Expert_combination): Combination of the expert predictions.
+             )pbdoc")
+
+    // Optimization of the hyperparameters of a GP over several calls. The
+    // session keeps the GP alive and updates its kernel hyperparameters.
+    py::class_<gprat::OptimizerSession>(m, "OptimizerSession")
+        .def(py::init<gprat::GP &, const gprat_hyper::AdamParams &>(),
+             py::arg("gp"),
+             py::arg("adam_params"),
+             py::keep_alive<1, 2>(),
+             R"pbdoc(
+Creates an optimizer session for a GP. The session owns the tiled training
+data, the distance tiles and the iteration counter of the Adam optimizer, such
+that each step only performs the numeric work.
+
+Parameters:
+    gp (GP): Gaussian process whose hyperparameters are optimized.
+    adam_params (AdamParams): Hyperparameters of the Adam optimizer.
+             )pbdoc")
+        .def_readwrite("adam_params", &gprat::OptimizerSession::adam_params)
+        .def("step", &gprat::OptimizerSession::step, "Perform a single optimization step and return its loss")
+        .def("run",
+             &gprat::OptimizerSession::run,
+             py::arg("n_iterations"),
+             "Perform pipelined optimization steps and return their losses")
+        .def_property_readonly(
+            "iteration", &gprat::OptimizerSession::iteration, "Number of performed optimization steps");
 }
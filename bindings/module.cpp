@@ -12,7 +12,11 @@ PYBIND11_MODULE(gprat, m)
 
     // NOTE: order of operations matters
 
-    init_gprat(m);  // Adds classes: `GP_data`, `AdamParams`, `GP`
+    init_gprat(m);  // Adds classes: `GP_data`, `AdamParams`, `LBFGSParams`,
+                    // `PCGParams`, `StochasticParams`, `TLRParams`,
+                    // `RFFParams`, `Precision`, `Approximation`,
+                    // `Expert_combination`, `Multistart_result`, `GP`, and
+                    // `OptimizerSession`
 
     init_utils(m);  // adds module functions: `compute_train_tiles`,
                     // `compute_train_tile_size`, `compute_test_tiles`, `print`,
@@ -0,0 +1,62 @@
+#ifndef APPROXIMATION_H
+#define APPROXIMATION_H
+
+namespace gprat
+{
+
+/**
+ * @brief Inducing point approximation of the covariance matrix of the training data
+ *
+ * All approximations replace K_NN by Q_NN = K_NM * K_MM^-1 * K_MN for M inducing points.
+ * Only used by the CPU implementation.
+ */
+enum class Approximation
+{
+    /**
+     * @brief Subset of regressors: Q_NN + noise variance for training,
+     * the predictive variance only contains the variance explained by the inducing points
+     */
+    sor,
+
+    /**
+     * @brief Deterministic training conditional: Q_NN + noise variance for training,
+     * the predictive variance is corrected by the exact prior variance
+     */
+    dtc,
+
+    /**
+     * @brief Fully independent training conditional: the diagonal of Q_NN is replaced by the
+     * exact prior variance, the predictive variance is corrected as for DTC
+     */
+    fitc
+};
+
+/**
+ * @brief Combination of the predictions of local experts
+ *
+ * Each training tile is an independent expert with predictive mean mu_k and variance sigma_k^2.
+ * The combined precision is sum_k beta_k / sigma_k^2, corrected by (1 - sum_k beta_k) / sigma_**^2
+ * with the prior variance sigma_**^2 for the Bayesian committee machines, the combined mean is
+ * the precision-weighted sum of the expert means. Only used by the CPU implementation.
+ */
+enum class Expert_combination
+{
+    /** @brief Product of experts: beta_k = 1 */
+    poe,
+
+    /** @brief Generalized product of experts: beta_k = 1 / number of experts */
+    gpoe,
+
+    /** @brief Bayesian committee machine: beta_k = 1 with prior correction */
+    bcm,
+
+    /**
+     * @brief Robust Bayesian committee machine: beta_k = 0.5 * (log(sigma_**^2) - log(sigma_k^2)),
+     * the differential entropy between prior and expert, with prior correction
+     */
+    rbcm
+};
+
+}  // namespace gprat
+
+#endif  // end of APPROXIMATION_H
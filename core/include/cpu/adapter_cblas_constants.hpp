@@ -0,0 +1,18 @@
+#ifndef CPU_ADAPTER_CBLAS_CONSTANTS_H
+#define CPU_ADAPTER_CBLAS_CONSTANTS_H
+
+// Constants that are compatible with CBLAS, shared by the FP32 and FP64 adapters
+
+typedef enum BLAS_TRANSPOSE { Blas_no_trans = 111, Blas_trans = 112 } BLAS_TRANSPOSE;
+
+typedef enum BLAS_SIDE { Blas_left = 141, Blas_right = 142 } BLAS_SIDE;
+
+typedef enum BLAS_ALPHA { Blas_add = 1, Blas_substract = -1 } BLAS_ALPHA;
+
+// typedef enum BLAS_UPLO { Blas_upper = 121,
+//                          Blas_lower = 122 } BLAS_UPLO;
+
+// typedef enum BLAS_ORDERING { Blas_row_major = 101,
+//                              Blas_col_major = 102 } BLAS_ORDERING;
+
+#endif  // end of CPU_ADAPTER_CBLAS_CONSTANTS_H
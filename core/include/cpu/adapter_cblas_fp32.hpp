@@ -1,44 +1,36 @@
 #ifndef CPU_ADAPTER_CBLAS_FP32_H
 #define CPU_ADAPTER_CBLAS_FP32_H
 
-#include <hpx/future.hpp>
+#include "cpu/adapter_cblas_constants.hpp"
 #include <vector>
-using vector_future = hpx::shared_future<std::vector<float>>;
-using vector = std::vector<float>;
-
-// Constants that are compatible with CBLAS
-typedef enum BLAS_TRANSPOSE { Blas_no_trans = 111, Blas_trans = 112 } BLAS_TRANSPOSE;
-
-typedef enum BLAS_SIDE { Blas_left = 141, Blas_right = 142 } BLAS_SIDE;
 
-typedef enum BLAS_ALPHA { Blas_add = 1, Blas_substract = -1 } BLAS_ALPHA;
+// The FP32 operations mirror the FP64 operations for std::vector<float>. They live in their own
+// namespace, so that the FP64 operations can still be passed by address without ambiguity.
+namespace fp32
+{
 
-// typedef enum BLAS_UPLO { Blas_upper = 121,
-//                          Blas_lower = 122 } BLAS_UPLO;
-
-// typedef enum BLAS_ORDERING { Blas_row_major = 101,
-//                              Blas_col_major = 102 } BLAS_ORDERING;
+using vector = std::vector<float>;
 
 // BLAS level 3 operations
 
 /**
  * @brief FP32 In-place Cholesky decomposition of A
- * @param f_A matrix to be factorized
+ * @param A matrix to be factorized
  * @param N matrix dimension
  * @return factorized, lower triangular matrix L
  */
-vector potrf(vector_future f_A, const int N);
+vector potrf(vector A, const int N);
 
 /**
  * @brief FP32 In-place solve L(^T) * X = A or X * L(^T) = A where L lower triangular
- * @param f_L Cholesky factor matrix
- * @param f_A right hand side matrix
+ * @param L Cholesky factor matrix
+ * @param A right hand side matrix
  * @param N first dimension
  * @param M second dimension
  * @return solution matrix X
  */
-vector trsm(vector_future f_L,
-            vector_future f_A,
+vector trsm(const vector &L,
+            vector A,
             const int N,
             const int M,
             const BLAS_TRANSPOSE transpose_L,
@@ -46,18 +38,18 @@ vector trsm(vector_future f_L,
 
 /**
  * @brief FP32 Symmetric rank-k update: A = A - B * B^T
- * @param f_A Base matrix
- * @param f_B Symmetric update matrix
+ * @param A Base matrix
+ * @param B Symmetric update matrix
  * @param N matrix dimension
  * @return updated matrix A
  */
-vector syrk(vector_future f_A, vector_future f_B, const int N);
+vector syrk(vector A, const vector &B, const int N);
 
 /**
  * @brief FP32 General matrix-matrix multiplication: C = C - A(^T) * B(^T)
- * @param f_C Base matrix
- * @param f_B Right update matrix
- * @param f_A Left update matrix
+ * @param C Base matrix
+ * @param B Right update matrix
+ * @param A Left update matrix
  * @param N first matrix dimension
  * @param M second matrix dimension
  * @param K third matrix dimension
@@ -65,84 +57,150 @@ vector syrk(vector_future f_A, vector_future f_B, const int N);
  * @param transpose_B transpose right matrix
  * @return updated matrix X
  */
-vector gemm(vector_future f_A,
-            vector_future f_B,
-            vector_future f_C,
+vector gemm(const vector &A,
+            const vector &B,
+            vector C,
             const int N,
             const int M,
             const int K,
             const BLAS_TRANSPOSE transpose_A,
             const BLAS_TRANSPOSE transpose_B);
 
+/**
+ * @brief FP32 Inverse of a lower triangular matrix L, computed in the storage of the buffer X
+ * @param L lower triangular matrix
+ * @param X buffer for the inverse, its strictly upper triangle is zeroed
+ * @param N matrix dimension
+ * @return lower triangular inverse L^-1
+ */
+vector trtri(const vector &L, vector X, const int N);
+
+/**
+ * @brief FP32 In-place product L^T * L of a lower triangular matrix L
+ * @param L lower triangular matrix
+ * @param N matrix dimension
+ * @return lower triangle of the symmetric product L^T * L
+ */
+vector lauum(vector L, const int N);
+
+/**
+ * @brief FP32 In-place multiplication A = L(^T) * A or A = A * L(^T) where L lower triangular
+ * @param L lower triangular matrix
+ * @param A base matrix
+ * @param N first dimension
+ * @param M second dimension
+ * @param transpose_L transpose lower triangular matrix
+ * @param side_L side of the lower triangular matrix
+ * @return updated matrix A
+ */
+vector trmm(const vector &L,
+            vector A,
+            const int N,
+            const int M,
+            const BLAS_TRANSPOSE transpose_L,
+            const BLAS_SIDE side_L);
+
+/**
+ * @brief FP32 Transposed symmetric rank-k update: A = A + B^T * B
+ * @param A Base matrix, only the lower triangle is updated
+ * @param B Symmetric update matrix
+ * @param N matrix dimension
+ * @return updated matrix A
+ */
+vector syrk_trans_add(vector A, const vector &B, const int N);
+
+/**
+ * @brief FP32 Transposed matrix-matrix multiplication: C = C + A^T * B
+ * @param A Left update matrix
+ * @param B Right update matrix
+ * @param C Base matrix
+ * @param N matrix dimension
+ * @return updated matrix C
+ */
+vector gemm_trans_add(const vector &A, const vector &B, vector C, const int N);
+
 // BLAS level 2 operations
 
 /**
  * @brief FP32 In-place solve L(^T) * x = a where L lower triangular
- * @param f_L Cholesky factor matrix
- * @param f_a right hand side vector
+ * @param L Cholesky factor matrix
+ * @param a right hand side vector
  * @param N matrix dimension
  * @param transpose_L transpose Cholesky factor
  * @return solution vector x
  */
-vector trsv(vector_future f_L, vector_future f_a, const int N, const BLAS_TRANSPOSE transpose_L);
+vector trsv(const vector &L, vector a, const int N, const BLAS_TRANSPOSE transpose_L);
 
 /**
  * @brief FP32 General matrix-vector multiplication: b = b - A(^T) * a
- * @param f_A update matrix
- * @param f_a update vector
- * @param f_b base vector
+ * @param A update matrix
+ * @param a update vector
+ * @param b base vector
  * @param N matrix dimension
  * @param alpha add or substract update to base vector
  * @param transpose_A transpose update matrix
  * @return updated vector b
  */
-vector gemv(vector_future f_A,
-            vector_future f_a,
-            vector_future f_b,
+vector gemv(const vector &A,
+            const vector &a,
+            vector b,
             const int N,
             const int M,
             const BLAS_ALPHA alpha,
             const BLAS_TRANSPOSE transpose_A);
 
+/**
+ * @brief FP32 Symmetric matrix-vector multiplication: b = b + A * a or b = b - A * a
+ * @param A symmetric update matrix, only the lower triangle is referenced
+ * @param a update vector
+ * @param b base vector
+ * @param N matrix dimension
+ * @param alpha add or substract update to base vector
+ * @return updated vector b
+ */
+vector symv(const vector &A, const vector &a, vector b, const int N, const BLAS_ALPHA alpha);
+
 /**
  * @brief FP32 Vector update with diagonal SYRK: r = r + diag(A^T * A)
- * @param f_A update matrix
- * @param f_r base vector
+ * @param A update matrix
+ * @param r base vector
  * @param N first matrix dimension
  * @param M second matrix dimension
  * @return updated vector r
  */
-vector dot_diag_syrk(vector_future f_A, vector_future f_r, const int N, const int M);
+vector dot_diag_syrk(const vector &A, vector r, const int N, const int M);
 
 /**
  * @brief FP32 Vector update with diagonal GEMM: r = r + diag(A * B)
- * @param f_A first update matrix
- * @param f_B second update matrix
- * @param f_r base vector
+ * @param A first update matrix
+ * @param B second update matrix
+ * @param r base vector
  * @param N first matrix dimension
  * @param M second matrix dimension
  * @return updated vector r
  */
-vector dot_diag_gemm(vector_future f_A, vector_future f_B, vector_future f_r, const int N, const int M);
+vector dot_diag_gemm(const vector &A, const vector &B, vector r, const int N, const int M);
 
 // BLAS level 1 operations
 
 /**
  * @brief FP32 AXPY: y - x
- * @param f_y left vector
- * @param f_x right vector
+ * @param y left vector
+ * @param x right vector
  * @param N vector length
  * @return y - x
  */
-vector axpy(vector_future f_y, vector_future f_x, const int N);
+vector axpy(vector y, const vector &x, const int N);
 
 /**
  * @brief FP32 Dot product: a * b
- * @param f_a left vector
- * @param f_b right vector
+ * @param a left vector
+ * @param b right vector
  * @param N vector length
  * @return a * b
  */
-float dot(std::vector<float> a, std::vector<float> b, const int N);
+float dot(const std::vector<float> &a, const std::vector<float> &b, const int N);
+
+}  // end of namespace fp32
 
 #endif  // end of CPU_ADAPTER_CBLAS_FP32_H
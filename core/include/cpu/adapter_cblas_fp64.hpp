@@ -1,46 +1,35 @@
 #ifndef CPU_ADAPTER_CBLAS_FP64_H
 #define CPU_ADAPTER_CBLAS_FP64_H
 
-#include <hpx/future.hpp>
+#include "cpu/adapter_cblas_constants.hpp"
 #include <vector>
 
-using vector_future = hpx::shared_future<std::vector<double>>;
 using vector = std::vector<double>;
 
-// Constants that are compatible with CBLAS
-
-typedef enum BLAS_TRANSPOSE { Blas_no_trans = 111, Blas_trans = 112 } BLAS_TRANSPOSE;
-
-typedef enum BLAS_SIDE { Blas_left = 141, Blas_right = 142 } BLAS_SIDE;
-
-typedef enum BLAS_ALPHA { Blas_add = 1, Blas_substract = -1 } BLAS_ALPHA;
-
-// typedef enum BLAS_UPLO { Blas_upper = 121,
-//                          Blas_lower = 122 } BLAS_UPLO;
-
-// typedef enum BLAS_ORDERING { Blas_row_major = 101,
-//                              Blas_col_major = 102 } BLAS_ORDERING;
+// Operands that are updated in-place are taken by value. Called through hpx::unwrapping,
+// a tile passed as unique hpx::future is moved into the operation without a copy, while
+// a tile passed as hpx::shared_future is copied since other tasks may still read it.
 
 // BLAS level 3 operations
 
 /**
  * @brief FP64 In-place Cholesky decomposition of A
- * @param f_A matrix to be factorized
+ * @param A matrix to be factorized
  * @param N matrix dimension
  * @return factorized, lower triangular matrix L
  */
-vector potrf(vector_future f_A, const int N);
+vector potrf(vector A, const int N);
 
 /**
  * @brief FP64 In-place solve L(^T) * X = A or X * L(^T) = A where L lower triangular
- * @param f_L Cholesky factor matrix
- * @param f_A right hand side matrix
+ * @param L Cholesky factor matrix
+ * @param A right hand side matrix
  * @param N first dimension
  * @param M second dimension
  * @return solution matrix X
  */
-vector trsm(vector_future f_L,
-            vector_future f_A,
+vector trsm(const vector &L,
+            vector A,
             const int N,
             const int M,
             const BLAS_TRANSPOSE transpose_L,
@@ -48,18 +37,18 @@ vector trsm(vector_future f_L,
 
 /**
  * @brief FP64 Symmetric rank-k update: A = A - B * B^T
- * @param f_A Base matrix
- * @param f_B Symmetric update matrix
+ * @param A Base matrix
+ * @param B Symmetric update matrix
  * @param N matrix dimension
  * @return updated matrix A
  */
-vector syrk(vector_future f_A, vector_future f_B, const int N);
+vector syrk(vector A, const vector &B, const int N);
 
 /**
  * @brief FP64 General matrix-matrix multiplication: C = C - A(^T) * B(^T)
- * @param f_C Base matrix
- * @param f_B Right update matrix
- * @param f_A Left update matrix
+ * @param C Base matrix
+ * @param B Right update matrix
+ * @param A Left update matrix
  * @param N first matrix dimension
  * @param M second matrix dimension
  * @param K third matrix dimension
@@ -67,76 +56,249 @@ vector syrk(vector_future f_A, vector_future f_B, const int N);
  * @param transpose_B transpose right matrix
  * @return updated matrix X
  */
-vector gemm(vector_future f_A,
-            vector_future f_B,
-            vector_future f_C,
+vector gemm(const vector &A,
+            const vector &B,
+            vector C,
             const int N,
             const int M,
             const int K,
             const BLAS_TRANSPOSE transpose_A,
             const BLAS_TRANSPOSE transpose_B);
 
+/**
+ * @brief FP64 Inverse of a lower triangular matrix L, computed in the storage of the buffer X
+ * @param L lower triangular matrix
+ * @param X buffer for the inverse, its strictly upper triangle is zeroed
+ * @param N matrix dimension
+ * @return lower triangular inverse L^-1
+ */
+vector trtri(const vector &L, vector X, const int N);
+
+/**
+ * @brief FP64 In-place product L^T * L of a lower triangular matrix L
+ * @param L lower triangular matrix
+ * @param N matrix dimension
+ * @return lower triangle of the symmetric product L^T * L
+ */
+vector lauum(vector L, const int N);
+
+/**
+ * @brief FP64 In-place multiplication A = L(^T) * A or A = A * L(^T) where L lower triangular
+ * @param L lower triangular matrix
+ * @param A base matrix
+ * @param N first dimension
+ * @param M second dimension
+ * @param transpose_L transpose lower triangular matrix
+ * @param side_L side of the lower triangular matrix
+ * @return updated matrix A
+ */
+vector trmm(const vector &L,
+            vector A,
+            const int N,
+            const int M,
+            const BLAS_TRANSPOSE transpose_L,
+            const BLAS_SIDE side_L);
+
+/**
+ * @brief FP64 Transposed symmetric rank-k update: A = A + B^T * B
+ * @param A Base matrix, only the lower triangle is updated
+ * @param B Symmetric update matrix
+ * @param N matrix dimension
+ * @return updated matrix A
+ */
+vector syrk_trans_add(vector A, const vector &B, const int N);
+
+/**
+ * @brief FP64 Transposed matrix-matrix multiplication: C = C + A^T * B
+ * @param A Left update matrix
+ * @param B Right update matrix
+ * @param C Base matrix
+ * @param N matrix dimension
+ * @return updated matrix C
+ */
+vector gemm_trans_add(const vector &A, const vector &B, vector C, const int N);
+
+/**
+ * @brief FP64 Symmetric rank-k update with a rectangular panel: A = A + B * B^T
+ * @param A Base matrix, only the lower triangle is updated
+ * @param B Update panel of size N x K
+ * @param N matrix dimension
+ * @param K number of columns of the panel
+ * @return updated matrix A
+ */
+vector syrk_panel_add(vector A, const vector &B, const int N, const int K);
+
+/**
+ * @brief FP64 Matrix-matrix multiplication with rectangular panels: C = C + A * B^T
+ * @param A Left update panel of size N x K
+ * @param B Right update panel of size M x K
+ * @param C Base matrix of size N x M
+ * @param N first matrix dimension
+ * @param M second matrix dimension
+ * @param K number of columns of the panels
+ * @return updated matrix C
+ */
+vector gemm_panel_add(const vector &A, const vector &B, vector C, const int N, const int M, const int K);
+
+/**
+ * @brief FP64 Matrix-multi-vector multiplication: C = C + A(^T) * B
+ * @param A quadratic update matrix of size N x N
+ * @param B block of M vectors of size N x M
+ * @param C base block of size N x M
+ * @param N matrix dimension
+ * @param M number of vectors
+ * @param transpose_A transpose update matrix
+ * @return updated block C
+ */
+vector gemm_multi_vector(const vector &A,
+                         const vector &B,
+                         vector C,
+                         const int N,
+                         const int M,
+                         const BLAS_TRANSPOSE transpose_A);
+
+/**
+ * @brief FP64 Inner product of rectangular panels: C = A^T * B
+ * @param A Left panel of size N x K_A
+ * @param B Right panel of size N x K_B
+ * @param N number of rows of the panels
+ * @param K_A number of columns of the left panel
+ * @param K_B number of columns of the right panel
+ * @return product matrix C of size K_A x K_B
+ */
+vector gemm_panel_inner(const vector &A, const vector &B, const int N, const int K_A, const int K_B);
+
+/**
+ * @brief FP64 Eigendecomposition of a symmetric tridiagonal matrix T = Z * diag(lambda) * Z^T
+ * @param diagonal diagonal of T
+ * @param off_diagonal subdiagonal of T
+ * @param N matrix dimension
+ * @return packed eigendecomposition: N eigenvalues in ascending order followed by the eigenvectors
+ *         as the columns of Z (N x N)
+ */
+vector stev(vector diagonal, vector off_diagonal, const int N);
+
+/**
+ * @brief FP64 Thin QR decomposition of a rectangular panel A = Q * R
+ * @param A panel of size N x K
+ * @param N number of rows
+ * @param K number of columns
+ * @return packed decomposition with r = min(N, K): orthonormal Q (N x r) followed by upper triangular R (r x K)
+ */
+vector geqrf_panel(vector A, const int N, const int K);
+
+/**
+ * @brief FP64 Thin singular value decomposition A = U * diag(sigma) * V^T
+ * @param A matrix of size N x M
+ * @param N first matrix dimension
+ * @param M second matrix dimension
+ * @return packed decomposition with r = min(N, M): singular values in descending order (r), followed by
+ *         U (N x r) and V^T (r x M)
+ */
+vector gesvd(vector A, const int N, const int M);
+
+/**
+ * @brief FP64 QR decomposition of the stacked matrix [L^T; W^T] = Q * [R; 0]
+ *
+ * First step of the rank-N update L' * L'^T = L * L^T + W * W^T.
+ *
+ * @param L lower triangular matrix
+ * @param W update matrix
+ * @param N matrix dimension
+ * @return packed QR decomposition: Householder reflectors (2N x N, column-major) followed by N scalar factors
+ */
+vector geqrf_update(const vector &L, const vector &W, const int N);
+
+/**
+ * @brief FP64 Extract updated lower triangular matrix L' = R^T with positive diagonal
+ * @param QR packed QR decomposition of geqrf_update
+ * @param N matrix dimension
+ * @return updated lower triangular matrix L'
+ */
+vector qr_update_factor(const vector &QR, const int N);
+
+/**
+ * @brief FP64 Apply the orthogonal factor of geqrf_update: [L' W'] = [L W] * Q
+ * @param QR packed QR decomposition of geqrf_update
+ * @param L matrix below the factorized diagonal matrix
+ * @param W update matrix
+ * @param N matrix dimension
+ * @return packed updated matrices L' and W'
+ */
+vector ormqr_update(const vector &QR, const vector &L, const vector &W, const int N);
+
 // BLAS level 2 operations
 
 /**
  * @brief FP64 In-place solve L(^T) * x = a where L lower triangular
- * @param f_L Cholesky factor matrix
- * @param f_a right hand side vector
+ * @param L Cholesky factor matrix
+ * @param a right hand side vector
  * @param N matrix dimension
  * @param transpose_L transpose Cholesky factor
  * @return solution vector x
  */
-vector trsv(vector_future f_L, vector_future f_a, const int N, const BLAS_TRANSPOSE transpose_L);
+vector trsv(const vector &L, vector a, const int N, const BLAS_TRANSPOSE transpose_L);
 
 /**
  * @brief FP64 General matrix-vector multiplication: b = b - A(^T) * a
- * @param f_A update matrix
- * @param f_a update vector
- * @param f_b base vector
+ * @param A update matrix
+ * @param a update vector
+ * @param b base vector
  * @param N matrix dimension
  * @param alpha add or substract update to base vector
  * @param transpose_A transpose update matrix
  * @return updated vector b
  */
-vector gemv(vector_future f_A,
-            vector_future f_a,
-            vector_future f_b,
+vector gemv(const vector &A,
+            const vector &a,
+            vector b,
             const int N,
             const int M,
             const BLAS_ALPHA alpha,
             const BLAS_TRANSPOSE transpose_A);
 
+/**
+ * @brief FP64 Symmetric matrix-vector multiplication: b = b + A * a or b = b - A * a
+ * @param A symmetric update matrix, only the lower triangle is referenced
+ * @param a update vector
+ * @param b base vector
+ * @param N matrix dimension
+ * @param alpha add or substract update to base vector
+ * @return updated vector b
+ */
+vector symv(const vector &A, const vector &a, vector b, const int N, const BLAS_ALPHA alpha);
+
 /**
  * @brief FP64 Vector update with diagonal SYRK: r = r + diag(A^T * A)
- * @param f_A update matrix
- * @param f_r base vector
+ * @param A update matrix
+ * @param r base vector
  * @param N first matrix dimension
  * @param M second matrix dimension
  * @return updated vector r
  */
-vector dot_diag_syrk(vector_future f_A, vector_future f_r, const int N, const int M);
+vector dot_diag_syrk(const vector &A, vector r, const int N, const int M);
 
 /**
  * @brief FP64 Vector update with diagonal GEMM: r = r + diag(A * B)
- * @param f_A first update matrix
- * @param f_B second update matrix
- * @param f_r base vector
+ * @param A first update matrix
+ * @param B second update matrix
+ * @param r base vector
  * @param N first matrix dimension
  * @param M second matrix dimension
  * @return updated vector r
  */
-vector dot_diag_gemm(vector_future f_A, vector_future f_B, vector_future f_r, const int N, const int M);
+vector dot_diag_gemm(const vector &A, const vector &B, vector r, const int N, const int M);
 
 // BLAS level 1 operations
 
 /**
  * @brief FP64 AXPY: y - x
- * @param f_y left vector
- * @param f_x right vector
+ * @param y left vector
+ * @param x right vector
  * @param N vector length
  * @return y - x
  */
-vector axpy(vector_future f_y, vector_future f_x, const int N);
+vector axpy(vector y, const vector &x, const int N);
 
 /**
  * @brief FP64 Dot product: a * b
@@ -145,6 +307,6 @@ vector axpy(vector_future f_y, vector_future f_x, const int N);
  * @param N vector length
  * @return a * b
  */
-double dot(std::vector<double> a, std::vector<double> b, const int N);
+double dot(const std::vector<double> &a, const std::vector<double> &b, const int N);
 
 #endif  // end of CPU_ADAPTER_CBLAS_FP64_H
@@ -7,6 +7,9 @@
 namespace cpu
 {
 
+// The tile generators templated on the element type T of the generated tile are instantiated
+// for double and float. Entries are computed in FP64 and rounded once when they are stored.
+
 /**
  * @brief Compute the squared exponential kernel of two feature vectors
  *
@@ -26,6 +29,33 @@ double compute_covariance_function(std::size_t i_global,
                                    const std::vector<double> &i_input,
                                    const std::vector<double> &j_input);
 
+/**
+ * @brief Generate a tile of squared distances between lagged feature vectors
+ *
+ * Feature vectors are sliding windows over one input series, so for many regressors
+ * d(i,j) = d(i-1,j-1) - (z_{i-1} - z_{j-1})^2 + (z_{i-1+R} - z_{j-1+R})^2 is used
+ * instead of the O(R) sum. Every 32nd row and the first column are computed exactly
+ * to bound the floating-point drift of the recurrence.
+ *
+ * @param row The row index of the tile in the tiled matrix
+ * @param col The column index of the tile in the tiled matrix
+ * @param N_row The row-wise dimension of the tile
+ * @param N_col The column-wise dimension of the tile
+ * @param n_regressors The number of regressors
+ * @param row_input The input data vector of the rows
+ * @param col_input The input data vector of the columns
+ *
+ * @return A tile of squared distances of size N_row x N_col
+ */
+std::vector<double> gen_tile_lagged_distance(
+    std::size_t row,
+    std::size_t col,
+    std::size_t N_row,
+    std::size_t N_col,
+    std::size_t n_regressors,
+    const std::vector<double> &row_input,
+    const std::vector<double> &col_input);
+
 /**
  * @brief Generate a tile of the covariance matrix
  *
@@ -39,7 +69,8 @@ double compute_covariance_function(std::size_t i_global,
  * @return A quadratic tile of the covariance matrix of size N x N
  * @note Does apply noise variance on the diagonal
  */
-std::vector<double> gen_tile_covariance(
+template <typename T>
+std::vector<T> gen_tile_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N,
@@ -61,7 +92,8 @@ std::vector<double> gen_tile_covariance(
  * @note Does NOT apply noise variance on the diagonal
  */
 // NAME: gen_tile_priot_covariance
-std::vector<double> gen_tile_full_prior_covariance(
+template <typename T>
+std::vector<T> gen_tile_full_prior_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N,
@@ -83,7 +115,8 @@ std::vector<double> gen_tile_full_prior_covariance(
  * @note Does NOT apply noise variance
  */
 // NAME: gen_tile_diag_prior_covariance
-std::vector<double> gen_tile_prior_covariance(
+template <typename T>
+std::vector<T> gen_tile_prior_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N,
@@ -105,7 +138,8 @@ std::vector<double> gen_tile_prior_covariance(
  * @return A tile of the cross covariance matrix of size N_row x N_col
  * @note Does NOT apply noise variance
  */
-std::vector<double> gen_tile_cross_covariance(
+template <typename T>
+std::vector<T> gen_tile_cross_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N_row,
@@ -115,6 +149,78 @@ std::vector<double> gen_tile_cross_covariance(
     const std::vector<double> &row_input,
     const std::vector<double> &col_input);
 
+/**
+ * @brief Generate a tile of squared distances between inducing points and lagged feature vectors
+ *
+ * @param col The column index of the tile in the tiled matrix
+ * @param M The number of inducing points
+ * @param N_col The column-wise dimension of the tile
+ * @param n_regressors The number of regressors
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ * @param col_input The input data vector of the columns
+ *
+ * @return A tile of squared distances of size M x N_col
+ */
+std::vector<double> gen_tile_inducing_distance(
+    std::size_t col,
+    std::size_t M,
+    std::size_t N_col,
+    std::size_t n_regressors,
+    const std::vector<double> &inducing_points,
+    const std::vector<double> &col_input);
+
+/**
+ * @brief Generate the squared distances between all pairs of inducing points
+ *
+ * @param M The number of inducing points
+ * @param n_regressors The number of regressors
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ *
+ * @return A quadratic tile of squared distances of size M x M
+ */
+std::vector<double>
+gen_tile_inducing_self_distance(std::size_t M, std::size_t n_regressors, const std::vector<double> &inducing_points);
+
+/**
+ * @brief Generate a tile of the cross-covariance matrix between inducing points and lagged feature vectors
+ *
+ * @param col The column index of the tile in the tiled matrix
+ * @param M The number of inducing points
+ * @param N_col The column-wise dimension of the tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ * @param col_input The input data vector of the columns
+ *
+ * @return A tile of the cross covariance matrix of size M x N_col
+ * @note Does NOT apply noise variance
+ */
+std::vector<double> gen_tile_inducing_cross_covariance(
+    std::size_t col,
+    std::size_t M,
+    std::size_t N_col,
+    std::size_t n_regressors,
+    const gprat_hyper::SEKParams &sek_params,
+    const std::vector<double> &inducing_points,
+    const std::vector<double> &col_input);
+
+/**
+ * @brief Generate the covariance matrix of the inducing points
+ *
+ * @param M The number of inducing points
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ *
+ * @return A quadratic tile of the covariance matrix of size M x M
+ * @note Applies a jitter of 1e-6 * vertical_lengthscale on the diagonal instead of the noise variance, such that
+ *       the matrix scales with the vertical lengthscale
+ */
+std::vector<double> gen_tile_inducing_covariance(std::size_t M,
+                                                 std::size_t n_regressors,
+                                                 const gprat_hyper::SEKParams &sek_params,
+                                                 const std::vector<double> &inducing_points);
+
 /**
  * @brief Transpose a tile of size N_row x N_col
  *
@@ -124,7 +230,33 @@ std::vector<double> gen_tile_cross_covariance(
  *
  * @return The transposed tile of size N_col x N_row
  */
-std::vector<double> gen_tile_transpose(std::size_t N_row, std::size_t N_col, const std::vector<double> &tile);
+template <typename T>
+std::vector<T> gen_tile_transpose(std::size_t N_row, std::size_t N_col, const std::vector<T> &tile);
+
+/**
+ * @brief Transpose a tile of size N_row x N_col into a given buffer
+ *
+ * @param transposed The buffer for the transposed tile, its storage is reused
+ * @param N_row The row-wise dimension of the tile
+ * @param N_col The column-wise dimension of the tile
+ * @param tile The tile to transpose
+ *
+ * @return The transposed tile of size N_col x N_row
+ */
+template <typename T>
+std::vector<T> gen_tile_transpose_into(
+    std::vector<T> transposed, std::size_t N_row, std::size_t N_col, const std::vector<T> &tile);
+
+/**
+ * @brief Extract a tile of size N x N from consecutively packed tiles
+ *
+ * @param index The index of the tile within the packed tiles
+ * @param N The dimension of the tile
+ * @param packed The packed tiles
+ *
+ * @return The tile of size N x N
+ */
+std::vector<double> gen_tile_unpack(std::size_t index, std::size_t N, const std::vector<double> &packed);
 
 /**
  * @brief Generate a tile of the output data
@@ -135,7 +267,8 @@ std::vector<double> gen_tile_transpose(std::size_t N_row, std::size_t N_col, con
  *
  * @return A tile of the output data of size N
  */
-std::vector<double> gen_tile_output(std::size_t row, std::size_t N, const std::vector<double> &output);
+template <typename T>
+std::vector<T> gen_tile_output(std::size_t row, std::size_t N, const std::vector<double> &output);
 
 /**
  * @brief Compute the L2-error norm over all tiles and elements
@@ -158,7 +291,8 @@ double compute_error_norm(std::size_t n_tiles,
  *
  * @return A tile filled with zeros of size N
  */
-std::vector<double> gen_tile_zeros(std::size_t N);
+template <typename T>
+std::vector<T> gen_tile_zeros(std::size_t N);
 
 /**
  * @brief Generate an identity tile (i==j?1:0)
@@ -166,7 +300,36 @@ std::vector<double> gen_tile_zeros(std::size_t N);
  * @param N The dimension of the quadratic tile
  * @return A NxN identity tile
  */
-std::vector<double> gen_tile_identity(std::size_t N);
+template <typename T>
+std::vector<T> gen_tile_identity(std::size_t N);
+
+/**
+ * @brief Fill a given buffer with an identity tile (i==j?1:0)
+ *
+ * @param tile The buffer for the tile, its storage is reused
+ * @param N The dimension of the quadratic tile
+ * @return A NxN identity tile
+ */
+template <typename T>
+std::vector<T> gen_tile_identity_into(std::vector<T> tile, std::size_t N);
+
+/**
+ * @brief Generate an FP32 copy of a tile, rounding each element
+ *
+ * @param tile The FP64 tile
+ *
+ * @return The FP32 tile of the same size
+ */
+std::vector<float> gen_tile_fp32(const std::vector<double> &tile);
+
+/**
+ * @brief Generate an FP64 copy of a tile, which is exact
+ *
+ * @param tile The FP32 tile
+ *
+ * @return The FP64 tile of the same size
+ */
+std::vector<double> gen_tile_fp64(const std::vector<float> &tile);
 
 }  // end of namespace cpu
 
@@ -0,0 +1,110 @@
+#ifndef CPU_GP_EXPERTS_H
+#define CPU_GP_EXPERTS_H
+
+#include "approximation.hpp"
+#include "gp_hyperparameters.hpp"
+#include "gp_kernels.hpp"
+#include <utility>
+#include <vector>
+
+namespace cpu
+{
+
+// Local experts approximation of a GP. Each diagonal tile of the covariance matrix is an independent expert with
+// its own Cholesky decomposition and triangular solves, all off-diagonal tiles are dropped. The loss of the
+// block-diagonal covariance matrix and the predictions of all experts are computed without any dependencies
+// between the experts, such that training and prediction scale linearly in the number of training tiles.
+// All local experts computations are performed in FP64.
+
+/**
+ * @brief Compute the loss of the local experts approximation
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles, equal to the number of experts
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ *
+ * @return The loss
+ */
+double compute_experts_loss(const std::vector<double> &training_input,
+                            const std::vector<double> &training_output,
+                            int n_tiles,
+                            int n_tile_size,
+                            int n_regressors,
+                            const gprat_hyper::SEKParams &sek_params);
+
+/**
+ * @brief Compute the loss of the local experts approximation and its gradients
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles, equal to the number of experts
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ *
+ * @return The loss and its gradients w.r.t. the unconstrained lengthscale, vertical lengthscale and noise variance
+ */
+std::pair<double, std::vector<double>>
+compute_experts_loss_and_gradient(const std::vector<double> &training_input,
+                                  const std::vector<double> &training_output,
+                                  int n_tiles,
+                                  int n_tile_size,
+                                  int n_regressors,
+                                  const gprat_hyper::SEKParams &sek_params);
+
+/**
+ * @brief Optimize the kernel hyperparameters of the local experts approximation with Adam
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles, equal to the number of experts
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param adam_params The Adam optimizer hyperparameters
+ * @param sek_params The kernel hyperparameters, updated in-place
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ *
+ * @return A vector containing the loss values of each iteration
+ */
+std::vector<double> optimize_experts(const std::vector<double> &training_input,
+                                     const std::vector<double> &training_output,
+                                     int n_tiles,
+                                     int n_tile_size,
+                                     int n_regressors,
+                                     const gprat_hyper::AdamParams &adam_params,
+                                     gprat_hyper::SEKParams &sek_params,
+                                     const std::vector<bool> &trainable_params);
+
+/**
+ * @brief Compute the combined predictions and uncertainties of the local experts
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles, equal to the number of experts
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param combination The combination of the expert predictions
+ *
+ * @return A vector containing the prediction vector and the uncertainty vector
+ */
+std::vector<std::vector<double>> predict_experts_with_uncertainty(const std::vector<double> &training_input,
+                                                                  const std::vector<double> &training_output,
+                                                                  const std::vector<double> &test_input,
+                                                                  int n_tiles,
+                                                                  int n_tile_size,
+                                                                  int m_tiles,
+                                                                  int m_tile_size,
+                                                                  int n_regressors,
+                                                                  const gprat_hyper::SEKParams &sek_params,
+                                                                  gprat::Expert_combination combination);
+
+}  // end of namespace cpu
+
+#endif  // end of CPU_GP_EXPERTS_H
@@ -1,13 +1,158 @@
 #ifndef CPU_GP_FUNCTIONS_H
 #define CPU_GP_FUNCTIONS_H
 
+#include "cpu/tiled_algorithms.hpp"
 #include "gp_hyperparameters.hpp"
 #include "gp_kernels.hpp"
+#include "precision.hpp"
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace cpu
 {
 
+// The functions templated on the element type T of the tiles are instantiated for double and float,
+// results are always returned in FP64
+
+/**
+ * @brief Factorization of the covariance matrix K of a GP that can be reused across predictions
+ *
+ * Holds the tiled Cholesky factor L of K and the tiled solution alpha = K^-1 * y. Both only depend
+ * on the training data and the kernel hyperparameters, which are stored alongside to detect when
+ * the factorization becomes stale.
+ *
+ * @tparam T The element type of the tiles
+ */
+template <typename T>
+struct Tiled_factorization
+{
+    /**
+     * @brief Tiled Cholesky factor L of the covariance matrix K (lower triangular tiles only), in mixed precision
+     * only the diagonal tiles
+     */
+    Tiles<T> L_tiles;
+
+    /** @brief In mixed precision, the FP32 lower off-diagonal tiles of L, otherwise empty */
+    Tiles<float> L_single_tiles;
+
+    /** @brief Tiled intermediate solution beta = L^-1 * y */
+    Tiles<T> beta_tiles;
+
+    /** @brief Tiled solution alpha = K^-1 * y */
+    Tiles<T> alpha_tiles;
+
+    /** @brief Kernel hyperparameters used to assemble K */
+    gprat_hyper::SEKParams sek_params;
+
+    /** @brief Number of regressors used to assemble K */
+    int n_regressors;
+
+    /**
+     * @brief Returns true if the factorization was computed with the given kernel configuration
+     *
+     * @param sek_params The kernel hyperparameters
+     * @param n_regressors The number of regressors
+     */
+    bool matches(const gprat_hyper::SEKParams &sek_params, int n_regressors) const;
+};
+
+using Factorization = Tiled_factorization<double>;
+using Factorization_fp32 = Tiled_factorization<float>;
+
+/**
+ * @brief Assemble K, compute its Cholesky factor L and solve K * alpha = y
+ *
+ * In mixed precision, the off-diagonal tiles of K and L are assembled and kept in FP32 and alpha
+ * is corrected by iterative refinement against the FP64 covariance matrix. Operations that need
+ * the full FP64 factor widen the FP32 tiles on demand.
+ * All computations are launched asynchronously, the returned tiles are not synchronized.
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param sek_params The kernel hyperparameters
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param precision The precision of the Cholesky decomposition, fp64 or mixed
+ *
+ * @return The factorization holding the tiled Cholesky factor and alpha
+ */
+Factorization factorize(const std::vector<double> &training_input,
+                        const std::vector<double> &training_output,
+                        const gprat_hyper::SEKParams &sek_params,
+                        int n_tiles,
+                        int n_tile_size,
+                        int n_regressors,
+                        gprat::Precision precision);
+
+/**
+ * @brief Assemble K, compute its Cholesky factor L and solve K * alpha = y in FP32
+ *
+ * The entries of K are computed in FP64 and rounded once to FP32, all tiles are stored in FP32.
+ * All computations are launched asynchronously, the returned tiles are not synchronized.
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param sek_params The kernel hyperparameters
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ *
+ * @return The FP32 factorization holding the tiled Cholesky factor and alpha
+ */
+Factorization_fp32 factorize_fp32(const std::vector<double> &training_input,
+                                  const std::vector<double> &training_output,
+                                  const gprat_hyper::SEKParams &sek_params,
+                                  int n_tiles,
+                                  int n_tile_size,
+                                  int n_regressors);
+
+/**
+ * @brief Extend a factorization by new tile rows of training data
+ *
+ * Only the new tile rows of K are assembled and factorized against the existing
+ * Cholesky factor, which costs O(N^2 * n_tile_size) instead of O(N^3) per tile row.
+ * All computations are launched asynchronously, the returned tiles are not synchronized.
+ *
+ * @param factorization The factorization of the covariance matrix of the first n_tiles_old tile rows
+ * @param training_input The extended training input data
+ * @param training_output The extended training output data
+ * @param n_tiles_old The number of training tiles covered by the factorization
+ * @param n_tiles The number of training tiles of the extended training data
+ * @param n_tile_size The size of each training tile
+ *
+ * @return The factorization of the extended covariance matrix
+ */
+Factorization extend_factorization(const Factorization &factorization,
+                                   const std::vector<double> &training_input,
+                                   const std::vector<double> &training_output,
+                                   int n_tiles_old,
+                                   int n_tiles,
+                                   int n_tile_size);
+
+/**
+ * @brief Remove the oldest tile rows of training data from a factorization
+ *
+ * Dropping the first tile rows and columns of K leaves K_22 = L_21 * L_21^T + L_22 * L_22^T,
+ * whose Cholesky factor is obtained with a tiled rank update of L_22 in O(N^2 * n_tile_size)
+ * per dropped tile row instead of O(N^3).
+ * All computations are launched asynchronously, the returned tiles are not synchronized.
+ *
+ * @param factorization The factorization of the covariance matrix of n_tiles tile rows
+ * @param training_output The training output data without the dropped observations
+ * @param n_tiles The number of training tiles covered by the factorization
+ * @param n_drop_tiles The number of oldest training tiles to drop
+ * @param n_tile_size The size of each training tile
+ *
+ * @return The factorization of the remaining covariance matrix
+ */
+Factorization drop_factorization(const Factorization &factorization,
+                                 const std::vector<double> &training_output,
+                                 int n_tiles,
+                                 int n_drop_tiles,
+                                 int n_tile_size);
+
 /**
  * @brief Perform Cholesky decompositon (+Assebmly)
  *
@@ -27,6 +172,17 @@ cholesky(const std::vector<double> &training_input,
          int n_tile_size,
          int n_regressors);
 
+/**
+ * @brief Synchronize and return the Cholesky factor of an existing factorization
+ *
+ * @param factorization The factorization of the covariance matrix
+ * @param n_tiles The number of training tiles
+ *
+ * @return The tiled Cholesky factor
+ */
+template <typename T>
+std::vector<std::vector<double>> cholesky(const Tiled_factorization<T> &factorization, int n_tiles);
+
 /**
  * @brief Compute the predictions without uncertainties.
  *
@@ -53,6 +209,28 @@ predict(const std::vector<double> &training_input,
         int m_tile_size,
         int n_regressors);
 
+/**
+ * @brief Compute the predictions without uncertainties using an existing factorization.
+ *
+ * @param factorization The factorization of the covariance matrix
+ * @param training_input The training input data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ *
+ * @return A vector containing the predictions
+ */
+template <typename T>
+std::vector<double> predict(const Tiled_factorization<T> &factorization,
+                            const std::vector<double> &training_input,
+                            const std::vector<double> &test_input,
+                            int n_tiles,
+                            int n_tile_size,
+                            int m_tiles,
+                            int m_tile_size);
+
 /**
  * @brief Compute the predictions with uncertainties.
  *
@@ -79,6 +257,29 @@ std::vector<std::vector<double>> predict_with_uncertainty(
     int m_tile_size,
     int n_regressors);
 
+/**
+ * @brief Compute the predictions with uncertainties using an existing factorization.
+ *
+ * @param factorization The factorization of the covariance matrix
+ * @param training_input The training input data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ *
+ * @return A vector containing the prediction vector and the uncertainty vector
+ */
+template <typename T>
+std::vector<std::vector<double>> predict_with_uncertainty(
+    const Tiled_factorization<T> &factorization,
+    const std::vector<double> &training_input,
+    const std::vector<double> &test_input,
+    int n_tiles,
+    int n_tile_size,
+    int m_tiles,
+    int m_tile_size);
+
 /**
  * @brief Compute the predictions with full covariance matrix.
  *
@@ -105,6 +306,29 @@ std::vector<std::vector<double>> predict_with_full_cov(
     int m_tile_size,
     int n_regressors);
 
+/**
+ * @brief Compute the predictions with full covariance matrix using an existing factorization.
+ *
+ * @param factorization The factorization of the covariance matrix
+ * @param training_input The training input data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ *
+ * @return A vector containing the prediction vector and the full posterior covariance matrix
+ */
+template <typename T>
+std::vector<std::vector<double>> predict_with_full_cov(
+    const Tiled_factorization<T> &factorization,
+    const std::vector<double> &training_input,
+    const std::vector<double> &test_input,
+    int n_tiles,
+    int n_tile_size,
+    int m_tiles,
+    int m_tile_size);
+
 /**
  * @brief Compute loss for given data and Gaussian process model
  *
@@ -124,6 +348,67 @@ double compute_loss(const std::vector<double> &training_input,
                     int n_tile_size,
                     int n_regressors);
 
+/**
+ * @brief Compute loss using an existing factorization
+ *
+ * @param factorization The factorization of the covariance matrix
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @return The loss
+ */
+template <typename T>
+double compute_loss(const Tiled_factorization<T> &factorization,
+                    const std::vector<double> &training_output,
+                    int n_tiles,
+                    int n_tile_size);
+
+/**
+ * @brief Squared distance tiles of the training data that are reused across optimization iterations
+ *
+ * The squared distances ||z_i - z_j||^2 only depend on the training input, the kernel hyperparameters
+ * are applied when assembling the covariance matrix and its derivatives.
+ *
+ * @tparam T The element type of the tiles
+ */
+template <typename T>
+struct Tiled_distances
+{
+    /** @brief Tiled squared distances (lower triangular tiles only) */
+    Tiles<T> distance_tiles;
+
+    /** @brief Tiled exp(-0.5 / lengthscale^2 * distance), only assembled while the lengthscale is not trained */
+    Tiles<T> exp_tiles;
+
+    /** @brief Lengthscale used to assemble exp_tiles */
+    double exp_lengthscale;
+
+    /** @brief Number of regressors used to compute the distances */
+    int n_regressors;
+};
+
+using DistanceTiles = Tiled_distances<double>;
+using DistanceTiles_fp32 = Tiled_distances<float>;
+
+/**
+ * @brief Compute the squared distance tiles of the training data
+ *
+ * All computations are launched asynchronously, the returned tiles are not synchronized.
+ *
+ * @param training_input The training input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ *
+ * @tparam T The element type of the distance tiles
+ *
+ * @return The distance tiles
+ */
+template <typename T>
+Tiled_distances<T>
+gen_distance_tiles(const std::vector<double> &training_input, int n_tiles, int n_tile_size, int n_regressors);
+
 /**
  * @brief Perform optimization for a given number of iterations
  *
@@ -150,6 +435,30 @@ optimize(const std::vector<double> &training_input,
          gprat_hyper::SEKParams &sek_params,
          std::vector<bool> trainable_params);
 
+/**
+ * @brief Perform optimization for a given number of iterations reusing distance tiles
+ *
+ * @param distances The distance tiles of the training data
+ * @param training_output The raining output data
+ *
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @param hyperparams The Adam optimizer hyperparameters
+ * @param hyperparameters The kernel hyperparameters
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ *
+ * @return A vector containing the loss values of each iteration
+ */
+template <typename T>
+std::vector<double> optimize(Tiled_distances<T> &distances,
+                             const std::vector<double> &training_output,
+                             int n_tiles,
+                             int n_tile_size,
+                             const gprat_hyper::AdamParams &adam_params,
+                             gprat_hyper::SEKParams &sek_params,
+                             std::vector<bool> trainable_params);
+
 /**
  * @brief Perform a single optimization step
  *
@@ -178,6 +487,202 @@ double optimize_step(const std::vector<double> &training_input,
                      std::vector<bool> trainable_params,
                      int iter);
 
+/**
+ * @brief Perform a single optimization step reusing distance tiles
+ *
+ * @param distances The distance tiles of the training data
+ * @param training_output The raining output data
+ *
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @param hyperparams The Adam optimizer hyperparameters
+ * @param hyperparameters The kernel hyperparameters
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ *
+ * @param iter The current optimization iteration
+ *
+ * @return The loss value
+ */
+template <typename T>
+double optimize_step(Tiled_distances<T> &distances,
+                     const std::vector<double> &training_output,
+                     int n_tiles,
+                     int n_tile_size,
+                     gprat_hyper::AdamParams &adam_params,
+                     gprat_hyper::SEKParams &sek_params,
+                     std::vector<bool> trainable_params,
+                     int iter);
+
+/**
+ * @brief Perform L-BFGS optimization reusing distance tiles
+ *
+ * The optimization works on the unconstrained hyperparameters. Each trial evaluation of the line
+ * search computes the loss and the gradients with the tiled pipeline of the Adam optimization.
+ *
+ * @param distances The distance tiles of the training data
+ * @param training_output The raining output data
+ *
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @param lbfgs_params The L-BFGS optimizer hyperparameters
+ * @param sek_params The kernel hyperparameters
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ *
+ * @return A vector containing the loss values of the initial hyperparameters and of each iteration
+ */
+template <typename T>
+std::vector<double> optimize_lbfgs(Tiled_distances<T> &distances,
+                                   const std::vector<double> &training_output,
+                                   int n_tiles,
+                                   int n_tile_size,
+                                   const gprat_hyper::LBFGSParams &lbfgs_params,
+                                   gprat_hyper::SEKParams &sek_params,
+                                   std::vector<bool> trainable_params);
+
+/**
+ * @brief Compute the loss and its gradients from a single factorization reusing distance tiles
+ *
+ * @param distances The distance tiles of the training data
+ * @param training_output The raining output data
+ *
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @param sek_params The kernel hyperparameters
+ * @param unconstrained Whether the gradients are w.r.t. the unconstrained hyperparameters
+ *
+ * @return The loss and its gradients w.r.t. lengthscale, vertical lengthscale and noise variance
+ */
+template <typename T>
+std::pair<double, std::vector<double>> compute_loss_and_gradient(Tiled_distances<T> &distances,
+                                                                 const std::vector<double> &training_output,
+                                                                 int n_tiles,
+                                                                 int n_tile_size,
+                                                                 const gprat_hyper::SEKParams &sek_params,
+                                                                 bool unconstrained);
+
+/**
+ * @brief Perform independent optimizations from several initial hyperparameters concurrently
+ *
+ * All optimizations share the distance tiles and the tiled training output, their iterations
+ * interleave in the same task graph.
+ *
+ * @param distances The distance tiles of the training data
+ * @param training_output The raining output data
+ *
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @param adam_params The Adam optimizer hyperparameters
+ * @param sek_params_list The initial kernel hyperparameters of each optimization, afterwards the optimized ones
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ *
+ * @return A vector containing the loss values of each iteration for each optimization
+ */
+template <typename T>
+std::vector<std::vector<double>> optimize_multistart(Tiled_distances<T> &distances,
+                                                     const std::vector<double> &training_output,
+                                                     int n_tiles,
+                                                     int n_tile_size,
+                                                     const gprat_hyper::AdamParams &adam_params,
+                                                     std::vector<gprat_hyper::SEKParams> &sek_params_list,
+                                                     std::vector<bool> trainable_params);
+
+/**
+ * @brief Compute the loss for several kernel hyperparameters reusing distance tiles
+ *
+ * The covariance matrices of all candidates are assembled from the same distance tiles and
+ * factorized in one task graph, only the losses are synchronized at the end.
+ *
+ * @param distances The distance tiles of the training data
+ * @param training_output The raining output data
+ *
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ *
+ * @param sek_params_list The kernel hyperparameters of each candidate
+ *
+ * @return A vector containing the loss of each candidate
+ */
+template <typename T>
+std::vector<double> evaluate_loss_grid(Tiled_distances<T> &distances,
+                                       const std::vector<double> &training_output,
+                                       int n_tiles,
+                                       int n_tile_size,
+                                       const std::vector<gprat_hyper::SEKParams> &sek_params_list);
+
+/**
+ * @brief State of an optimization that is continued over several calls
+ *
+ * Holds the tiled training output, the distance tiles and the iteration counter of
+ * the Adam bias correction, such that each call only performs the numeric work of
+ * its iterations. The Adam moments are kept in the kernel hyperparameters.
+ *
+ * @tparam T The element type of the tiles
+ */
+template <typename T>
+struct Tiled_optimizer
+{
+    /** @brief Distance tiles of the training input */
+    std::shared_ptr<Tiled_distances<T>> distances;
+
+    /** @brief Tiled training output */
+    Tiles<T> y_tiles;
+
+    /** @brief Number of tiles */
+    int n_tiles;
+
+    /** @brief Size of each tile in each dimension */
+    int n_tile_size;
+
+    /** @brief Flags indicating the trainable hyperparameters */
+    std::vector<bool> trainable_params;
+
+    /** @brief Number of performed iterations */
+    std::size_t iter;
+};
+
+using Optimizer = Tiled_optimizer<double>;
+using Optimizer_fp32 = Tiled_optimizer<float>;
+
+/**
+ * @brief Create the state of an optimization starting at the first iteration
+ *
+ * @param distances The distance tiles of the training data, shared with the optimizer
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ *
+ * @return The optimizer state
+ */
+template <typename T>
+Tiled_optimizer<T> start_optimizer(std::shared_ptr<Tiled_distances<T>> distances,
+                                   const std::vector<double> &training_output,
+                                   int n_tiles,
+                                   int n_tile_size,
+                                   std::vector<bool> trainable_params);
+
+/**
+ * @brief Continue an optimization for a given number of iterations
+ *
+ * Consecutive iterations are pipelined, only the losses are synchronized at the end.
+ *
+ * @param optimizer The optimizer state, its iteration counter is advanced
+ * @param adam_params The Adam optimizer hyperparameters
+ * @param sek_params The kernel hyperparameters including the Adam moments
+ * @param n_iterations The number of iterations
+ *
+ * @return A vector containing the loss values of each iteration
+ */
+template <typename T>
+std::vector<double> optimize(Tiled_optimizer<T> &optimizer,
+                             const gprat_hyper::AdamParams &adam_params,
+                             gprat_hyper::SEKParams &sek_params,
+                             int n_iterations);
+
 }  // end of namespace cpu
 
 #endif  // end of CPU_GP_FUNCTIONS_H
@@ -0,0 +1,141 @@
+#ifndef CPU_GP_ITERATIVE_H
+#define CPU_GP_ITERATIVE_H
+
+#include "gp_hyperparameters.hpp"
+#include "gp_kernels.hpp"
+#include <utility>
+#include <vector>
+
+namespace cpu
+{
+
+// Iterative alternative to the tiled Cholesky decomposition: K * alpha = y is solved with preconditioned conjugate
+// gradients, such that only tiled matrix-vector products with K are required. The preconditioner
+// P = L_k * L_k^T + noise variance * I is built from a pivoted partial Cholesky decomposition of rank k of the
+// prior covariance matrix. If the tiles are regenerated for every product, the memory stays O(N * n_tile_size).
+//
+// The stochastic training mode replaces the Cholesky decomposition in the loss and its gradients: block conjugate
+// gradients solve K * [u_0, u_1, ..., u_p] = [y, z_1, ..., z_p] for p Rademacher probes z_c with batched tiled
+// matrix-multi-vector products, log(det(K)) follows from stochastic Lanczos quadrature with the tridiagonal matrices
+// of the conjugate gradient coefficients and tr(K^-1 * dK) from the Hutchinson estimate 1/p * sum_c u_c^T * dK * z_c.
+// All iterative computations are performed in FP64.
+
+/**
+ * @brief Solve K * alpha = y with preconditioned conjugate gradients
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param pcg_params The parameters of the solver
+ *
+ * @return The solution alpha and the number of iterations, max_iter if the tolerance was not reached
+ */
+std::pair<std::vector<double>, int> solve_pcg(const std::vector<double> &training_input,
+                                              const std::vector<double> &training_output,
+                                              int n_tiles,
+                                              int n_tile_size,
+                                              int n_regressors,
+                                              const gprat_hyper::SEKParams &sek_params,
+                                              const gprat_hyper::PCGParams &pcg_params);
+
+/**
+ * @brief Compute the predictions with alpha from preconditioned conjugate gradients
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param pcg_params The parameters of the solver
+ *
+ * @return A vector containing the predictions
+ */
+std::vector<double> predict_pcg(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const gprat_hyper::PCGParams &pcg_params);
+
+/**
+ * @brief Estimate the loss and its gradients with probe vectors instead of the Cholesky decomposition
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param stochastic_params The parameters of the estimation
+ *
+ * @return The loss and its gradients w.r.t. the unconstrained lengthscale, vertical lengthscale and noise variance
+ */
+std::pair<double, std::vector<double>>
+compute_stochastic_loss_and_gradient(const std::vector<double> &training_input,
+                                     const std::vector<double> &training_output,
+                                     int n_tiles,
+                                     int n_tile_size,
+                                     int n_regressors,
+                                     const gprat_hyper::SEKParams &sek_params,
+                                     const gprat_hyper::StochasticParams &stochastic_params);
+
+/**
+ * @brief Estimate the loss with probe vectors instead of the Cholesky decomposition
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param stochastic_params The parameters of the estimation
+ *
+ * @return The loss
+ */
+double compute_stochastic_loss(const std::vector<double> &training_input,
+                               const std::vector<double> &training_output,
+                               int n_tiles,
+                               int n_tile_size,
+                               int n_regressors,
+                               const gprat_hyper::SEKParams &sek_params,
+                               const gprat_hyper::StochasticParams &stochastic_params);
+
+/**
+ * @brief Optimize the kernel hyperparameters with Adam and stochastic estimates of the loss and its gradients
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param adam_params The Adam optimizer hyperparameters
+ * @param sek_params The kernel hyperparameters, updated in-place
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ * @param stochastic_params The parameters of the estimation
+ *
+ * @return A vector containing the estimated loss values of each iteration
+ */
+std::vector<double> optimize_stochastic(const std::vector<double> &training_input,
+                                        const std::vector<double> &training_output,
+                                        int n_tiles,
+                                        int n_tile_size,
+                                        int n_regressors,
+                                        const gprat_hyper::AdamParams &adam_params,
+                                        gprat_hyper::SEKParams &sek_params,
+                                        const std::vector<bool> &trainable_params,
+                                        const gprat_hyper::StochasticParams &stochastic_params);
+
+}  // end of namespace cpu
+
+#endif  // end of CPU_GP_ITERATIVE_H
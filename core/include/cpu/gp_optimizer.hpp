@@ -8,6 +8,9 @@
 namespace cpu
 {
 
+// The tile generators and reductions templated on the element type T of the tiles are
+// instantiated for double and float. Reductions of FP32 tiles are accumulated in FP64.
+
 /**
  * @brief Transform hyperparameter to enforce constraints using softplus.
  *
@@ -40,85 +43,125 @@ double to_unconstrained(double parameter, bool noise);
 double compute_sigmoid(double parameter);
 
 /**
- * @brief Compute the distance between two feature vectors divided by the lengthscale
+ * @brief Compute the squared distance between two feature vectors
+ *
+ * The distance does not depend on the kernel hyperparameters and can be reused across optimization iterations.
  *
  * @param i_global The global index of the first feature vector
  * @param j_global The global index of the second feature vector
  * @param n_regressors The number of regressors
- * @param hyperparameters The kernel hyperparameters
  * @param i_input The first feature vector
  * @param j_input The second feature vector
  *
- * @return The distance between two features at position i_global,j_global
+ * @return The squared distance between two features at position i_global,j_global
  */
 double compute_covariance_distance(std::size_t i_global,
                                    std::size_t j_global,
                                    std::size_t n_regressors,
-                                   const gprat_hyper::SEKParams &sek_params,
                                    const std::vector<double> &i_input,
                                    const std::vector<double> &j_input);
 
 /**
- * @brief Generate a tile of distances divided by the lengthscale
+ * @brief Generate a tile of squared distances
  *
  * @param row The row index of the tile in the tiled matrix
  * @param col The column index of the tile in the tiled matrix
  * @param N The dimension of the quadratic tile (N*N elements)
  * @param n_regressors The number of regressors
- * @param hyperparameters The kernel hyperparameters
  * @param input The input data vector
  *
- * @return A quadratic tile containing the distance between the features of size N x N
+ * @return A quadratic tile containing the squared distance between the features of size N x N
  */
-std::vector<double> gen_tile_distance(
-    std::size_t row,
-    std::size_t col,
-    std::size_t N,
-    std::size_t n_regressors,
-    const gprat_hyper::SEKParams &sek_params,
-    const std::vector<double> &input);
+template <typename T>
+std::vector<T> gen_tile_distance(
+    std::size_t row, std::size_t col, std::size_t N, std::size_t n_regressors, const std::vector<double> &input);
+
+/**
+ * @brief Generate a tile of exponentiated scaled distances exp(-0.5 / lengthscale^2 * distance)
+ *
+ * @param N The dimension of the quadratic tile (N*N elements)
+ * @param hyperparameters The kernel hyperparameters
+ * @param distance The pre-computed squared distances for the tile
+ *
+ * @return A quadratic tile of exponentiated scaled distances of size N x N
+ */
+template <typename T>
+std::vector<T>
+gen_tile_exp_distance(std::size_t N, const gprat_hyper::SEKParams &sek_params, const std::vector<T> &distance);
 
 /**
  * @brief Generate a tile of the covariance matrix with given distances
  *
+ * @param tile The buffer for the tile, its storage is reused
  * @param row The row index of the tile in the tiled matrix
  * @param col The column index of the tile in the tiled matrix
  * @param N The dimension of the quadratic tile (N*N elements)
  * @param hyperparameters The kernel hyperparameters
- * @param cov_dists The pre-computed distances for the tile
+ * @param distance The pre-computed squared distances for the tile
  *
  * @return A quadratic tile of the covariance matrix of size N x N
  */
-std::vector<double> gen_tile_covariance_with_distance(
+template <typename T>
+std::vector<T> gen_tile_covariance_with_distance(
+    std::vector<T> tile,
     std::size_t row,
     std::size_t col,
     std::size_t N,
     const gprat_hyper::SEKParams &sek_params,
-    const std::vector<double> &distance);
+    const std::vector<T> &distance);
 
 /**
- * @brief  Generate a derivative tile w.r.t. vertical_lengthscale v
+ * @brief Generate a tile of the covariance matrix with given exponentiated scaled distances
  *
+ * @param tile The buffer for the tile, its storage is reused
+ * @param row The row index of the tile in the tiled matrix
+ * @param col The column index of the tile in the tiled matrix
  * @param N The dimension of the quadratic tile (N*N elements)
  * @param hyperparameters The kernel hyperparameters
- * @param cov_dists The pre-computed distances for the tile
+ * @param exp_distance The pre-computed exponentiated scaled distances for the tile
  *
- * @return A quadratic tile of the derivative of v of size N x N
+ * @return A quadratic tile of the covariance matrix of size N x N
  */
-std::vector<double>
-gen_tile_grad_v(std::size_t N, const gprat_hyper::SEKParams &sek_params, const std::vector<double> &distance);
+template <typename T>
+std::vector<T> gen_tile_covariance_with_exp_distance(
+    std::vector<T> tile,
+    std::size_t row,
+    std::size_t col,
+    std::size_t N,
+    const gprat_hyper::SEKParams &sek_params,
+    const std::vector<T> &exp_distance);
 
 /**
- * @brief  Generate a derivative tile w.r.t. lengthscale l
- *
+ * @brief Add the contribution of a tile of the lower triangle to the gradients of the loss w.r.t. all
+ * hyperparameters.
+ *
+ * The derivative tiles are computed elementwise from the distances and never stored. With
+ * W = K^-1 - alpha * alpha^T, the contribution to the gradient w.r.t. theta_i is trace(W * delta(K)/delta(theta_i))
+ * restricted to the tile and its mirrored tile in the upper triangle.
+ *
+ * @param gradient The current gradients w.r.t. lengthscale, vertical lengthscale and noise variance
+ * @param K_inv_tile The tile of the inverse covariance matrix K^-1
+ * @param alpha_row The tile of alpha = K^-1 * y of the row of the tile
+ * @param alpha_col The tile of alpha = K^-1 * y of the column of the tile
+ * @param distance The pre-computed squared distances for the tile, or the exponentiated scaled
+ *        distances if exp_distance is set
  * @param N The dimension of the quadratic tile (N*N elements)
- * @param hyperparameters The kernel hyperparameters
- * @param cov_dists The pre-computed distances for the tile
+ * @param sek_params The kernel hyperparameters
+ * @param exp_distance Whether the distances are exponentiated, then the gradient w.r.t. the lengthscale is not updated
+ * @param diagonal Whether the tile is a diagonal tile, of which only the lower triangle is read
  *
- * @return A quadratic tile of the derivative of l of size N x N
+ * @return The updated gradients
  */
-std::vector<double>
-gen_tile_grad_l(std::size_t N, const gprat_hyper::SEKParams &sek_params, const std::vector<double> &distance);
+template <typename T>
+std::vector<double> compute_gradient_tile(std::vector<double> gradient,
+                                          const std::vector<T> &K_inv_tile,
+                                          const std::vector<T> &alpha_row,
+                                          const std::vector<T> &alpha_col,
+                                          const std::vector<T> &distance,
+                                          std::size_t N,
+                                          const gprat_hyper::SEKParams &sek_params,
+                                          bool exp_distance,
+                                          bool diagonal);
 
 /**
  * @brief Update biased first raw moment estimate: m_T+1 = beta_1 * m_T + (1 - beta_1) * g_T.
@@ -168,9 +211,10 @@ double adam_step(const double unconstrained_hyperparam,
  *
  * @return Return l = y^T * alpha + \sum_i^N log(L_ii^2)
  */
-double compute_loss(const std::vector<double> &K_diag_tile,
-                    const std::vector<double> &alpha_tile,
-                    const std::vector<double> &y_tile,
+template <typename T>
+double compute_loss(const std::vector<T> &K_diag_tile,
+                    const std::vector<T> &alpha_tile,
+                    const std::vector<T> &y_tile,
                     std::size_t N);
 
 /**
@@ -185,48 +229,91 @@ double compute_loss(const std::vector<double> &K_diag_tile,
 double add_losses(const std::vector<double> &losses, std::size_t N, std::size_t n);
 
 /**
- * @brief Compute the loss gradient.
+ * @brief Add up the gradients of the loss for all tile rows.
  *
- * @param trace The first part of the gradient: trace(K^-1 * delta(K)/delta(theta_i))
- * @param dot The second part of the gradient:  beta^T * delta(K)/delta(theta_i) * beta
+ * @param gradients A vector containing the gradients per tile row
  * @param N The size of a tile
  * @param n_tiles The number of tiles
  *
- * @return The added up loss plus the constant factor
+ * @return The gradients w.r.t. lengthscale, vertical lengthscale and noise variance
  */
-double compute_gradient(double trace, double dot, std::size_t N, std::size_t n_tiles);
+std::vector<double>
+add_gradients(const std::vector<std::vector<double>> &gradients, std::size_t N, std::size_t n_tiles);
 
 /**
- * @brief Add the local trace of a tile to the global trace.
+ * @brief Update a hyperparameter of the SEK kernel with an Adam step.
  *
- * @param diagonal The tile to compute the local trace
- * @param trace The current global trace
+ * @param gradient The gradient of the loss w.r.t. the hyperparameter
+ * @param adam_params The Adam optimization parameters
+ * @param sek_params The kernel hyperparameters, afterwards containing the updated hyperparameter and moments
+ * @param iter The current iteration
+ * @param param_idx The index of the hyperparameter: 0: lengthscale, 1: vertical lengthscale, 2: noise variance
+ */
+void update_hyperparameter(double gradient,
+                           const gprat_hyper::AdamParams &adam_params,
+                           gprat_hyper::SEKParams &sek_params,
+                           std::size_t iter,
+                           std::size_t param_idx);
+
+/**
+ * @brief Update all trainable hyperparameters of the SEK kernel with an Adam step.
  *
- * @return The updated global trace
+ * @param gradient The gradients of the loss w.r.t. lengthscale, vertical lengthscale and noise variance
+ * @param adam_params The Adam optimization parameters
+ * @param sek_params The kernel hyperparameters
+ * @param trainable_params The flags indicating the trainable hyperparameters
+ * @param iter The current iteration
+ *
+ * @return The kernel hyperparameters with updated hyperparameters and moments
  */
-double compute_trace(const std::vector<double> &diagonal, double trace);
+gprat_hyper::SEKParams update_hyperparameters(const std::vector<double> &gradient,
+                                              const gprat_hyper::AdamParams &adam_params,
+                                              gprat_hyper::SEKParams sek_params,
+                                              const std::vector<bool> &trainable_params,
+                                              std::size_t iter);
 
 /**
- * @brief Add the dot product of a vector to a global result.
+ * @brief Compute the L-BFGS search direction with the two-loop recursion.
  *
- * @param vector_T The transposed vector
- * @param vector The vector
- * @param result The current global result
+ * The inverse Hessian of the loss w.r.t. the unconstrained hyperparameters is approximated from the
+ * recent steps and gradient differences, scaled by s^T * y / y^T * y of the most recent pair.
  *
- * @return The updated global result
+ * @param gradient The gradient of the loss w.r.t. the unconstrained hyperparameters
+ * @param s_history The recent steps in the unconstrained space, oldest first
+ * @param y_history The recent gradient differences, oldest first
+ *
+ * @return The search direction -H * gradient
+ */
+std::vector<double> lbfgs_direction(const std::vector<double> &gradient,
+                                    const std::vector<std::vector<double>> &s_history,
+                                    const std::vector<std::vector<double>> &y_history);
+
+/**
+ * @brief Move the trainable hyperparameters of the SEK kernel along a direction in the unconstrained space.
+ *
+ * @param sek_params The kernel hyperparameters
+ * @param direction The direction w.r.t. the unconstrained lengthscale, vertical lengthscale and noise variance
+ * @param step The step length along the direction
+ * @param trainable_params The flags indicating the trainable hyperparameters
+ *
+ * @return The kernel hyperparameters with moved trainable hyperparameters
  */
-double compute_dot(const std::vector<double> &vector_T, const std::vector<double> &vector, double result);
+gprat_hyper::SEKParams move_hyperparameters(gprat_hyper::SEKParams sek_params,
+                                            const std::vector<double> &direction,
+                                            double step,
+                                            const std::vector<bool> &trainable_params);
 
 /**
- * @brief Add the local trace of a matrix tile to the global trace
+ * @brief Add the dot product of a vector to a global result.
  *
- * @param tile The matrix tile
- * @param trace The current global trace
- * @param N The dimension of the tile
+ * @param vector_T The transposed vector
+ * @param vector The vector
+ * @param result The current global result
  *
- * @return The updated global trace
+ * @return The updated global result
  */
-double compute_trace_diag(const std::vector<double> &tile, double trace, std::size_t N);
+template <typename T>
+double compute_dot(const std::vector<T> &vector_T, const std::vector<T> &vector, double result);
 
 }  // end of namespace cpu
 
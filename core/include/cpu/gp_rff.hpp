@@ -0,0 +1,144 @@
+#ifndef CPU_GP_RFF_H
+#define CPU_GP_RFF_H
+
+#include "gp_hyperparameters.hpp"
+#include "gp_kernels.hpp"
+#include <utility>
+#include <vector>
+
+namespace cpu
+{
+
+// Random Fourier feature approximation of the squared exponential kernel. The lagged regressor windows z are mapped
+// to D features phi(z) = sqrt(2 * vertical_lengthscale / D) * cos(omega^T * z / lengthscale + b) with fixed standard
+// normal frequencies omega and uniform phases b, such that k(z, z') ~ phi(z)^T * phi(z'). The GP becomes a Bayesian
+// linear regression on the feature tiles Phi: only the D x D matrix A = Phi^T * Phi + noise variance * I is
+// factorized, training takes O(N * D^2) and prediction O(D) per test point for the mean and O(D^2) for the
+// uncertainty. The hyperparameters enter through the feature map and are optimized with exact gradients of the
+// approximate loss. All random feature computations are performed in FP64.
+
+/**
+ * @brief Compute the loss of the random feature approximation
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param rff_params The parameters of the random features
+ *
+ * @return The loss
+ */
+double compute_rff_loss(const std::vector<double> &training_input,
+                        const std::vector<double> &training_output,
+                        int n_tiles,
+                        int n_tile_size,
+                        int n_regressors,
+                        const gprat_hyper::SEKParams &sek_params,
+                        const gprat_hyper::RFFParams &rff_params);
+
+/**
+ * @brief Compute the loss of the random feature approximation and its gradients
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param rff_params The parameters of the random features
+ *
+ * @return The loss and its gradients w.r.t. the unconstrained lengthscale, vertical lengthscale and noise variance
+ */
+std::pair<double, std::vector<double>>
+compute_rff_loss_and_gradient(const std::vector<double> &training_input,
+                              const std::vector<double> &training_output,
+                              int n_tiles,
+                              int n_tile_size,
+                              int n_regressors,
+                              const gprat_hyper::SEKParams &sek_params,
+                              const gprat_hyper::RFFParams &rff_params);
+
+/**
+ * @brief Optimize the kernel hyperparameters of the random feature approximation with Adam
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param adam_params The Adam optimizer hyperparameters
+ * @param sek_params The kernel hyperparameters, updated in-place
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ * @param rff_params The parameters of the random features
+ *
+ * @return A vector containing the loss values of each iteration
+ */
+std::vector<double> optimize_rff(const std::vector<double> &training_input,
+                                 const std::vector<double> &training_output,
+                                 int n_tiles,
+                                 int n_tile_size,
+                                 int n_regressors,
+                                 const gprat_hyper::AdamParams &adam_params,
+                                 gprat_hyper::SEKParams &sek_params,
+                                 const std::vector<bool> &trainable_params,
+                                 const gprat_hyper::RFFParams &rff_params);
+
+/**
+ * @brief Compute the predictions of the random feature approximation
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param rff_params The parameters of the random features
+ *
+ * @return A vector containing the predictions
+ */
+std::vector<double> predict_rff(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const gprat_hyper::RFFParams &rff_params);
+
+/**
+ * @brief Compute the predictions and uncertainties of the random feature approximation
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param rff_params The parameters of the random features
+ *
+ * @return A vector containing the prediction vector and the uncertainty vector
+ */
+std::vector<std::vector<double>> predict_rff_with_uncertainty(const std::vector<double> &training_input,
+                                                              const std::vector<double> &training_output,
+                                                              const std::vector<double> &test_input,
+                                                              int n_tiles,
+                                                              int n_tile_size,
+                                                              int m_tiles,
+                                                              int m_tile_size,
+                                                              int n_regressors,
+                                                              const gprat_hyper::SEKParams &sek_params,
+                                                              const gprat_hyper::RFFParams &rff_params);
+
+}  // end of namespace cpu
+
+#endif  // end of CPU_GP_RFF_H
@@ -0,0 +1,147 @@
+#ifndef CPU_GP_SPARSE_H
+#define CPU_GP_SPARSE_H
+
+#include "approximation.hpp"
+#include "gp_hyperparameters.hpp"
+#include "gp_kernels.hpp"
+#include <utility>
+#include <vector>
+
+namespace cpu
+{
+
+// Inducing point approximations of a GP with M inducing points. The M x N cross-covariance K_MN between the
+// inducing points and the training data is assembled in tiles of M x n_tile_size, all reductions over the N
+// training points are accumulated tile by tile, such that training and prediction take O(N * M^2) operations.
+// All sparse computations are performed in FP64.
+
+/**
+ * @brief Select inducing points from the lagged feature vectors of the training input
+ *
+ * The inducing points are evenly strided feature vectors, optionally refined by k-means iterations
+ * over all feature vectors.
+ *
+ * @param training_input The training input data
+ * @param n_samples The number of training samples
+ * @param n_regressors The number of regressors
+ * @param n_inducing The number of inducing points M
+ * @param kmeans_iterations The number of k-means iterations
+ *
+ * @return The inducing points, row-major M x n_regressors
+ */
+std::vector<double> select_inducing_points(const std::vector<double> &training_input,
+                                           int n_samples,
+                                           int n_regressors,
+                                           int n_inducing,
+                                           int kmeans_iterations);
+
+/**
+ * @brief Compute the loss of an inducing point approximation
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param approximation The inducing point approximation
+ *
+ * @return The loss
+ */
+double compute_sparse_loss(const std::vector<double> &training_input,
+                           const std::vector<double> &training_output,
+                           const std::vector<double> &inducing_points,
+                           int n_tiles,
+                           int n_tile_size,
+                           int n_regressors,
+                           const gprat_hyper::SEKParams &sek_params,
+                           gprat::Approximation approximation);
+
+/**
+ * @brief Compute the loss of an inducing point approximation and its gradients
+ *
+ * The inducing points are fixed, the gradients refer to the unconstrained hyperparameters that are
+ * updated by the Adam optimizer.
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param approximation The inducing point approximation
+ *
+ * @return The loss and its gradients w.r.t. lengthscale, vertical lengthscale and noise variance
+ */
+std::pair<double, std::vector<double>>
+compute_sparse_loss_and_gradient(const std::vector<double> &training_input,
+                                 const std::vector<double> &training_output,
+                                 const std::vector<double> &inducing_points,
+                                 int n_tiles,
+                                 int n_tile_size,
+                                 int n_regressors,
+                                 const gprat_hyper::SEKParams &sek_params,
+                                 gprat::Approximation approximation);
+
+/**
+ * @brief Optimize the kernel hyperparameters of an inducing point approximation with Adam
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param adam_params The Adam optimizer hyperparameters
+ * @param sek_params The kernel hyperparameters, updated in-place
+ * @param trainable_params The vector containing a bool wheather to train a hyperparameter
+ * @param approximation The inducing point approximation
+ *
+ * @return A vector containing the loss values of each iteration
+ */
+std::vector<double> optimize_sparse(const std::vector<double> &training_input,
+                                    const std::vector<double> &training_output,
+                                    const std::vector<double> &inducing_points,
+                                    int n_tiles,
+                                    int n_tile_size,
+                                    int n_regressors,
+                                    const gprat_hyper::AdamParams &adam_params,
+                                    gprat_hyper::SEKParams &sek_params,
+                                    const std::vector<bool> &trainable_params,
+                                    gprat::Approximation approximation);
+
+/**
+ * @brief Compute the predictions and uncertainties of an inducing point approximation
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param inducing_points The inducing points, row-major M x n_regressors
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param approximation The inducing point approximation
+ *
+ * @return A vector containing the prediction vector and the uncertainty vector
+ */
+std::vector<std::vector<double>>
+predict_sparse_with_uncertainty(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &inducing_points,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                gprat::Approximation approximation);
+
+}  // end of namespace cpu
+
+#endif  // end of CPU_GP_SPARSE_H
@@ -0,0 +1,89 @@
+#ifndef CPU_GP_TLR_H
+#define CPU_GP_TLR_H
+
+#include "gp_hyperparameters.hpp"
+#include "gp_kernels.hpp"
+#include <vector>
+
+namespace cpu
+{
+
+// Tile low-rank (TLR) variant of the tiled Cholesky decomposition. The off-diagonal tiles of the covariance matrix
+// are compressed to U * V^T with adaptive cross approximation directly from the kernel, such that they are never
+// assembled densely, and recompressed with a truncated singular value decomposition. The TRSM, SYRK and GEMM steps
+// of the right-looking decomposition operate on the low-rank factors, the updated off-diagonal tiles are
+// recompressed to the tolerance. Only the diagonal tiles are dense, with ranks k of the off-diagonal tiles the
+// memory is O(N * (n_tile_size + k)) and the decomposition takes O(N * n_tiles * k^2) operations for the updates.
+// All TLR computations are performed in FP64.
+
+/**
+ * @brief Compute the loss with the TLR Cholesky decomposition
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param tlr_params The parameters of the compression
+ *
+ * @return The loss
+ */
+double compute_tlr_loss(const std::vector<double> &training_input,
+                        const std::vector<double> &training_output,
+                        int n_tiles,
+                        int n_tile_size,
+                        int n_regressors,
+                        const gprat_hyper::SEKParams &sek_params,
+                        const gprat_hyper::TLRParams &tlr_params);
+
+/**
+ * @brief Compute the predictions with alpha from the TLR Cholesky decomposition
+ *
+ * @param training_input The training input data
+ * @param training_output The training output data
+ * @param test_input The test input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param m_tiles The number of test tiles
+ * @param m_tile_size The size of each test tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param tlr_params The parameters of the compression
+ *
+ * @return A vector containing the predictions
+ */
+std::vector<double> predict_tlr(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const gprat_hyper::TLRParams &tlr_params);
+
+/**
+ * @brief Compute the ranks of the tiles of the TLR Cholesky factor
+ *
+ * @param training_input The training input data
+ * @param n_tiles The number of training tiles
+ * @param n_tile_size The size of each training tile
+ * @param n_regressors The number of regressors
+ * @param sek_params The kernel hyperparameters
+ * @param tlr_params The parameters of the compression
+ *
+ * @return The n_tiles x n_tiles ranks in row-major order, n_tile_size for the dense diagonal tiles and zero above
+ *         the diagonal
+ */
+std::vector<int> compute_tlr_ranks(const std::vector<double> &training_input,
+                                   int n_tiles,
+                                   int n_tile_size,
+                                   int n_regressors,
+                                   const gprat_hyper::SEKParams &sek_params,
+                                   const gprat_hyper::TLRParams &tlr_params);
+
+}  // end of namespace cpu
+
+#endif  // end of CPU_GP_TLR_H
@@ -16,7 +16,8 @@ namespace cpu
  * @return Diagonal element vector of the matrix A of size M
  */
 // std::vector<double> get_matrix_diagonal(const std::vector<double> &A, std::size_t M);
-hpx::shared_future<std::vector<double>> get_matrix_diagonal(hpx::shared_future<std::vector<double>> f_A, std::size_t M);
+template <typename T>
+hpx::shared_future<std::vector<T>> get_matrix_diagonal(hpx::shared_future<std::vector<T>> f_A, std::size_t M);
 
 }  // end of namespace cpu
 
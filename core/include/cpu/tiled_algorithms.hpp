@@ -5,12 +5,22 @@
 #include "gp_kernels.hpp"
 #include <hpx/future.hpp>
 
-using Tiled_matrix = std::vector<hpx::shared_future<std::vector<double>>>;
-using Tiled_vector = std::vector<hpx::shared_future<std::vector<double>>>;
+// Tiled matrix or vector with elements of type T, represented as a vector of futurized tiles
+template <typename T>
+using Tiles = std::vector<hpx::shared_future<std::vector<T>>>;
+// Tiles with a single consumer, whose storage is taken over by the algorithm
+template <typename T>
+using Owned_tiles = std::vector<hpx::future<std::vector<T>>>;
+
+using Tiled_matrix = Tiles<double>;
+using Tiled_vector = Tiles<double>;
+using Tiled_owned_matrix = Owned_tiles<double>;
 
 namespace cpu
 {
 
+// The algorithms templated on the element type T of the tiles are instantiated for double and float
+
 // Tiled Cholesky Algorithm
 
 /**
@@ -21,7 +31,69 @@ namespace cpu
  * @param N Tile size per dimension.
  * @param n_tiles Number of tiles per dimension.
  */
-void right_looking_cholesky_tiled(Tiled_matrix &ft_tiles, int N, std::size_t n_tiles);
+template <typename T>
+void right_looking_cholesky_tiled(Tiles<T> &ft_tiles, int N, std::size_t n_tiles);
+
+/**
+ * @brief Perform right-looking tiled Cholesky decomposition of a matrix with owned tiles.
+ *
+ * The factorization is computed in the storage of the owned tiles, no tile is copied.
+ *
+ * @param ft_owned Tiled matrix represented as a vector of owned futurized tiles, containing
+ *        the covariance matrix, moved into the decomposition.
+ * @param ft_tiles Tiled matrix of size n_tiles * n_tiles, afterwards containing the Cholesky decomposition.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void right_looking_cholesky_tiled(Owned_tiles<T> &ft_owned, Tiles<T> &ft_tiles, int N, std::size_t n_tiles);
+
+/**
+ * @brief Perform right-looking tiled Cholesky decomposition in mixed precision.
+ *
+ * The off-diagonal tiles are stored in FP32 and updated with FP32 TRSM and GEMM, while the
+ * diagonal tiles are updated and factorized in FP64. The factor stays split into FP64 diagonal
+ * and FP32 off-diagonal tiles and is accurate to about FP32 precision.
+ *
+ * @param ft_tiles Tiled matrix of size n_tiles * n_tiles, whose diagonal tiles contain the FP64
+ *        diagonal tiles of the covariance matrix, afterwards those of the Cholesky decomposition.
+ * @param ft_single Tiled matrix of size n_tiles * n_tiles, whose lower off-diagonal tiles contain
+ *        the FP32 off-diagonal tiles of the covariance matrix, afterwards those of the Cholesky
+ *        decomposition.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+void right_looking_cholesky_tiled_mixed(Tiled_matrix &ft_tiles, Tiles<float> &ft_single, int N, std::size_t n_tiles);
+
+/**
+ * @brief Extend a tiled Cholesky decomposition by new tile rows.
+ *
+ * Only the tile rows n_tiles_old to n_tiles - 1 are computed, the leading
+ * n_tiles_old x n_tiles_old tiles must already contain the Cholesky factor.
+ *
+ * @param ft_tiles Tiled matrix represented as a vector of futurized tiles, containing the
+ *        Cholesky factor and the covariance matrix of the new tile rows, afterwards the
+ *        extended Cholesky decomposition.
+ * @param N Tile size per dimension.
+ * @param n_tiles_old Number of already factorized tiles per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void extend_cholesky_tiled(Tiles<T> &ft_tiles, int N, std::size_t n_tiles_old, std::size_t n_tiles);
+
+/**
+ * @brief Perform tiled rank-N update of a Cholesky decomposition: L' * L'^T = L * L^T + W * W^T.
+ *
+ * Each tile column is updated with a QR decomposition of [L_kk^T; W_k^T] whose orthogonal
+ * factor is applied to the tiles below, which costs O(n_tiles^2 * N^3).
+ *
+ * @param ft_tiles Tiled matrix represented as a vector of futurized tiles, containing the
+ *        Cholesky factor L, afterwards the updated Cholesky factor L'.
+ * @param ft_update Tiled column of the update matrix W, overwritten during the update.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+void update_cholesky_tiled(Tiled_matrix &ft_tiles, Tiled_matrix &ft_update, int N, std::size_t n_tiles);
 
 // Tiled Triangular Solve Algorithms
 
@@ -33,7 +105,8 @@ void right_looking_cholesky_tiled(Tiled_matrix &ft_tiles, int N, std::size_t n_t
  * @param N Tile size per dimension.
  * @param n_tiles Number of tiles per dimension.
  */
-void forward_solve_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_rhs, int N, std::size_t n_tiles);
+template <typename T>
+void forward_solve_tiled(const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, std::size_t n_tiles);
 
 /**
  * @brief Perform tiled backward triangular matrix-vector solve.
@@ -43,7 +116,59 @@ void forward_solve_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_rhs, int N, st
  * @param N Tile size per dimension.
  * @param n_tiles Number of tiles per dimension.
  */
-void backward_solve_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_rhs, int N, std::size_t n_tiles);
+template <typename T>
+void backward_solve_tiled(const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, std::size_t n_tiles);
+
+/**
+ * @brief Perform tiled forward triangular matrix-vector solve with a mixed precision factor.
+ *
+ * The FP32 off-diagonal tiles are widened entry by entry while they are applied, the vector is
+ * kept in FP64.
+ *
+ * @param ft_tiles Tiled triangular matrix, only the FP64 diagonal tiles are used.
+ * @param ft_single Tiled triangular matrix, only the FP32 lower off-diagonal tiles are used.
+ * @param ft_rhs Tiled right-hand side vector, afterwards containing the tiled solution vector
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+void forward_solve_tiled_mixed(const Tiled_matrix &ft_tiles,
+                               const Tiles<float> &ft_single,
+                               Tiled_vector &ft_rhs,
+                               int N,
+                               std::size_t n_tiles);
+
+/**
+ * @brief Perform tiled backward triangular matrix-vector solve with a mixed precision factor.
+ *
+ * Solves with the transpose of the factor, see forward_solve_tiled_mixed.
+ *
+ * @param ft_tiles Tiled triangular matrix, only the FP64 diagonal tiles are used.
+ * @param ft_single Tiled triangular matrix, only the FP32 lower off-diagonal tiles are used.
+ * @param ft_rhs Tiled right-hand side vector, afterwards containing the tiled solution vector
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+void backward_solve_tiled_mixed(const Tiled_matrix &ft_tiles,
+                                const Tiles<float> &ft_single,
+                                Tiled_vector &ft_rhs,
+                                int N,
+                                std::size_t n_tiles);
+
+/**
+ * @brief Extend a tiled forward triangular matrix-vector solve by new tiles.
+ *
+ * Only the tiles n_tiles_old to n_tiles - 1 are solved, the leading n_tiles_old
+ * tiles must already contain the solution.
+ *
+ * @param ft_tiles Tiled triangular matrix represented as a vector of futurized tiles.
+ * @param ft_rhs Tiled right-hand side vector, afterwards containing the tiled solution vector
+ * @param N Tile size per dimension.
+ * @param n_tiles_old Number of already solved tiles.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void extend_forward_solve_tiled(
+    const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, std::size_t n_tiles_old, std::size_t n_tiles);
 
 /**
  * @brief Perform tiled forward triangular matrix-matrix solve.
@@ -55,8 +180,32 @@ void backward_solve_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_rhs, int N, s
  * @param n_tiles Number of tiles in first dimension.
  * @param m_tiles Number of tiles in second dimension.
  */
+template <typename T>
 void forward_solve_tiled_matrix(
-    Tiled_matrix &ft_tiles, Tiled_matrix &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
+    const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
+
+/**
+ * @brief Perform tiled forward triangular matrix-matrix solve with an owned right-hand side.
+ *
+ * The solution is computed in the storage of the owned right-hand side tiles, no tile is copied.
+ *
+ * @param ft_tiles Tiled triangular matrix represented as a vector of futurized tiles.
+ * @param ft_owned_rhs Tiled right-hand side matrix represented as a vector of owned futurized
+ *        tiles, moved into the solution.
+ * @param ft_rhs Tiled matrix of size n_tiles * m_tiles, afterwards containing the tiled solution matrix.
+ * @param N Tile size of first dimension.
+ * @param M Tile size of second dimension.
+ * @param n_tiles Number of tiles in first dimension.
+ * @param m_tiles Number of tiles in second dimension.
+ */
+template <typename T>
+void forward_solve_tiled_matrix(const Tiles<T> &ft_tiles,
+                                Owned_tiles<T> &ft_owned_rhs,
+                                Tiles<T> &ft_rhs,
+                                int N,
+                                int M,
+                                std::size_t n_tiles,
+                                std::size_t m_tiles);
 
 /**
  * @brief Perform tiled backward triangular matrix-matrix solve.
@@ -68,8 +217,62 @@ void forward_solve_tiled_matrix(
  * @param n_tiles Number of tiles in first dimension.
  * @param m_tiles Number of tiles in second dimension.
  */
+template <typename T>
 void backward_solve_tiled_matrix(
-    Tiled_matrix &ft_tiles, Tiled_matrix &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
+    const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
+
+// Tiled Triangular Inverse Algorithms
+
+/**
+ * @brief Compute the tiled inverse X = L^-1 of a lower triangular matrix L.
+ *
+ * Only the lower triangular tiles of X are computed, the strictly upper triangle of its diagonal tiles is zero.
+ *
+ * @param ft_tiles Tiled lower triangular matrix represented as a vector of futurized tiles.
+ * @param ft_owned Tiled buffers for the lower triangular tiles of X represented as a vector of owned
+ *        futurized tiles, the strictly lower tiles must be zero. Moved into the inverse.
+ * @param ft_inv Tiled matrix of size n_tiles * n_tiles, afterwards containing the tiled inverse in its
+ *        lower triangular tiles.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void triangular_inverse_tiled(
+    const Tiles<T> &ft_tiles, Owned_tiles<T> &ft_owned, Tiles<T> &ft_inv, int N, std::size_t n_tiles);
+
+/**
+ * @brief Compute the tiled symmetric product X^T * X of a lower triangular matrix X.
+ *
+ * With X = L^-1 the product is the inverse of L * L^T. Only the lower triangle of the product is computed.
+ *
+ * @param ft_tiles Tiled lower triangular matrix represented as a vector of futurized tiles, afterwards
+ *        containing the lower triangle of the product.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void triangular_transpose_product_tiled(Tiles<T> &ft_tiles, int N, std::size_t n_tiles);
+
+/**
+ * @brief Perform tiled matrix-vector multiplication with the covariance matrix: rhs = rhs + K * x
+ *
+ * The tiles of the covariance matrix K are generated within the tasks and never stored.
+ *
+ * @param input The training input data
+ * @param sek_params The kernel hyperparameters
+ * @param n_regressors The number of regressors
+ * @param ft_vector Tiled vector x represented as a vector of futurized tiles.
+ * @param ft_rhs Tiled vector, afterwards containing the updated tiled vector.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+void covariance_vector_tiled(const std::vector<double> &input,
+                             const gprat_hyper::SEKParams &sek_params,
+                             int n_regressors,
+                             const Tiled_vector &ft_vector,
+                             Tiled_vector &ft_rhs,
+                             int N,
+                             std::size_t n_tiles);
 
 /**
  * @brief Perform tiled matrix-vector multiplication
@@ -82,14 +285,29 @@ void backward_solve_tiled_matrix(
  * @param n_tiles Number of tiles in first dimension.
  * @param m_tiles Number of tiles in second dimension.
  */
-void matrix_vector_tiled(Tiled_matrix &ft_tiles,
-                         Tiled_vector &ft_vector,
-                         Tiled_vector &ft_rhs,
+template <typename T>
+void matrix_vector_tiled(const Tiles<T> &ft_tiles,
+                         const Tiles<T> &ft_vector,
+                         Tiles<T> &ft_rhs,
                          int N_row,
                          int N_col,
                          std::size_t n_tiles,
                          std::size_t m_tiles);
 
+/**
+ * @brief Perform tiled symmetric matrix-vector multiplication: rhs = rhs + A * x
+ *
+ * @param ft_tiles Tiled symmetric matrix A represented as a vector of futurized tiles, only the
+ *        lower triangle is referenced.
+ * @param ft_vector Tiled vector x represented as a vector of futurized tiles.
+ * @param ft_rhs Tiled vector, afterwards containing the updated tiled vector.
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void symmetric_matrix_vector_tiled(
+    const Tiles<T> &ft_tiles, const Tiles<T> &ft_vector, Tiles<T> &ft_rhs, int N, std::size_t n_tiles);
+
 /**
  * @brief Perform tiled symmetric k-rank update on diagonal tiles
  *
@@ -100,8 +318,9 @@ void matrix_vector_tiled(Tiled_matrix &ft_tiles,
  * @param n_tiles Number of tiles in first dimension.
  * @param m_tiles Number of tiles in second dimension.
  */
+template <typename T>
 void symmetric_matrix_matrix_diagonal_tiled(
-    Tiled_matrix &ft_tiles, Tiled_vector &ft_vector, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
+    Tiles<T> &ft_tiles, Tiles<T> &ft_vector, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
 
 /**
  * @brief Perform tiled symmetric k-rank update (ft_tiles^T * ft_tiles)
@@ -113,8 +332,9 @@ void symmetric_matrix_matrix_diagonal_tiled(
  * @param n_tiles Number of tiles in first dimension.
  * @param m_tiles Number of tiles in second dimension.
  */
+template <typename T>
 void symmetric_matrix_matrix_tiled(
-    Tiled_matrix &ft_tiles, Tiled_matrix &ft_result, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
+    Tiles<T> &ft_tiles, Tiles<T> &ft_result, int N, int M, std::size_t n_tiles, std::size_t m_tiles);
 
 /**
  * @brief Compute the difference between two tiled vectors
@@ -124,7 +344,8 @@ void symmetric_matrix_matrix_tiled(
  * @param M Tile size dimension.
  * @param m_tiles Number of tiles.
  */
-void vector_difference_tiled(Tiled_vector &ft_minuend, Tiled_vector &ft_substrahend, int M, std::size_t m_tiles);
+template <typename T>
+void vector_difference_tiled(Tiles<T> &ft_minuend, Tiles<T> &ft_substrahend, int M, std::size_t m_tiles);
 
 /**
  * @brief Extract the tiled diagonals of a tiled matrix
@@ -133,7 +354,8 @@ void vector_difference_tiled(Tiled_vector &ft_minuend, Tiled_vector &ft_substrah
  * @param M Tile size per dimension.
  * @param m_tiles Number of tiles per dimension.
  */
-void matrix_diagonal_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_vector, int M, std::size_t m_tiles);
+template <typename T>
+void matrix_diagonal_tiled(Tiles<T> &ft_tiles, Tiles<T> &ft_vector, int M, std::size_t m_tiles);
 
 /**
  * @brief Compute the negative log likelihood loss with a tiled covariance matrix K.
@@ -147,36 +369,39 @@ void matrix_diagonal_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_vector, int
  * @param N Tile size per dimension.
  * @param n_tiles Number of tiles per dimension.
  */
-void compute_loss_tiled(Tiled_matrix &ft_tiles,
-                        Tiled_vector &ft_alpha,
-                        Tiled_vector &ft_y,
+template <typename T>
+void compute_loss_tiled(const Tiles<T> &ft_tiles,
+                        const Tiles<T> &ft_alpha,
+                        const Tiles<T> &ft_y,
                         hpx::shared_future<double> &loss,
                         int N,
                         std::size_t n_tiles);
 
 /**
- * @brief Updates a hyperparameter of the SEK kernel using Adam
+ * @brief Compute the gradients of the loss w.r.t. all hyperparameters of the SEK kernel.
+ *
+ * The derivative tiles of the covariance matrix are computed on the fly from the distances and never stored.
  *
- * @param ft_invK Tiled inverse of the covariance matrix K represented as a vector of futurized tiles.
- * @param ft_grad_param Tiled covariance matrix gradient w.r.t. a hyperparameter.
+ * @param ft_invK Tiled inverse of the covariance matrix K represented as a vector of futurized tiles,
+ *        only the lower triangle is referenced.
  * @param ft_alpha Tiled vector containing the precomputed inv(K) * y where y is the training output.
- * @param adam_params Hyperparameter of the Adam optimizer
- * @param sek_params Hyperparameters of the SEK kernel
- * @param N Tile size per dimension.
- * @param n_tiles Number of tiles per dimension.
- * @param iter Current iteration.
- * @param param_idx Index of the hyperparameter to optimize.
- */
-void update_hyperparameter_tiled(
-    const Tiled_matrix &ft_invK,
-    const Tiled_matrix &ft_gradK_param,
-    const Tiled_vector &ft_alpha,
-    const gprat_hyper::AdamParams &adam_params,
-    gprat_hyper::SEKParams &sek_params,
-    int N,
-    std::size_t n_tiles,
-    std::size_t iter,
-    std::size_t param_idx);
+ * @param ft_distances Tiled squared distances of the training input, or the exponentiated scaled distances
+ *        if exp_distance is set. Only the lower triangle is referenced.
+ * @param sek_params Future of the hyperparameters of the SEK kernel
+ * @param exp_distance Whether the distances are exponentiated, then the gradient w.r.t. the lengthscale is zero.
+ * @param gradient The gradients w.r.t. lengthscale, vertical lengthscale and noise variance to be computed
+ * @param N Tile size per dimension.
+ * @param n_tiles Number of tiles per dimension.
+ */
+template <typename T>
+void gradient_tiled(const Tiles<T> &ft_invK,
+                    const Tiles<T> &ft_alpha,
+                    const Tiles<T> &ft_distances,
+                    const hpx::shared_future<gprat_hyper::SEKParams> &sek_params,
+                    bool exp_distance,
+                    hpx::shared_future<std::vector<double>> &gradient,
+                    int N,
+                    std::size_t n_tiles);
 
 }  // end of namespace cpu
 
@@ -0,0 +1,61 @@
+#ifndef CPU_VECTORIZED_EXP_H
+#define CPU_VECTORIZED_EXP_H
+
+#include <bit>
+#include <cstdint>
+
+namespace cpu
+{
+
+/**
+ * @brief Compute exp(x) without branches or library calls so that loops over tiles vectorize
+ *
+ * Uses the range reduction x = n * ln(2) + r with |r| <= ln(2)/2 and a degree 13
+ * Taylor polynomial for exp(r), which is accurate to about one ulp. The result is
+ * scaled by 2^n through the exponent bits. Arguments below -708 flush to zero, so
+ * subnormal results are not represented, and arguments above 709 saturate.
+ *
+ * @param x The exponent
+ *
+ * @return The value of exp(x)
+ */
+inline double vectorized_exp(double x)
+{
+    // 1.5 * 2^52, adding it rounds to the nearest integer stored in the low mantissa bits
+    const double round_magic = 6755399441055744.0;
+    const double log2e = 1.4426950408889634;
+    const double ln2_hi = 6.93147180369123816490e-01;
+    const double ln2_lo = 1.90821492927058770002e-10;
+
+    const double x_clamped = x < -708.0 ? -708.0 : (x > 709.0 ? 709.0 : x);
+    // n = round(x / ln(2))
+    const double shifted = x_clamped * log2e + round_magic;
+    const double n = shifted - round_magic;
+    const double r = (x_clamped - n * ln2_hi) - n * ln2_lo;
+
+    // exp(r) = sum_k r^k / k!
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    // 2^n assembled from the integer left in the low bits of the shifted value
+    const std::uint64_t n_bits = std::bit_cast<std::uint64_t>(shifted) - std::bit_cast<std::uint64_t>(round_magic);
+    const double two_to_n = std::bit_cast<double>((n_bits + 1023) << 52);
+
+    return x < -708.0 ? 0.0 : p * two_to_n;
+}
+
+}  // end of namespace cpu
+
+#endif  // end of CPU_VECTORIZED_EXP_H
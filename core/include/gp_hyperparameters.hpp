@@ -55,6 +55,199 @@ struct AdamParams
     std::string repr() const;
 };
 
+/**
+ * @brief Hyperparameters for the L-BFGS optimizer
+ */
+struct LBFGSParams
+{
+    /**
+     * @brief Maximum number of L-BFGS iterations
+     */
+    int max_iter;
+
+    /**
+     * @brief Number of recent steps and gradient differences approximating the inverse Hessian
+     */
+    int history_size;
+
+    /**
+     * @brief Convergence tolerance on the largest absolute gradient entry
+     */
+    double gradient_tolerance;
+
+    /**
+     * @brief Sufficient decrease constant of the Armijo condition in the line search
+     */
+    double armijo;
+
+    /**
+     * @brief Maximum number of trial evaluations of the line search per iteration
+     */
+    int max_line_search;
+
+    /**
+     * @brief Initialize hyperparameters
+     *
+     * @param max_i maximum number of iterations
+     * @param history history size
+     * @param grad_tol gradient tolerance
+     * @param c1 sufficient decrease constant
+     * @param max_ls maximum number of line search evaluations
+     */
+    LBFGSParams(int max_i = 30, int history = 6, double grad_tol = 1e-5, double c1 = 1e-4, int max_ls = 20);
+
+    /**
+     * @brief Returns a string representation of the hyperparameters
+     */
+    std::string repr() const;
+};
+
+/**
+ * @brief Parameters of the preconditioned conjugate gradient solver
+ */
+struct PCGParams
+{
+    /**
+     * @brief Maximum number of conjugate gradient iterations
+     */
+    int max_iter;
+
+    /**
+     * @brief Convergence tolerance on the residual norm relative to the norm of the right-hand side
+     */
+    double tolerance;
+
+    /**
+     * @brief Rank of the pivoted partial Cholesky preconditioner, zero disables the preconditioner
+     */
+    int preconditioner_rank;
+
+    /**
+     * @brief Whether the covariance tiles are regenerated for every matrix-vector product instead of stored
+     */
+    bool regenerate_tiles;
+
+    /**
+     * @brief Initialize parameters
+     *
+     * @param max_i maximum number of iterations
+     * @param tol relative residual tolerance
+     * @param rank preconditioner rank
+     * @param regenerate regenerate tiles on the fly
+     */
+    PCGParams(int max_i = 1000, double tol = 1e-8, int rank = 20, bool regenerate = false);
+
+    /**
+     * @brief Returns a string representation of the parameters
+     */
+    std::string repr() const;
+};
+
+/**
+ * @brief Parameters of the stochastic estimation of the loss and its gradients
+ */
+struct StochasticParams
+{
+    /**
+     * @brief Number of Rademacher probe vectors of the trace and log-determinant estimates
+     */
+    int n_probes;
+
+    /**
+     * @brief Maximum number of block conjugate gradient iterations, also bounds the Lanczos quadrature size
+     */
+    int max_iter;
+
+    /**
+     * @brief Convergence tolerance on the residual norms relative to the norms of the right-hand sides
+     */
+    double tolerance;
+
+    /**
+     * @brief Whether the covariance tiles are regenerated for every matrix-multi-vector product instead of stored
+     */
+    bool regenerate_tiles;
+
+    /**
+     * @brief Seed of the probe vectors, the optimizer adds the iteration to draw new probes per iteration
+     */
+    unsigned int seed;
+
+    /**
+     * @brief Initialize parameters
+     *
+     * @param probes number of probe vectors
+     * @param max_i maximum number of iterations
+     * @param tol relative residual tolerance
+     * @param regenerate regenerate tiles on the fly
+     * @param s seed of the probe vectors
+     */
+    StochasticParams(int probes = 16, int max_i = 100, double tol = 1e-6, bool regenerate = false, unsigned int s = 0);
+
+    /**
+     * @brief Returns a string representation of the parameters
+     */
+    std::string repr() const;
+};
+
+/**
+ * @brief Parameters of the tile low-rank compression of the off-diagonal tiles
+ */
+struct TLRParams
+{
+    /**
+     * @brief Truncation tolerance relative to the largest singular value of a tile
+     */
+    double tolerance;
+
+    /**
+     * @brief Maximum rank of a compressed tile, zero limits the rank only by the tile size
+     */
+    int max_rank;
+
+    /**
+     * @brief Initialize parameters
+     *
+     * @param tol relative truncation tolerance
+     * @param max_r maximum rank
+     */
+    TLRParams(double tol = 1e-8, int max_r = 0);
+
+    /**
+     * @brief Returns a string representation of the parameters
+     */
+    std::string repr() const;
+};
+
+/**
+ * @brief Parameters of the random Fourier feature approximation of the squared exponential kernel
+ */
+struct RFFParams
+{
+    /**
+     * @brief Number of random cosine features, zero disables the approximation
+     */
+    int n_features;
+
+    /**
+     * @brief Seed of the random frequencies and phases, which stay fixed while the hyperparameters change
+     */
+    unsigned int seed;
+
+    /**
+     * @brief Initialize parameters
+     *
+     * @param features number of random features
+     * @param s seed of the random frequencies and phases
+     */
+    RFFParams(int features = 256, unsigned int s = 0);
+
+    /**
+     * @brief Returns a string representation of the parameters
+     */
+    std::string repr() const;
+};
+
 }  // namespace gprat_hyper
 
 #endif  // GP_HYPERPARAMETERS_H
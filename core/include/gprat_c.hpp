@@ -1,13 +1,26 @@
 #ifndef GPRAT_C_H
 #define GPRAT_C_H
 
+#include "approximation.hpp"
 #include "gp_hyperparameters.hpp"
 #include "gp_kernels.hpp"
+#include "precision.hpp"
 #include "target.hpp"
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+namespace cpu
+{
+template <typename T>
+struct Tiled_factorization;
+template <typename T>
+struct Tiled_distances;
+template <typename T>
+struct Tiled_optimizer;
+}
+
 // namespace for GPRat library entities
 namespace gprat
 {
@@ -47,6 +60,23 @@ struct GP_data
     GP_data(const std::string &file_path, int n, int n_reg);
 };
 
+// Multistart_result /////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Result of optimizations from several initial hyperparameters
+ */
+struct Multistart_result
+{
+    /** @brief Optimized lengthscale, vertical lengthscale and noise variance of the best optimization */
+    std::vector<double> best_params;
+
+    /** @brief Index of the best optimization, the one with the lowest final loss */
+    std::size_t best_index;
+
+    /** @brief Loss values of each iteration for each optimization */
+    std::vector<std::vector<double>> losses;
+};
+
 // GP /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -55,6 +85,13 @@ struct GP_data
  * This class provides methods for training a Gaussian Process model, making
  * predictions, optimizing hyperparameters, and calculating loss. It also
  * includes methods for computing the Cholesky decomposition.
+ *
+ * A GP must not be used from more than one thread at a time. The cached
+ * factorization and distance tiles are rebuilt without synchronization
+ * whenever the hyperparameters, the training data or the number of
+ * regressors change, even by operations that only read the model such as
+ * predict and calculate_loss. Each operation itself runs in parallel on the
+ * HPX runtime.
  */
 class GP
 {
@@ -82,6 +119,121 @@ class GP
      */
     std::shared_ptr<Target> target_;
 
+    /**
+     * @brief Precision of the tiles of the covariance matrix on the CPU
+     */
+    Precision precision_;
+
+    /**
+     * @brief Cached factorization of the covariance matrix used by the CPU
+     * implementation.
+     *
+     * Reused by predictions, loss and Cholesky computations as long as the
+     * kernel hyperparameters and the number of regressors stay the same.
+     * Not synchronized, see the thread-safety note of the class.
+     */
+    std::shared_ptr<const cpu::Tiled_factorization<double>> factorization_;
+
+    /**
+     * @brief Returns the cached factorization, recomputes it if it is missing
+     * or stale.
+     */
+    const cpu::Tiled_factorization<double> &cpu_factorization();
+
+    /**
+     * @brief Cached FP32 factorization of the covariance matrix used by the
+     * CPU implementation in FP32 precision.
+     */
+    std::shared_ptr<const cpu::Tiled_factorization<float>> factorization_fp32_;
+
+    /**
+     * @brief Returns the cached FP32 factorization, recomputes it if it is
+     * missing or stale.
+     */
+    const cpu::Tiled_factorization<float> &cpu_factorization_fp32();
+
+    /**
+     * @brief Calls f with the cached factorization in the precision of the GP
+     * and returns its result.
+     */
+    template <typename F>
+    auto with_cpu_factorization(F &&f);
+
+    /**
+     * @brief Cached squared distance tiles of the training input used by the
+     * CPU optimizer.
+     *
+     * The distances do not depend on the kernel hyperparameters and are kept
+     * until the training data or the number of regressors change.
+     */
+    std::shared_ptr<cpu::Tiled_distances<double>> distances_;
+
+    /**
+     * @brief Returns the cached distance tiles, recomputes them if they are
+     * missing or stale.
+     */
+    cpu::Tiled_distances<double> &cpu_distances();
+
+    /**
+     * @brief Cached FP32 squared distance tiles of the training input used by
+     * the CPU optimizer in FP32 precision.
+     */
+    std::shared_ptr<cpu::Tiled_distances<float>> distances_fp32_;
+
+    /**
+     * @brief Returns the cached FP32 distance tiles, recomputes them if they
+     * are missing or stale.
+     */
+    cpu::Tiled_distances<float> &cpu_distances_fp32();
+
+    /**
+     * @brief Inducing points of the sparse approximations, row-major
+     * n_inducing_ x n_reg
+     */
+    std::vector<double> inducing_points_;
+
+    /** @brief Number of inducing points */
+    int n_inducing_;
+
+    /**
+     * @brief Returns the inducing points, throws if they have not been
+     * selected for the current number of regressors.
+     */
+    const std::vector<double> &sparse_inducing_points() const;
+
+    /**
+     * @brief Parameters of the random Fourier feature approximation, zero
+     * features for the exact GP
+     */
+    gprat_hyper::RFFParams rff_params_;
+
+    /** @brief Whether the local experts approximation is enabled */
+    bool local_experts_;
+
+    /** @brief Combination of the predictions of the local experts */
+    Expert_combination expert_combination_;
+
+    /**
+     * @brief Throws if the random feature or local experts approximation is
+     * enabled, for the operations that are only defined for the exact GP.
+     */
+    void require_exact_model(const std::string &operation) const;
+
+    /**
+     * @brief Predict output for test input and additionally provide
+     * uncertainty for the predictions with the local experts approximation.
+     *
+     * @param test_data Test input data
+     * @param m_tiles Number of tiles
+     * @param m_tile_size Size of each tile
+     *
+     * @return predictions and uncertainties
+     */
+    std::vector<std::vector<double>>
+    predict_experts_with_uncertainty(const std::vector<double> &test_data, int m_tiles, int m_tile_size);
+
+    friend class OptimizerSession;
+
   public:
     /// Variables
     /// /////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -110,6 +262,7 @@ class GP
      *                           parameter of squared exponential kernel
      * @param trainable_bool Vector indicating which parameters are trainable
      * @param target Target for computations
+     * @param precision Precision of the tiles of the covariance matrix on the CPU
      */
     GP(std::vector<double> input,
        std::vector<double> output,
@@ -118,7 +271,8 @@ class GP
        int n_regressors,
        std::vector<double> kernel_hyperparams,
        std::vector<bool> trainable_bool,
-       std::shared_ptr<Target> target);
+       std::shared_ptr<Target> target,
+       Precision precision = Precision::fp64);
 
     /// CPU constructor
     /// ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -135,6 +289,7 @@ class GP
      *                           vertical lengthscale, and noise variance
      *                           parameter of squared exponential kernel
      * @param trainable_bool Vector indicating which parameters are trainable
+     * @param precision Precision of the tiles of the covariance matrix
      */
     GP(std::vector<double> input,
        std::vector<double> output,
@@ -142,7 +297,8 @@ class GP
        int n_tile_size,
        int n_regressors,
        std::vector<double> kernel_hyperparams,
-       std::vector<bool> trainable_bool);
+       std::vector<bool> trainable_bool,
+       Precision precision = Precision::fp64);
 
     /// GPU constructor
     /// ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -190,6 +346,31 @@ class GP
      */
     std::vector<double> get_training_output() const;
 
+    /**
+     * @brief Append new observations to the training data
+     *
+     * The new input values continue the training input series. If a
+     * factorization of the covariance matrix is cached, it is extended by
+     * the new tile rows instead of being recomputed from scratch.
+     *
+     * @param new_input New training input values, a multiple of the tile size
+     * @param new_output New training output values, one per input value
+     */
+    void append_observations(const std::vector<double> &new_input, const std::vector<double> &new_output);
+
+    /**
+     * @brief Slide the training window over new observations
+     *
+     * Appends the new observations and drops the same number of oldest
+     * observations, such that the number of tiles stays the same. If a
+     * factorization of the covariance matrix is cached, it is updated
+     * instead of being recomputed from scratch.
+     *
+     * @param new_input New training input values, a multiple of the tile size
+     * @param new_output New training output values, one per input value
+     */
+    void slide_window(const std::vector<double> &new_input, const std::vector<double> &new_output);
+
     /**
      * @brief Predict output for test input
      */
@@ -225,6 +406,31 @@ class GP
      */
     std::vector<double> optimize(const gprat_hyper::AdamParams &adam_params);
 
+    /**
+     * @brief Optimize hyperparameters from several initial hyperparameters
+     *
+     * The optimizations run concurrently and share the distance tiles of the
+     * training data. Afterwards, the kernel hyperparameters are set to the
+     * result of the optimization with the lowest final loss.
+     *
+     * @param initial_params_list Initial lengthscale, vertical lengthscale
+     *        and noise variance of each optimization
+     * @param adam_params Hyperparameters of the Adam optimizer
+     *
+     * @return best hyperparameters and losses of all optimizations
+     */
+    Multistart_result optimize_multistart(const std::vector<std::vector<double>> &initial_params_list,
+                                          const gprat_hyper::AdamParams &adam_params);
+
+    /**
+     * @brief Optimize hyperparameters with L-BFGS
+     *
+     * @param lbfgs_params Hyperparameters of the L-BFGS optimizer
+     *
+     * @return losses of the initial hyperparameters and of each iteration
+     */
+    std::vector<double> optimize_lbfgs(const gprat_hyper::LBFGSParams &lbfgs_params);
+
     /**
      * @brief Perform a single optimization step
      *
@@ -241,12 +447,269 @@ class GP
      */
     double calculate_loss();
 
+    /**
+     * @brief Calculate loss for several hyperparameters
+     *
+     * The covariance matrices of all candidates are assembled from the same
+     * distance tiles and factorized in one task graph. The hyperparameters of
+     * the GP are not changed.
+     *
+     * @param params_list Lengthscale, vertical lengthscale and noise variance
+     *        of each candidate
+     *
+     * @return loss of each candidate
+     */
+    std::vector<double> evaluate_loss_grid(const std::vector<std::vector<double>> &params_list);
+
+    /**
+     * @brief Calculate loss and its gradients for given hyperparameters
+     *
+     * Both are computed from a single factorization of the covariance matrix,
+     * the hyperparameters of the GP are not changed.
+     *
+     * @param params Lengthscale, vertical lengthscale and noise variance
+     * @param unconstrained Whether params and gradients refer to the
+     *        unconstrained hyperparameters of the softplus transformation
+     *
+     * @return loss and gradients w.r.t. lengthscale, vertical lengthscale
+     *         and noise variance
+     */
+    std::pair<double, std::vector<double>>
+    loss_and_gradient(const std::vector<double> &params, bool unconstrained = false);
+
+    /**
+     * @brief Select the inducing points of the sparse approximations
+     *
+     * The inducing points are evenly strided feature vectors of the training
+     * input, optionally refined by k-means iterations. They are kept when
+     * training data is appended or the training window slides.
+     *
+     * @param n_inducing Number of inducing points, at most the number of
+     *        training samples
+     * @param kmeans_iterations Number of k-means iterations
+     */
+    void set_inducing_points(int n_inducing, int kmeans_iterations = 0);
+
+    /**
+     * @brief Returns the inducing points, row-major n_inducing x n_reg
+     */
+    std::vector<double> get_inducing_points() const;
+
+    /**
+     * @brief Calculate loss of an inducing point approximation
+     *
+     * @param approximation Inducing point approximation
+     */
+    double calculate_sparse_loss(Approximation approximation);
+
+    /**
+     * @brief Optimize hyperparameters of an inducing point approximation
+     *
+     * The inducing points stay fixed, each iteration takes O(N * M^2)
+     * operations for M inducing points.
+     *
+     * @param adam_params Hyperparameters of the Adam optimizer
+     * @param approximation Inducing point approximation
+     *
+     * @return losses
+     */
+    std::vector<double> optimize_sparse(const gprat_hyper::AdamParams &adam_params, Approximation approximation);
+
+    /**
+     * @brief Predict output for test input and additionally provide
+     * uncertainty for the predictions with an inducing point approximation.
+     *
+     * @param test_data Test input data
+     * @param m_tiles Number of tiles
+     * @param m_tile_size Size of each tile
+     * @param approximation Inducing point approximation
+     *
+     * @return predictions and uncertainties
+     */
+    std::vector<std::vector<double>> predict_sparse_with_uncertainty(
+        const std::vector<double> &test_data, int m_tiles, int m_tile_size, Approximation approximation);
+
+    /**
+     * @brief Predict output for test input with preconditioned conjugate
+     * gradients instead of the Cholesky decomposition
+     *
+     * Only matrix-vector products with the covariance matrix are required.
+     * If the tiles are regenerated for every product, the memory stays
+     * O(N * n_tile_size).
+     *
+     * @param test_data Test input data
+     * @param m_tiles Number of tiles
+     * @param m_tile_size Size of each tile
+     * @param pcg_params Parameters of the solver
+     *
+     * @return predictions
+     */
+    std::vector<double> predict_pcg(
+        const std::vector<double> &test_data, int m_tiles, int m_tile_size, const gprat_hyper::PCGParams &pcg_params);
+
+    /**
+     * @brief Estimate loss with probe vectors instead of the Cholesky
+     * decomposition
+     *
+     * The quadratic term and the log-determinant are estimated with block
+     * conjugate gradients and stochastic Lanczos quadrature.
+     *
+     * @param stochastic_params Parameters of the estimation
+     *
+     * @return estimated loss
+     */
+    double calculate_stochastic_loss(const gprat_hyper::StochasticParams &stochastic_params);
+
+    /**
+     * @brief Optimize hyperparameters with Adam and stochastic estimates of
+     * the loss and its gradients
+     *
+     * Only matrix-multi-vector products with the covariance matrix are
+     * required, new probe vectors are drawn in every iteration.
+     *
+     * @param adam_params Hyperparameters of the Adam optimizer
+     * @param stochastic_params Parameters of the estimation
+     *
+     * @return estimated losses
+     */
+    std::vector<double> optimize_stochastic(const gprat_hyper::AdamParams &adam_params,
+                                            const gprat_hyper::StochasticParams &stochastic_params);
+
+    /**
+     * @brief Calculate loss with the tile low-rank Cholesky decomposition
+     *
+     * The off-diagonal tiles are compressed to low rank and the
+     * decomposition operates on the low-rank factors.
+     *
+     * @param tlr_params Parameters of the compression
+     *
+     * @return loss
+     */
+    double calculate_tlr_loss(const gprat_hyper::TLRParams &tlr_params);
+
+    /**
+     * @brief Predict output for test input with the tile low-rank Cholesky
+     * decomposition
+     *
+     * @param test_data Test input data
+     * @param m_tiles Number of tiles
+     * @param m_tile_size Size of each tile
+     * @param tlr_params Parameters of the compression
+     *
+     * @return predictions
+     */
+    std::vector<double> predict_tlr(
+        const std::vector<double> &test_data, int m_tiles, int m_tile_size, const gprat_hyper::TLRParams &tlr_params);
+
+    /**
+     * @brief Compute the ranks of the tiles of the tile low-rank Cholesky
+     * factor
+     *
+     * @param tlr_params Parameters of the compression
+     *
+     * @return n_tiles x n_tiles ranks in row-major order, the tile size for
+     *         the dense diagonal tiles and zero above the diagonal
+     */
+    std::vector<int> tlr_ranks(const gprat_hyper::TLRParams &tlr_params);
+
+    /**
+     * @brief Switch to the random Fourier feature approximation
+     *
+     * While enabled, predict, predict_with_uncertainty, calculate_loss and
+     * optimize use the Bayesian linear regression on random features of the
+     * squared exponential kernel instead of the exact GP. The features are
+     * drawn once from the seed and stay fixed while the hyperparameters
+     * change. Zero features switch back to the exact GP. The operations
+     * that are only defined for the exact GP throw while enabled, and the
+     * local experts approximation must be disabled.
+     *
+     * @param rff_params Parameters of the random features
+     */
+    void set_random_features(const gprat_hyper::RFFParams &rff_params);
+
+    /**
+     * @brief Switch to the local experts approximation
+     *
+     * While enabled, predict, predict_with_uncertainty, calculate_loss and
+     * optimize treat each training tile as an independent expert. The loss
+     * is the loss of the block-diagonal covariance matrix, each optimizer
+     * iteration factorizes the diagonal tiles independently and takes
+     * O(N * n_tile_size^2) operations, and the predictions of the experts
+     * are combined with the given combination. The operations that are only
+     * defined for the exact GP throw while enabled.
+     *
+     * @param enabled Whether to use the local experts instead of the exact GP
+     * @param combination Combination of the expert predictions
+     */
+    void set_local_experts(bool enabled, Expert_combination combination = Expert_combination::rbcm);
+
     /**
      * @brief Computes & returns cholesky decomposition
      */
     std::vector<std::vector<double>> cholesky();
 };
 
+// OptimizerSession ///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Optimization of the hyperparameters of a GP over several calls
+ *
+ * The session owns the tiled training output, the distance tiles and the
+ * iteration counter of the Adam bias correction. Repeated steps therefore
+ * only perform the numeric work of the iterations. The Adam moments are kept
+ * in the kernel hyperparameters of the GP, which is updated after each step.
+ *
+ * The session uses the training data and the number of regressors of the GP
+ * at its construction. The GP must outlive the session.
+ */
+class OptimizerSession
+{
+  private:
+    /** @brief Gaussian process whose hyperparameters are optimized */
+    GP &gp_;
+
+    /** @brief Optimizer state in FP64 precision */
+    std::shared_ptr<cpu::Tiled_optimizer<double>> optimizer_;
+
+    /** @brief Optimizer state in FP32 precision */
+    std::shared_ptr<cpu::Tiled_optimizer<float>> optimizer_fp32_;
+
+  public:
+    /** @brief Hyperparameters of the Adam optimizer */
+    gprat_hyper::AdamParams adam_params;
+
+    /**
+     * @brief Constructs an optimizer session for a GP
+     *
+     * @param gp Gaussian process whose hyperparameters are optimized
+     * @param adam Hyperparameters of the Adam optimizer
+     */
+    OptimizerSession(GP &gp, const gprat_hyper::AdamParams &adam);
+
+    /**
+     * @brief Perform a single optimization step
+     *
+     * @return loss
+     */
+    double step();
+
+    /**
+     * @brief Perform consecutive optimization steps
+     *
+     * The iterations are pipelined, only the losses are synchronized at the end.
+     *
+     * @param n_iterations Number of optimization steps
+     *
+     * @return losses
+     */
+    std::vector<double> run(int n_iterations);
+
+    /**
+     * @brief Returns the number of performed optimization steps
+     */
+    int iteration() const;
+};
+
 }  // namespace gprat
 
 #endif  // end of GPRAT_C_H
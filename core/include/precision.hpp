@@ -0,0 +1,29 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+namespace gprat
+{
+
+/**
+ * @brief Floating point precision of the tiles of the covariance matrix and its factorization
+ *
+ * Only used by the CPU implementation, GPU targets always compute in FP64.
+ */
+enum class Precision
+{
+    /** @brief All tiles are computed and stored in FP64 */
+    fp64,
+
+    /**
+     * @brief Off-diagonal tiles and their updates are computed in FP32, diagonal tiles in FP64, and
+     * the solution is refined against the FP64 covariance matrix
+     */
+    mixed,
+
+    /** @brief All tiles are computed and stored in FP32, results are returned in FP64 */
+    fp32
+};
+
+}  // namespace gprat
+
+#endif  // end of PRECISION_H
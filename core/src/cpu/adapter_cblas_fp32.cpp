@@ -9,11 +9,13 @@
 #include "lapacke.h"
 #endif
 
+namespace fp32
+{
+
 // BLAS level 3 operations
 
-vector potrf(vector_future f_A, const int N)
+vector potrf(vector A, const int N)
 {
-    vector A = f_A.get();
     // POTRF: in-place Cholesky decomposition of A
     // use spotrf2 recursive version for better stability
     LAPACKE_spotrf2(LAPACK_ROW_MAJOR, 'L', N, A.data(), N);
@@ -21,16 +23,14 @@ vector potrf(vector_future f_A, const int N)
     return A;
 }
 
-vector trsm(vector_future f_L,
-            vector_future f_A,
+vector trsm(const vector &L,
+            vector A,
             const int N,
             const int M,
             const BLAS_TRANSPOSE transpose_L,
             const BLAS_SIDE side_L)
 
 {
-    const vector &L = f_L.get();
-    vector A = f_A.get();
     // TRSM constants
     const float alpha = 1.0f;
     // TRSM: in-place solve L(^T) * X = A or X * L(^T) = A where L lower triangular
@@ -51,10 +51,8 @@ vector trsm(vector_future f_L,
     return A;
 }
 
-vector syrk(vector_future f_A, vector_future f_B, const int N)
+vector syrk(vector A, const vector &B, const int N)
 {
-    const vector &B = f_B.get();
-    vector A = f_A.get();
     // SYRK constants
     const float alpha = -1.0f;
     const float beta = 1.0f;
@@ -64,18 +62,15 @@ vector syrk(vector_future f_A, vector_future f_B, const int N)
     return A;
 }
 
-vector gemm(vector_future f_A,
-            vector_future f_B,
-            vector_future f_C,
+vector gemm(const vector &A,
+            const vector &B,
+            vector C,
             const int N,
             const int M,
             const int K,
             const BLAS_TRANSPOSE transpose_A,
             const BLAS_TRANSPOSE transpose_B)
 {
-    vector C = f_C.get();
-    const vector &B = f_B.get();
-    const vector &A = f_A.get();
     // GEMM constants
     const float alpha = -1.0f;
     const float beta = 1.0f;
@@ -99,12 +94,85 @@ vector gemm(vector_future f_A,
     return C;
 }
 
+vector trtri(const vector &L, vector X, const int N)
+{
+    // Copy the lower triangle of L and zero the strictly upper triangle, such that X can be used as a general matrix
+    const std::size_t n = static_cast<std::size_t>(N);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            X[i * n + j] = j <= i ? L[i * n + j] : 0.0f;
+        }
+    }
+    // TRTRI: in-place inverse of X where X lower triangular
+    LAPACKE_strtri(LAPACK_ROW_MAJOR, 'L', 'N', N, X.data(), N);
+    // return inverse matrix L^-1
+    return X;
+}
+
+vector lauum(vector L, const int N)
+{
+    // LAUUM: in-place product L^T * L where L lower triangular, only the lower triangle is computed
+    LAPACKE_slauum(LAPACK_ROW_MAJOR, 'L', N, L.data(), N);
+    // return lower triangle of L^T * L
+    return L;
+}
+
+vector trmm(const vector &L,
+            vector A,
+            const int N,
+            const int M,
+            const BLAS_TRANSPOSE transpose_L,
+            const BLAS_SIDE side_L)
+{
+    // TRMM constants
+    const float alpha = 1.0f;
+    // TRMM: in-place A = L(^T) * A or A = A * L(^T) where L lower triangular
+    cblas_strmm(
+        CblasRowMajor,
+        static_cast<CBLAS_SIDE>(side_L),
+        CblasLower,
+        static_cast<CBLAS_TRANSPOSE>(transpose_L),
+        CblasNonUnit,
+        N,
+        M,
+        alpha,
+        L.data(),
+        N,
+        A.data(),
+        M);
+    // return updated matrix A
+    return A;
+}
+
+vector syrk_trans_add(vector A, const vector &B, const int N)
+{
+    // SYRK constants
+    const float alpha = 1.0f;
+    const float beta = 1.0f;
+    // SYRK: A = A + B^T * B
+    cblas_ssyrk(CblasRowMajor, CblasLower, CblasTrans, N, N, alpha, B.data(), N, beta, A.data(), N);
+    // return updated matrix A
+    return A;
+}
+
+vector gemm_trans_add(const vector &A, const vector &B, vector C, const int N)
+{
+    // GEMM constants
+    const float alpha = 1.0f;
+    const float beta = 1.0f;
+    // GEMM: C = C + A^T * B
+    cblas_sgemm(
+        CblasRowMajor, CblasTrans, CblasNoTrans, N, N, N, alpha, A.data(), N, B.data(), N, beta, C.data(), N);
+    // return updated matrix C
+    return C;
+}
+
 // BLAS level 2 operations
 
-vector trsv(vector_future f_L, vector_future f_a, const int N, const BLAS_TRANSPOSE transpose_L)
+vector trsv(const vector &L, vector a, const int N, const BLAS_TRANSPOSE transpose_L)
 {
-    const vector &L = f_L.get();
-    vector a = f_a.get();
     // TRSV: In-place solve L(^T) * x = a where L lower triangular
     cblas_strsv(CblasRowMajor,
                 CblasLower,
@@ -119,17 +187,14 @@ vector trsv(vector_future f_L, vector_future f_a, const int N, const BLAS_TRANSP
     return a;
 }
 
-vector gemv(vector_future f_A,
-            vector_future f_a,
-            vector_future f_b,
+vector gemv(const vector &A,
+            const vector &a,
+            vector b,
             const int N,
             const int M,
             const BLAS_ALPHA alpha,
             const BLAS_TRANSPOSE transpose_A)
 {
-    const vector &A = f_A.get();
-    const vector &a = f_a.get();
-    vector b = f_b.get();
     // GEMV constants
     // const float alpha = -1.0;
     const float beta = 1.0f;
@@ -151,10 +216,18 @@ vector gemv(vector_future f_A,
     return b;
 }
 
-vector dot_diag_syrk(vector_future f_A, vector_future f_r, const int N, const int M)
+vector symv(const vector &A, const vector &a, vector b, const int N, const BLAS_ALPHA alpha)
+{
+    // SYMV constants
+    const float beta = 1.0f;
+    // SYMV: b{N} = b{N} + alpha * A{NxN} * a{N} where only the lower triangle of A is referenced
+    cblas_ssymv(CblasRowMajor, CblasLower, N, alpha, A.data(), N, a.data(), 1, beta, b.data(), 1);
+    // return updated vector b
+    return b;
+}
+
+vector dot_diag_syrk(const vector &A, vector r, const int N, const int M)
 {
-    const vector &A = f_A.get();
-    vector r = f_r.get();
     // r = r + diag(A^T * A)
     for (std::size_t j = 0; j < static_cast<std::size_t>(M); ++j)
     {
@@ -164,11 +237,8 @@ vector dot_diag_syrk(vector_future f_A, vector_future f_r, const int N, const in
     return r;
 }
 
-vector dot_diag_gemm(vector_future f_A, vector_future f_B, vector_future f_r, const int N, const int M)
+vector dot_diag_gemm(const vector &A, const vector &B, vector r, const int N, const int M)
 {
-    const vector &A = f_A.get();
-    const vector &B = f_B.get();
-    vector r = f_r.get();
     // r = r + diag(A * B)
     for (std::size_t i = 0; i < static_cast<std::size_t>(N); ++i)
     {
@@ -179,16 +249,16 @@ vector dot_diag_gemm(vector_future f_A, vector_future f_B, vector_future f_r, co
 
 // BLAS level 1 operations
 
-vector axpy(vector_future f_y, vector_future f_x, const int N)
+vector axpy(vector y, const vector &x, const int N)
 {
-    vector y = f_y.get();
-    const vector &x = f_x.get();
     cblas_saxpy(N, -1.0f, x.data(), 1, y.data(), 1);
     return y;
 }
 
-float dot(vector a, vector b, const int N)
+float dot(const vector &a, const vector &b, const int N)
 {
     // DOT: a * b
     return cblas_sdot(N, a.data(), 1, b.data(), 1);
 }
+
+}  // end of namespace fp32
@@ -8,12 +8,12 @@
 #include "cblas.h"
 #include "lapacke.h"
 #endif
+#include <algorithm>
 
 // BLAS level 3 operations
 
-vector potrf(vector_future f_A, const int N)
+vector potrf(vector A, const int N)
 {
-    vector A = f_A.get();
     // POTRF: in-place Cholesky decomposition of A
     // use dpotrf2 recursive version for better stability
     LAPACKE_dpotrf2(LAPACK_ROW_MAJOR, 'L', N, A.data(), N);
@@ -21,16 +21,14 @@ vector potrf(vector_future f_A, const int N)
     return A;
 }
 
-vector trsm(vector_future f_L,
-            vector_future f_A,
+vector trsm(const vector &L,
+            vector A,
             const int N,
             const int M,
             const BLAS_TRANSPOSE transpose_L,
             const BLAS_SIDE side_L)
 
 {
-    const vector &L = f_L.get();
-    vector A = f_A.get();
     // TRSM constants
     const double alpha = 1.0;
     // TRSM: in-place solve L(^T) * X = A or X * L(^T) = A where L lower triangular
@@ -51,10 +49,8 @@ vector trsm(vector_future f_L,
     return A;
 }
 
-vector syrk(vector_future f_A, vector_future f_B, const int N)
+vector syrk(vector A, const vector &B, const int N)
 {
-    const vector &B = f_B.get();
-    vector A = f_A.get();
     // SYRK constants
     const double alpha = -1.0;
     const double beta = 1.0;
@@ -64,18 +60,15 @@ vector syrk(vector_future f_A, vector_future f_B, const int N)
     return A;
 }
 
-vector gemm(vector_future f_A,
-            vector_future f_B,
-            vector_future f_C,
+vector gemm(const vector &A,
+            const vector &B,
+            vector C,
             const int N,
             const int M,
             const int K,
             const BLAS_TRANSPOSE transpose_A,
             const BLAS_TRANSPOSE transpose_B)
 {
-    vector C = f_C.get();
-    const vector &B = f_B.get();
-    const vector &A = f_A.get();
     // GEMM constants
     const double alpha = -1.0;
     const double beta = 1.0;
@@ -99,12 +92,293 @@ vector gemm(vector_future f_A,
     return C;
 }
 
+vector trtri(const vector &L, vector X, const int N)
+{
+    // Copy the lower triangle of L and zero the strictly upper triangle, such that X can be used as a general matrix
+    const std::size_t n = static_cast<std::size_t>(N);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            X[i * n + j] = j <= i ? L[i * n + j] : 0.0;
+        }
+    }
+    // TRTRI: in-place inverse of X where X lower triangular
+    LAPACKE_dtrtri(LAPACK_ROW_MAJOR, 'L', 'N', N, X.data(), N);
+    // return inverse matrix L^-1
+    return X;
+}
+
+vector lauum(vector L, const int N)
+{
+    // LAUUM: in-place product L^T * L where L lower triangular, only the lower triangle is computed
+    LAPACKE_dlauum(LAPACK_ROW_MAJOR, 'L', N, L.data(), N);
+    // return lower triangle of L^T * L
+    return L;
+}
+
+vector trmm(const vector &L,
+            vector A,
+            const int N,
+            const int M,
+            const BLAS_TRANSPOSE transpose_L,
+            const BLAS_SIDE side_L)
+{
+    // TRMM constants
+    const double alpha = 1.0;
+    // TRMM: in-place A = L(^T) * A or A = A * L(^T) where L lower triangular
+    cblas_dtrmm(
+        CblasRowMajor,
+        static_cast<CBLAS_SIDE>(side_L),
+        CblasLower,
+        static_cast<CBLAS_TRANSPOSE>(transpose_L),
+        CblasNonUnit,
+        N,
+        M,
+        alpha,
+        L.data(),
+        N,
+        A.data(),
+        M);
+    // return updated matrix A
+    return A;
+}
+
+vector syrk_trans_add(vector A, const vector &B, const int N)
+{
+    // SYRK constants
+    const double alpha = 1.0;
+    const double beta = 1.0;
+    // SYRK: A = A + B^T * B
+    cblas_dsyrk(CblasRowMajor, CblasLower, CblasTrans, N, N, alpha, B.data(), N, beta, A.data(), N);
+    // return updated matrix A
+    return A;
+}
+
+vector gemm_trans_add(const vector &A, const vector &B, vector C, const int N)
+{
+    // GEMM constants
+    const double alpha = 1.0;
+    const double beta = 1.0;
+    // GEMM: C = C + A^T * B
+    cblas_dgemm(
+        CblasRowMajor, CblasTrans, CblasNoTrans, N, N, N, alpha, A.data(), N, B.data(), N, beta, C.data(), N);
+    // return updated matrix C
+    return C;
+}
+
+vector syrk_panel_add(vector A, const vector &B, const int N, const int K)
+{
+    // SYRK constants
+    const double alpha = 1.0;
+    const double beta = 1.0;
+    // SYRK: A{NxN} = A{NxN} + B{NxK} * B^T{KxN}
+    cblas_dsyrk(CblasRowMajor, CblasLower, CblasNoTrans, N, K, alpha, B.data(), K, beta, A.data(), N);
+    // return updated matrix A
+    return A;
+}
+
+vector gemm_panel_add(const vector &A, const vector &B, vector C, const int N, const int M, const int K)
+{
+    // GEMM constants
+    const double alpha = 1.0;
+    const double beta = 1.0;
+    // GEMM: C{NxM} = C{NxM} + A{NxK} * B^T{KxM}
+    cblas_dgemm(
+        CblasRowMajor, CblasNoTrans, CblasTrans, N, M, K, alpha, A.data(), K, B.data(), K, beta, C.data(), M);
+    // return updated matrix C
+    return C;
+}
+
+vector gemm_multi_vector(const vector &A,
+                         const vector &B,
+                         vector C,
+                         const int N,
+                         const int M,
+                         const BLAS_TRANSPOSE transpose_A)
+{
+    // GEMM constants
+    const double alpha = 1.0;
+    const double beta = 1.0;
+    // GEMM: C{NxM} = C{NxM} + A(^T){NxN} * B{NxM}
+    cblas_dgemm(CblasRowMajor,
+                static_cast<CBLAS_TRANSPOSE>(transpose_A),
+                CblasNoTrans,
+                N,
+                M,
+                N,
+                alpha,
+                A.data(),
+                N,
+                B.data(),
+                M,
+                beta,
+                C.data(),
+                M);
+    // return updated block C
+    return C;
+}
+
+vector gemm_panel_inner(const vector &A, const vector &B, const int N, const int K_A, const int K_B)
+{
+    vector C(static_cast<std::size_t>(K_A) * static_cast<std::size_t>(K_B));
+    // GEMM: C = A^T * B
+    cblas_dgemm(CblasRowMajor,
+                CblasTrans,
+                CblasNoTrans,
+                K_A,
+                K_B,
+                N,
+                1.0,
+                A.data(),
+                K_A,
+                B.data(),
+                K_B,
+                0.0,
+                C.data(),
+                K_B);
+    // return product matrix C
+    return C;
+}
+
+vector stev(vector diagonal, vector off_diagonal, const int N)
+{
+    const std::size_t n = static_cast<std::size_t>(N);
+    vector eigen(n + n * n);
+    // STEV: eigenvalues overwrite the diagonal, eigenvectors are stored behind the eigenvalues
+    LAPACKE_dstev(LAPACK_ROW_MAJOR, 'V', N, diagonal.data(), off_diagonal.data(), eigen.data() + n, N);
+    std::copy(diagonal.begin(), diagonal.end(), eigen.begin());
+    // return eigenvalues followed by eigenvectors
+    return eigen;
+}
+
+vector geqrf_panel(vector A, const int N, const int K)
+{
+    const std::size_t n = static_cast<std::size_t>(N);
+    const std::size_t k = static_cast<std::size_t>(K);
+    const std::size_t r = std::min(n, k);
+    // Column-major copy of A, reflectors and scalar factors of the reflectors are stored in-place
+    vector QR(n * k + r);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < k; j++)
+        {
+            QR[j * n + i] = A[i * k + j];
+        }
+    }
+    // GEQRF: in-place QR decomposition
+    LAPACKE_dgeqrf(LAPACK_COL_MAJOR, N, K, QR.data(), N, QR.data() + n * k);
+    // Upper triangular R behind Q, stored in the buffer of A
+    A.assign(n * r + r * k, 0.0);
+    for (std::size_t i = 0; i < r; i++)
+    {
+        for (std::size_t j = i; j < k; j++)
+        {
+            A[n * r + i * k + j] = QR[j * n + i];
+        }
+    }
+    // ORGQR: form the first r columns of Q in-place
+    LAPACKE_dorgqr(LAPACK_COL_MAJOR, N, static_cast<int>(r), static_cast<int>(r), QR.data(), N, QR.data() + n * k);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < r; j++)
+        {
+            A[i * r + j] = QR[j * n + i];
+        }
+    }
+    // return packed Q followed by R
+    return A;
+}
+
+vector gesvd(vector A, const int N, const int M)
+{
+    const std::size_t n = static_cast<std::size_t>(N);
+    const std::size_t m = static_cast<std::size_t>(M);
+    const std::size_t r = std::min(n, m);
+    vector SVD(r + n * r + r * m);
+    vector superb(r > 1 ? r - 1 : 1);
+    // GESVD: thin singular value decomposition, A is overwritten
+    LAPACKE_dgesvd(LAPACK_ROW_MAJOR,
+                   'S',
+                   'S',
+                   N,
+                   M,
+                   A.data(),
+                   M,
+                   SVD.data(),
+                   SVD.data() + r,
+                   static_cast<int>(r),
+                   SVD.data() + r + n * r,
+                   M,
+                   superb.data());
+    // return singular values followed by U and V^T
+    return SVD;
+}
+
+vector geqrf_update(const vector &L, const vector &W, const int N)
+{
+    const std::size_t n = static_cast<std::size_t>(N);
+    // Column j of the column-major stacked matrix [L^T; W^T] holds row j of L and row j of W
+    vector QR(2 * n * n + n);
+    for (std::size_t j = 0; j < n; j++)
+    {
+        std::copy(L.data() + j * n, L.data() + j * n + j + 1, QR.data() + j * 2 * n);
+        std::copy(W.data() + j * n, W.data() + (j + 1) * n, QR.data() + j * 2 * n + n);
+    }
+    // GEQRF: in-place QR decomposition, scalar factors of the reflectors are stored at the end
+    LAPACKE_dgeqrf(LAPACK_COL_MAJOR, 2 * N, N, QR.data(), 2 * N, QR.data() + 2 * n * n);
+    // return packed QR decomposition
+    return QR;
+}
+
+vector qr_update_factor(const vector &QR, const int N)
+{
+    const std::size_t n = static_cast<std::size_t>(N);
+    vector L(n * n, 0.0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            // L' = R^T with sign of column j flipped for positive diagonal
+            const double sign = QR[j * 2 * n + j] < 0.0 ? -1.0 : 1.0;
+            L[i * n + j] = sign * QR[i * 2 * n + j];
+        }
+    }
+    // return updated matrix L'
+    return L;
+}
+
+vector ormqr_update(const vector &QR, const vector &L, const vector &W, const int N)
+{
+    const std::size_t n = static_cast<std::size_t>(N);
+    // Column i of the column-major matrix [L W]^T holds row i of L and row i of W
+    vector C(2 * n * n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::copy(L.data() + i * n, L.data() + (i + 1) * n, C.data() + i * 2 * n);
+        std::copy(W.data() + i * n, W.data() + (i + 1) * n, C.data() + i * 2 * n + n);
+    }
+    // ORMQR: ([L W] * Q)^T = Q^T * [L W]^T
+    LAPACKE_dormqr(LAPACK_COL_MAJOR, 'L', 'T', 2 * N, N, N, QR.data(), 2 * N, QR.data() + 2 * n * n, C.data(), 2 * N);
+    // Unpack row-major L' and W', L' with the same sign flips as in qr_update_factor
+    vector LW(2 * n * n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < n; j++)
+        {
+            const double sign = QR[j * 2 * n + j] < 0.0 ? -1.0 : 1.0;
+            LW[i * n + j] = sign * C[i * 2 * n + j];
+            LW[n * n + i * n + j] = C[i * 2 * n + n + j];
+        }
+    }
+    // return packed updated matrices L' and W'
+    return LW;
+}
+
 // BLAS level 2 operations
 
-vector trsv(vector_future f_L, vector_future f_a, const int N, const BLAS_TRANSPOSE transpose_L)
+vector trsv(const vector &L, vector a, const int N, const BLAS_TRANSPOSE transpose_L)
 {
-    const vector &L = f_L.get();
-    vector a = f_a.get();
     // TRSV: In-place solve L(^T) * x = a where L lower triangular
     cblas_dtrsv(CblasRowMajor,
                 CblasLower,
@@ -119,17 +393,14 @@ vector trsv(vector_future f_L, vector_future f_a, const int N, const BLAS_TRANSP
     return a;
 }
 
-vector gemv(vector_future f_A,
-            vector_future f_a,
-            vector_future f_b,
+vector gemv(const vector &A,
+            const vector &a,
+            vector b,
             const int N,
             const int M,
             const BLAS_ALPHA alpha,
             const BLAS_TRANSPOSE transpose_A)
 {
-    const vector &A = f_A.get();
-    const vector &a = f_a.get();
-    vector b = f_b.get();
     // GEMV constants
     // const double alpha = -1.0;
     const double beta = 1.0;
@@ -151,10 +422,18 @@ vector gemv(vector_future f_A,
     return b;
 }
 
-vector dot_diag_syrk(vector_future f_A, vector_future f_r, const int N, const int M)
+vector symv(const vector &A, const vector &a, vector b, const int N, const BLAS_ALPHA alpha)
+{
+    // SYMV constants
+    const double beta = 1.0;
+    // SYMV: b{N} = b{N} + alpha * A{NxN} * a{N} where only the lower triangle of A is referenced
+    cblas_dsymv(CblasRowMajor, CblasLower, N, alpha, A.data(), N, a.data(), 1, beta, b.data(), 1);
+    // return updated vector b
+    return b;
+}
+
+vector dot_diag_syrk(const vector &A, vector r, const int N, const int M)
 {
-    const vector &A = f_A.get();
-    vector r = f_r.get();
     // r = r + diag(A^T * A)
     for (std::size_t j = 0; j < static_cast<std::size_t>(M); ++j)
     {
@@ -164,11 +443,8 @@ vector dot_diag_syrk(vector_future f_A, vector_future f_r, const int N, const in
     return r;
 }
 
-vector dot_diag_gemm(vector_future f_A, vector_future f_B, vector_future f_r, const int N, const int M)
+vector dot_diag_gemm(const vector &A, const vector &B, vector r, const int N, const int M)
 {
-    const vector &A = f_A.get();
-    const vector &B = f_B.get();
-    vector r = f_r.get();
     // r = r + diag(A * B)
     for (std::size_t i = 0; i < static_cast<std::size_t>(N); ++i)
     {
@@ -179,15 +455,13 @@ vector dot_diag_gemm(vector_future f_A, vector_future f_B, vector_future f_r, co
 
 // BLAS level 1 operations
 
-vector axpy(vector_future f_y, vector_future f_x, const int N)
+vector axpy(vector y, const vector &x, const int N)
 {
-    vector y = f_y.get();
-    const vector &x = f_x.get();
     cblas_daxpy(N, -1.0, x.data(), 1, y.data(), 1);
     return y;
 }
 
-double dot(std::vector<double> a, std::vector<double> b, const int N)
+double dot(const std::vector<double> &a, const std::vector<double> &b, const int N)
 {
     // DOT: a * b
     return cblas_ddot(N, a.data(), 1, b.data(), 1);
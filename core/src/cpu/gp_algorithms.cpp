@@ -1,21 +1,31 @@
 #include "cpu/gp_algorithms.hpp"
 
+#include "cpu/vectorized_exp.hpp"
 #include <cmath>
 #include <iterator>
+#include <type_traits>
 
 namespace cpu
 {
 
 // Tile generation
 
-double compute_covariance_function(std::size_t i_global,
-                                   std::size_t j_global,
-                                   std::size_t n_regressors,
-                                   const gprat_hyper::SEKParams &sek_params,
-                                   const std::vector<double> &i_input,
-                                   const std::vector<double> &j_input)
+// Number of regressors from which the lagged distance recurrence pays off
+static const std::size_t LAGGED_MIN_REGRESSORS = 16;
+// Number of tile rows after which lagged distances are recomputed exactly
+static const std::size_t LAGGED_RESEED_ROWS = 32;
+// Jitter on the diagonal of the inducing point covariance, relative to the vertical lengthscale
+static const double INDUCING_JITTER = 1e-6;
+
+/**
+ * @brief Compute the squared distance of two feature vectors with n_regressors entries each
+ */
+static double compute_squared_distance(std::size_t i_global,
+                                       std::size_t j_global,
+                                       std::size_t n_regressors,
+                                       const std::vector<double> &i_input,
+                                       const std::vector<double> &j_input)
 {
-    // k(z_i,z_j) = vertical_lengthscale * exp(-0.5 / lengthscale^2 * (z_i - z_j)^2)
     double distance = 0.0;
     double z_ik_minus_z_jk;
 
@@ -24,44 +34,105 @@ double compute_covariance_function(std::size_t i_global,
         z_ik_minus_z_jk = i_input[i_global + k] - j_input[j_global + k];
         distance += z_ik_minus_z_jk * z_ik_minus_z_jk;
     }
-    return sek_params.vertical_lengthscale * exp(-0.5 / (sek_params.lengthscale * sek_params.lengthscale) * distance);
+    return distance;
 }
 
-std::vector<double> gen_tile_covariance(
+double compute_covariance_function(std::size_t i_global,
+                                   std::size_t j_global,
+                                   std::size_t n_regressors,
+                                   const gprat_hyper::SEKParams &sek_params,
+                                   const std::vector<double> &i_input,
+                                   const std::vector<double> &j_input)
+{
+    // k(z_i,z_j) = vertical_lengthscale * exp(-0.5 / lengthscale^2 * (z_i - z_j)^2)
+    double distance = compute_squared_distance(i_global, j_global, n_regressors, i_input, j_input);
+    double scale = -0.5 / (sek_params.lengthscale * sek_params.lengthscale);
+    return sek_params.vertical_lengthscale * vectorized_exp(scale * distance);
+}
+
+std::vector<double> gen_tile_lagged_distance(
     std::size_t row,
     std::size_t col,
-    std::size_t N,
+    std::size_t N_row,
+    std::size_t N_col,
     std::size_t n_regressors,
-    const gprat_hyper::SEKParams &sek_params,
-    const std::vector<double> &input)
+    const std::vector<double> &row_input,
+    const std::vector<double> &col_input)
 {
-    std::size_t i_global, j_global;
-    double covariance_function;
+    std::size_t i_global;
+    double z_ik, z_leaving, z_entering, z_ik_minus_z_jk;
+    const bool use_recurrence = n_regressors >= LAGGED_MIN_REGRESSORS;
+    // Column feature vectors start at consecutive entries of the column input
+    const double *z_col = col_input.data() + N_col * col;
     // Preallocate required memory
-    std::vector<double> tile;
-    tile.reserve(N * N);
-    // Compute entries
-    for (std::size_t i = 0; i < N; i++)
+    std::vector<double> tile(N_row * N_col, 0.0);
+    // Compute entries row-wise so that the inner loops vectorize
+    for (std::size_t i = 0; i < N_row; i++)
     {
-        i_global = N * row + i;
-        for (std::size_t j = 0; j < N; j++)
+        i_global = N_row * row + i;
+        double *tile_row = tile.data() + i * N_col;
+        if (!use_recurrence || i % LAGGED_RESEED_ROWS == 0)
         {
-            j_global = N * col + j;
-            // compute covariance function
-            covariance_function =
-                compute_covariance_function(i_global, j_global, n_regressors, sek_params, input, input);
-            if (i_global == j_global)
+            // exact distances, also used to re-seed the recurrence
+            for (std::size_t k = 0; k < n_regressors; k++)
             {
-                // noise variance on diagonal
-                covariance_function += sek_params.noise_variance;
+                z_ik = row_input[i_global + k];
+                for (std::size_t j = 0; j < N_col; j++)
+                {
+                    z_ik_minus_z_jk = z_ik - z_col[j + k];
+                    tile_row[j] += z_ik_minus_z_jk * z_ik_minus_z_jk;
+                }
             }
-            tile.push_back(covariance_function);
+            continue;
+        }
+        // first column has no upper left neighbour within the tile
+        tile_row[0] = compute_squared_distance(i_global, N_col * col, n_regressors, row_input, col_input);
+        // d(i,j) = d(i-1,j-1) - (z_{i-1} - z_{j-1})^2 + (z_{i-1+R} - z_{j-1+R})^2
+        const double *previous_row = tile_row - N_col;
+        z_ik = row_input[i_global - 1];
+        const double z_ik_entering = row_input[i_global - 1 + n_regressors];
+        for (std::size_t j = 1; j < N_col; j++)
+        {
+            z_leaving = z_ik - z_col[j - 1];
+            z_entering = z_ik_entering - z_col[j - 1 + n_regressors];
+            tile_row[j] = previous_row[j - 1] - z_leaving * z_leaving + z_entering * z_entering;
         }
     }
     return tile;
 }
 
-std::vector<double> gen_tile_full_prior_covariance(
+/**
+ * @brief Replace squared distances by vertical_lengthscale * exp(scale * distance)
+ *
+ * FP64 tiles are computed in place of the distances, FP32 tiles are rounded from the FP64 entries.
+ */
+template <typename T>
+static std::vector<T>
+exponentiate_distance_tile(std::vector<double> distances, double vertical_lengthscale, double scale)
+{
+    const double *entries = distances.data();
+    const std::size_t size = distances.size();
+    if constexpr (std::is_same_v<T, double>)
+    {
+        for (std::size_t k = 0; k < size; k++)
+        {
+            distances[k] = vertical_lengthscale * vectorized_exp(scale * entries[k]);
+        }
+        return distances;
+    }
+    else
+    {
+        std::vector<T> tile(size);
+        for (std::size_t k = 0; k < size; k++)
+        {
+            tile[k] = static_cast<T>(vertical_lengthscale * vectorized_exp(scale * entries[k]));
+        }
+        return tile;
+    }
+}
+
+template <typename T>
+std::vector<T> gen_tile_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N,
@@ -69,25 +140,24 @@ std::vector<double> gen_tile_full_prior_covariance(
     const gprat_hyper::SEKParams &sek_params,
     const std::vector<double> &input)
 {
-    std::size_t i_global, j_global;
-    // Preallocate required memory
-    std::vector<double> tile;
-    tile.reserve(N * N);
-    // Compute entries
-    for (std::size_t i = 0; i < N; i++)
+    // Compute distances in place of the covariance entries
+    std::vector<T> tile =
+        exponentiate_distance_tile<T>(gen_tile_lagged_distance(row, col, N, N, n_regressors, input, input),
+                                      sek_params.vertical_lengthscale,
+                                      -0.5 / (sek_params.lengthscale * sek_params.lengthscale));
+    if (row == col)
     {
-        i_global = N * row + i;
-        for (std::size_t j = 0; j < N; j++)
+        // noise variance on diagonal
+        for (std::size_t i = 0; i < N; i++)
         {
-            j_global = N * col + j;
-            // compute covariance function
-            tile.push_back(compute_covariance_function(i_global, j_global, n_regressors, sek_params, input, input));
+            tile[i * N + i] += static_cast<T>(sek_params.noise_variance);
         }
     }
     return tile;
 }
 
-std::vector<double> gen_tile_prior_covariance(
+template <typename T>
+std::vector<T> gen_tile_full_prior_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N,
@@ -95,9 +165,29 @@ std::vector<double> gen_tile_prior_covariance(
     const gprat_hyper::SEKParams &sek_params,
     const std::vector<double> &input)
 {
+    // Compute distances in place of the covariance entries
+    return exponentiate_distance_tile<T>(gen_tile_lagged_distance(row, col, N, N, n_regressors, input, input),
+                                         sek_params.vertical_lengthscale,
+                                         -0.5 / (sek_params.lengthscale * sek_params.lengthscale));
+}
+
+template <typename T>
+std::vector<T> gen_tile_prior_covariance(
+    std::size_t row,
+    std::size_t col,
+    std::size_t N,
+    std::size_t n_regressors,
+    const gprat_hyper::SEKParams &sek_params,
+    const std::vector<double> &input)
+{
+    if (row == col)
+    {
+        // feature vectors on the diagonal coincide, so the distance vanishes
+        return std::vector<T>(N, static_cast<T>(sek_params.vertical_lengthscale));
+    }
     std::size_t i_global, j_global;
     // Preallocate required memory
-    std::vector<double> tile;
+    std::vector<T> tile;
     tile.reserve(N);
     // Compute entries
     for (std::size_t i = 0; i < N; i++)
@@ -105,12 +195,14 @@ std::vector<double> gen_tile_prior_covariance(
         i_global = N * row + i;
         j_global = N * col + i;
         // compute covariance function
-        tile.push_back(compute_covariance_function(i_global, j_global, n_regressors, sek_params, input, input));
+        tile.push_back(static_cast<T>(
+            compute_covariance_function(i_global, j_global, n_regressors, sek_params, input, input)));
     }
     return tile;
 }
 
-std::vector<double> gen_tile_cross_covariance(
+template <typename T>
+std::vector<T> gen_tile_cross_covariance(
     std::size_t row,
     std::size_t col,
     std::size_t N_row,
@@ -120,46 +212,130 @@ std::vector<double> gen_tile_cross_covariance(
     const std::vector<double> &row_input,
     const std::vector<double> &col_input)
 {
-    std::size_t i_global, j_global;
+    // Compute distances in place of the covariance entries
+    return exponentiate_distance_tile<T>(
+        gen_tile_lagged_distance(row, col, N_row, N_col, n_regressors, row_input, col_input),
+        sek_params.vertical_lengthscale,
+        -0.5 / (sek_params.lengthscale * sek_params.lengthscale));
+}
+
+std::vector<double> gen_tile_inducing_distance(
+    std::size_t col,
+    std::size_t M,
+    std::size_t N_col,
+    std::size_t n_regressors,
+    const std::vector<double> &inducing_points,
+    const std::vector<double> &col_input)
+{
+    // Column feature vectors start at consecutive entries of the column input
+    const double *z_col = col_input.data() + N_col * col;
     // Preallocate required memory
-    std::vector<double> tile;
-    tile.reserve(N_row * N_col);
-    // Compute entries
-    for (std::size_t i = 0; i < N_row; i++)
+    std::vector<double> tile(M * N_col, 0.0);
+    // Compute entries row-wise so that the inner loop vectorizes
+    for (std::size_t m = 0; m < M; m++)
     {
-        i_global = N_row * row + i;
-        for (std::size_t j = 0; j < N_col; j++)
+        double *tile_row = tile.data() + m * N_col;
+        for (std::size_t k = 0; k < n_regressors; k++)
         {
-            j_global = N_col * col + j;
-            // compute covariance function
-            tile.push_back(
-                compute_covariance_function(i_global, j_global, n_regressors, sek_params, row_input, col_input));
+            const double u_mk = inducing_points[m * n_regressors + k];
+            for (std::size_t j = 0; j < N_col; j++)
+            {
+                const double u_mk_minus_z_jk = u_mk - z_col[j + k];
+                tile_row[j] += u_mk_minus_z_jk * u_mk_minus_z_jk;
+            }
         }
     }
     return tile;
 }
 
-std::vector<double> gen_tile_transpose(std::size_t N_row, std::size_t N_col, const std::vector<double> &tile)
+std::vector<double>
+gen_tile_inducing_self_distance(std::size_t M, std::size_t n_regressors, const std::vector<double> &inducing_points)
 {
     // Preallocate required memory
-    std::vector<double> transposed;
-    transposed.reserve(N_row * N_col);
+    std::vector<double> tile(M * M, 0.0);
+    // Compute the lower triangle and mirror it
+    for (std::size_t i = 0; i < M; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            const double distance = compute_squared_distance(
+                i * n_regressors, j * n_regressors, n_regressors, inducing_points, inducing_points);
+            tile[i * M + j] = distance;
+            tile[j * M + i] = distance;
+        }
+    }
+    return tile;
+}
+
+std::vector<double> gen_tile_inducing_cross_covariance(
+    std::size_t col,
+    std::size_t M,
+    std::size_t N_col,
+    std::size_t n_regressors,
+    const gprat_hyper::SEKParams &sek_params,
+    const std::vector<double> &inducing_points,
+    const std::vector<double> &col_input)
+{
+    // Compute distances in place of the covariance entries
+    return exponentiate_distance_tile<double>(
+        gen_tile_inducing_distance(col, M, N_col, n_regressors, inducing_points, col_input),
+        sek_params.vertical_lengthscale,
+        -0.5 / (sek_params.lengthscale * sek_params.lengthscale));
+}
+
+std::vector<double> gen_tile_inducing_covariance(std::size_t M,
+                                                 std::size_t n_regressors,
+                                                 const gprat_hyper::SEKParams &sek_params,
+                                                 const std::vector<double> &inducing_points)
+{
+    // Compute distances in place of the covariance entries
+    std::vector<double> tile =
+        exponentiate_distance_tile<double>(gen_tile_inducing_self_distance(M, n_regressors, inducing_points),
+                                           sek_params.vertical_lengthscale,
+                                           -0.5 / (sek_params.lengthscale * sek_params.lengthscale));
+    // jitter on diagonal, inducing points may nearly coincide
+    for (std::size_t i = 0; i < M; i++)
+    {
+        tile[i * M + i] += INDUCING_JITTER * sek_params.vertical_lengthscale;
+    }
+    return tile;
+}
+
+template <typename T>
+std::vector<T> gen_tile_transpose(std::size_t N_row, std::size_t N_col, const std::vector<T> &tile)
+{
+    return gen_tile_transpose_into(std::vector<T>(N_row * N_col), N_row, N_col, tile);
+}
+
+template <typename T>
+std::vector<T>
+gen_tile_transpose_into(std::vector<T> transposed, std::size_t N_row, std::size_t N_col, const std::vector<T> &tile)
+{
+    transposed.resize(N_row * N_col);
     // Transpose entries
     for (std::size_t j = 0; j < N_col; j++)
     {
         for (std::size_t i = 0; i < N_row; ++i)
         {
             // Mapping (i, j) in the original tile to (j, i) in the transposed tile
-            transposed.push_back(tile[i * N_col + j]);
+            transposed[j * N_row + i] = tile[i * N_col + j];
         }
     }
     return transposed;
 }
 
-std::vector<double> gen_tile_output(std::size_t row, std::size_t N, const std::vector<double> &output)
+std::vector<double> gen_tile_unpack(std::size_t index, std::size_t N, const std::vector<double> &packed)
+{
+    // Copy entries of the tile at the given index
+    return std::vector<double>(packed.begin() + static_cast<std::ptrdiff_t>(index * N * N),
+                               packed.begin() + static_cast<std::ptrdiff_t>((index + 1) * N * N));
+}
+
+template <typename T>
+std::vector<T> gen_tile_output(std::size_t row, std::size_t N, const std::vector<double> &output)
 {
     // Preallocate required memory
-    std::vector<double> tile;
+    std::vector<T> tile;
     tile.reserve(N);
     // Copy entries
     std::copy(output.begin() + static_cast<long int>(N * row),
@@ -168,16 +344,21 @@ std::vector<double> gen_tile_output(std::size_t row, std::size_t N, const std::v
     return tile;
 }
 
-std::vector<double> gen_tile_zeros(std::size_t N) { return std::vector<double>(N, 0.0); }
+template <typename T>
+std::vector<T> gen_tile_zeros(std::size_t N) { return std::vector<T>(N, T{ 0 }); }
 
-std::vector<double> gen_tile_identity(std::size_t N)
+template <typename T>
+std::vector<T> gen_tile_identity(std::size_t N) { return gen_tile_identity_into(std::vector<T>(), N); }
+
+template <typename T>
+std::vector<T> gen_tile_identity_into(std::vector<T> tile, std::size_t N)
 {
     // Initialize zero tile
-    std::vector<double> tile(N * N, 0.0);
+    tile.assign(N * N, T{ 0 });
     // Fill diagonal with ones
     for (std::size_t i = 0; i < N; i++)
     {
-        tile[i * N + i] = 1.0;
+        tile[i * N + i] = T{ 1 };
     }
     return tile;
 }
@@ -203,4 +384,60 @@ double compute_error_norm(std::size_t n_tiles,
     return sqrt(error);
 }
 
+std::vector<float> gen_tile_fp32(const std::vector<double> &tile)
+{
+    std::vector<float> converted(tile.size());
+    for (std::size_t i = 0; i < tile.size(); i++)
+    {
+        converted[i] = static_cast<float>(tile[i]);
+    }
+    return converted;
+}
+
+std::vector<double> gen_tile_fp64(const std::vector<float> &tile)
+{
+    return std::vector<double>(tile.begin(), tile.end());
+}
+
+// Explicit instantiations for FP64 and FP32 tiles
+#define GPRAT_INSTANTIATE_TILE_GENERATORS(T)                                                                           \
+    template std::vector<T> gen_tile_covariance<T>(std::size_t,                                                        \
+                                                   std::size_t,                                                        \
+                                                   std::size_t,                                                        \
+                                                   std::size_t,                                                        \
+                                                   const gprat_hyper::SEKParams &,                                     \
+                                                   const std::vector<double> &);                                       \
+    template std::vector<T> gen_tile_full_prior_covariance<T>(std::size_t,                                             \
+                                                              std::size_t,                                             \
+                                                              std::size_t,                                             \
+                                                              std::size_t,                                             \
+                                                              const gprat_hyper::SEKParams &,                          \
+                                                              const std::vector<double> &);                            \
+    template std::vector<T> gen_tile_prior_covariance<T>(std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         const gprat_hyper::SEKParams &,                               \
+                                                         const std::vector<double> &);                                 \
+    template std::vector<T> gen_tile_cross_covariance<T>(std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         std::size_t,                                                  \
+                                                         const gprat_hyper::SEKParams &,                               \
+                                                         const std::vector<double> &,                                  \
+                                                         const std::vector<double> &);                                 \
+    template std::vector<T> gen_tile_transpose<T>(std::size_t, std::size_t, const std::vector<T> &);                   \
+    template std::vector<T> gen_tile_transpose_into<T>(                                                                \
+        std::vector<T>, std::size_t, std::size_t, const std::vector<T> &);                                             \
+    template std::vector<T> gen_tile_output<T>(std::size_t, std::size_t, const std::vector<double> &);                 \
+    template std::vector<T> gen_tile_zeros<T>(std::size_t);                                                            \
+    template std::vector<T> gen_tile_identity<T>(std::size_t);                                                         \
+    template std::vector<T> gen_tile_identity_into<T>(std::vector<T>, std::size_t);
+
+GPRAT_INSTANTIATE_TILE_GENERATORS(double)
+GPRAT_INSTANTIATE_TILE_GENERATORS(float)
+
+#undef GPRAT_INSTANTIATE_TILE_GENERATORS
+
 }  // end of namespace cpu
@@ -0,0 +1,384 @@
+#include "cpu/gp_experts.hpp"
+
+#include "cpu/adapter_cblas_fp64.hpp"
+#include "cpu/gp_algorithms.hpp"
+#include "cpu/gp_optimizer.hpp"
+#include "cpu/tiled_algorithms.hpp"
+#include <algorithm>
+#include <cmath>
+#include <hpx/future.hpp>
+#include <limits>
+
+namespace cpu
+{
+
+///////////////////////////////////////////////////////////////////////////
+// TILE OPERATIONS
+
+// Add the weighted precisions beta_k / sigma_k^2, the weighted precision means beta_k * mu_k / sigma_k^2 and the
+// weights beta_k of an expert to the partial sums of a test tile, sigma_k^2 = prior - diag(V^T * V)
+static std::vector<double> accumulate_expert_tile(std::vector<double> partial,
+                                                  const std::vector<double> &prior,
+                                                  const std::vector<double> &mean,
+                                                  const std::vector<double> &explained_variance,
+                                                  std::size_t N,
+                                                  std::size_t n_experts,
+                                                  gprat::Expert_combination combination)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        // The expert variance is bounded by the prior variance and positive up to roundoff
+        const double variance =
+            std::max(prior[i] - explained_variance[i], std::numeric_limits<double>::epsilon() * prior[i]);
+        double beta = 1.0;
+        if (combination == gprat::Expert_combination::gpoe)
+        {
+            beta = 1.0 / static_cast<double>(n_experts);
+        }
+        else if (combination == gprat::Expert_combination::rbcm)
+        {
+            beta = 0.5 * (std::log(prior[i]) - std::log(variance));
+        }
+        partial[i] += beta / variance;
+        partial[N + i] += beta * mean[i] / variance;
+        partial[2 * N + i] += beta;
+    }
+    return partial;
+}
+
+// Combined predictive variance of a test tile from the partial sums of all experts, the committee machines
+// correct the precision by the prior precision that is counted once per expert
+static std::vector<double> compute_experts_variance(const std::vector<double> &partial,
+                                                    const std::vector<double> &prior,
+                                                    std::size_t N,
+                                                    gprat::Expert_combination combination)
+{
+    const bool prior_correction =
+        combination == gprat::Expert_combination::bcm || combination == gprat::Expert_combination::rbcm;
+    std::vector<double> variance(N);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        double precision = partial[i];
+        if (prior_correction)
+        {
+            precision += (1.0 - partial[2 * N + i]) / prior[i];
+        }
+        variance[i] = 1.0 / precision;
+    }
+    return variance;
+}
+
+// Combined predictive mean of a test tile from the partial sums of all experts and the combined variance
+static std::vector<double>
+compute_experts_mean(const std::vector<double> &partial, const std::vector<double> &variance, std::size_t N)
+{
+    std::vector<double> mean(N);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        mean[i] = variance[i] * partial[N + i];
+    }
+    return mean;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// FACTORIZATION
+
+/**
+ * @brief Independent factorizations of the local experts, one per diagonal tile of the covariance matrix
+ */
+struct Experts_factorization
+{
+    /** @brief Cholesky factors L_k of the diagonal tiles K_kk */
+    Tiles<double> L_tiles;
+
+    /** @brief alpha_k = K_kk^-1 * y_k of each expert */
+    Tiles<double> alpha_tiles;
+
+    /** @brief Tiled training output y */
+    Tiles<double> y_tiles;
+
+    /** @brief Loss of the block-diagonal covariance matrix */
+    hpx::shared_future<double> loss;
+};
+
+// Launch the asynchronous assembly, Cholesky decomposition and triangular solves of all experts and the loss
+static Experts_factorization factorize_experts(const std::vector<double> &training_input,
+                                               const std::vector<double> &training_output,
+                                               int n_tiles,
+                                               int n_tile_size,
+                                               int n_regressors,
+                                               const gprat_hyper::SEKParams &sek_params)
+{
+    /*
+     * Every expert k is independent:
+     * 1: Assemble K_kk and y_k
+     * 2: Cholesky decomposition K_kk = L_k * L_k^T
+     * 3: Triangular solves L_k * L_k^T * alpha_k = y_k
+     * 4: Loss contribution y_k^T * alpha_k + log(det(K_kk))
+     */
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+
+    Experts_factorization factorization;
+    factorization.L_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    factorization.alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    factorization.y_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    std::vector<hpx::shared_future<double>> loss_tiles;
+    loss_tiles.reserve(static_cast<std::size_t>(n_tiles));
+
+    for (std::size_t k = 0; k < static_cast<std::size_t>(n_tiles); k++)
+    {
+        factorization.L_tiles.push_back(hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&potrf), "cholesky_experts"),
+            hpx::async(hpx::annotated_function(gen_tile_covariance<double>, "assemble_experts"),
+                       k,
+                       k,
+                       N,
+                       R,
+                       sek_params,
+                       training_input),
+            n_tile_size));
+        factorization.y_tiles.push_back(hpx::async(
+            hpx::annotated_function(gen_tile_output<double>, "assemble_experts"), k, N, training_output));
+        factorization.alpha_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "solve_experts"),
+                          factorization.L_tiles[k],
+                          hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "solve_experts"),
+                                        factorization.L_tiles[k],
+                                        factorization.y_tiles[k],
+                                        n_tile_size,
+                                        Blas_no_trans),
+                          n_tile_size,
+                          Blas_trans));
+        loss_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_loss<double>), "loss_experts"),
+                          factorization.L_tiles[k],
+                          factorization.alpha_tiles[k],
+                          factorization.y_tiles[k],
+                          N));
+    }
+
+    factorization.loss = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_losses), "loss_experts"),
+                                       loss_tiles,
+                                       N,
+                                       static_cast<std::size_t>(n_tiles));
+    return factorization;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// LOSS AND GRADIENT
+
+double compute_experts_loss(const std::vector<double> &training_input,
+                            const std::vector<double> &training_output,
+                            int n_tiles,
+                            int n_tile_size,
+                            int n_regressors,
+                            const gprat_hyper::SEKParams &sek_params)
+{
+    return factorize_experts(training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params)
+        .loss.get();
+}
+
+std::pair<double, std::vector<double>>
+compute_experts_loss_and_gradient(const std::vector<double> &training_input,
+                                  const std::vector<double> &training_output,
+                                  int n_tiles,
+                                  int n_tile_size,
+                                  int n_regressors,
+                                  const gprat_hyper::SEKParams &sek_params)
+{
+    /*
+     * The gradient of the loss of the block-diagonal covariance matrix is the sum of the gradients of all experts,
+     * 0.5 / N * sum_k tr(W_k * dK_kk) with W_k = K_kk^-1 - alpha_k * alpha_k^T and K_kk^-1 = L_k^-T * L_k^-1
+     */
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+
+    Experts_factorization factorization =
+        factorize_experts(training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params);
+
+    std::vector<hpx::shared_future<std::vector<double>>> gradient_tiles;
+    gradient_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t k = 0; k < static_cast<std::size_t>(n_tiles); k++)
+    {
+        // TRTRI and LAUUM: K_kk^-1 = L_k^-T * L_k^-1
+        hpx::shared_future<std::vector<double>> K_inv = hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&lauum), "gradient_experts"),
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trtri), "gradient_experts"),
+                          factorization.L_tiles[k],
+                          hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_experts"), N * N),
+                          n_tile_size),
+            n_tile_size);
+        gradient_tiles.push_back(hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&compute_gradient_tile<double>), "gradient_experts"),
+            std::vector<double>(3, 0.0),
+            K_inv,
+            factorization.alpha_tiles[k],
+            factorization.alpha_tiles[k],
+            hpx::async(hpx::annotated_function(&gen_tile_lagged_distance, "assemble_experts"),
+                       k,
+                       k,
+                       N,
+                       N,
+                       R,
+                       training_input,
+                       training_input),
+            N,
+            sek_params,
+            false,
+            true));
+    }
+
+    hpx::shared_future<std::vector<double>> gradient =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_gradients), "gradient_experts"),
+                      gradient_tiles,
+                      N,
+                      static_cast<std::size_t>(n_tiles));
+    return { factorization.loss.get(), gradient.get() };
+}
+
+///////////////////////////////////////////////////////////////////////////
+// OPTIMIZATION
+
+std::vector<double> optimize_experts(const std::vector<double> &training_input,
+                                     const std::vector<double> &training_output,
+                                     int n_tiles,
+                                     int n_tile_size,
+                                     int n_regressors,
+                                     const gprat_hyper::AdamParams &adam_params,
+                                     gprat_hyper::SEKParams &sek_params,
+                                     const std::vector<bool> &trainable_params)
+{
+    std::vector<double> losses;
+    losses.reserve(static_cast<std::size_t>(adam_params.opt_iter));
+    for (std::size_t iter = 0; iter < static_cast<std::size_t>(adam_params.opt_iter); iter++)
+    {
+        auto [loss, gradient] = compute_experts_loss_and_gradient(
+            training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params);
+        losses.push_back(loss);
+        sek_params = update_hyperparameters(gradient, adam_params, sek_params, trainable_params, iter);
+    }
+    return losses;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// PREDICTION
+
+std::vector<std::vector<double>> predict_experts_with_uncertainty(const std::vector<double> &training_input,
+                                                                  const std::vector<double> &training_output,
+                                                                  const std::vector<double> &test_input,
+                                                                  int n_tiles,
+                                                                  int n_tile_size,
+                                                                  int m_tiles,
+                                                                  int m_tile_size,
+                                                                  int n_regressors,
+                                                                  const gprat_hyper::SEKParams &sek_params,
+                                                                  gprat::Expert_combination combination)
+{
+    /*
+     * Expert prediction: mu_k = K_Tk * alpha_k
+     * Expert uncertainty: sigma_k^2 = diag(prior(K)) - diag(V_k^T * V_k) where L_k * V_k = K_kT
+     * The expert predictions of a test tile are accumulated in one chain per test tile, the test tiles and the
+     * expert solves run concurrently.
+     */
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t M = static_cast<std::size_t>(m_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t n_experts = static_cast<std::size_t>(n_tiles);
+
+    Experts_factorization factorization =
+        factorize_experts(training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params);
+
+    // Tiled future data structures
+    Tiles<double> prediction_tiles;   // Tiled solution
+    Tiles<double> uncertainty_tiles;  // Tiled uncertainty solution
+    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    uncertainty_tiles.reserve(static_cast<std::size_t>(m_tiles));
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        hpx::shared_future<std::vector<double>> prior = hpx::async(
+            hpx::annotated_function(gen_tile_prior_covariance<double>, "assemble_tiled"),
+            i,
+            i,
+            M,
+            R,
+            sek_params,
+            test_input);
+        // Partial sums of the weighted precisions, weighted precision means and weights
+        hpx::shared_future<std::vector<double>> partial =
+            hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), 3 * M);
+        for (std::size_t k = 0; k < n_experts; k++)
+        {
+            hpx::shared_future<std::vector<double>> K_kT =
+                hpx::async(hpx::annotated_function(gen_tile_cross_covariance<double>, "assemble_pred"),
+                           k,
+                           i,
+                           N,
+                           M,
+                           R,
+                           sek_params,
+                           training_input,
+                           test_input);
+            // GEMV: mu_k = K_Tk * alpha_k
+            hpx::shared_future<std::vector<double>> mean = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&gemv), "predict_experts"),
+                K_kT,
+                factorization.alpha_tiles[k],
+                hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), M),
+                n_tile_size,
+                m_tile_size,
+                Blas_add,
+                Blas_trans);
+            // TRSM: Solve L_k * V_k = K_kT, then diag(V_k^T * V_k)
+            hpx::shared_future<std::vector<double>> explained_variance = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&dot_diag_syrk), "predict_experts"),
+                hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm), "predict_experts"),
+                              factorization.L_tiles[k],
+                              K_kT,
+                              n_tile_size,
+                              m_tile_size,
+                              Blas_no_trans,
+                              Blas_left),
+                hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), M),
+                n_tile_size,
+                m_tile_size);
+            partial =
+                hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&accumulate_expert_tile), "combine_experts"),
+                              partial,
+                              prior,
+                              mean,
+                              explained_variance,
+                              M,
+                              n_experts,
+                              combination);
+        }
+        uncertainty_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_experts_variance), "combine_experts"),
+                          partial,
+                          prior,
+                          M,
+                          combination));
+        prediction_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_experts_mean), "combine_experts"),
+                          partial,
+                          uncertainty_tiles[i],
+                          M));
+    }
+
+    // Get & return predictions and uncertainty
+    std::vector<double> prediction_result;
+    std::vector<double> uncertainty_result;
+    prediction_result.reserve(static_cast<std::size_t>(m_tiles) * M);
+    uncertainty_result.reserve(static_cast<std::size_t>(m_tiles) * M);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        const std::vector<double> &prediction = prediction_tiles[i].get();
+        const std::vector<double> &uncertainty = uncertainty_tiles[i].get();
+        prediction_result.insert(prediction_result.end(), prediction.begin(), prediction.end());
+        uncertainty_result.insert(uncertainty_result.end(), uncertainty.begin(), uncertainty.end());
+    }
+    return std::vector<std::vector<double>>{ prediction_result, uncertainty_result };
+}
+
+}  // end of namespace cpu
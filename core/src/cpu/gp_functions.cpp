@@ -4,122 +4,182 @@
 #include "cpu/gp_algorithms.hpp"
 #include "cpu/gp_optimizer.hpp"
 #include "cpu/tiled_algorithms.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <hpx/future.hpp>
-
-using Tiled_matrix = std::vector<hpx::shared_future<std::vector<double>>>;
-using Tiled_vector = std::vector<hpx::shared_future<std::vector<double>>>;
+#include <hpx/runtime.hpp>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
 
 namespace cpu
 {
 
 ///////////////////////////////////////////////////////////////////////////
-// PREDICT
-std::vector<std::vector<double>>
-cholesky(const std::vector<double> &training_input,
-         const gprat_hyper::SEKParams &sek_params,
-         int n_tiles,
-         int n_tile_size,
-         int n_regressors)
+// FACTORIZATION
+
+// Iterative refinement steps of a mixed precision factorization, each step reduces the error of
+// alpha by about the condition number of K times the FP32 unit roundoff
+static constexpr int MIXED_REFINEMENT_STEPS = 3;
+
+// Compare the bit patterns of two hyperparameters, cached results stay valid only for identical values
+static bool same_bits(double a, double b) { return std::bit_cast<std::uint64_t>(a) == std::bit_cast<std::uint64_t>(b); }
+
+template <typename T>
+bool Tiled_factorization<T>::matches(const gprat_hyper::SEKParams &params, int regressors) const
 {
-    std::vector<std::vector<double>> result;
+    return n_regressors == regressors && same_bits(sek_params.lengthscale, params.lengthscale)
+           && same_bits(sek_params.vertical_lengthscale, params.vertical_lengthscale)
+           && same_bits(sek_params.noise_variance, params.noise_variance);
+}
 
-#if GPRAT_APEX_CHOLESKY
-    GPRAT_START_TIMER(assembly_cholesky_timer);
-#endif
-    GPRAT_START_STEP(assembly_timer);
+template struct Tiled_factorization<double>;
+template struct Tiled_factorization<float>;
 
-    // Tiled future data structures
-    Tiled_matrix K_tiles;  // Tiled covariance matrix
+// Launch the asynchronous Cholesky decomposition K = L * L^T of FP64 tiles, in mixed precision if K has FP32
+// off-diagonal tiles
+static void factorize_cholesky(Factorization &factorization, int n_tile_size, int n_tiles)
+{
+    if (!factorization.L_single_tiles.empty())
+    {
+        right_looking_cholesky_tiled_mixed(factorization.L_tiles,
+                                           factorization.L_single_tiles,
+                                           n_tile_size,
+                                           static_cast<std::size_t>(n_tiles));
+    }
+    else
+    {
+        right_looking_cholesky_tiled(factorization.L_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+    }
+}
 
-    // Preallocate memory
-    result.resize(static_cast<std::size_t>(n_tiles * n_tiles));
-    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
+// Launch the asynchronous Cholesky decomposition K = L * L^T of FP32 tiles
+static void factorize_cholesky(Factorization_fp32 &factorization, int n_tile_size, int n_tiles)
+{
+    right_looking_cholesky_tiled(factorization.L_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+}
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous assembly
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+// Launch the asynchronous forward solve L * x = b with the FP64 factor, in mixed precision if it has FP32
+// off-diagonal tiles
+static void forward_solve_factor(const Factorization &factorization, Tiled_vector &rhs, int n_tile_size, int n_tiles)
+{
+    if (!factorization.L_single_tiles.empty())
     {
-        for (std::size_t j = 0; j <= i; j++)
-        {
-            K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                hpx::annotated_function(gen_tile_covariance, "assemble_tiled_K"),
-                i,
-                j,
-                n_tile_size,
-                n_regressors,
-                sek_params,
-                training_input);
-        }
+        forward_solve_tiled_mixed(factorization.L_tiles,
+                                  factorization.L_single_tiles,
+                                  rhs,
+                                  n_tile_size,
+                                  static_cast<std::size_t>(n_tiles));
     }
+    else
+    {
+        forward_solve_tiled(factorization.L_tiles, rhs, n_tile_size, static_cast<std::size_t>(n_tiles));
+    }
+}
 
-    GPRAT_END_STEP(assembly_timer, "cholesky_step assembly", K_tiles);
-    GPRAT_START_STEP(cholesky_timer);
+// Launch the asynchronous forward solve L * x = b with the FP32 factor
+static void
+forward_solve_factor(const Factorization_fp32 &factorization, Tiles<float> &rhs, int n_tile_size, int n_tiles)
+{
+    forward_solve_tiled(factorization.L_tiles, rhs, n_tile_size, static_cast<std::size_t>(n_tiles));
+}
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous Cholesky decomposition: K = L * L^T
-    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+// Launch the asynchronous backward solve L^T * x = b with the FP64 factor, in mixed precision if it has FP32
+// off-diagonal tiles
+static void backward_solve_factor(const Factorization &factorization, Tiled_vector &rhs, int n_tile_size, int n_tiles)
+{
+    if (!factorization.L_single_tiles.empty())
+    {
+        backward_solve_tiled_mixed(factorization.L_tiles,
+                                   factorization.L_single_tiles,
+                                   rhs,
+                                   n_tile_size,
+                                   static_cast<std::size_t>(n_tiles));
+    }
+    else
+    {
+        backward_solve_tiled(factorization.L_tiles, rhs, n_tile_size, static_cast<std::size_t>(n_tiles));
+    }
+}
 
-    GPRAT_END_STEP(cholesky_timer, "cholesky_step cholesky", K_tiles);
-#if GPRAT_APEX_CHOLESKY
-    GPRAT_STOP_TIMER(assembly_cholesky_timer, "cholesky", K_tiles);
-#endif
+// Launch the asynchronous backward solve L^T * x = b with the FP32 factor
+static void
+backward_solve_factor(const Factorization_fp32 &factorization, Tiles<float> &rhs, int n_tile_size, int n_tiles)
+{
+    backward_solve_tiled(factorization.L_tiles, rhs, n_tile_size, static_cast<std::size_t>(n_tiles));
+}
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Synchronize
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+// Returns the Cholesky factor with FP64 tiles, the FP32 off-diagonal tiles of a mixed precision factor are widened
+// for the operations that need the full factor
+static Tiled_matrix full_factor(const Factorization &factorization, int n_tiles)
+{
+    Tiled_matrix L_tiles = factorization.L_tiles;
+    if (!factorization.L_single_tiles.empty())
     {
-        for (std::size_t j = 0; j <= i; j++)
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
         {
-            result[i * static_cast<std::size_t>(n_tiles) + j] =
-                K_tiles[i * static_cast<std::size_t>(n_tiles) + j].get();
+            for (std::size_t j = 0; j < i; j++)
+            {
+                const std::size_t index = i * static_cast<std::size_t>(n_tiles) + j;
+                L_tiles[index] = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(&gen_tile_fp64), "widen_factor"),
+                    factorization.L_single_tiles[index]);
+            }
         }
     }
-    return result;
+    return L_tiles;
 }
 
-std::vector<double>
-predict(const std::vector<double> &training_input,
-        const std::vector<double> &training_output,
-        const std::vector<double> &test_input,
-        const gprat_hyper::SEKParams &sek_params,
-        int n_tiles,
-        int n_tile_size,
-        int m_tiles,
-        int m_tile_size,
-        int n_regressors)
+// Returns the Cholesky factor with FP32 tiles
+static Tiles<float> full_factor(const Factorization_fp32 &factorization, int) { return factorization.L_tiles; }
+
+// Assemble K in the precision of T, compute its Cholesky factor L and launch the triangular solves for alpha
+template <typename T>
+static Tiled_factorization<T> factorize_tiled(const std::vector<double> &training_input,
+                                              const std::vector<double> &training_output,
+                                              const gprat_hyper::SEKParams &sek_params,
+                                              int n_tiles,
+                                              int n_tile_size,
+                                              int n_regressors,
+                                              gprat::Precision precision)
 {
     /*
-     * Prediction: hat(y)_M = cross(K)_MxN * K^-1_NxN * y_N
+     * Factorization: K = L * L^T and alpha = K^-1 * y
      * - Covariance matrix K_NxN
-     * - Cross-covariance cross(K)_MxN
      * - Training ouput y_N
-     * - Prediction output hat(y)_M
      *
      * Algorithm:
      * 1: Compute lower triangular part of covariance matrix K
      * 2: Compute Cholesky factor L of K
-     * 3: Compute prediction hat(y):
+     * 3: Compute alpha:
      *    - triangular solve L * beta = y
      *    - triangular solve L^T * alpha = beta
-     *    - compute hat(y) = cross(K) * alpha
      */
 
+    Tiled_factorization<T> factorization{
+        Tiles<T>{}, Tiles<float>{}, Tiles<T>{}, Tiles<T>{}, sek_params, n_regressors
+    };
+    // In mixed precision, the off-diagonal tiles are assembled and factorized in FP32
+    const bool mixed = precision == gprat::Precision::mixed;
+
+#if GPRAT_APEX_CHOLESKY
+    GPRAT_START_TIMER(assembly_cholesky_timer);
+#endif
     GPRAT_START_STEP(assembly_timer);
 
-    std::vector<double> prediction_result;
     // Tiled future data structures
-    Tiled_matrix K_tiles;                 // Tiled covariance matrix
-    Tiled_matrix cross_covariance_tiles;  // Tiled cross_covariance matrix
-    Tiled_vector prediction_tiles;        // Tiled solution
-    Tiled_vector alpha_tiles;             // Tiled intermediate solution
+    Tiles<T> &K_tiles = factorization.L_tiles;          // Tiled covariance matrix, overwritten by L
+    Tiles<T> &alpha_tiles = factorization.alpha_tiles;  // Tiled intermediate solution
 
     // Preallocate memory
-    prediction_result.reserve(test_input.size());
-
     K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
     alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
-    cross_covariance_tiles.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(n_tiles));
-    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    if (mixed)
+    {
+        factorization.L_single_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));
+    }
 
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous assembly
@@ -127,8 +187,20 @@ predict(const std::vector<double> &training_input,
     {
         for (std::size_t j = 0; j <= i; j++)
         {
+            if (mixed && j < i)
+            {
+                factorization.L_single_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
+                    hpx::annotated_function(gen_tile_covariance<float>, "assemble_tiled_K"),
+                    i,
+                    j,
+                    n_tile_size,
+                    n_regressors,
+                    sek_params,
+                    training_input);
+                continue;
+            }
             K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                hpx::annotated_function(gen_tile_covariance, "assemble_tiled_K"),
+                hpx::annotated_function(gen_tile_covariance<T>, "assemble_tiled_K"),
                 i,
                 j,
                 n_tile_size,
@@ -141,204 +213,626 @@ predict(const std::vector<double> &training_input,
     for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
     {
         alpha_tiles.push_back(hpx::async(
-            hpx::annotated_function(gen_tile_output, "assemble_tiled_alpha"), i, n_tile_size, training_output));
-    }
-
-    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
-    {
-        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
-        {
-            cross_covariance_tiles.push_back(hpx::async(
-                hpx::annotated_function(gen_tile_cross_covariance, "assemble_pred"),
-                i,
-                j,
-                m_tile_size,
-                n_tile_size,
-                n_regressors,
-                sek_params,
-                test_input,
-                training_input));
-        }
-    }
-
-    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
-    {
-        prediction_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_tiled"), m_tile_size));
+            hpx::annotated_function(gen_tile_output<T>, "assemble_tiled_alpha"), i, n_tile_size, training_output));
     }
 
-    GPRAT_END_STEP(
-        assembly_timer, "predict_step assembly", K_tiles, alpha_tiles, cross_covariance_tiles, prediction_tiles);
+    GPRAT_END_STEP(assembly_timer, "cholesky_step assembly", K_tiles, factorization.L_single_tiles, alpha_tiles);
     GPRAT_START_STEP(cholesky_timer);
 
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous Cholesky decomposition: K = L * L^T
-    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+    factorize_cholesky(factorization, n_tile_size, n_tiles);
 
-    GPRAT_END_STEP(cholesky_timer, "predict_step cholesky", K_tiles);
+    GPRAT_END_STEP(cholesky_timer, "cholesky_step cholesky", K_tiles, factorization.L_single_tiles);
+#if GPRAT_APEX_CHOLESKY
+    GPRAT_STOP_TIMER(assembly_cholesky_timer, "cholesky", K_tiles, factorization.L_single_tiles);
+#endif
     GPRAT_START_STEP(forward_timer);
 
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous triangular solve  L * (L^T * alpha) = y
     // First, forward solve L * beta = y
-    forward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+    forward_solve_factor(factorization, alpha_tiles, n_tile_size, n_tiles);
 
-    GPRAT_END_STEP(forward_timer, "predict_step forward", alpha_tiles);
+    GPRAT_END_STEP(forward_timer, "factorize_step forward", alpha_tiles);
     GPRAT_START_STEP(backward_timer);
 
+    // Keep beta to allow extending the factorization
+    factorization.beta_tiles = alpha_tiles;
+
     // Second, backward solve L^T * alpha = beta
-    backward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+    backward_solve_factor(factorization, alpha_tiles, n_tile_size, n_tiles);
 
-    GPRAT_END_STEP(backward_timer, "predict_step backward", alpha_tiles);
-    GPRAT_START_STEP(prediction_timer);
+    GPRAT_END_STEP(backward_timer, "factorize_step backward", alpha_tiles);
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous prediction computation solve: \hat{y} = K_cross_cov * alpha
-    matrix_vector_tiled(
-        cross_covariance_tiles,
-        alpha_tiles,
-        prediction_tiles,
-        m_tile_size,
-        n_tile_size,
-        static_cast<std::size_t>(n_tiles),
-        static_cast<std::size_t>(m_tiles));
+    return factorization;
+}
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Synchronize prediction
-    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+Factorization factorize(const std::vector<double> &training_input,
+                        const std::vector<double> &training_output,
+                        const gprat_hyper::SEKParams &sek_params,
+                        int n_tiles,
+                        int n_tile_size,
+                        int n_regressors,
+                        gprat::Precision precision)
+{
+    /*
+     * In mixed precision, refine alpha of the factorization:
+     * - alpha = alpha - K^-1 * (K * alpha - y) with the FP64 K and the mixed precision L
+     */
+
+    Factorization factorization = factorize_tiled<double>(
+        training_input, training_output, sek_params, n_tiles, n_tile_size, n_regressors, precision);
+
+    Tiled_vector &alpha_tiles = factorization.alpha_tiles;
+
+    if (precision == gprat::Precision::mixed)
     {
-        auto tile = prediction_tiles[i].get();
-        std::copy(tile.begin(), tile.end(), std::back_inserter(prediction_result));
+        GPRAT_START_STEP(refinement_timer);
+        for (int step = 0; step < MIXED_REFINEMENT_STEPS; step++)
+        {
+            // Residual K * alpha - y with the FP64 covariance matrix
+            Tiled_vector residual_tiles;
+            Tiled_vector correction_tiles;
+            residual_tiles.reserve(static_cast<std::size_t>(n_tiles));
+            correction_tiles.reserve(static_cast<std::size_t>(n_tiles));
+            for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+            {
+                residual_tiles.push_back(
+                    hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), n_tile_size));
+                correction_tiles.push_back(
+                    hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_tiled_alpha"),
+                               i,
+                               n_tile_size,
+                               training_output));
+            }
+            covariance_vector_tiled(training_input,
+                                    sek_params,
+                                    n_regressors,
+                                    alpha_tiles,
+                                    residual_tiles,
+                                    n_tile_size,
+                                    static_cast<std::size_t>(n_tiles));
+            vector_difference_tiled(residual_tiles, correction_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+            // Correction K^-1 * (K * alpha - y) with the mixed precision Cholesky factor
+            forward_solve_factor(factorization, correction_tiles, n_tile_size, n_tiles);
+            backward_solve_factor(factorization, correction_tiles, n_tile_size, n_tiles);
+            vector_difference_tiled(alpha_tiles, correction_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+            alpha_tiles = correction_tiles;
+        }
+        GPRAT_END_STEP(refinement_timer, "factorize_step refinement", alpha_tiles);
     }
 
-    GPRAT_END_STEP(prediction_timer, "predict_step prediction");
+    return factorization;
+}
 
-    return prediction_result;
+Factorization_fp32 factorize_fp32(const std::vector<double> &training_input,
+                                  const std::vector<double> &training_output,
+                                  const gprat_hyper::SEKParams &sek_params,
+                                  int n_tiles,
+                                  int n_tile_size,
+                                  int n_regressors)
+{
+    return factorize_tiled<float>(
+        training_input, training_output, sek_params, n_tiles, n_tile_size, n_regressors, gprat::Precision::fp32);
 }
 
-std::vector<std::vector<double>> predict_with_uncertainty(
-    const std::vector<double> &training_input,
-    const std::vector<double> &training_output,
-    const std::vector<double> &test_input,
-    const gprat_hyper::SEKParams &sek_params,
-    int n_tiles,
-    int n_tile_size,
-    int m_tiles,
-    int m_tile_size,
-    int n_regressors)
+Factorization extend_factorization(const Factorization &factorization,
+                                   const std::vector<double> &training_input,
+                                   const std::vector<double> &training_output,
+                                   int n_tiles_old,
+                                   int n_tiles,
+                                   int n_tile_size)
 {
     /*
-     * Prediction: hat(y) = cross(K) * K^-1 * y
-     * Uncertainty: diag(Sigma) = diag(prior(K)) * diag(cross(K)^T * K^-1 * cross(K))
-     * - Covariance matrix K_NxN
-     * - Cross-covariance cross(K)_MxN
-     * - Prior covariance prior(K)_MxM
-     * - Training ouput y_N
-     * - Prediction output hat(y)_M
-     * - Posterior covariance matrix Sigma_MxM
+     * Extension: K' = [K, B^T; B, C] = L' * L'^T with L' = [L, 0; L_B, L_C]
+     * - Factorized covariance matrix K = L * L^T of the old tile rows
+     * - Covariance B between new and old tile rows, covariance C of new tile rows
+     * - Extended training ouput y' = [y; y_new]
      *
      * Algorithm:
-     * 1: Compute lower triangular part of covariance matrix K
-     * 2: Compute Cholesky factor L of K
-     * 3: Compute prediction hat(y):
-     *    - triangular solve L * beta = y
-     *    - triangular solve L^T * alpha = beta
-     *    - compute hat(y) = cross(K) * alpha
-     * 4: Compute uncertainty diag(Sigma):
-     *    - triangular solve L * V = cross(K)^T
-     *    - compute diag(W) = diag(V^T * V)
-     *    - compute diag(Sigma) = diag(prior(K)) - diag(W)
+     * 1: Compute new tile rows [B, C] of the covariance matrix
+     * 2: Compute the new tile rows of the Cholesky factor:
+     *    - triangular solve L_B * L^T = B
+     *    - Cholesky factor L_C of C - L_B * L_B^T
+     * 3: Compute alpha':
+     *    - extend forward solve beta_new = L_C^-1 * (y_new - L_B * beta)
+     *    - triangular solve L'^T * alpha' = beta'
      */
 
+    Factorization extended{ Tiled_matrix{},
+                            Tiles<float>{},
+                            Tiled_vector{},
+                            Tiled_vector{},
+                            factorization.sek_params,
+                            factorization.n_regressors };
+
     GPRAT_START_STEP(assembly_timer);
 
-    std::vector<double> prediction_result;
-    std::vector<double> uncertainty_result;
-    // Tiled future data structures for prediction
-    Tiled_matrix K_tiles;                 // Tiled covariance matrix K_NxN
-    Tiled_matrix cross_covariance_tiles;  // Tiled cross_covariance matrix K_NxM
-    Tiled_vector prediction_tiles;        // Tiled solution
-    Tiled_vector alpha_tiles;             // Tiled intermediate solution
-    // Tiled future data structures for uncertainty
-    Tiled_matrix t_cross_covariance_tiles;  // Tiled transposed cross_covariance matrix K_MxN
-    Tiled_vector prior_K_tiles;             // Tiled prior covariance matrix diagonal diag(K_MxM)
-    Tiled_vector uncertainty_tiles;         // Tiled uncertainty solution
+    // Tiled future data structures
+    Tiled_matrix &L_tiles = extended.L_tiles;        // Tiled Cholesky factor
+    Tiled_vector &beta_tiles = extended.beta_tiles;  // Tiled intermediate solution
 
     // Preallocate memory
-    prediction_result.reserve(test_input.size());
-    uncertainty_result.reserve(test_input.size());
-
-    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
-    cross_covariance_tiles.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(n_tiles));
-    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
-    alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
-
-    t_cross_covariance_tiles.reserve(static_cast<std::size_t>(n_tiles) * static_cast<std::size_t>(m_tiles));
-    prior_K_tiles.reserve(static_cast<std::size_t>(m_tiles));
-    uncertainty_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    L_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
+    beta_tiles.reserve(static_cast<std::size_t>(n_tiles));
 
     ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous assembly
+    // Reuse existing tiles and launch asynchronous assembly of the new tile rows
     for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
     {
         for (std::size_t j = 0; j <= i; j++)
         {
-            K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                hpx::annotated_function(gen_tile_covariance, "assemble_tiled_K"),
-                i,
-                j,
-                n_tile_size,
-                n_regressors,
-                sek_params,
-                training_input);
+            if (i < static_cast<std::size_t>(n_tiles_old))
+            {
+                L_tiles[i * static_cast<std::size_t>(n_tiles) + j] =
+                    factorization.L_tiles[i * static_cast<std::size_t>(n_tiles_old) + j];
+            }
+            else
+            {
+                L_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
+                    hpx::annotated_function(gen_tile_covariance<double>, "assemble_tiled_K"),
+                    i,
+                    j,
+                    n_tile_size,
+                    extended.n_regressors,
+                    extended.sek_params,
+                    training_input);
+            }
         }
     }
 
     for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
     {
-        alpha_tiles.push_back(hpx::async(
-            hpx::annotated_function(gen_tile_output, "assemble_tiled_alpha"), i, n_tile_size, training_output));
-    }
-
-    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
-    {
-        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+        if (i < static_cast<std::size_t>(n_tiles_old))
         {
-            cross_covariance_tiles.push_back(hpx::async(
-                hpx::annotated_function(gen_tile_cross_covariance, "assemble_pred"),
-                i,
-                j,
-                m_tile_size,
-                n_tile_size,
-                n_regressors,
-                sek_params,
-                test_input,
-                training_input));
+            beta_tiles.push_back(factorization.beta_tiles[i]);
+        }
+        else
+        {
+            beta_tiles.push_back(
+                hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_tiled_alpha"),
+                           i,
+                           n_tile_size,
+                           training_output));
         }
     }
 
-    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
-    {
-        prediction_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_tiled"), m_tile_size));
-    }
+    GPRAT_END_STEP(assembly_timer, "extend_step assembly", L_tiles, beta_tiles);
+    GPRAT_START_STEP(cholesky_timer);
 
-    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
-    {
-        prior_K_tiles.push_back(hpx::async(
-            hpx::annotated_function(gen_tile_prior_covariance, "assemble_tiled"),
-            i,
-            i,
-            m_tile_size,
-            n_regressors,
-            sek_params,
-            test_input));
-    }
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous Cholesky decomposition of the new tile rows
+    extend_cholesky_tiled(
+        L_tiles, n_tile_size, static_cast<std::size_t>(n_tiles_old), static_cast<std::size_t>(n_tiles));
+
+    GPRAT_END_STEP(cholesky_timer, "extend_step cholesky", L_tiles);
+    GPRAT_START_STEP(forward_timer);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous triangular solve  L' * (L'^T * alpha') = y'
+    // First, extend forward solve L' * beta' = y'
+    extend_forward_solve_tiled(
+        L_tiles, beta_tiles, n_tile_size, static_cast<std::size_t>(n_tiles_old), static_cast<std::size_t>(n_tiles));
+
+    GPRAT_END_STEP(forward_timer, "extend_step forward", beta_tiles);
+    GPRAT_START_STEP(backward_timer);
+
+    // Second, backward solve L'^T * alpha' = beta'
+    extended.alpha_tiles = beta_tiles;
+    backward_solve_tiled(L_tiles, extended.alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+    GPRAT_END_STEP(backward_timer, "extend_step backward", extended.alpha_tiles);
+
+    return extended;
+}
+
+Factorization drop_factorization(const Factorization &factorization,
+                                 const std::vector<double> &training_output,
+                                 int n_tiles,
+                                 int n_drop_tiles,
+                                 int n_tile_size)
+{
+    /*
+     * Downdate: K = [K_11, K_21^T; K_21, K_22] with L = [L_11, 0; L_21, L_22]
+     * - Remaining covariance matrix K_22 = L_21 * L_21^T + L_22 * L_22^T
+     * - Remaining training ouput y_2
+     *
+     * Algorithm:
+     * 1: Reuse tiles of L_22
+     * 2: Compute Cholesky factor L' of K_22:
+     *    - rank update L' * L'^T = L_22 * L_22^T + W * W^T for each tile column W of L_21
+     * 3: Compute alpha:
+     *    - triangular solve L' * beta = y_2
+     *    - triangular solve L'^T * alpha = beta
+     */
+
+    Factorization reduced{ Tiled_matrix{},
+                           Tiles<float>{},
+                           Tiled_vector{},
+                           Tiled_vector{},
+                           factorization.sek_params,
+                           factorization.n_regressors };
+    const std::size_t n_old = static_cast<std::size_t>(n_tiles);
+    const std::size_t n_drop = static_cast<std::size_t>(n_drop_tiles);
+    const std::size_t n_new = n_old - n_drop;
+
+    GPRAT_START_STEP(assembly_timer);
+
+    // Tiled future data structures
+    Tiled_matrix &L_tiles = reduced.L_tiles;        // Tiled Cholesky factor
+    Tiled_vector &beta_tiles = reduced.beta_tiles;  // Tiled intermediate solution
+    Tiled_matrix update_tiles;                      // Tiled column of L_21
+
+    // Preallocate memory
+    L_tiles.resize(n_new * n_new);  // No reserve because of triangular structure
+    beta_tiles.reserve(n_new);
+    update_tiles.resize(n_new);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Reuse tiles of L_22 and launch asynchronous assembly of output
+    for (std::size_t i = 0; i < n_new; i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            L_tiles[i * n_new + j] = factorization.L_tiles[(i + n_drop) * n_old + j + n_drop];
+        }
+    }
+
+    for (std::size_t i = 0; i < n_new; i++)
+    {
+        beta_tiles.push_back(hpx::async(
+            hpx::annotated_function(gen_tile_output<double>, "assemble_tiled_alpha"), i, n_tile_size, training_output));
+    }
+
+    GPRAT_END_STEP(assembly_timer, "drop_step assembly", L_tiles, beta_tiles);
+    GPRAT_START_STEP(cholesky_timer);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous rank updates L' * L'^T = L_22 * L_22^T + L_21 * L_21^T
+    for (std::size_t c = 0; c < n_drop; c++)
+    {
+        for (std::size_t m = 0; m < n_new; m++)
+        {
+            update_tiles[m] = factorization.L_tiles[(m + n_drop) * n_old + c];
+        }
+        update_cholesky_tiled(L_tiles, update_tiles, n_tile_size, n_new);
+    }
+
+    GPRAT_END_STEP(cholesky_timer, "drop_step cholesky", L_tiles);
+    GPRAT_START_STEP(forward_timer);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous triangular solve  L' * (L'^T * alpha) = y_2
+    // First, forward solve L' * beta = y_2
+    forward_solve_tiled(L_tiles, beta_tiles, n_tile_size, n_new);
+
+    GPRAT_END_STEP(forward_timer, "drop_step forward", beta_tiles);
+    GPRAT_START_STEP(backward_timer);
+
+    // Second, backward solve L'^T * alpha = beta
+    reduced.alpha_tiles = beta_tiles;
+    backward_solve_tiled(L_tiles, reduced.alpha_tiles, n_tile_size, n_new);
+
+    GPRAT_END_STEP(backward_timer, "drop_step backward", reduced.alpha_tiles);
+
+    return reduced;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// PREDICT
+std::vector<std::vector<double>>
+cholesky(const std::vector<double> &training_input,
+         const gprat_hyper::SEKParams &sek_params,
+         int n_tiles,
+         int n_tile_size,
+         int n_regressors)
+{
+    std::vector<std::vector<double>> result;
+
+#if GPRAT_APEX_CHOLESKY
+    GPRAT_START_TIMER(assembly_cholesky_timer);
+#endif
+    GPRAT_START_STEP(assembly_timer);
+
+    // Tiled future data structures
+    Tiled_matrix K_tiles;  // Tiled covariance matrix
+
+    // Preallocate memory
+    result.resize(static_cast<std::size_t>(n_tiles * n_tiles));
+    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous assembly
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
+                hpx::annotated_function(gen_tile_covariance<double>, "assemble_tiled_K"),
+                i,
+                j,
+                n_tile_size,
+                n_regressors,
+                sek_params,
+                training_input);
+        }
+    }
+
+    GPRAT_END_STEP(assembly_timer, "cholesky_step assembly", K_tiles);
+    GPRAT_START_STEP(cholesky_timer);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous Cholesky decomposition: K = L * L^T
+    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+    GPRAT_END_STEP(cholesky_timer, "cholesky_step cholesky", K_tiles);
+#if GPRAT_APEX_CHOLESKY
+    GPRAT_STOP_TIMER(assembly_cholesky_timer, "cholesky", K_tiles);
+#endif
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Synchronize
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            result[i * static_cast<std::size_t>(n_tiles) + j] =
+                K_tiles[i * static_cast<std::size_t>(n_tiles) + j].get();
+        }
+    }
+    return result;
+}
+
+template <typename T>
+std::vector<std::vector<double>> cholesky(const Tiled_factorization<T> &factorization, int n_tiles)
+{
+    std::vector<std::vector<double>> result;
+    result.resize(static_cast<std::size_t>(n_tiles * n_tiles));
+    const auto L_tiles = full_factor(factorization, n_tiles);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Synchronize and widen to FP64
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            const std::vector<T> &tile = L_tiles[i * static_cast<std::size_t>(n_tiles) + j].get();
+            result[i * static_cast<std::size_t>(n_tiles) + j].assign(tile.begin(), tile.end());
+        }
+    }
+    return result;
+}
+
+std::vector<double>
+predict(const std::vector<double> &training_input,
+        const std::vector<double> &training_output,
+        const std::vector<double> &test_input,
+        const gprat_hyper::SEKParams &sek_params,
+        int n_tiles,
+        int n_tile_size,
+        int m_tiles,
+        int m_tile_size,
+        int n_regressors)
+{
+    return predict(
+        factorize(
+            training_input, training_output, sek_params, n_tiles, n_tile_size, n_regressors, gprat::Precision::fp64),
+        training_input,
+        test_input,
+        n_tiles,
+        n_tile_size,
+        m_tiles,
+        m_tile_size);
+}
+
+template <typename T>
+std::vector<double> predict(const Tiled_factorization<T> &factorization,
+                            const std::vector<double> &training_input,
+                            const std::vector<double> &test_input,
+                            int n_tiles,
+                            int n_tile_size,
+                            int m_tiles,
+                            int m_tile_size)
+{
+    /*
+     * Prediction: hat(y)_M = cross(K)_MxN * K^-1_NxN * y_N
+     * - Covariance matrix K_NxN
+     * - Cross-covariance cross(K)_MxN
+     * - Training ouput y_N
+     * - Prediction output hat(y)_M
+     *
+     * Algorithm:
+     * 1: Reuse alpha = K^-1 * y of the factorization
+     * 2: Compute prediction hat(y) = cross(K) * alpha
+     */
+
+    GPRAT_START_STEP(assembly_timer);
+
+    std::vector<double> prediction_result;
+    // Tiled future data structures
+    Tiles<T> cross_covariance_tiles;  // Tiled cross_covariance matrix
+    Tiles<T> prediction_tiles;        // Tiled solution
+
+    // Preallocate memory
+    prediction_result.reserve(test_input.size());
+
+    cross_covariance_tiles.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(n_tiles));
+    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous assembly
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+        {
+            cross_covariance_tiles.push_back(hpx::async(
+                hpx::annotated_function(gen_tile_cross_covariance<T>, "assemble_pred"),
+                i,
+                j,
+                m_tile_size,
+                n_tile_size,
+                factorization.n_regressors,
+                factorization.sek_params,
+                test_input,
+                training_input));
+        }
+    }
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        prediction_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_tiled"), m_tile_size));
+    }
+
+    GPRAT_END_STEP(assembly_timer, "predict_step assembly", cross_covariance_tiles, prediction_tiles);
+    GPRAT_START_STEP(prediction_timer);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous prediction computation solve: \hat{y} = K_cross_cov * alpha
+    matrix_vector_tiled(
+        cross_covariance_tiles,
+        factorization.alpha_tiles,
+        prediction_tiles,
+        m_tile_size,
+        n_tile_size,
+        static_cast<std::size_t>(n_tiles),
+        static_cast<std::size_t>(m_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Synchronize prediction
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        auto tile = prediction_tiles[i].get();
+        std::copy(tile.begin(), tile.end(), std::back_inserter(prediction_result));
+    }
+
+    GPRAT_END_STEP(prediction_timer, "predict_step prediction");
+
+    return prediction_result;
+}
+
+std::vector<std::vector<double>> predict_with_uncertainty(
+    const std::vector<double> &training_input,
+    const std::vector<double> &training_output,
+    const std::vector<double> &test_input,
+    const gprat_hyper::SEKParams &sek_params,
+    int n_tiles,
+    int n_tile_size,
+    int m_tiles,
+    int m_tile_size,
+    int n_regressors)
+{
+    return predict_with_uncertainty(
+        factorize(
+            training_input, training_output, sek_params, n_tiles, n_tile_size, n_regressors, gprat::Precision::fp64),
+        training_input,
+        test_input,
+        n_tiles,
+        n_tile_size,
+        m_tiles,
+        m_tile_size);
+}
+
+template <typename T>
+std::vector<std::vector<double>> predict_with_uncertainty(
+    const Tiled_factorization<T> &factorization,
+    const std::vector<double> &training_input,
+    const std::vector<double> &test_input,
+    int n_tiles,
+    int n_tile_size,
+    int m_tiles,
+    int m_tile_size)
+{
+    /*
+     * Prediction: hat(y) = cross(K) * K^-1 * y
+     * Uncertainty: diag(Sigma) = diag(prior(K)) * diag(cross(K)^T * K^-1 * cross(K))
+     * - Covariance matrix K_NxN
+     * - Cross-covariance cross(K)_MxN
+     * - Prior covariance prior(K)_MxM
+     * - Training ouput y_N
+     * - Prediction output hat(y)_M
+     * - Posterior covariance matrix Sigma_MxM
+     *
+     * Algorithm:
+     * 1: Reuse Cholesky factor L of K and alpha = K^-1 * y of the factorization
+     * 2: Compute prediction hat(y) = cross(K) * alpha
+     * 3: Compute uncertainty diag(Sigma):
+     *    - triangular solve L * V = cross(K)^T
+     *    - compute diag(W) = diag(V^T * V)
+     *    - compute diag(Sigma) = diag(prior(K)) - diag(W)
+     */
+
+    GPRAT_START_STEP(assembly_timer);
+
+    const gprat_hyper::SEKParams &sek_params = factorization.sek_params;
+    const int n_regressors = factorization.n_regressors;
+
+    std::vector<double> prediction_result;
+    std::vector<double> uncertainty_result;
+    // Tiled future data structures for prediction
+    Tiles<T> cross_covariance_tiles;  // Tiled cross_covariance matrix K_NxM
+    Tiles<T> prediction_tiles;        // Tiled solution
+    // Tiled future data structures for uncertainty
+    Tiles<T> t_cross_covariance_tiles;  // Tiled transposed cross_covariance matrix K_MxN
+    Tiles<T> prior_K_tiles;             // Tiled prior covariance matrix diagonal diag(K_MxM)
+    Tiles<T> uncertainty_tiles;         // Tiled uncertainty solution
+
+    // Preallocate memory
+    prediction_result.reserve(test_input.size());
+    uncertainty_result.reserve(test_input.size());
+
+    cross_covariance_tiles.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(n_tiles));
+    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+
+    t_cross_covariance_tiles.reserve(static_cast<std::size_t>(n_tiles) * static_cast<std::size_t>(m_tiles));
+    prior_K_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    uncertainty_tiles.reserve(static_cast<std::size_t>(m_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous assembly
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+        {
+            cross_covariance_tiles.push_back(hpx::async(
+                hpx::annotated_function(gen_tile_cross_covariance<T>, "assemble_pred"),
+                i,
+                j,
+                m_tile_size,
+                n_tile_size,
+                n_regressors,
+                sek_params,
+                test_input,
+                training_input));
+        }
+    }
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        prediction_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_tiled"), m_tile_size));
+    }
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        prior_K_tiles.push_back(hpx::async(
+            hpx::annotated_function(gen_tile_prior_covariance<T>, "assemble_tiled"),
+            i,
+            i,
+            m_tile_size,
+            n_regressors,
+            sek_params,
+            test_input));
+    }
 
     for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
     {
         for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
         {
             t_cross_covariance_tiles.push_back(hpx::dataflow(
-                hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_pred"),
+                hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose<T>), "assemble_pred"),
                 m_tile_size,
                 n_tile_size,
                 cross_covariance_tiles[i * static_cast<std::size_t>(n_tiles) + j]));
@@ -348,48 +842,25 @@ std::vector<std::vector<double>> predict_with_uncertainty(
     for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
     {
         uncertainty_tiles.push_back(
-            hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_prior_inter"), m_tile_size));
+            hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_prior_inter"), m_tile_size));
     }
 
     GPRAT_END_STEP(
         assembly_timer,
         "predict_uncer_step assembly",
-        K_tiles,
-        alpha_tiles,
         cross_covariance_tiles,
         prediction_tiles,
         prior_K_tiles,
         uncertainty_tiles,
         t_cross_covariance_tiles);
-    GPRAT_START_STEP(cholesky_timer);
-
-    // Prediction
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous Cholesky decomposition: K = L * L^T
-    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    GPRAT_END_STEP(cholesky_timer, "predict_uncer_step cholesky", K_tiles);
-    GPRAT_START_STEP(forward_timer);
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous triangular solve  L * (L^T * alpha) = y
-    // First, forward solve L * beta = y
-    forward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    GPRAT_END_STEP(forward_timer, "predict_uncer_step forward", alpha_tiles);
-    GPRAT_START_STEP(backward_timer);
-
-    // Second, backward solve L^T * alpha = beta
-    backward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    GPRAT_END_STEP(backward_timer, "predict_uncer_step backward", alpha_tiles);
     GPRAT_START_STEP(prediction_timer);
 
+    // Prediction
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous prediction computation solve: hat(y) = cross(K) * alpha
     matrix_vector_tiled(
         cross_covariance_tiles,
-        alpha_tiles,
+        factorization.alpha_tiles,
         prediction_tiles,
         m_tile_size,
         n_tile_size,
@@ -402,7 +873,7 @@ std::vector<std::vector<double>> predict_with_uncertainty(
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous triangular solve L * V = cross(K)^T
     forward_solve_tiled_matrix(
-        K_tiles,
+        full_factor(factorization, n_tiles),
         t_cross_covariance_tiles,
         n_tile_size,
         m_tile_size,
@@ -459,6 +930,27 @@ std::vector<std::vector<double>> predict_with_full_cov(
     int m_tiles,
     int m_tile_size,
     int n_regressors)
+{
+    return predict_with_full_cov(
+        factorize(
+            training_input, training_output, sek_params, n_tiles, n_tile_size, n_regressors, gprat::Precision::fp64),
+        training_input,
+        test_input,
+        n_tiles,
+        n_tile_size,
+        m_tiles,
+        m_tile_size);
+}
+
+template <typename T>
+std::vector<std::vector<double>> predict_with_full_cov(
+    const Tiled_factorization<T> &factorization,
+    const std::vector<double> &training_input,
+    const std::vector<double> &test_input,
+    int n_tiles,
+    int n_tile_size,
+    int m_tiles,
+    int m_tile_size)
 {
     /*
      * Prediction: hat(y)_M = cross(K) * K^-1 * y
@@ -471,42 +963,38 @@ std::vector<std::vector<double>> predict_with_full_cov(
      * - Posterior covariance matrix Sigma_MxM
      *
      * Algorithm:
-     * 1: Compute lower triangular part of covariance matrix K
-     * 2: Compute Cholesky factor L of K
-     * 3: Compute intermediate solutions (alpha and V):
-     * - triangular solve L * beta = y
-     * - triangular solve L^T * alpha = beta
+     * 1: Reuse Cholesky factor L of K and alpha = K^-1 * y of the factorization
+     * 2: Compute intermediate solution V:
      * - triangular solve L * V = cross(K)^T
-     * 4: Compute prediction hat(y):
+     * 3: Compute prediction hat(y):
      * - compute hat(y) = cross(K) * alpha
-     * 5: Compute full covariance matrix Sigma:
+     * 4: Compute full covariance matrix Sigma:
      * - compute W = V^T * V
      * - compute Sigma = prior(K) - W
-     * 6: Compute diag(Sigma)
+     * 5: Compute diag(Sigma)
      */
 
     GPRAT_START_STEP(assembly_timer);
 
+    const gprat_hyper::SEKParams &sek_params = factorization.sek_params;
+    const int n_regressors = factorization.n_regressors;
+
     std::vector<double> prediction_result;
     std::vector<double> uncertainty_result;
     // Tiled future data structures for prediction
-    Tiled_matrix K_tiles;                 // Tiled covariance matrix K_NxN
-    Tiled_matrix cross_covariance_tiles;  // Tiled cross_covariance matrix K_NxM
-    Tiled_vector prediction_tiles;        // Tiled solution
-    Tiled_vector alpha_tiles;             // Tiled intermediate solution
+    Tiles<T> cross_covariance_tiles;  // Tiled cross_covariance matrix K_NxM
+    Tiles<T> prediction_tiles;        // Tiled solution
     // Tiled future data structures for uncertainty
-    Tiled_matrix t_cross_covariance_tiles;  // Tiled transposed cross_covariance matrix K_MxN
-    Tiled_matrix prior_K_tiles;             // Tiled prior covariance matrix K_MxM
-    Tiled_vector uncertainty_tiles;         // Tiled uncertainty solution
+    Tiles<T> t_cross_covariance_tiles;  // Tiled transposed cross_covariance matrix K_MxN
+    Tiles<T> prior_K_tiles;             // Tiled prior covariance matrix K_MxM
+    Tiles<T> uncertainty_tiles;         // Tiled uncertainty solution
 
     // Preallocate memory
     prediction_result.reserve(test_input.size());
     uncertainty_result.reserve(test_input.size());
 
-    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
     cross_covariance_tiles.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(n_tiles));
     prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
-    alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
 
     t_cross_covariance_tiles.reserve(static_cast<std::size_t>(n_tiles) * static_cast<std::size_t>(m_tiles));
     prior_K_tiles.resize(static_cast<std::size_t>(m_tiles * m_tiles));
@@ -514,33 +1002,12 @@ std::vector<std::vector<double>> predict_with_full_cov(
 
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous assembly
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-    {
-        for (std::size_t j = 0; j <= i; j++)
-        {
-            K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                hpx::annotated_function(gen_tile_covariance, "assemble_tiled_K"),
-                i,
-                j,
-                n_tile_size,
-                n_regressors,
-                sek_params,
-                training_input);
-        }
-    }
-
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-    {
-        alpha_tiles.push_back(hpx::async(
-            hpx::annotated_function(gen_tile_output, "assemble_tiled_alpha"), i, n_tile_size, training_output));
-    }
-
     for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
     {
         for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
         {
             cross_covariance_tiles.push_back(hpx::async(
-                hpx::annotated_function(gen_tile_cross_covariance, "assemble_pred"),
+                hpx::annotated_function(gen_tile_cross_covariance<T>, "assemble_pred"),
                 i,
                 j,
                 m_tile_size,
@@ -554,7 +1021,8 @@ std::vector<std::vector<double>> predict_with_full_cov(
 
     for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
     {
-        prediction_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_tiled"), m_tile_size));
+        prediction_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_tiled"), m_tile_size));
     }
 
     // Assemble prior covariance matrix vector
@@ -563,7 +1031,7 @@ std::vector<std::vector<double>> predict_with_full_cov(
         for (std::size_t j = 0; j <= i; j++)
         {
             prior_K_tiles[i * static_cast<std::size_t>(m_tiles) + j] = hpx::async(
-                hpx::annotated_function(gen_tile_full_prior_covariance, "assemble_prior_tiled"),
+                hpx::annotated_function(gen_tile_full_prior_covariance<T>, "assemble_prior_tiled"),
                 i,
                 j,
                 m_tile_size,
@@ -574,7 +1042,7 @@ std::vector<std::vector<double>> predict_with_full_cov(
             if (i != j)
             {
                 prior_K_tiles[j * static_cast<std::size_t>(m_tiles) + i] = hpx::dataflow(
-                    hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_prior_tiled"),
+                    hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose<T>), "assemble_prior_tiled"),
                     m_tile_size,
                     m_tile_size,
                     prior_K_tiles[i * static_cast<std::size_t>(m_tiles) + j]);
@@ -587,7 +1055,7 @@ std::vector<std::vector<double>> predict_with_full_cov(
         for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
         {
             t_cross_covariance_tiles.push_back(hpx::dataflow(
-                hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_pred"),
+                hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose<T>), "assemble_pred"),
                 m_tile_size,
                 n_tile_size,
                 cross_covariance_tiles[i * static_cast<std::size_t>(n_tiles) + j]));
@@ -596,45 +1064,24 @@ std::vector<std::vector<double>> predict_with_full_cov(
 
     for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
     {
-        uncertainty_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_tiled"), m_tile_size));
+        uncertainty_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_tiled"), m_tile_size));
     }
 
     GPRAT_END_STEP(
         assembly_timer,
         "predict_full_cov_step assembly",
-        K_tiles,
-        alpha_tiles,
         cross_covariance_tiles,
         prediction_tiles,
         prior_K_tiles,
         uncertainty_tiles,
         t_cross_covariance_tiles);
-    GPRAT_START_STEP(cholesky_timer);
-
-    // Prediction
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous Cholesky decomposition: K = L * L^T
-    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    GPRAT_END_STEP(cholesky_timer, "predict_full_cov_step cholesky", K_tiles);
-    GPRAT_START_STEP(forward_timer);
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous triangular solve  L * (L^T * alpha) = y
-    forward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    GPRAT_END_STEP(forward_timer, "predict_full_cov_step forward", alpha_tiles);
-    GPRAT_START_STEP(backward_timer);
-
-    backward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    GPRAT_END_STEP(backward_timer, "predict_full_cov_step backward", alpha_tiles);
     GPRAT_START_STEP(forward_KcK_timer);
 
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous triangular solve L * V = cross(K)^T
     forward_solve_tiled_matrix(
-        K_tiles,
+        full_factor(factorization, n_tiles),
         t_cross_covariance_tiles,
         n_tile_size,
         m_tile_size,
@@ -648,7 +1095,7 @@ std::vector<std::vector<double>> predict_with_full_cov(
     // Launch asynchronous prediction computation solve: hat(y) = K_cross_cov * alpha
     matrix_vector_tiled(
         cross_covariance_tiles,
-        alpha_tiles,
+        factorization.alpha_tiles,
         prediction_tiles,
         m_tile_size,
         n_tile_size,
@@ -703,6 +1150,20 @@ double compute_loss(const std::vector<double> &training_input,
                     int n_tiles,
                     int n_tile_size,
                     int n_regressors)
+{
+    return compute_loss(
+        factorize(
+            training_input, training_output, sek_params, n_tiles, n_tile_size, n_regressors, gprat::Precision::fp64),
+        training_output,
+        n_tiles,
+        n_tile_size);
+}
+
+template <typename T>
+double compute_loss(const Tiled_factorization<T> &factorization,
+                    const std::vector<double> &training_output,
+                    int n_tiles,
+                    int n_tile_size)
 {
     /*
      * Negative log likelihood loss:
@@ -712,72 +1173,332 @@ double compute_loss(const std::vector<double> &training_input,
      * - Hyperparameters theta ={ v, l, v_n }
      *
      * Algorithm:
-     * 1: Compute lower triangular part of covariance matrix K
-     * 2: Compute Cholesky factor L of K
-     * 3: Compute prediction alpha = K^-1 * y:
-     *    - triangular solve L * beta = y
-     *    - triangular solve L^T * alpha = beta
-     * 5: Compute beta = K^-1 * y
-     * 6: Compute negative log likelihood loss
+     * 1: Reuse Cholesky factor L of K and alpha = K^-1 * y of the factorization
+     * 2: Compute negative log likelihood loss
      *    - Calculate sum_i^N log(L_ii^2)
-     *    - Calculate y^T * beta
+     *    - Calculate y^T * alpha
      *    - Add constant N * log (2 * pi)
      */
 
     hpx::shared_future<double> loss_value;
     // Tiled future data structures
-    Tiled_matrix K_tiles;      // Tiled covariance matrix K_NxN
-    Tiled_vector y_tiles;      // Tiled output
-    Tiled_vector alpha_tiles;  // Tiled intermediate solution
+    Tiles<T> y_tiles;  // Tiled output
 
     // Preallocate memory
-    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
     y_tiles.reserve(static_cast<std::size_t>(n_tiles));
-    alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
 
     ///////////////////////////////////////////////////////////////////////////
     // Launch asynchronous assembly
     for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        y_tiles.push_back(hpx::async(
+            hpx::annotated_function(gen_tile_output<T>, "assemble_tiled_y"), i, n_tile_size, training_output));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous loss computation
+    compute_loss_tiled(factorization.L_tiles,
+                       factorization.alpha_tiles,
+                       y_tiles,
+                       loss_value,
+                       n_tile_size,
+                       static_cast<std::size_t>(n_tiles));
+
+    return loss_value.get();
+}
+
+template <typename T>
+Tiled_distances<T>
+gen_distance_tiles(const std::vector<double> &training_input, int n_tiles, int n_tile_size, int n_regressors)
+{
+    Tiled_distances<T> distances{ Tiles<T>{}, Tiles<T>{}, 0.0, n_regressors };
+    // No reserve because of triangular structure
+    distances.distance_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous assembly of the squared distances (z_i - z_j)^2 of K entries
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
     {
         for (std::size_t j = 0; j <= i; j++)
         {
-            K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                hpx::annotated_function(gen_tile_covariance, "assemble_tiled_K"),
+            distances.distance_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
+                hpx::annotated_function(gen_tile_distance<T>, "assemble_cov_dist"),
                 i,
                 j,
                 n_tile_size,
                 n_regressors,
-                sek_params,
                 training_input);
         }
     }
+    return distances;
+}
+
+// Launch asynchronous assembly of the lower triangle of K, gated by the future of the hyperparameters. The frozen
+// hyperparameters are read from sek_params.
+template <typename T>
+static void assemble_covariance(Tiled_distances<T> &distances,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const hpx::shared_future<gprat_hyper::SEKParams> &ft_sek_params,
+                                const std::vector<bool> &trainable_params,
+                                int n_tiles,
+                                int n_tile_size,
+                                Owned_tiles<T> &K_tiles)
+{
+    std::size_t tile_elements = static_cast<std::size_t>(n_tile_size * n_tile_size);
+    // With a frozen lengthscale, exp(-0.5 / lengthscale^2 * (z_i - z_j)^2) is constant across iterations
+    bool use_exp_distances = !trainable_params[0];
+    if (use_exp_distances
+        && (distances.exp_tiles.empty() || !same_bits(distances.exp_lengthscale, sek_params.lengthscale)))
+    {
+        distances.exp_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));
+        distances.exp_lengthscale = sek_params.lengthscale;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+        {
+            for (std::size_t j = 0; j <= i; j++)
+            {
+                distances.exp_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(&gen_tile_exp_distance<T>), "assemble_exp_dist"),
+                    n_tile_size,
+                    sek_params,
+                    distances.distance_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            if (use_exp_distances)
+            {
+                K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(&gen_tile_covariance_with_exp_distance<T>), "assemble_K"),
+                    std::vector<T>(tile_elements),
+                    i,
+                    j,
+                    n_tile_size,
+                    ft_sek_params,
+                    distances.exp_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
+            }
+            else
+            {
+                K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(&gen_tile_covariance_with_distance<T>), "assemble_K"),
+                    std::vector<T>(tile_elements),
+                    i,
+                    j,
+                    n_tile_size,
+                    ft_sek_params,
+                    distances.distance_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
+            }
+        }
+    }
+}
+
+// Release the references of a loss and gradient evaluation to its tiles once its loss and gradients are computed.
+// The storage of a tile is freed with its last reference, which other tasks may still hold.
+template <typename T>
+static void release_evaluation_tiles(Tiles<T> K_inv_tiles,
+                                     Tiles<T> K_tiles,
+                                     const hpx::shared_future<double> &,
+                                     const hpx::shared_future<std::vector<double>> &)
+{
+    K_inv_tiles.clear();
+    K_tiles.clear();
+}
+
+// Launch the evaluation of the loss and its gradients w.r.t. the unconstrained hyperparameters of ft_sek_params
+// without synchronization. Returns the future of the release of the tiles of the evaluation.
+template <typename T>
+static hpx::future<void> evaluate_loss_and_gradient(Tiled_distances<T> &distances,
+                                                    const Tiles<T> &y_tiles,
+                                                    int n_tiles,
+                                                    int n_tile_size,
+                                                    const gprat_hyper::SEKParams &sek_params,
+                                                    const hpx::shared_future<gprat_hyper::SEKParams> &ft_sek_params,
+                                                    const std::vector<bool> &trainable_params,
+                                                    hpx::shared_future<double> &loss_value,
+                                                    hpx::shared_future<std::vector<double>> &gradient)
+{
+    std::size_t tile_elements = static_cast<std::size_t>(n_tile_size * n_tile_size);
+
+    // With a frozen lengthscale, the gradients are computed from the cached exponentiated distances
+    bool use_exp_distances = !trainable_params[0];
+
+    // Tiled future data structures
+    Owned_tiles<T> K_owned_tiles;      // Tiled covariance matrix K_NxN, factorized in-place
+    Tiles<T> K_tiles;                  // Tiled Cholesky factor L
+    Tiles<T> alpha_tiles;              // Tiled intermediate solution
+    Owned_tiles<T> K_inv_owned_tiles;  // Tiled buffers for the inverse Cholesky factor, computed in-place
+    Tiles<T> K_inv_tiles;              // Tiled lower triangle of the inversed covariance matrix K^-1_NxN
+
+    // Preallocate memory
+    alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
+
+    K_owned_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
+    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));        // No reserve because of triangular structure
+    K_inv_owned_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // Triangular structure
+    K_inv_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));        // Triangular structure
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous assembly of tiled covariance matrix from the cached distances
+    assemble_covariance(distances, sek_params, ft_sek_params, trainable_params, n_tiles, n_tile_size, K_owned_tiles);
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        alpha_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_tiled"), n_tile_size));
+    }
+
+    // Buffers of the inverse Cholesky factor, the strictly lower tiles accumulate their updates from zero
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        K_inv_owned_tiles[i * static_cast<std::size_t>(n_tiles) + i] =
+            hpx::make_ready_future(std::vector<T>(tile_elements));
+        for (std::size_t j = 0; j < i; j++)
+        {
+            K_inv_owned_tiles[i * static_cast<std::size_t>(n_tiles) + j] =
+                hpx::async(hpx::annotated_function(gen_tile_zeros<T>, "assemble_inverse_factor"), tile_elements);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous Cholesky decomposition: K = L * L^T
+    right_looking_cholesky_tiled(K_owned_tiles, K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous compute of the lower triangle of K^-1 = L^-T * L^-1
+    triangular_inverse_tiled(K_tiles, K_inv_owned_tiles, K_inv_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+    triangular_transpose_product_tiled(K_inv_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous compute beta = inv(K) * y
+    symmetric_matrix_vector_tiled(K_inv_tiles, y_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous loss computation where
+    // loss(theta) = 0.5 * ( log(det(K)) - y^T * K^-1 * y - N * log(2 * pi) )
+    compute_loss_tiled(K_tiles, alpha_tiles, y_tiles, loss_value, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous computation of the gradients, the derivatives of K are computed on the fly
+    gradient_tiled(K_inv_tiles,
+                   alpha_tiles,
+                   use_exp_distances ? distances.exp_tiles : distances.distance_tiles,
+                   ft_sek_params,
+                   use_exp_distances,
+                   gradient,
+                   n_tile_size,
+                   static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous release of the tiles once the evaluation is done
+    return hpx::dataflow(hpx::annotated_function(&release_evaluation_tiles<T>, "release_tiles"),
+                         std::move(K_inv_tiles),
+                         std::move(K_tiles),
+                         loss_value,
+                         gradient);
+}
+
+// Launch one optimization iteration without synchronization. The iteration starts with the hyperparameters of
+// ft_sek_params, which is replaced by the future of the hyperparameters after the Adam step. Returns the future of the
+// release of the tiles of the iteration.
+template <typename T>
+static hpx::future<void> optimize_iteration(Tiled_distances<T> &distances,
+                                            const Tiles<T> &y_tiles,
+                                            int n_tiles,
+                                            int n_tile_size,
+                                            const gprat_hyper::AdamParams &adam_params,
+                                            const gprat_hyper::SEKParams &sek_params,
+                                            hpx::shared_future<gprat_hyper::SEKParams> &ft_sek_params,
+                                            hpx::shared_future<double> &loss_value,
+                                            const std::vector<bool> &trainable_params,
+                                            std::size_t iter)
+{
+    // data holder for the gradients w.r.t. lengthscale, vertical_lengthscale and noise_variance
+    hpx::shared_future<std::vector<double>> gradient;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous loss and gradient computation
+    hpx::future<void> released = evaluate_loss_and_gradient(
+        distances, y_tiles, n_tiles, n_tile_size, sek_params, ft_sek_params, trainable_params, loss_value, gradient);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous Adam update of the trainable hyperparameters, gating the next iteration
+    ft_sek_params = hpx::dataflow(
+        hpx::annotated_function(hpx::unwrapping(&update_hyperparameters), "update_hyperparam"),
+        gradient,
+        adam_params,
+        ft_sek_params,
+        trainable_params,
+        iter);
+    return released;
+}
+
+// Launch n_iterations optimization iterations starting at iteration first_iter and return their losses. Consecutive
+// iterations are pipelined through the futures of the hyperparameters, only the losses and the final hyperparameters
+// are synchronized.
+template <typename T>
+static std::vector<double> optimize_iterations(Tiled_distances<T> &distances,
+                                               const Tiles<T> &y_tiles,
+                                               int n_tiles,
+                                               int n_tile_size,
+                                               const gprat_hyper::AdamParams &adam_params,
+                                               gprat_hyper::SEKParams &sek_params,
+                                               const std::vector<bool> &trainable_params,
+                                               std::size_t first_iter,
+                                               std::size_t n_iterations)
+{
+    // data holder for computed loss values
+    std::vector<hpx::shared_future<double>> loss_values;
+    loss_values.reserve(n_iterations);
+    // Future of the hyperparameters, updated by each iteration
+    hpx::shared_future<gprat_hyper::SEKParams> ft_sek_params = hpx::make_ready_future(sek_params);
+    // Releases of the tiles of the iterations, the tiles of an iteration are released once its loss and gradients are
+    // computed, before the hyperparameter update that gates the next iteration
+    std::vector<hpx::future<void>> released;
+    released.reserve(n_iterations);
+
+    for (std::size_t iter = first_iter; iter < first_iter + n_iterations; iter++)
+    {
+        // Launch the iteration, its tile generation is gated by the hyperparameters of the previous iteration
+        hpx::shared_future<double> loss_value;
+        released.push_back(optimize_iteration(distances,
+                                              y_tiles,
+                                              n_tiles,
+                                              n_tile_size,
+                                              adam_params,
+                                              sek_params,
+                                              ft_sek_params,
+                                              loss_value,
+                                              trainable_params,
+                                              iter));
+        loss_values.push_back(loss_value);
+    }
+    hpx::wait_all(released);
+    sek_params = ft_sek_params.get();
 
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    // Synchronize the losses once after all iterations
+    std::vector<double> losses;
+    losses.reserve(loss_values.size());
+    for (const auto &loss_value : loss_values)
     {
-        y_tiles.push_back(
-            hpx::async(hpx::annotated_function(gen_tile_output, "assemble_tiled_y"), i, n_tile_size, training_output));
+        losses.push_back(loss_value.get());
     }
+    return losses;
+}
 
+// Launch asynchronous assembly of the tiled training output y
+template <typename T>
+static Tiles<T> assemble_output_tiles(const std::vector<double> &training_output, int n_tiles, int n_tile_size)
+{
+    Tiles<T> y_tiles;
+    y_tiles.reserve(static_cast<std::size_t>(n_tiles));
     for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
     {
-        alpha_tiles.push_back(hpx::async(
-            hpx::annotated_function(gen_tile_output, "assemble_tiled_alpha"), i, n_tile_size, training_output));
+        y_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_output<T>, "assemble_y"), i, n_tile_size, training_output));
     }
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous Cholesky decomposition: K = L * L^T
-    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous triangular solve  L * (L^T * alpha) = y
-    forward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-    backward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous loss computation
-    compute_loss_tiled(K_tiles, alpha_tiles, y_tiles, loss_value, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-    return loss_value.get();
+    return y_tiles;
 }
 
 std::vector<double>
@@ -789,6 +1510,19 @@ optimize(const std::vector<double> &training_input,
          const gprat_hyper::AdamParams &adam_params,
          gprat_hyper::SEKParams &sek_params,
          std::vector<bool> trainable_params)
+{
+    DistanceTiles distances = gen_distance_tiles<double>(training_input, n_tiles, n_tile_size, n_regressors);
+    return optimize(distances, training_output, n_tiles, n_tile_size, adam_params, sek_params, trainable_params);
+}
+
+template <typename T>
+std::vector<double> optimize(Tiled_distances<T> &distances,
+                             const std::vector<double> &training_output,
+                             int n_tiles,
+                             int n_tile_size,
+                             const gprat_hyper::AdamParams &adam_params,
+                             gprat_hyper::SEKParams &sek_params,
+                             std::vector<bool> trainable_params)
 {
     /*
      * - Hyperparameters theta={v, l, v_n}
@@ -797,25 +1531,24 @@ optimize(const std::vector<double> &training_input,
      *
      * Algorithm:
      * for opt_iter:
-     *   1: Compute distance for entries of covariance matrix K
+     *   1: Reuse cached distance for entries of covariance matrix K
      *   2: Compute lower triangular part of K with distance
-     *   3: Compute lower triangular gradients for delta(K)/delta(v), and delta(K)/delta(l) with distance
      *
-     *   4: Compute Cholesky factor L of K
-     *   5: Compute K^-1:
-     *       - triangular solve L * {} = I
-     *       - triangular solve L^T * K^-1 = {}
-     *   6: Compute beta = K^-1 * y
+     *   3: Compute Cholesky factor L of K
+     *   4: Compute lower triangle of K^-1:
+     *       - triangular inverse L^-1 (TRTRI)
+     *       - symmetric product K^-1 = L^-T * L^-1 (LAUUM)
+     *   5: Compute beta = K^-1 * y (SYMV)
      *
-     *   7: Compute negative log likelihood loss
+     *   6: Compute negative log likelihood loss
      *       - Calculate 0.5 sum_i^N log(L_ii^2)
      *       - Calculate 0.5 y^T * beta
      *       - Add constant N / 2 * log (2 * pi)
      *
-     *   8: Compute delta(loss)/delta(param_i)
-     *       - Compute trace(K^-1 * delta(K)/delta(theta_i))
-     *       - Compute beta^T *  delta(K)/delta(theta_i) * beta
-     *   9: Update hyperparameters theta with Adam optimizer
+     *   7: Compute delta(loss)/delta(param_i) in one pass over the lower triangle
+     *       - Compute delta(K)/delta(theta_i) on the fly with distance
+     *       - Compute trace((K^-1 - beta * beta^T) * delta(K)/delta(theta_i))
+     *   8: Update hyperparameters theta with Adam optimizer
      *       - m_T = beta1 * m_T-1 + (1 - beta1) * g_T
      *       - w_T = beta2 + w_T-1 + (1 - beta2) * g_T^2
      *       - nu_T = nu * sqrt(1 - beta2_T) / (1 - beta1_T)
@@ -823,210 +1556,17 @@ optimize(const std::vector<double> &training_input,
      * endfor
      */
 
-    // data holder for loss
-    hpx::shared_future<double> loss_value;
-    // data holder for computed loss values
-    std::vector<double> losses;
-
-    // Tiled future data structures
-    Tiled_matrix K_tiles;      // Tiled covariance matrix K_NxN
-    Tiled_vector y_tiles;      // Tiled output
-    Tiled_vector alpha_tiles;  // Tiled intermediate solution
-    Tiled_matrix K_inv_tiles;  // Tiled inversed covariance matrix K^-1_NxN
-    // Tiled future data structures for gradients
-    Tiled_matrix grad_v_tiles;  // Tiled covariance with gradient v
-    Tiled_matrix grad_l_tiles;  // Tiled covariance with gradient l
-
-    // Preallocate memory
-    losses.reserve(static_cast<std::size_t>(adam_params.opt_iter));
-    y_tiles.reserve(static_cast<std::size_t>(n_tiles));
-
-    alpha_tiles.resize(static_cast<std::size_t>(n_tiles));            // for now resize since reset in loop
-    K_inv_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // for now resize since reset in loop
-
-    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));       // No reserve because of triangular structure
-    grad_v_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
-    grad_l_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
-
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous assembly of output y
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-    {
-        y_tiles.push_back(
-            hpx::async(hpx::annotated_function(gen_tile_output, "assemble_y"), i, n_tile_size, training_output));
-    }
-
-    //////////////////////////////////////////////////////////////////////////////
-    // Perform optimization
-    for (std::size_t iter = 0; iter < static_cast<std::size_t>(adam_params.opt_iter); iter++)
-    {
-        ///////////////////////////////////////////////////////////////////////////
-        // Launch asynchronous assembly of tiled covariance matrix, derivative of covariance matrix
-        // vector w.r.t. to vertical lengthscale and derivative of covariance
-        // matrix vector w.r.t. to lengthscale
-        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-        {
-            for (std::size_t j = 0; j <= i; j++)
-            {
-                // Compute the distance (z_i - z_j) of K entries to reuse
-                hpx::shared_future<std::vector<double>> cov_dists = hpx::async(
-                    hpx::annotated_function(gen_tile_distance, "assemble_cov_dist"),
-                    i,
-                    j,
-                    n_tile_size,
-                    n_regressors,
-                    sek_params,
-                    training_input);
-
-                K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
-                    hpx::annotated_function(hpx::unwrapping(&gen_tile_covariance_with_distance), "assemble_K"),
-                    i,
-                    j,
-                    n_tile_size,
-                    sek_params,
-                    cov_dists);
-                if (trainable_params[0])
-                {
-                    grad_l_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
-                        hpx::annotated_function(hpx::unwrapping(&gen_tile_grad_l), "assemble_gradl"),
-                        n_tile_size,
-                        sek_params,
-                        cov_dists);
-                    if (i != j)
-                    {
-                        grad_l_tiles[j * static_cast<std::size_t>(n_tiles) + i] = hpx::dataflow(
-                            hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_gradl_t"),
-                            n_tile_size,
-                            n_tile_size,
-                            grad_l_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
-                    }
-                }
-
-                if (trainable_params[1])
-                {
-                    grad_v_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
-                        hpx::annotated_function(hpx::unwrapping(&gen_tile_grad_v), "assemble_gradv"),
-                        n_tile_size,
-                        sek_params,
-                        cov_dists);
-                    if (i != j)
-                    {
-                        grad_v_tiles[j * static_cast<std::size_t>(n_tiles) + i] = hpx::dataflow(
-                            hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_gradv_t"),
-                            n_tile_size,
-                            n_tile_size,
-                            grad_v_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
-                    }
-                }
-            }
-        }
-
-        // Assembly with reallocation -> optimize to only set existing values
-        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-        {
-            alpha_tiles[i] = hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_tiled"), n_tile_size);
-        }
-
-        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-        {
-            for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
-            {
-                if (i == j)
-                {
-                    K_inv_tiles[i * static_cast<std::size_t>(n_tiles) + j] =
-                        hpx::async(hpx::annotated_function(gen_tile_identity, "assemble_identity_matrix"), n_tile_size);
-                }
-                else
-                {
-                    K_inv_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                        hpx::annotated_function(gen_tile_zeros, "assemble_identity_matrix"), n_tile_size * n_tile_size);
-                }
-            }
-        }
-
-        ///////////////////////////////////////////////////////////////////////////
-        // Launch asynchronous Cholesky decomposition: K = L * L^T
-        right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-        ///////////////////////////////////////////////////////////////////////////
-        // Launch asynchronous compute K^-1 through L* (L^T * X) = I
-        forward_solve_tiled_matrix(
-            K_tiles,
-            K_inv_tiles,
-            n_tile_size,
-            n_tile_size,
-            static_cast<std::size_t>(n_tiles),
-            static_cast<std::size_t>(n_tiles));
-        backward_solve_tiled_matrix(
-            K_tiles,
-            K_inv_tiles,
-            n_tile_size,
-            n_tile_size,
-            static_cast<std::size_t>(n_tiles),
-            static_cast<std::size_t>(n_tiles));
-
-        ///////////////////////////////////////////////////////////////////////////
-        // Launch asynchronous compute beta = inv(K) * y
-        matrix_vector_tiled(
-            K_inv_tiles,
-            y_tiles,
-            alpha_tiles,
-            n_tile_size,
-            n_tile_size,
-            static_cast<std::size_t>(n_tiles),
-            static_cast<std::size_t>(n_tiles));
-
-        ///////////////////////////////////////////////////////////////////////////
-        // Launch asynchronous loss computation where
-        // loss(theta) = 0.5 * ( log(det(K)) - y^T * K^-1 * y - N * log(2 * pi) )
-        compute_loss_tiled(K_tiles, alpha_tiles, y_tiles, loss_value, n_tile_size, static_cast<std::size_t>(n_tiles));
-
-        ///////////////////////////////////////////////////////////////////////////
-        // Launch asynchronous update of the hyperparameters
-        if (trainable_params[0])
-        {  // lengthscale
-            update_hyperparameter_tiled(
-                K_inv_tiles,
-                grad_l_tiles,
-                alpha_tiles,
-                adam_params,
-                sek_params,
-                n_tile_size,
-                static_cast<std::size_t>(n_tiles),
-                iter,
-                0);
-        }
-        if (trainable_params[1])
-        {  // vertical_lengthscale
-            update_hyperparameter_tiled(
-                K_inv_tiles,
-                grad_v_tiles,
-                alpha_tiles,
-                adam_params,
-                sek_params,
-                n_tile_size,
-                static_cast<std::size_t>(n_tiles),
-                iter,
-                1);
-        }
-        if (trainable_params[2])
-        {  // noise_variance
-            update_hyperparameter_tiled(
-                K_inv_tiles,
-                Tiled_matrix{},  // no tiled gradient matrix required
-                alpha_tiles,
-                adam_params,
-                sek_params,
-                n_tile_size,
-                static_cast<std::size_t>(n_tiles),
-                iter,
-                2);
-        }
-        // Synchronize after iteration
-        losses.push_back(loss_value.get());
-    }
-    // Return losses
-    return losses;
+    // Launch asynchronous assembly of output y and perform optimization
+    Tiles<T> y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
+    return optimize_iterations(distances,
+                               y_tiles,
+                               n_tiles,
+                               n_tile_size,
+                               adam_params,
+                               sek_params,
+                               trainable_params,
+                               0,
+                               static_cast<std::size_t>(adam_params.opt_iter));
 }
 
 double optimize_step(const std::vector<double> &training_input,
@@ -1038,6 +1578,21 @@ double optimize_step(const std::vector<double> &training_input,
                      gprat_hyper::SEKParams &sek_params,
                      std::vector<bool> trainable_params,
                      int iter)
+{
+    DistanceTiles distances = gen_distance_tiles<double>(training_input, n_tiles, n_tile_size, n_regressors);
+    return optimize_step(
+        distances, training_output, n_tiles, n_tile_size, adam_params, sek_params, trainable_params, iter);
+}
+
+template <typename T>
+double optimize_step(Tiled_distances<T> &distances,
+                     const std::vector<double> &training_output,
+                     int n_tiles,
+                     int n_tile_size,
+                     gprat_hyper::AdamParams &adam_params,
+                     gprat_hyper::SEKParams &sek_params,
+                     std::vector<bool> trainable_params,
+                     int iter)
 {
     /*
      * - Hyperparameters theta={v, l, v_n}
@@ -1045,227 +1600,452 @@ double optimize_step(const std::vector<double> &training_input,
      * - Training ouput y
      *
      * Algorithm:
-     * 1: Compute distance for entries of covariance matrix K
+     * 1: Reuse cached distance for entries of covariance matrix K
      * 2: Compute lower triangular part of K with distance
-     * 3: Compute lower triangular gradients for delta(K)/delta(v), and delta(K)/delta(l) with distance
      *
-     * 4: Compute Cholesky factor L of K
-     * 5: Compute K^-1:
-     *     - triangular solve L * {} = I
-     *     - triangular solve L^T * K^-1 = {}
-     * 6: Compute beta = K^-1 * y
+     * 3: Compute Cholesky factor L of K
+     * 4: Compute lower triangle of K^-1:
+     *     - triangular inverse L^-1 (TRTRI)
+     *     - symmetric product K^-1 = L^-T * L^-1 (LAUUM)
+     * 5: Compute beta = K^-1 * y (SYMV)
      *
-     * 7: Compute negative log likelihood loss
+     * 6: Compute negative log likelihood loss
      *     - Calculate 0.5 sum_i^N log(L_ii^2)
      *     - Calculate 0.5 y^T * beta
      *     - Add constant N / 2 * log (2 * pi)
      *
-     * 8: Compute delta(loss)/delta(param_i)
-     *     - Compute trace(K^-1 * delta(K)/delta(theta_i))
-     *     - Compute beta^T * delta(K)/delta(theta_i) * beta
-     * 9: Update hyperparameters theta with Adam optimizer
+     * 7: Compute delta(loss)/delta(param_i) in one pass over the lower triangle
+     *     - Compute delta(K)/delta(theta_i) on the fly with distance
+     *     - Compute trace((K^-1 - beta * beta^T) * delta(K)/delta(theta_i))
+     * 8: Update hyperparameters theta with Adam optimizer
      *     - m_T = beta1 * m_T-1 + (1 - beta1) * g_T
      *     - w_T = beta2 + w_T-1 + (1 - beta2) * g_T^2
      *     - nu_T = nu * sqrt(1 - beta2_T) / (1 - beta1_T)
      *     - theta_T = theta_T-1 - nu_T * m_T / (sqrt(w_T) + epsilon)
      */
 
-    // data holder for loss
-    hpx::shared_future<double> loss_value;
+    // Launch asynchronous assembly of output y and perform one optimization step
+    Tiles<T> y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
+    return optimize_iterations(distances,
+                               y_tiles,
+                               n_tiles,
+                               n_tile_size,
+                               adam_params,
+                               sek_params,
+                               trainable_params,
+                               static_cast<std::size_t>(iter),
+                               1)
+        .front();
+}
 
-    // Tiled future data structures
-    Tiled_matrix K_tiles;      // Tiled covariance matrix K_NxN
-    Tiled_vector y_tiles;      // Tiled output
-    Tiled_vector alpha_tiles;  // Tiled intermediate solution
-    Tiled_matrix K_inv_tiles;  // Tiled inversed covariance matrix K^-1_NxN
-    // Tiled future data structures for gradients
-    Tiled_matrix grad_v_tiles;  // Tiled covariance with gradient v
-    Tiled_matrix grad_l_tiles;  // Tiled covariance with gradient l
+// Evaluate the loss and its gradients w.r.t. the unconstrained hyperparameters, the gradients w.r.t. frozen
+// hyperparameters are set to zero
+template <typename T>
+static double loss_and_gradient(Tiled_distances<T> &distances,
+                                const Tiles<T> &y_tiles,
+                                int n_tiles,
+                                int n_tile_size,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const std::vector<bool> &trainable_params,
+                                std::vector<double> &gradient)
+{
+    hpx::shared_future<double> loss_value;
+    hpx::shared_future<std::vector<double>> ft_gradient;
+    evaluate_loss_and_gradient(distances,
+                               y_tiles,
+                               n_tiles,
+                               n_tile_size,
+                               sek_params,
+                               hpx::make_ready_future(sek_params),
+                               trainable_params,
+                               loss_value,
+                               ft_gradient)
+        .get();
+    gradient = ft_gradient.get();
+    for (std::size_t param_idx = 0; param_idx < trainable_params.size(); param_idx++)
+    {
+        if (!trainable_params[param_idx])
+        {
+            gradient[param_idx] = 0.0;
+        }
+    }
+    return loss_value.get();
+}
 
-    // Preallocate memory
-    y_tiles.reserve(static_cast<std::size_t>(n_tiles));
+template <typename T>
+std::vector<double> optimize_lbfgs(Tiled_distances<T> &distances,
+                                   const std::vector<double> &training_output,
+                                   int n_tiles,
+                                   int n_tile_size,
+                                   const gprat_hyper::LBFGSParams &lbfgs_params,
+                                   gprat_hyper::SEKParams &sek_params,
+                                   std::vector<bool> trainable_params)
+{
+    /*
+     * - Unconstrained hyperparameters x = to_unconstrained(theta)
+     * - Loss f(x) and gradient g(x) of the Adam optimization
+     *
+     * Algorithm:
+     * for max_iter while max|g_k| > gradient_tolerance:
+     *   1: Compute direction d_k = -H_k * g_k with the two-loop recursion over the recent pairs (s_i, y_i)
+     *   2: Backtracking line search on x_k + t * d_k until the Armijo condition
+     *      f(x_k + t * d_k) <= f(x_k) + c1 * t * g_k^T * d_k holds, each trial evaluates loss and gradient
+     *   3: Store s_k = t * d_k and y_k = g_k+1 - g_k if s_k^T * y_k > 0
+     * endfor
+     */
+    if (lbfgs_params.max_iter < 0 || lbfgs_params.history_size < 1 || lbfgs_params.max_line_search < 1)
+    {
+        throw std::invalid_argument("The L-BFGS iteration, history and line search limits must be positive");
+    }
+    auto dot = [](const std::vector<double> &a, const std::vector<double> &b)
+    { return std::inner_product(a.begin(), a.end(), b.begin(), 0.0); };
 
-    alpha_tiles.resize(static_cast<std::size_t>(n_tiles));            // for now resize since reset in loop
-    K_inv_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // for now resize since reset in loop
+    // Launch asynchronous assembly of output y, the tiles are reused by all evaluations
+    Tiles<T> y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
 
-    K_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));       // No reserve because of triangular structure
-    grad_v_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
-    grad_l_tiles.resize(static_cast<std::size_t>(n_tiles * n_tiles));  // No reserve because of triangular structure
+    std::vector<double> gradient;
+    double loss = loss_and_gradient(distances, y_tiles, n_tiles, n_tile_size, sek_params, trainable_params, gradient);
+    std::vector<double> losses{ loss };
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous assembly of output y
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
-    {
-        y_tiles.push_back(
-            hpx::async(hpx::annotated_function(gen_tile_output, "assemble_y"), i, n_tile_size, training_output));
-    }
+    // Recent steps and gradient differences in the unconstrained space, oldest first
+    std::vector<std::vector<double>> s_history;
+    std::vector<std::vector<double>> y_history;
 
-    //////////////////////////////////////////////////////////////////////////////
-    // Perform one optimization step
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous assembly of tiled covariance matrix, derivative of covariance matrix
-    // vector w.r.t. to vertical lengthscale and derivative of covariance
-    // matrix vector w.r.t. to lengthscale
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    for (int iter = 0; iter < lbfgs_params.max_iter; iter++)
     {
-        for (std::size_t j = 0; j <= i; j++)
+        double gradient_norm = 0.0;
+        for (double value : gradient)
         {
-            // Compute the distance (z_i - z_j) of K entries to reuse
-            hpx::shared_future<std::vector<double>> cov_dists = hpx::async(
-                hpx::annotated_function(gen_tile_distance, "assemble_cov_dist"),
-                i,
-                j,
-                n_tile_size,
-                n_regressors,
-                sek_params,
-                training_input);
-
-            K_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
-                hpx::annotated_function(hpx::unwrapping(&gen_tile_covariance_with_distance), "assemble_K"),
-                i,
-                j,
-                n_tile_size,
-                sek_params,
-                cov_dists);
+            gradient_norm = std::max(gradient_norm, std::abs(value));
+        }
+        if (gradient_norm <= lbfgs_params.gradient_tolerance)
+        {
+            break;
+        }
 
-            if (trainable_params[0])
+        std::vector<double> direction = lbfgs_direction(gradient, s_history, y_history);
+        double slope = dot(gradient, direction);
+        if (!(slope < 0.0))
+        {
+            // Restart with steepest descent if the direction is not a descent direction
+            s_history.clear();
+            y_history.clear();
+            direction = lbfgs_direction(gradient, s_history, y_history);
+            slope = dot(gradient, direction);
+        }
+        // Without curvature information, the first step is bounded to one in the unconstrained space
+        double step = s_history.empty() ? std::min(1.0, 1.0 / gradient_norm) : 1.0;
+
+        // Backtracking line search, the trial evaluations reuse the distance tiles
+        gprat_hyper::SEKParams trial_params = sek_params;
+        std::vector<double> trial_gradient;
+        bool accepted = false;
+        double trial_loss = loss;
+        for (int trial = 0; trial < lbfgs_params.max_line_search; trial++)
+        {
+            trial_params = move_hyperparameters(sek_params, direction, step, trainable_params);
+            trial_loss = loss_and_gradient(
+                distances, y_tiles, n_tiles, n_tile_size, trial_params, trainable_params, trial_gradient);
+            // Non-finite losses fail the Armijo condition
+            if (trial_loss <= loss + lbfgs_params.armijo * step * slope)
             {
-                grad_l_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
-                    hpx::annotated_function(hpx::unwrapping(&gen_tile_grad_l), "assemble_gradl"),
-                    n_tile_size,
-                    sek_params,
-                    cov_dists);
-                if (i != j)
-                {
-                    grad_l_tiles[j * static_cast<std::size_t>(n_tiles) + i] = hpx::dataflow(
-                        hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_gradl_t"),
-                        n_tile_size,
-                        n_tile_size,
-                        grad_l_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
-                }
+                accepted = true;
+                break;
             }
+            // Minimum of the quadratic interpolation of the loss along the direction, safeguarded to [0.1, 0.5] * step
+            double curvature = trial_loss - loss - slope * step;
+            double next_step = std::isfinite(curvature) ? -0.5 * slope * step * step / curvature : 0.5 * step;
+            step = std::clamp(next_step, 0.1 * step, 0.5 * step);
+        }
+        if (!accepted)
+        {
+            break;
+        }
 
-            if (trainable_params[1])
+        // Curvature pair, skipped if it would break the positive definiteness of the approximation
+        std::vector<double> s(gradient.size());
+        std::vector<double> y(gradient.size());
+        for (std::size_t p = 0; p < gradient.size(); p++)
+        {
+            s[p] = step * direction[p];
+            y[p] = trial_gradient[p] - gradient[p];
+        }
+        if (dot(s, y) > std::numeric_limits<double>::epsilon() * dot(y, y))
+        {
+            s_history.push_back(std::move(s));
+            y_history.push_back(std::move(y));
+            if (s_history.size() > static_cast<std::size_t>(lbfgs_params.history_size))
             {
-                grad_v_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::dataflow(
-                    hpx::annotated_function(hpx::unwrapping(&gen_tile_grad_v), "assemble_gradv"),
-                    n_tile_size,
-                    sek_params,
-                    cov_dists);
-                if (i != j)
-                {
-                    grad_v_tiles[j * static_cast<std::size_t>(n_tiles) + i] = hpx::dataflow(
-                        hpx::annotated_function(hpx::unwrapping(&gen_tile_transpose), "assemble_gradv_t"),
-                        n_tile_size,
-                        n_tile_size,
-                        grad_v_tiles[i * static_cast<std::size_t>(n_tiles) + j]);
-                }
+                s_history.erase(s_history.begin());
+                y_history.erase(y_history.begin());
             }
         }
+
+        sek_params = trial_params;
+        loss = trial_loss;
+        gradient = std::move(trial_gradient);
+        losses.push_back(loss);
     }
+    return losses;
+}
 
-    // Assembly with reallocation -> optimize to only set existing values
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+template <typename T>
+std::vector<std::vector<double>> optimize_multistart(Tiled_distances<T> &distances,
+                                                     const std::vector<double> &training_output,
+                                                     int n_tiles,
+                                                     int n_tile_size,
+                                                     const gprat_hyper::AdamParams &adam_params,
+                                                     std::vector<gprat_hyper::SEKParams> &sek_params_list,
+                                                     std::vector<bool> trainable_params)
+{
+    // Launch asynchronous assembly of output y, the tiles are shared by all optimizations
+    Tiles<T> y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
+
+    // Launch the optimizations as concurrent tasks, their synchronizations only suspend their own task
+    std::vector<hpx::future<std::vector<double>>> runs;
+    runs.reserve(sek_params_list.size());
+    for (auto &sek_params : sek_params_list)
     {
-        alpha_tiles[i] = hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble_tiled"), n_tile_size);
+        runs.push_back(hpx::async(
+            [&distances, &y_tiles, n_tiles, n_tile_size, &adam_params, &sek_params, &trainable_params]()
+            {
+                // Each optimization caches its own exponentiated distances, as they depend on its lengthscale
+                Tiled_distances<T> run_distances{
+                    distances.distance_tiles, Tiles<T>{}, 0.0, distances.n_regressors
+                };
+                return optimize_iterations(run_distances,
+                                           y_tiles,
+                                           n_tiles,
+                                           n_tile_size,
+                                           adam_params,
+                                           sek_params,
+                                           trainable_params,
+                                           0,
+                                           static_cast<std::size_t>(adam_params.opt_iter));
+            }));
     }
 
-    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    std::vector<std::vector<double>> losses;
+    losses.reserve(runs.size());
+    for (auto &run : runs)
     {
-        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+        losses.push_back(run.get());
+    }
+    return losses;
+}
+
+template <typename T>
+std::pair<double, std::vector<double>> compute_loss_and_gradient(Tiled_distances<T> &distances,
+                                                                 const std::vector<double> &training_output,
+                                                                 int n_tiles,
+                                                                 int n_tile_size,
+                                                                 const gprat_hyper::SEKParams &sek_params,
+                                                                 bool unconstrained)
+{
+    // All gradients are computed from the distances, which does not reuse the exponentiated distances
+    const std::vector<bool> all_params = { true, true, true };
+    Tiles<T> y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
+
+    std::vector<double> gradient;
+    double loss = loss_and_gradient(distances, y_tiles, n_tiles, n_tile_size, sek_params, all_params, gradient);
+    if (!unconstrained)
+    {
+        // Chain rule of the softplus: delta(theta)/delta(unconstrained theta) = sigmoid(unconstrained theta)
+        for (std::size_t param_idx = 0; param_idx < gradient.size(); param_idx++)
         {
-            if (i == j)
-            {
-                K_inv_tiles[i * static_cast<std::size_t>(n_tiles) + j] =
-                    hpx::async(hpx::annotated_function(gen_tile_identity, "assemble_identity_matrix"), n_tile_size);
-            }
-            else
-            {
-                K_inv_tiles[i * static_cast<std::size_t>(n_tiles) + j] = hpx::async(
-                    hpx::annotated_function(gen_tile_zeros, "assemble_identity_matrix"), n_tile_size * n_tile_size);
-            }
+            gradient[param_idx] /= compute_sigmoid(to_unconstrained(sek_params.get_param(param_idx), param_idx == 2));
         }
     }
+    return { loss, std::move(gradient) };
+}
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous Cholesky decomposition: K = L * L^T
-    right_looking_cholesky_tiled(K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+// Release the references of a loss evaluation to the tiles of its Cholesky factor once the loss is computed
+template <typename T>
+static void release_loss_tiles(Tiles<T> K_tiles, const hpx::shared_future<double> &)
+{
+    K_tiles.clear();
+}
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous compute K^-1 through L* (L^T * X) = I
-    forward_solve_tiled_matrix(
-        K_tiles,
-        K_inv_tiles,
-        n_tile_size,
-        n_tile_size,
-        static_cast<std::size_t>(n_tiles),
-        static_cast<std::size_t>(n_tiles));
-    backward_solve_tiled_matrix(
-        K_tiles,
-        K_inv_tiles,
-        n_tile_size,
-        n_tile_size,
-        static_cast<std::size_t>(n_tiles),
-        static_cast<std::size_t>(n_tiles));
+template <typename T>
+std::vector<double> evaluate_loss_grid(Tiled_distances<T> &distances,
+                                       const std::vector<double> &training_output,
+                                       int n_tiles,
+                                       int n_tile_size,
+                                       const std::vector<gprat_hyper::SEKParams> &sek_params_list)
+{
+    /*
+     * Algorithm:
+     * for each candidate theta:
+     *   1: Compute lower triangular part of K(theta) with the cached distance
+     *   2: Compute Cholesky factor L of K
+     *   3: Compute alpha = K^-1 * y with the triangular solves L * beta = y and L^T * alpha = beta
+     *   4: Compute negative log likelihood loss
+     * endfor
+     */
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous compute beta = inv(K) * y
-    matrix_vector_tiled(
-        K_inv_tiles,
-        y_tiles,
-        alpha_tiles,
-        n_tile_size,
-        n_tile_size,
-        static_cast<std::size_t>(n_tiles),
-        static_cast<std::size_t>(n_tiles));
+    // All candidates assemble K from the distances, which does not reuse the exponentiated distances
+    const std::vector<bool> all_params = { true, true, true };
+    // Bound the tiles in flight to one candidate per worker thread
+    const std::size_t max_in_flight = std::max<std::size_t>(2, hpx::get_num_worker_threads());
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous loss computation where
-    // loss(theta) = 0.5 * ( log(det(K)) - y^T * K^-1 * y - N * log(2 * pi) )
-    compute_loss_tiled(K_tiles, alpha_tiles, y_tiles, loss_value, n_tile_size, static_cast<std::size_t>(n_tiles));
+    // Launch asynchronous assembly of output y, the tiles are shared by all candidates
+    Tiles<T> y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Launch asynchronous update of the hyperparameters
-    if (trainable_params[0])
-    {  // lengthscale
-        update_hyperparameter_tiled(
-            K_inv_tiles,
-            grad_l_tiles,
-            alpha_tiles,
-            adam_params,
-            sek_params,
-            n_tile_size,
-            static_cast<std::size_t>(n_tiles),
-            static_cast<std::size_t>(iter),
-            0);
+    std::vector<hpx::shared_future<double>> loss_values(sek_params_list.size());
+    std::vector<hpx::future<void>> released;
+    released.reserve(sek_params_list.size());
+    for (std::size_t c = 0; c < sek_params_list.size(); c++)
+    {
+        if (c >= max_in_flight)
+        {
+            released[c - max_in_flight].get();
+        }
+
+        // Tiled future data structures
+        Owned_tiles<T> K_owned_tiles(static_cast<std::size_t>(n_tiles * n_tiles));  // Tiled covariance matrix K
+        Tiles<T> K_tiles(static_cast<std::size_t>(n_tiles * n_tiles));              // Tiled Cholesky factor L
+        Tiles<T> alpha_tiles = y_tiles;                                             // Tiled intermediate solution
+
+        ///////////////////////////////////////////////////////////////////////////
+        // Launch asynchronous assembly of tiled covariance matrix from the cached distances
+        assemble_covariance(distances,
+                            sek_params_list[c],
+                            hpx::make_ready_future(sek_params_list[c]),
+                            all_params,
+                            n_tiles,
+                            n_tile_size,
+                            K_owned_tiles);
+
+        ///////////////////////////////////////////////////////////////////////////
+        // Launch asynchronous Cholesky decomposition: K = L * L^T
+        right_looking_cholesky_tiled(K_owned_tiles, K_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+        ///////////////////////////////////////////////////////////////////////////
+        // Launch asynchronous triangular solve  L * (L^T * alpha) = y
+        forward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+        backward_solve_tiled(K_tiles, alpha_tiles, n_tile_size, static_cast<std::size_t>(n_tiles));
+
+        ///////////////////////////////////////////////////////////////////////////
+        // Launch asynchronous loss computation
+        compute_loss_tiled(
+            K_tiles, alpha_tiles, y_tiles, loss_values[c], n_tile_size, static_cast<std::size_t>(n_tiles));
+
+        ///////////////////////////////////////////////////////////////////////////
+        // Launch asynchronous release of the tiles once the loss is computed
+        released.push_back(hpx::dataflow(
+            hpx::annotated_function(&release_loss_tiles<T>, "release_tiles"), std::move(K_tiles), loss_values[c]));
     }
-    if (trainable_params[1])
-    {  // vertical_lengthscale
-        update_hyperparameter_tiled(
-            K_inv_tiles,
-            grad_v_tiles,
-            alpha_tiles,
-            adam_params,
-            sek_params,
-            n_tile_size,
-            static_cast<std::size_t>(n_tiles),
-            static_cast<std::size_t>(iter),
-            1);
+    for (auto &candidate_released : released)
+    {
+        if (candidate_released.valid())
+        {
+            candidate_released.get();
+        }
     }
-    if (trainable_params[2])
-    {  // noise_variance
-        update_hyperparameter_tiled(
-            K_inv_tiles,
-            Tiled_matrix{},  // no tiled gradient matrix required
-            alpha_tiles,
-            adam_params,
-            sek_params,
-            n_tile_size,
-            static_cast<std::size_t>(n_tiles),
-            static_cast<std::size_t>(iter),
-            2);
+
+    // Synchronize the losses once after all candidates
+    std::vector<double> losses;
+    losses.reserve(loss_values.size());
+    for (const auto &loss_value : loss_values)
+    {
+        losses.push_back(loss_value.get());
     }
-    return loss_value.get();
+    return losses;
+}
+
+template <typename T>
+Tiled_optimizer<T> start_optimizer(std::shared_ptr<Tiled_distances<T>> distances,
+                                   const std::vector<double> &training_output,
+                                   int n_tiles,
+                                   int n_tile_size,
+                                   std::vector<bool> trainable_params)
+{
+    Tiled_optimizer<T> optimizer;
+    optimizer.distances = std::move(distances);
+    optimizer.y_tiles = assemble_output_tiles<T>(training_output, n_tiles, n_tile_size);
+    optimizer.n_tiles = n_tiles;
+    optimizer.n_tile_size = n_tile_size;
+    optimizer.trainable_params = std::move(trainable_params);
+    optimizer.iter = 0;
+    return optimizer;
+}
+
+template <typename T>
+std::vector<double> optimize(Tiled_optimizer<T> &optimizer,
+                             const gprat_hyper::AdamParams &adam_params,
+                             gprat_hyper::SEKParams &sek_params,
+                             int n_iterations)
+{
+    if (n_iterations < 0)
+    {
+        throw std::invalid_argument("The number of iterations must not be negative");
+    }
+    // Continue with the Adam bias correction of the performed iterations
+    std::vector<double> losses = optimize_iterations(*optimizer.distances,
+                                                     optimizer.y_tiles,
+                                                     optimizer.n_tiles,
+                                                     optimizer.n_tile_size,
+                                                     adam_params,
+                                                     sek_params,
+                                                     optimizer.trainable_params,
+                                                     optimizer.iter,
+                                                     static_cast<std::size_t>(n_iterations));
+    optimizer.iter += static_cast<std::size_t>(n_iterations);
+    return losses;
 }
 
+// Explicit instantiations for FP64 and FP32 tiles
+#define GPRAT_INSTANTIATE_GP_FUNCTIONS(T)                                                                              \
+    template std::vector<std::vector<double>> cholesky<T>(const Tiled_factorization<T> &, int);                        \
+    template std::vector<double> predict<T>(                                                                           \
+        const Tiled_factorization<T> &, const std::vector<double> &, const std::vector<double> &, int, int, int, int); \
+    template std::vector<std::vector<double>> predict_with_uncertainty<T>(                                             \
+        const Tiled_factorization<T> &, const std::vector<double> &, const std::vector<double> &, int, int, int, int); \
+    template std::vector<std::vector<double>> predict_with_full_cov<T>(                                                \
+        const Tiled_factorization<T> &, const std::vector<double> &, const std::vector<double> &, int, int, int, int); \
+    template double compute_loss<T>(const Tiled_factorization<T> &, const std::vector<double> &, int, int);            \
+    template Tiled_distances<T> gen_distance_tiles<T>(const std::vector<double> &, int, int, int);                     \
+    template std::vector<double> optimize<T>(Tiled_distances<T> &,                                                     \
+                                             const std::vector<double> &,                                              \
+                                             int,                                                                      \
+                                             int,                                                                      \
+                                             const gprat_hyper::AdamParams &,                                          \
+                                             gprat_hyper::SEKParams &,                                                 \
+                                             std::vector<bool>);                                                       \
+    template double optimize_step<T>(Tiled_distances<T> &,                                                             \
+                                     const std::vector<double> &,                                                      \
+                                     int,                                                                              \
+                                     int,                                                                              \
+                                     gprat_hyper::AdamParams &,                                                        \
+                                     gprat_hyper::SEKParams &,                                                         \
+                                     std::vector<bool>,                                                                \
+                                     int);                                                                             \
+    template std::vector<double> optimize_lbfgs<T>(Tiled_distances<T> &,                                               \
+                                                   const std::vector<double> &,                                        \
+                                                   int,                                                                \
+                                                   int,                                                                \
+                                                   const gprat_hyper::LBFGSParams &,                                   \
+                                                   gprat_hyper::SEKParams &,                                           \
+                                                   std::vector<bool>);                                                 \
+    template std::vector<std::vector<double>> optimize_multistart<T>(Tiled_distances<T> &,                             \
+                                                                     const std::vector<double> &,                      \
+                                                                     int,                                              \
+                                                                     int,                                              \
+                                                                     const gprat_hyper::AdamParams &,                  \
+                                                                     std::vector<gprat_hyper::SEKParams> &,            \
+                                                                     std::vector<bool>);                               \
+    template std::pair<double, std::vector<double>> compute_loss_and_gradient<T>(                                      \
+        Tiled_distances<T> &, const std::vector<double> &, int, int, const gprat_hyper::SEKParams &, bool);            \
+    template std::vector<double> evaluate_loss_grid<T>(                                                                \
+        Tiled_distances<T> &, const std::vector<double> &, int, int, const std::vector<gprat_hyper::SEKParams> &);     \
+    template Tiled_optimizer<T> start_optimizer<T>(                                                                    \
+        std::shared_ptr<Tiled_distances<T>>, const std::vector<double> &, int, int, std::vector<bool>);                \
+    template std::vector<double> optimize<T>(                                                                          \
+        Tiled_optimizer<T> &, const gprat_hyper::AdamParams &, gprat_hyper::SEKParams &, int);
+
+GPRAT_INSTANTIATE_GP_FUNCTIONS(double)
+GPRAT_INSTANTIATE_GP_FUNCTIONS(float)
+
+#undef GPRAT_INSTANTIATE_GP_FUNCTIONS
+
 }  // end of namespace cpu
@@ -0,0 +1,1078 @@
+#include "cpu/gp_iterative.hpp"
+
+#include "cpu/adapter_cblas_fp64.hpp"
+#include "cpu/gp_algorithms.hpp"
+#include "cpu/gp_optimizer.hpp"
+#include "cpu/tiled_algorithms.hpp"
+#include <algorithm>
+#include <cmath>
+#include <hpx/future.hpp>
+#include <limits>
+#include <numbers>
+#include <random>
+
+namespace cpu
+{
+
+///////////////////////////////////////////////////////////////////////////
+// TILE OPERATIONS
+
+// x = x + alpha * p of a tile
+static std::vector<double> update_cg_tile(std::vector<double> x, const std::vector<double> &p, double alpha)
+{
+    for (std::size_t i = 0; i < x.size(); i++)
+    {
+        x[i] += alpha * p[i];
+    }
+    return x;
+}
+
+// b = b + K_row,col * a with the covariance tile regenerated and released within the task
+static std::vector<double> regenerated_covariance_mvm(std::vector<double> b,
+                                                      const std::vector<double> &a,
+                                                      std::size_t row,
+                                                      std::size_t col,
+                                                      std::size_t N,
+                                                      std::size_t n_regressors,
+                                                      const gprat_hyper::SEKParams &sek_params,
+                                                      const std::vector<double> &input)
+{
+    return gemv(gen_tile_covariance<double>(row, col, N, n_regressors, sek_params, input),
+                a,
+                std::move(b),
+                static_cast<int>(N),
+                static_cast<int>(N),
+                Blas_add,
+                Blas_no_trans);
+}
+
+// b = b + cross(K)_row,col * a with the cross-covariance tile regenerated and released within the task
+static std::vector<double> regenerated_cross_covariance_mvm(std::vector<double> b,
+                                                            const std::vector<double> &a,
+                                                            std::size_t row,
+                                                            std::size_t col,
+                                                            std::size_t M,
+                                                            std::size_t N,
+                                                            std::size_t n_regressors,
+                                                            const gprat_hyper::SEKParams &sek_params,
+                                                            const std::vector<double> &test_input,
+                                                            const std::vector<double> &training_input)
+{
+    return gemv(
+        gen_tile_cross_covariance<double>(row, col, M, N, n_regressors, sek_params, test_input, training_input),
+        a,
+        std::move(b),
+        static_cast<int>(M),
+        static_cast<int>(N),
+        Blas_add,
+        Blas_no_trans);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// PRECONDITIONER
+
+/**
+ * @brief Pivot of a step of the pivoted partial Cholesky decomposition
+ */
+struct Cholesky_pivot
+{
+    /** @brief Global index of the pivot */
+    std::size_t index;
+
+    /** @brief Residual diagonal entry of the pivot */
+    double residual;
+
+    /** @brief Entries of the previous columns of the factor in the row of the pivot */
+    std::vector<double> row;
+};
+
+// Select the largest residual diagonal entry as pivot, the panel tiles store the factor transposed as rank x N
+static Cholesky_pivot select_cholesky_pivot(const std::vector<std::vector<double>> &residual_tiles,
+                                            const std::vector<std::vector<double>> &panel_tiles,
+                                            std::size_t N,
+                                            std::size_t step)
+{
+    std::size_t pivot_tile = 0;
+    std::size_t pivot_local = 0;
+    double pivot_residual = -1.0;
+    for (std::size_t t = 0; t < residual_tiles.size(); t++)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            if (residual_tiles[t][i] > pivot_residual)
+            {
+                pivot_tile = t;
+                pivot_local = i;
+                pivot_residual = residual_tiles[t][i];
+            }
+        }
+    }
+    std::vector<double> row(step);
+    for (std::size_t q = 0; q < step; q++)
+    {
+        row[q] = panel_tiles[pivot_tile][q * N + pivot_local];
+    }
+    return Cholesky_pivot{ pivot_tile * N + pivot_local, pivot_residual, std::move(row) };
+}
+
+// Column step of the factor for the rows of a tile: L_i,step = (K_i,p - sum_q L_i,q * L_p,q) / sqrt(d_p)
+static std::vector<double> update_cholesky_panel(std::vector<double> panel,
+                                                 const Cholesky_pivot &pivot,
+                                                 std::size_t tile,
+                                                 std::size_t N,
+                                                 std::size_t step,
+                                                 std::size_t n_regressors,
+                                                 const gprat_hyper::SEKParams &sek_params,
+                                                 const std::vector<double> &input)
+{
+    // Residuals at the level of roundoff indicate that the factor already reproduces the matrix
+    if (pivot.residual <= std::numeric_limits<double>::epsilon() * sek_params.vertical_lengthscale)
+    {
+        return panel;
+    }
+    const double pivot_scale = 1.0 / std::sqrt(pivot.residual);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        double value =
+            compute_covariance_function(tile * N + i, pivot.index, n_regressors, sek_params, input, input);
+        for (std::size_t q = 0; q < step; q++)
+        {
+            value -= panel[q * N + i] * pivot.row[q];
+        }
+        panel[step * N + i] = value * pivot_scale;
+    }
+    return panel;
+}
+
+// Residual diagonal d_i = d_i - L_i,step^2 of a tile
+static std::vector<double> update_cholesky_residual(std::vector<double> residual,
+                                                    const std::vector<double> &panel,
+                                                    std::size_t N,
+                                                    std::size_t step)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        residual[i] = std::max(residual[i] - panel[step * N + i] * panel[step * N + i], 0.0);
+    }
+    return residual;
+}
+
+// Capacitance matrix noise variance * I of the preconditioner before the panel updates
+static std::vector<double> gen_preconditioner_capacitance(std::size_t rank, double noise_variance)
+{
+    std::vector<double> capacitance(rank * rank, 0.0);
+    for (std::size_t q = 0; q < rank; q++)
+    {
+        capacitance[q * rank + q] = noise_variance;
+    }
+    return capacitance;
+}
+
+// z = (r - L * s) / noise variance of a tile with the transposed factor panel L^T
+static std::vector<double> apply_preconditioner_tile(const std::vector<double> &panel,
+                                                     std::vector<double> r,
+                                                     const std::vector<double> &s,
+                                                     std::size_t rank,
+                                                     std::size_t N,
+                                                     double noise_variance)
+{
+    std::vector<double> z =
+        gemv(panel, s, std::move(r), static_cast<int>(rank), static_cast<int>(N), Blas_substract, Blas_trans);
+    for (auto &value : z)
+    {
+        value /= noise_variance;
+    }
+    return z;
+}
+
+/**
+ * @brief Preconditioner P = L * L^T + noise variance * I from a pivoted partial Cholesky decomposition
+ *
+ * With the Woodbury identity P^-1 = (I - L * C^-1 * L^T) / noise variance, where
+ * C = noise variance * I + L^T * L is the rank x rank capacitance matrix.
+ */
+struct Cholesky_preconditioner
+{
+    /** @brief Tiles of the transposed factor L^T, rank x n_tile_size each */
+    Tiles<double> panel_tiles;
+
+    /** @brief Cholesky factor of the capacitance matrix C */
+    hpx::shared_future<std::vector<double>> L_C;
+
+    /** @brief Rank of the factor L */
+    std::size_t rank;
+};
+
+// Launch the asynchronous pivoted partial Cholesky decomposition of the prior covariance matrix
+static Cholesky_preconditioner build_cholesky_preconditioner(const std::vector<double> &training_input,
+                                                             std::size_t n_tiles,
+                                                             std::size_t N,
+                                                             std::size_t n_regressors,
+                                                             const gprat_hyper::SEKParams &sek_params,
+                                                             std::size_t rank)
+{
+    /*
+     * Step q: select the pivot p with the largest residual diagonal entry, compute the column
+     * L_:,q = (K_:,p - L_:,0:q * L_p,0:q^T) / sqrt(d_p) tile by tile from the generated column
+     * K_:,p and update the residual diagonal d = d - L_:,q^2
+     */
+    Cholesky_preconditioner preconditioner;
+    preconditioner.rank = rank;
+    preconditioner.panel_tiles.reserve(n_tiles);
+    Tiles<double> residual_tiles;
+    residual_tiles.reserve(n_tiles);
+    for (std::size_t t = 0; t < n_tiles; t++)
+    {
+        preconditioner.panel_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_preconditioner"), rank * N));
+        residual_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_prior_covariance<double>, "assemble_preconditioner"),
+                       t,
+                       t,
+                       N,
+                       n_regressors,
+                       sek_params,
+                       training_input));
+    }
+
+    for (std::size_t step = 0; step < rank; step++)
+    {
+        hpx::shared_future<Cholesky_pivot> pivot =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&select_cholesky_pivot), "pivoted_cholesky"),
+                          residual_tiles,
+                          preconditioner.panel_tiles,
+                          N,
+                          step);
+        for (std::size_t t = 0; t < n_tiles; t++)
+        {
+            preconditioner.panel_tiles[t] =
+                hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&update_cholesky_panel), "pivoted_cholesky"),
+                              preconditioner.panel_tiles[t],
+                              pivot,
+                              t,
+                              N,
+                              step,
+                              n_regressors,
+                              sek_params,
+                              training_input);
+            residual_tiles[t] =
+                hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&update_cholesky_residual), "pivoted_cholesky"),
+                              residual_tiles[t],
+                              preconditioner.panel_tiles[t],
+                              N,
+                              step);
+        }
+    }
+
+    // SYRK: C = noise variance * I + sum_t L_t^T * L_t, then its Cholesky decomposition
+    hpx::shared_future<std::vector<double>> capacitance =
+        hpx::async(hpx::annotated_function(&gen_preconditioner_capacitance, "assemble_preconditioner"),
+                   rank,
+                   sek_params.noise_variance);
+    for (std::size_t t = 0; t < n_tiles; t++)
+    {
+        capacitance = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&syrk_panel_add), "pivoted_cholesky"),
+                                    capacitance,
+                                    preconditioner.panel_tiles[t],
+                                    static_cast<int>(rank),
+                                    static_cast<int>(N));
+    }
+    preconditioner.L_C = hpx::dataflow(
+        hpx::annotated_function(hpx::unwrapping(&potrf), "pivoted_cholesky"), capacitance, static_cast<int>(rank));
+    return preconditioner;
+}
+
+// Launch the asynchronous application z = P^-1 * r of the preconditioner
+static Tiles<double> apply_cholesky_preconditioner(const Cholesky_preconditioner &preconditioner,
+                                                   const Tiles<double> &r_tiles,
+                                                   std::size_t N,
+                                                   double noise_variance)
+{
+    const int rank = static_cast<int>(preconditioner.rank);
+    // GEMV: w = L^T * r, then s = C^-1 * w
+    hpx::shared_future<std::vector<double>> w =
+        hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "apply_preconditioner"), preconditioner.rank);
+    for (std::size_t t = 0; t < r_tiles.size(); t++)
+    {
+        w = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv), "apply_preconditioner"),
+                          preconditioner.panel_tiles[t],
+                          r_tiles[t],
+                          w,
+                          rank,
+                          static_cast<int>(N),
+                          Blas_add,
+                          Blas_no_trans);
+    }
+    hpx::shared_future<std::vector<double>> s =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "apply_preconditioner"),
+                      preconditioner.L_C,
+                      hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "apply_preconditioner"),
+                                    preconditioner.L_C,
+                                    w,
+                                    rank,
+                                    Blas_no_trans),
+                      rank,
+                      Blas_trans);
+
+    Tiles<double> z_tiles;
+    z_tiles.reserve(r_tiles.size());
+    for (std::size_t t = 0; t < r_tiles.size(); t++)
+    {
+        z_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&apply_preconditioner_tile), "apply_preconditioner"),
+                          preconditioner.panel_tiles[t],
+                          r_tiles[t],
+                          s,
+                          preconditioner.rank,
+                          N,
+                          noise_variance));
+    }
+    return z_tiles;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// CONJUGATE GRADIENTS
+
+// Launch the asynchronous product q = K * p, either with the stored lower triangle of K or with tiles regenerated
+// in one accumulation chain per tile row, such that at most one tile per row is alive
+static Tiles<double> covariance_mvm(const Tiles<double> &K_tiles,
+                                    const Tiles<double> &p_tiles,
+                                    const std::vector<double> &training_input,
+                                    std::size_t n_tiles,
+                                    std::size_t N,
+                                    std::size_t n_regressors,
+                                    const gprat_hyper::SEKParams &sek_params)
+{
+    Tiles<double> q_tiles;
+    q_tiles.reserve(n_tiles);
+    for (std::size_t i = 0; i < n_tiles; i++)
+    {
+        q_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), N));
+    }
+    if (!K_tiles.empty())
+    {
+        symmetric_matrix_vector_tiled(K_tiles, p_tiles, q_tiles, static_cast<int>(N), n_tiles);
+        return q_tiles;
+    }
+    for (std::size_t i = 0; i < n_tiles; i++)
+    {
+        for (std::size_t j = 0; j < n_tiles; j++)
+        {
+            q_tiles[i] =
+                hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&regenerated_covariance_mvm), "pcg_mvm"),
+                              q_tiles[i],
+                              p_tiles[j],
+                              i,
+                              j,
+                              N,
+                              n_regressors,
+                              sek_params,
+                              training_input);
+        }
+    }
+    return q_tiles;
+}
+
+// Dot product of two tiled vectors
+static double dot_tiled(const Tiles<double> &a_tiles, const Tiles<double> &b_tiles, std::size_t N)
+{
+    std::vector<hpx::shared_future<double>> dot_tiles;
+    dot_tiles.reserve(a_tiles.size());
+    for (std::size_t t = 0; t < a_tiles.size(); t++)
+    {
+        dot_tiles.push_back(hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&dot), "pcg_dot"), a_tiles[t], b_tiles[t], static_cast<int>(N)));
+    }
+    double result = 0.0;
+    for (const auto &dot_tile : dot_tiles)
+    {
+        result += dot_tile.get();
+    }
+    return result;
+}
+
+// Launch the asynchronous update x = x + alpha * p of a tiled vector
+static void update_cg_tiled(Tiles<double> &x_tiles, const Tiles<double> &p_tiles, double alpha)
+{
+    for (std::size_t t = 0; t < x_tiles.size(); t++)
+    {
+        x_tiles[t] = hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&update_cg_tile), "pcg_update"), x_tiles[t], p_tiles[t], alpha);
+    }
+}
+
+std::pair<std::vector<double>, int> solve_pcg(const std::vector<double> &training_input,
+                                              const std::vector<double> &training_output,
+                                              int n_tiles,
+                                              int n_tile_size,
+                                              int n_regressors,
+                                              const gprat_hyper::SEKParams &sek_params,
+                                              const gprat_hyper::PCGParams &pcg_params)
+{
+    /*
+     * Preconditioned conjugate gradients for K * alpha = y starting at alpha = 0:
+     * r = y, z = P^-1 * r, p = z
+     * repeat: q = K * p, a = r^T * z / p^T * q, alpha = alpha + a * p, r = r - a * q,
+     *         z = P^-1 * r, b = r_new^T * z_new / r^T * z, p = z + b * p
+     * until ||r|| <= tolerance * ||y||
+     */
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t rank = std::min(static_cast<std::size_t>(std::max(pcg_params.preconditioner_rank, 0)),
+                                      static_cast<std::size_t>(n_tiles) * N);
+
+    // Stored lower triangle of K unless the tiles are regenerated for every product
+    Tiles<double> K_tiles;
+    if (!pcg_params.regenerate_tiles)
+    {
+        K_tiles.resize(static_cast<std::size_t>(n_tiles) * static_cast<std::size_t>(n_tiles));
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+        {
+            for (std::size_t j = 0; j <= i; j++)
+            {
+                K_tiles[i * static_cast<std::size_t>(n_tiles) + j] =
+                    hpx::async(hpx::annotated_function(gen_tile_covariance<double>, "assemble_tiled_K"),
+                               i,
+                               j,
+                               N,
+                               R,
+                               sek_params,
+                               training_input);
+            }
+        }
+    }
+
+    Cholesky_preconditioner preconditioner;
+    if (rank > 0)
+    {
+        preconditioner = build_cholesky_preconditioner(
+            training_input, static_cast<std::size_t>(n_tiles), N, R, sek_params, rank);
+    }
+    // z = P^-1 * r, or z = r without preconditioner
+    auto precondition = [&](const Tiles<double> &r_tiles)
+    {
+        return rank > 0 ? apply_cholesky_preconditioner(preconditioner, r_tiles, N, sek_params.noise_variance)
+                        : r_tiles;
+    };
+
+    Tiles<double> x_tiles;
+    Tiles<double> r_tiles;
+    x_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    r_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t t = 0; t < static_cast<std::size_t>(n_tiles); t++)
+    {
+        x_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), N));
+        r_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_tiled"), t, N, training_output));
+    }
+    const double y_norm = std::sqrt(dot_tiled(r_tiles, r_tiles, N));
+    Tiles<double> z_tiles = precondition(r_tiles);
+    Tiles<double> p_tiles = z_tiles;
+    double rz = dot_tiled(r_tiles, z_tiles, N);
+
+    int iter = 0;
+    while (iter < pcg_params.max_iter && std::sqrt(dot_tiled(r_tiles, r_tiles, N)) > pcg_params.tolerance * y_norm)
+    {
+        Tiles<double> q_tiles = covariance_mvm(
+            K_tiles, p_tiles, training_input, static_cast<std::size_t>(n_tiles), N, R, sek_params);
+        const double a = rz / dot_tiled(p_tiles, q_tiles, N);
+        update_cg_tiled(x_tiles, p_tiles, a);
+        update_cg_tiled(r_tiles, q_tiles, -a);
+        z_tiles = precondition(r_tiles);
+        const double rz_new = dot_tiled(r_tiles, z_tiles, N);
+        // p = z + b * p
+        const double b = rz_new / rz;
+        for (std::size_t t = 0; t < static_cast<std::size_t>(n_tiles); t++)
+        {
+            p_tiles[t] = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&update_cg_tile), "pcg_update"), z_tiles[t], p_tiles[t], b);
+        }
+        rz = rz_new;
+        iter++;
+    }
+
+    std::vector<double> alpha;
+    alpha.reserve(static_cast<std::size_t>(n_tiles) * N);
+    for (std::size_t t = 0; t < static_cast<std::size_t>(n_tiles); t++)
+    {
+        const std::vector<double> &x = x_tiles[t].get();
+        alpha.insert(alpha.end(), x.begin(), x.end());
+    }
+    return { alpha, iter };
+}
+
+///////////////////////////////////////////////////////////////////////////
+// PREDICTION
+
+std::vector<double> predict_pcg(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const gprat_hyper::PCGParams &pcg_params)
+{
+    // Prediction: hat(y) = cross(K) * alpha with the cross-covariance tiles regenerated row by row
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t M = static_cast<std::size_t>(m_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+
+    const std::vector<double> alpha =
+        solve_pcg(training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, pcg_params).first;
+
+    Tiles<double> alpha_tiles;
+    alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+    {
+        alpha_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_tiled"), j, N, alpha));
+    }
+
+    Tiles<double> prediction_tiles;
+    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        hpx::shared_future<std::vector<double>> prediction =
+            hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), M);
+        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+        {
+            prediction = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&regenerated_cross_covariance_mvm), "predict_pcg"),
+                prediction,
+                alpha_tiles[j],
+                i,
+                j,
+                M,
+                N,
+                R,
+                sek_params,
+                test_input,
+                training_input);
+        }
+        prediction_tiles.push_back(prediction);
+    }
+
+    std::vector<double> prediction_result;
+    prediction_result.reserve(static_cast<std::size_t>(m_tiles) * M);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        const std::vector<double> &prediction = prediction_tiles[i].get();
+        prediction_result.insert(prediction_result.end(), prediction.begin(), prediction.end());
+    }
+    return prediction_result;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// BLOCK CONJUGATE GRADIENTS
+
+// Block of right-hand sides [y, z_1, ..., z_p] of a tile, N x (p + 1)
+static std::vector<double> gen_tile_block_rhs(std::size_t row,
+                                              std::size_t N,
+                                              std::size_t n_probes,
+                                              const std::vector<double> &output,
+                                              const std::vector<double> &probes)
+{
+    const std::size_t S = n_probes + 1;
+    std::vector<double> block(N * S);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        const std::size_t i_global = N * row + i;
+        block[i * S] = output[i_global];
+        std::copy(probes.begin() + static_cast<std::ptrdiff_t>(i_global * n_probes),
+                  probes.begin() + static_cast<std::ptrdiff_t>((i_global + 1) * n_probes),
+                  block.begin() + static_cast<std::ptrdiff_t>(i * S + 1));
+    }
+    return block;
+}
+
+// Column-wise dot products of two blocks of a tile
+static std::vector<double>
+dot_block_columns(const std::vector<double> &A, const std::vector<double> &B, std::size_t N, std::size_t S)
+{
+    std::vector<double> result(S, 0.0);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t c = 0; c < S; c++)
+        {
+            result[c] += A[i * S + c] * B[i * S + c];
+        }
+    }
+    return result;
+}
+
+// X = X + P * diag(coefficients) of a block tile
+static std::vector<double> update_block_tile(std::vector<double> X,
+                                             const std::vector<double> &P,
+                                             const std::vector<double> &coefficients,
+                                             std::size_t N,
+                                             std::size_t S)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t c = 0; c < S; c++)
+        {
+            X[i * S + c] += coefficients[c] * P[i * S + c];
+        }
+    }
+    return X;
+}
+
+// B = B + K_row,col * A for a block with the covariance tile regenerated and released within the task
+static std::vector<double> regenerated_covariance_block_mvm(std::vector<double> B,
+                                                            const std::vector<double> &A,
+                                                            std::size_t row,
+                                                            std::size_t col,
+                                                            std::size_t N,
+                                                            std::size_t S,
+                                                            std::size_t n_regressors,
+                                                            const gprat_hyper::SEKParams &sek_params,
+                                                            const std::vector<double> &input)
+{
+    return gemm_multi_vector(gen_tile_covariance<double>(row, col, N, n_regressors, sek_params, input),
+                             A,
+                             std::move(B),
+                             static_cast<int>(N),
+                             static_cast<int>(S),
+                             Blas_no_trans);
+}
+
+// Launch the asynchronous product Q = K * P for a block of S vectors, either with the stored lower triangle of K
+// or with tiles regenerated in one accumulation chain per tile row
+static Tiles<double> covariance_block_mvm(const Tiles<double> &K_tiles,
+                                          const Tiles<double> &P_tiles,
+                                          const std::vector<double> &training_input,
+                                          std::size_t n_tiles,
+                                          std::size_t N,
+                                          std::size_t S,
+                                          std::size_t n_regressors,
+                                          const gprat_hyper::SEKParams &sek_params)
+{
+    Tiles<double> Q_tiles;
+    Q_tiles.reserve(n_tiles);
+    for (std::size_t i = 0; i < n_tiles; i++)
+    {
+        hpx::shared_future<std::vector<double>> Q =
+            hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), N * S);
+        for (std::size_t j = 0; j < n_tiles; j++)
+        {
+            if (K_tiles.empty())
+            {
+                Q = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(&regenerated_covariance_block_mvm), "block_cg_mvm"),
+                    Q,
+                    P_tiles[j],
+                    i,
+                    j,
+                    N,
+                    S,
+                    n_regressors,
+                    sek_params,
+                    training_input);
+                continue;
+            }
+            // GEMM: Q_i = Q_i + K_ij * P_j with the stored tile K_ij or K_ji^T
+            Q = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemm_multi_vector), "block_cg_mvm"),
+                              j <= i ? K_tiles[i * n_tiles + j] : K_tiles[j * n_tiles + i],
+                              P_tiles[j],
+                              Q,
+                              static_cast<int>(N),
+                              static_cast<int>(S),
+                              j <= i ? Blas_no_trans : Blas_trans);
+        }
+        Q_tiles.push_back(Q);
+    }
+    return Q_tiles;
+}
+
+// Column-wise dot products of two tiled blocks
+static std::vector<double>
+dot_block_tiled(const Tiles<double> &A_tiles, const Tiles<double> &B_tiles, std::size_t N, std::size_t S)
+{
+    std::vector<hpx::shared_future<std::vector<double>>> dot_tiles;
+    dot_tiles.reserve(A_tiles.size());
+    for (std::size_t t = 0; t < A_tiles.size(); t++)
+    {
+        dot_tiles.push_back(hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&dot_block_columns), "block_cg_dot"),
+                                          A_tiles[t],
+                                          B_tiles[t],
+                                          N,
+                                          S));
+    }
+    std::vector<double> result(S, 0.0);
+    for (const auto &dot_tile : dot_tiles)
+    {
+        const std::vector<double> &dots = dot_tile.get();
+        for (std::size_t c = 0; c < S; c++)
+        {
+            result[c] += dots[c];
+        }
+    }
+    return result;
+}
+
+// Launch the asynchronous update X = X + P * diag(coefficients) of a tiled block
+static void update_block_tiled(Tiles<double> &X_tiles,
+                               const Tiles<double> &P_tiles,
+                               const std::vector<double> &coefficients,
+                               std::size_t N,
+                               std::size_t S)
+{
+    for (std::size_t t = 0; t < X_tiles.size(); t++)
+    {
+        X_tiles[t] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&update_block_tile), "block_cg_update"),
+                                   X_tiles[t],
+                                   P_tiles[t],
+                                   coefficients,
+                                   N,
+                                   S);
+    }
+}
+
+// Quadrature estimate of z^T * log(K) * z = ||z||^2 * e_1^T * log(T) * e_1, where the Lanczos tridiagonal matrix T
+// follows from the conjugate gradient step lengths a_k and direction updates b_k of the right-hand side z
+static double
+lanczos_log_quadrature(const std::vector<double> &cg_a, const std::vector<double> &cg_b, double squared_norm)
+{
+    /*
+     * T_00 = 1 / a_0, T_kk = 1 / a_k + b_k-1 / a_k-1, T_k,k+1 = sqrt(b_k) / a_k
+     * e_1^T * log(T) * e_1 = sum_k Z_0k^2 * log(lambda_k) with T = Z * diag(lambda) * Z^T
+     */
+    const std::size_t m = cg_a.size();
+    if (m == 0)
+    {
+        return 0.0;
+    }
+    std::vector<double> diagonal(m);
+    std::vector<double> off_diagonal(std::max<std::size_t>(m, 2) - 1, 0.0);
+    for (std::size_t k = 0; k < m; k++)
+    {
+        diagonal[k] = 1.0 / cg_a[k] + (k > 0 ? cg_b[k - 1] / cg_a[k - 1] : 0.0);
+        if (k + 1 < m)
+        {
+            off_diagonal[k] = std::sqrt(cg_b[k]) / cg_a[k];
+        }
+    }
+    const std::vector<double> eigen = stev(diagonal, off_diagonal, static_cast<int>(m));
+    double quadrature = 0.0;
+    for (std::size_t k = 0; k < m; k++)
+    {
+        quadrature += eigen[m + k] * eigen[m + k] * std::log(eigen[k]);
+    }
+    return squared_norm * quadrature;
+}
+
+/**
+ * @brief Solutions of the block conjugate gradients for the stochastic loss and its gradients
+ */
+struct Stochastic_solve
+{
+    /** @brief Tiled right-hand sides [y, z_1, ..., z_p] */
+    Tiles<double> B_tiles;
+
+    /** @brief Tiled solutions [u_0, u_1, ..., u_p] of K * U = B */
+    Tiles<double> X_tiles;
+
+    /** @brief Estimated loss */
+    double loss;
+};
+
+// Solve K * U = [y, z_1, ..., z_p] with block conjugate gradients and estimate the loss
+static Stochastic_solve solve_stochastic(const std::vector<double> &training_input,
+                                         const std::vector<double> &training_output,
+                                         int n_tiles,
+                                         int n_tile_size,
+                                         int n_regressors,
+                                         const gprat_hyper::SEKParams &sek_params,
+                                         const gprat_hyper::StochasticParams &stochastic_params)
+{
+    /*
+     * Conjugate gradients for every column c of the block, with one batched product per iteration:
+     * Q = K * P, a_c = r_c^T * r_c / p_c^T * q_c, x_c = x_c + a_c * p_c, r_c = r_c - a_c * q_c,
+     * b_c = r_c,new^T * r_c,new / r_c^T * r_c, p_c = r_c + b_c * p_c
+     * Converged columns keep their solutions, a_c and b_c of the probes are the Lanczos coefficients.
+     * Loss: 0.5 / N * ( y^T * u_0 + log(det(K)) + N * log(2 * pi) ) with
+     * log(det(K)) ~ 1 / p * sum_c z_c^T * log(K) * z_c
+     */
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t n_samples = static_cast<std::size_t>(n_tiles) * N;
+    const std::size_t n_probes = static_cast<std::size_t>(std::max(stochastic_params.n_probes, 1));
+    const std::size_t S = n_probes + 1;
+
+    // Rademacher probes, drawn for all samples such that they do not depend on the tiling
+    std::mt19937_64 generator(stochastic_params.seed);
+    std::vector<double> probes(n_samples * n_probes);
+    for (auto &value : probes)
+    {
+        value = (generator() & 1) ? 1.0 : -1.0;
+    }
+
+    // Stored lower triangle of K unless the tiles are regenerated for every product
+    Tiles<double> K_tiles;
+    if (!stochastic_params.regenerate_tiles)
+    {
+        K_tiles.resize(static_cast<std::size_t>(n_tiles) * static_cast<std::size_t>(n_tiles));
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+        {
+            for (std::size_t j = 0; j <= i; j++)
+            {
+                K_tiles[i * static_cast<std::size_t>(n_tiles) + j] =
+                    hpx::async(hpx::annotated_function(gen_tile_covariance<double>, "assemble_tiled_K"),
+                               i,
+                               j,
+                               N,
+                               R,
+                               sek_params,
+                               training_input);
+            }
+        }
+    }
+
+    Stochastic_solve solve;
+    solve.B_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    solve.X_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t t = 0; t < static_cast<std::size_t>(n_tiles); t++)
+    {
+        solve.B_tiles.push_back(hpx::async(
+            hpx::annotated_function(&gen_tile_block_rhs, "assemble_tiled"), t, N, n_probes, training_output, probes));
+        solve.X_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), N * S));
+    }
+    Tiles<double> R_tiles = solve.B_tiles;
+    Tiles<double> P_tiles = solve.B_tiles;
+    std::vector<double> rr = dot_block_tiled(R_tiles, R_tiles, N, S);
+    std::vector<double> rhs_norms(S);
+    std::vector<bool> active(S);
+    for (std::size_t c = 0; c < S; c++)
+    {
+        rhs_norms[c] = std::sqrt(rr[c]);
+        active[c] = rr[c] > 0.0;
+    }
+    std::vector<std::vector<double>> cg_a(S);
+    std::vector<std::vector<double>> cg_b(S);
+
+    for (int iter = 0; iter < stochastic_params.max_iter; iter++)
+    {
+        if (std::none_of(active.begin(), active.end(), [](bool is_active) { return is_active; }))
+        {
+            break;
+        }
+        Tiles<double> Q_tiles = covariance_block_mvm(
+            K_tiles, P_tiles, training_input, static_cast<std::size_t>(n_tiles), N, S, R, sek_params);
+        const std::vector<double> pq = dot_block_tiled(P_tiles, Q_tiles, N, S);
+        std::vector<double> a(S, 0.0);
+        std::vector<double> minus_a(S, 0.0);
+        for (std::size_t c = 0; c < S; c++)
+        {
+            if (active[c])
+            {
+                a[c] = rr[c] / pq[c];
+                minus_a[c] = -a[c];
+            }
+        }
+        update_block_tiled(solve.X_tiles, P_tiles, a, N, S);
+        update_block_tiled(R_tiles, Q_tiles, minus_a, N, S);
+        const std::vector<double> rr_new = dot_block_tiled(R_tiles, R_tiles, N, S);
+        std::vector<double> b(S, 0.0);
+        for (std::size_t c = 0; c < S; c++)
+        {
+            if (active[c])
+            {
+                b[c] = rr_new[c] / rr[c];
+                cg_a[c].push_back(a[c]);
+                cg_b[c].push_back(b[c]);
+                active[c] = std::sqrt(rr_new[c]) > stochastic_params.tolerance * rhs_norms[c];
+            }
+        }
+        // P = R + P * diag(b)
+        for (std::size_t t = 0; t < static_cast<std::size_t>(n_tiles); t++)
+        {
+            P_tiles[t] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&update_block_tile), "block_cg_update"),
+                                       R_tiles[t],
+                                       P_tiles[t],
+                                       b,
+                                       N,
+                                       S);
+        }
+        rr = rr_new;
+    }
+
+    // y^T * u_0 and the stochastic Lanczos quadrature of log(det(K))
+    const double data_fit = dot_block_tiled(solve.B_tiles, solve.X_tiles, N, S)[0];
+    double log_det = 0.0;
+    for (std::size_t c = 1; c < S; c++)
+    {
+        log_det += lanczos_log_quadrature(cg_a[c], cg_b[c], static_cast<double>(n_samples));
+    }
+    log_det /= static_cast<double>(n_probes);
+    const double n = static_cast<double>(n_samples);
+    solve.loss = 0.5 * (data_fit + log_det + n * std::log(2.0 * std::numbers::pi)) / n;
+    return solve;
+}
+
+// Symmetrized Hutchinson estimate 0.5 / p * (U_row * Z_col^T + Z_row * U_col^T) of a tile of K^-1 from the block
+// solutions U = [u_1, ..., u_p] and probes Z = [z_1, ..., z_p]
+static std::vector<double> gen_tile_inverse_estimate(const std::vector<double> &X_row,
+                                                     const std::vector<double> &B_row,
+                                                     const std::vector<double> &X_col,
+                                                     const std::vector<double> &B_col,
+                                                     std::size_t N,
+                                                     std::size_t n_probes)
+{
+    const std::size_t S = n_probes + 1;
+    // Panels of the probe columns, N x p
+    auto probe_panel = [&](const std::vector<double> &block)
+    {
+        std::vector<double> panel(N * n_probes);
+        for (std::size_t i = 0; i < N; i++)
+        {
+            std::copy(block.begin() + static_cast<std::ptrdiff_t>(i * S + 1),
+                      block.begin() + static_cast<std::ptrdiff_t>((i + 1) * S),
+                      panel.begin() + static_cast<std::ptrdiff_t>(i * n_probes));
+        }
+        return panel;
+    };
+    const int n = static_cast<int>(N);
+    const int p = static_cast<int>(n_probes);
+    std::vector<double> estimate =
+        gemm_panel_add(probe_panel(X_row), probe_panel(B_col), std::vector<double>(N * N, 0.0), n, n, p);
+    estimate = gemm_panel_add(probe_panel(B_row), probe_panel(X_col), std::move(estimate), n, n, p);
+    for (auto &value : estimate)
+    {
+        value *= 0.5 / static_cast<double>(n_probes);
+    }
+    return estimate;
+}
+
+// Solution u_0 = K^-1 * y of a tile of the block solutions
+static std::vector<double> extract_block_solution(const std::vector<double> &X, std::size_t N, std::size_t S)
+{
+    std::vector<double> solution(N);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        solution[i] = X[i * S];
+    }
+    return solution;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// STOCHASTIC LOSS AND GRADIENT
+
+std::pair<double, std::vector<double>>
+compute_stochastic_loss_and_gradient(const std::vector<double> &training_input,
+                                     const std::vector<double> &training_output,
+                                     int n_tiles,
+                                     int n_tile_size,
+                                     int n_regressors,
+                                     const gprat_hyper::SEKParams &sek_params,
+                                     const gprat_hyper::StochasticParams &stochastic_params)
+{
+    /*
+     * Gradient 0.5 / N * tr(W * dK) with W = K^-1 - u_0 * u_0^T as for the Cholesky decomposition, where the tiles
+     * of K^-1 are replaced by the Hutchinson estimate 1 / p * sum_c u_c * z_c^T
+     */
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t n_probes = static_cast<std::size_t>(std::max(stochastic_params.n_probes, 1));
+    const std::size_t S = n_probes + 1;
+
+    Stochastic_solve solve = solve_stochastic(
+        training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, stochastic_params);
+
+    Tiles<double> u_tiles;
+    u_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t t = 0; t < static_cast<std::size_t>(n_tiles); t++)
+    {
+        u_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&extract_block_solution), "gradient_stochastic"),
+                          solve.X_tiles[t],
+                          N,
+                          S));
+    }
+
+    std::vector<hpx::shared_future<std::vector<double>>> gradient_tiles;
+    gradient_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        // Gradients w.r.t. lengthscale, vertical_lengthscale and noise_variance accumulated over the tile row
+        hpx::shared_future<std::vector<double>> row_gradient = hpx::make_ready_future(std::vector<double>(3, 0.0));
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            row_gradient = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&compute_gradient_tile<double>), "gradient_stochastic"),
+                row_gradient,
+                hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(&gen_tile_inverse_estimate), "gradient_stochastic"),
+                    solve.X_tiles[i],
+                    solve.B_tiles[i],
+                    solve.X_tiles[j],
+                    solve.B_tiles[j],
+                    N,
+                    n_probes),
+                u_tiles[i],
+                u_tiles[j],
+                hpx::async(hpx::annotated_function(&gen_tile_lagged_distance, "assemble_tiled"),
+                           i,
+                           j,
+                           N,
+                           N,
+                           R,
+                           training_input,
+                           training_input),
+                N,
+                sek_params,
+                false,
+                i == j);
+        }
+        gradient_tiles.push_back(row_gradient);
+    }
+
+    hpx::shared_future<std::vector<double>> gradient =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_gradients), "gradient_stochastic"),
+                      gradient_tiles,
+                      N,
+                      static_cast<std::size_t>(n_tiles));
+    return { solve.loss, gradient.get() };
+}
+
+double compute_stochastic_loss(const std::vector<double> &training_input,
+                               const std::vector<double> &training_output,
+                               int n_tiles,
+                               int n_tile_size,
+                               int n_regressors,
+                               const gprat_hyper::SEKParams &sek_params,
+                               const gprat_hyper::StochasticParams &stochastic_params)
+{
+    return solve_stochastic(
+               training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, stochastic_params)
+        .loss;
+}
+
+std::vector<double> optimize_stochastic(const std::vector<double> &training_input,
+                                        const std::vector<double> &training_output,
+                                        int n_tiles,
+                                        int n_tile_size,
+                                        int n_regressors,
+                                        const gprat_hyper::AdamParams &adam_params,
+                                        gprat_hyper::SEKParams &sek_params,
+                                        const std::vector<bool> &trainable_params,
+                                        const gprat_hyper::StochasticParams &stochastic_params)
+{
+    std::vector<double> losses;
+    losses.reserve(static_cast<std::size_t>(adam_params.opt_iter));
+    gprat_hyper::StochasticParams iteration_params = stochastic_params;
+    for (std::size_t iter = 0; iter < static_cast<std::size_t>(adam_params.opt_iter); iter++)
+    {
+        // New probes per iteration
+        iteration_params.seed = stochastic_params.seed + static_cast<unsigned int>(iter);
+        auto [loss, gradient] = compute_stochastic_loss_and_gradient(
+            training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, iteration_params);
+        losses.push_back(loss);
+        sek_params = update_hyperparameters(gradient, adam_params, sek_params, trainable_params, iter);
+    }
+    return losses;
+}
+
+}  // end of namespace cpu
@@ -1,8 +1,12 @@
 #include "cpu/gp_optimizer.hpp"
 
 #include "cpu/adapter_cblas_fp64.hpp"
+#include "cpu/gp_algorithms.hpp"
+#include "cpu/vectorized_exp.hpp"
+#include <cmath>
 #include <numbers>
 #include <numeric>
+#include <type_traits>
 
 namespace cpu
 {
@@ -40,11 +44,10 @@ double compute_sigmoid(double parameter) { return 1.0 / (1.0 + exp(-parameter));
 double compute_covariance_distance(std::size_t i_global,
                                    std::size_t j_global,
                                    std::size_t n_regressors,
-                                   const gprat_hyper::SEKParams &sek_params,
                                    const std::vector<double> &i_input,
                                    const std::vector<double> &j_input)
 {
-    // -0.5*lengthscale^2*(z_i-z_j)^2
+    // (z_i-z_j)^2
     double distance = 0.0;
     double z_ik_minus_z_jk;
 
@@ -53,100 +56,147 @@ double compute_covariance_distance(std::size_t i_global,
         z_ik_minus_z_jk = i_input[i_global + k] - j_input[j_global + k];
         distance += z_ik_minus_z_jk * z_ik_minus_z_jk;
     }
-    return -0.5 / (sek_params.lengthscale * sek_params.lengthscale) * distance;
+    return distance;
 }
 
-std::vector<double> gen_tile_distance(
-    std::size_t row,
-    std::size_t col,
-    std::size_t N,
-    std::size_t n_regressors,
-    const gprat_hyper::SEKParams &sek_params,
-    const std::vector<double> &input)
+template <typename T>
+std::vector<T> gen_tile_distance(
+    std::size_t row, std::size_t col, std::size_t N, std::size_t n_regressors, const std::vector<double> &input)
 {
-    std::size_t i_global, j_global;
-    // Preallocate memory
-    std::vector<double> tile;
-    tile.reserve(N * N);
-    for (std::size_t i = 0; i < N; i++)
+    std::vector<double> distance = gen_tile_lagged_distance(row, col, N, N, n_regressors, input, input);
+    if constexpr (std::is_same_v<T, double>)
     {
-        i_global = N * row + i;
-        for (std::size_t j = 0; j < N; j++)
-        {
-            j_global = N * col + j;
-            // compute covariance function
-            tile.push_back(compute_covariance_distance(i_global, j_global, n_regressors, sek_params, input, input));
-        }
+        return distance;
+    }
+    else
+    {
+        // Distances are accumulated in FP64 and rounded once
+        return std::vector<T>(distance.begin(), distance.end());
+    }
+}
+
+template <typename T>
+std::vector<T>
+gen_tile_exp_distance(std::size_t N, const gprat_hyper::SEKParams &sek_params, const std::vector<T> &distance)
+{
+    // Preallocate required memory
+    std::vector<T> tile(N * N);
+    const double scale = -0.5 / (sek_params.lengthscale * sek_params.lengthscale);
+    for (std::size_t i = 0; i < N * N; i++)
+    {
+        // exp(-0.5*lengthscale^2*(z_i-z_j)^2)
+        tile[i] = static_cast<T>(vectorized_exp(scale * distance[i]));
     }
     return tile;
 }
 
-std::vector<double> gen_tile_covariance_with_distance(
+template <typename T>
+std::vector<T> gen_tile_covariance_with_distance(
+    std::vector<T> tile,
     std::size_t row,
     std::size_t col,
     std::size_t N,
     const gprat_hyper::SEKParams &sek_params,
-    const std::vector<double> &distance)
+    const std::vector<T> &distance)
 {
-    std::size_t i_global, j_global;
-    double covariance;
-    // Preallocate required memory
-    std::vector<double> tile;
-    tile.reserve(N * N);
-    for (std::size_t i = 0; i < N; i++)
+    tile.resize(N * N);
+    const double scale = -0.5 / (sek_params.lengthscale * sek_params.lengthscale);
+    // compute covariance function
+    for (std::size_t i = 0; i < N * N; i++)
+    {
+        tile[i] = static_cast<T>(sek_params.vertical_lengthscale * vectorized_exp(scale * distance[i]));
+    }
+    if (row == col)
     {
-        i_global = N * row + i;
-        for (std::size_t j = 0; j < N; j++)
+        // noise variance on diagonal
+        for (std::size_t i = 0; i < N; i++)
         {
-            j_global = N * col + j;
-            // compute covariance function
-            covariance = sek_params.vertical_lengthscale * exp(distance[i * N + j]);
-            if (i_global == j_global)
-            {
-                // noise variance on diagonal
-                covariance += sek_params.noise_variance;
-            }
-            tile.push_back(covariance);
+            tile[i * N + i] += static_cast<T>(sek_params.noise_variance);
         }
     }
     return tile;
 }
 
-std::vector<double>
-gen_tile_grad_v(std::size_t N, const gprat_hyper::SEKParams &sek_params, const std::vector<double> &distance)
+template <typename T>
+std::vector<T> gen_tile_covariance_with_exp_distance(
+    std::vector<T> tile,
+    std::size_t row,
+    std::size_t col,
+    std::size_t N,
+    const gprat_hyper::SEKParams &sek_params,
+    const std::vector<T> &exp_distance)
 {
-    // Preallocate required memory
-    std::vector<double> tile;
-    tile.reserve(N * N);
-    double hyperparam_der = compute_sigmoid(to_unconstrained(sek_params.vertical_lengthscale, false));
-    for (std::size_t i = 0; i < N; i++)
+    tile.resize(N * N);
+    // compute covariance function
+    for (std::size_t i = 0; i < N * N; i++)
+    {
+        tile[i] = static_cast<T>(sek_params.vertical_lengthscale * exp_distance[i]);
+    }
+    if (row == col)
     {
-        for (std::size_t j = 0; j < N; j++)
+        // noise variance on diagonal
+        for (std::size_t i = 0; i < N; i++)
         {
-            // compute derivative
-            tile.push_back(exp(distance[i * N + j]) * hyperparam_der);
+            tile[i * N + i] += static_cast<T>(sek_params.noise_variance);
         }
     }
     return tile;
 }
 
-std::vector<double>
-gen_tile_grad_l(std::size_t N, const gprat_hyper::SEKParams &sek_params, const std::vector<double> &distance)
+template <typename T>
+std::vector<double> compute_gradient_tile(std::vector<double> gradient,
+                                          const std::vector<T> &K_inv_tile,
+                                          const std::vector<T> &alpha_row,
+                                          const std::vector<T> &alpha_col,
+                                          const std::vector<T> &distance,
+                                          std::size_t N,
+                                          const gprat_hyper::SEKParams &sek_params,
+                                          bool exp_distance,
+                                          bool diagonal)
 {
-    // Preallocate required memory
-    std::vector<double> tile;
-    tile.reserve(N * N);
-    double hyperparam_der = compute_sigmoid(to_unconstrained(sek_params.lengthscale, false));
-    double factor = -2.0 * sek_params.vertical_lengthscale / sek_params.lengthscale;
+    const double hyperparam_der_l = compute_sigmoid(to_unconstrained(sek_params.lengthscale, false));
+    const double hyperparam_der_v = compute_sigmoid(to_unconstrained(sek_params.vertical_lengthscale, false));
+    const double hyperparam_der_n = compute_sigmoid(to_unconstrained(sek_params.noise_variance, true));
+    const double factor = -2.0 * sek_params.vertical_lengthscale / sek_params.lengthscale;
+    const double scale = -0.5 / (sek_params.lengthscale * sek_params.lengthscale);
+    double trace_l = 0.0;
+    double trace_v = 0.0;
+    double trace_n = 0.0;
     for (std::size_t i = 0; i < N; i++)
     {
-        for (std::size_t j = 0; j < N; j++)
+        // Diagonal tiles are only read in their lower triangle
+        const std::size_t n_cols = diagonal ? i + 1 : N;
+        for (std::size_t j = 0; j < n_cols; j++)
         {
-            // compute derivative
-            tile.push_back(factor * distance[i * N + j] * exp(distance[i * N + j]) * hyperparam_der);
+            // W = K^-1 - alpha * alpha^T, elements below the diagonal stand for themselves and their mirrored elements
+            const double w = (diagonal && i == j ? 1.0 : 2.0)
+                             * (static_cast<double>(K_inv_tile[i * N + j])
+                                - static_cast<double>(alpha_row[i]) * static_cast<double>(alpha_col[j]));
+            if (exp_distance)
+            {
+                // derivative w.r.t. vertical_lengthscale with exp(-0.5 / lengthscale^2 * (z_i - z_j)^2)
+                trace_v += w * static_cast<double>(distance[i * N + j]);
+            }
+            else
+            {
+                // derivatives with distance scaled by the lengthscale
+                const double scaled_distance = scale * static_cast<double>(distance[i * N + j]);
+                const double exp_distance_ij = vectorized_exp(scaled_distance);
+                trace_l += w * factor * scaled_distance * exp_distance_ij;
+                trace_v += w * exp_distance_ij;
+            }
+        }
+        if (diagonal)
+        {
+            // derivative w.r.t. noise_variance is the identity
+            trace_n += static_cast<double>(K_inv_tile[i * N + i])
+                       - static_cast<double>(alpha_row[i]) * static_cast<double>(alpha_col[i]);
         }
     }
-    return tile;
+    gradient[0] += hyperparam_der_l * trace_l;
+    gradient[1] += hyperparam_der_v * trace_v;
+    gradient[2] += hyperparam_der_n * trace_n;
+    return gradient;
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -184,15 +234,16 @@ double adam_step(const double unconstrained_hyperparam,
 
 /////////////////////////////////////////////////////////////////////////
 // Loss
-double compute_loss(const std::vector<double> &K_diag_tile,
-                    const std::vector<double> &alpha_tile,
-                    const std::vector<double> &y_tile,
+template <typename T>
+double compute_loss(const std::vector<T> &K_diag_tile,
+                    const std::vector<T> &alpha_tile,
+                    const std::vector<T> &y_tile,
                     std::size_t N)
 {
     // l = y^T * alpha + \sum_i^N log(L_ii^2)
     double l;
     // Compute y^T * alpha
-    l = dot(y_tile, alpha_tile, static_cast<int>(N));
+    l = compute_dot(y_tile, alpha_tile, 0.0);
     // Compute \sum_i^N log(L_ii^2)
     for (std::size_t i = 0; i < N; i++)
     {
@@ -219,29 +270,182 @@ double add_losses(const std::vector<double> &losses, std::size_t N, std::size_t
 
 /////////////////////////////////////////////////////////////////////////
 // Gradient
-double compute_gradient(double trace, double dot, std::size_t N, std::size_t n_tiles)
+std::vector<double>
+add_gradients(const std::vector<std::vector<double>> &gradients, std::size_t N, std::size_t n_tiles)
 {
-    return 0.5 / static_cast<double>(N * n_tiles) * (trace - dot);
+    // 0.5 * \sum gradients / (N * n_tiles)
+    std::vector<double> gradient(gradients.front().size(), 0.0);
+    for (const auto &row_gradient : gradients)
+    {
+        for (std::size_t p = 0; p < gradient.size(); p++)
+        {
+            gradient[p] += row_gradient[p];
+        }
+    }
+    for (auto &value : gradient)
+    {
+        value *= 0.5 / static_cast<double>(N * n_tiles);
+    }
+    return gradient;
 }
 
-double compute_trace(const std::vector<double> &diagonal, double trace)
+void update_hyperparameter(double gradient,
+                           const gprat_hyper::AdamParams &adam_params,
+                           gprat_hyper::SEKParams &sek_params,
+                           std::size_t iter,
+                           std::size_t param_idx)
 {
-    return trace + std::reduce(diagonal.begin(), diagonal.end());
+    // The noise variance is constrained with a jitter
+    bool jitter = param_idx == 2;
+    // Update moments
+    // m_T = beta1 * m_T-1 + (1 - beta1) * g_T
+    sek_params.m_T[param_idx] = update_first_moment(gradient, sek_params.m_T[param_idx], adam_params.beta1);
+    // w_T = beta2 + w_T-1 + (1 - beta2) * g_T^2
+    sek_params.w_T[param_idx] = update_second_moment(gradient, sek_params.w_T[param_idx], adam_params.beta2);
+
+    // Transform hyperparameter to unconstrained form
+    double unconstrained_param = to_unconstrained(sek_params.get_param(param_idx), jitter);
+    // Adam step update with unconstrained parameter
+    // compute beta_t inside
+    double updated_param =
+        adam_step(unconstrained_param, adam_params, sek_params.m_T[param_idx], sek_params.w_T[param_idx], iter);
+    // Transform hyperparameter back to constrained form
+    sek_params.set_param(param_idx, to_constrained(updated_param, jitter));
 }
 
-double compute_dot(const std::vector<double> &vector_T, const std::vector<double> &vector, double result)
+gprat_hyper::SEKParams update_hyperparameters(const std::vector<double> &gradient,
+                                              const gprat_hyper::AdamParams &adam_params,
+                                              gprat_hyper::SEKParams sek_params,
+                                              const std::vector<bool> &trainable_params,
+                                              std::size_t iter)
 {
-    return result + dot(vector_T, vector, static_cast<int>(vector.size()));
+    // 0: lengthscale; 1: vertical_lengthscale; 2: noise_variance
+    for (std::size_t param_idx = 0; param_idx < trainable_params.size(); param_idx++)
+    {
+        if (trainable_params[param_idx])
+        {
+            update_hyperparameter(gradient[param_idx], adam_params, sek_params, iter, param_idx);
+        }
+    }
+    return sek_params;
 }
 
-double compute_trace_diag(const std::vector<double> &tile, double trace, std::size_t N)
+/////////////////////////////////////////////////////////////////////////
+// L-BFGS
+std::vector<double> lbfgs_direction(const std::vector<double> &gradient,
+                                    const std::vector<std::vector<double>> &s_history,
+                                    const std::vector<std::vector<double>> &y_history)
 {
-    double local_trace = 0.0;
-    for (std::size_t i = 0; i < N; ++i)
+    auto dot = [](const std::vector<double> &a, const std::vector<double> &b)
+    { return std::inner_product(a.begin(), a.end(), b.begin(), 0.0); };
+
+    // q = g, first loop from the newest to the oldest pair
+    std::vector<double> q = gradient;
+    std::vector<double> alpha(s_history.size());
+    for (std::size_t k = s_history.size(); k-- > 0;)
+    {
+        alpha[k] = dot(s_history[k], q) / dot(y_history[k], s_history[k]);
+        for (std::size_t p = 0; p < q.size(); p++)
+        {
+            q[p] -= alpha[k] * y_history[k][p];
+        }
+    }
+
+    // Initial inverse Hessian gamma * I
+    double gamma = 1.0;
+    if (!s_history.empty())
+    {
+        gamma = dot(s_history.back(), y_history.back()) / dot(y_history.back(), y_history.back());
+    }
+    for (auto &value : q)
     {
-        local_trace += tile[i * N + i];
+        value *= gamma;
+    }
+
+    // Second loop from the oldest to the newest pair
+    for (std::size_t k = 0; k < s_history.size(); k++)
+    {
+        double beta = dot(y_history[k], q) / dot(y_history[k], s_history[k]);
+        for (std::size_t p = 0; p < q.size(); p++)
+        {
+            q[p] += (alpha[k] - beta) * s_history[k][p];
+        }
     }
-    return trace + local_trace;
+
+    // Descent direction d = -H * g
+    for (auto &value : q)
+    {
+        value = -value;
+    }
+    return q;
 }
 
+gprat_hyper::SEKParams move_hyperparameters(gprat_hyper::SEKParams sek_params,
+                                            const std::vector<double> &direction,
+                                            double step,
+                                            const std::vector<bool> &trainable_params)
+{
+    // 0: lengthscale; 1: vertical_lengthscale; 2: noise_variance
+    for (std::size_t param_idx = 0; param_idx < trainable_params.size(); param_idx++)
+    {
+        if (trainable_params[param_idx])
+        {
+            // The noise variance is constrained with a jitter
+            bool jitter = param_idx == 2;
+            double unconstrained_param = to_unconstrained(sek_params.get_param(param_idx), jitter);
+            sek_params.set_param(param_idx, to_constrained(unconstrained_param + step * direction[param_idx], jitter));
+        }
+    }
+    return sek_params;
+}
+
+template <typename T>
+double compute_dot(const std::vector<T> &vector_T, const std::vector<T> &vector, double result)
+{
+    if constexpr (std::is_same_v<T, double>)
+    {
+        return result + dot(vector_T, vector, static_cast<int>(vector.size()));
+    }
+    else
+    {
+        return result + std::transform_reduce(vector_T.begin(), vector_T.end(), vector.begin(), 0.0);
+    }
+}
+
+// Explicit instantiations for FP64 and FP32 tiles
+#define GPRAT_INSTANTIATE_OPTIMIZER_TILES(T)                                                                           \
+    template std::vector<T> gen_tile_distance<T>(                                                                      \
+        std::size_t, std::size_t, std::size_t, std::size_t, const std::vector<double> &);                              \
+    template std::vector<T> gen_tile_exp_distance<T>(                                                                  \
+        std::size_t, const gprat_hyper::SEKParams &, const std::vector<T> &);                                          \
+    template std::vector<T> gen_tile_covariance_with_distance<T>(std::vector<T>,                                       \
+                                                                 std::size_t,                                          \
+                                                                 std::size_t,                                          \
+                                                                 std::size_t,                                          \
+                                                                 const gprat_hyper::SEKParams &,                       \
+                                                                 const std::vector<T> &);                              \
+    template std::vector<T> gen_tile_covariance_with_exp_distance<T>(std::vector<T>,                                   \
+                                                                     std::size_t,                                      \
+                                                                     std::size_t,                                      \
+                                                                     std::size_t,                                      \
+                                                                     const gprat_hyper::SEKParams &,                   \
+                                                                     const std::vector<T> &);                          \
+    template std::vector<double> compute_gradient_tile<T>(std::vector<double>,                                         \
+                                                          const std::vector<T> &,                                      \
+                                                          const std::vector<T> &,                                      \
+                                                          const std::vector<T> &,                                      \
+                                                          const std::vector<T> &,                                      \
+                                                          std::size_t,                                                 \
+                                                          const gprat_hyper::SEKParams &,                              \
+                                                          bool,                                                        \
+                                                          bool);                                                       \
+    template double compute_loss<T>(                                                                                   \
+        const std::vector<T> &, const std::vector<T> &, const std::vector<T> &, std::size_t);                          \
+    template double compute_dot<T>(const std::vector<T> &, const std::vector<T> &, double);
+
+GPRAT_INSTANTIATE_OPTIMIZER_TILES(double)
+GPRAT_INSTANTIATE_OPTIMIZER_TILES(float)
+
+#undef GPRAT_INSTANTIATE_OPTIMIZER_TILES
+
 }  // end of namespace cpu
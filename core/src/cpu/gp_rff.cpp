@@ -0,0 +1,558 @@
+#include "cpu/gp_rff.hpp"
+
+#include "cpu/adapter_cblas_fp64.hpp"
+#include "cpu/gp_algorithms.hpp"
+#include "cpu/gp_optimizer.hpp"
+#include "cpu/tiled_algorithms.hpp"
+#include <cmath>
+#include <hpx/future.hpp>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+
+namespace cpu
+{
+
+/**
+ * @brief Random frequencies and phases of the feature map
+ */
+struct Random_features
+{
+    /** @brief Standard normal frequencies omega of size D x n_regressors */
+    std::vector<double> frequencies;
+
+    /** @brief Uniform phases b in [0, 2 * pi) of size D */
+    std::vector<double> phases;
+
+    /** @brief Number of features D */
+    std::size_t n_features;
+};
+
+// Draw the frequencies and phases, the lengthscale scales the frequencies in the feature map such that they stay
+// fixed while the hyperparameters change
+static Random_features draw_random_features(std::size_t n_features, std::size_t n_regressors, unsigned int seed)
+{
+    std::mt19937_64 generator(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 2.0 * std::numbers::pi);
+    Random_features random_features{ std::vector<double>(n_features * n_regressors),
+                                     std::vector<double>(n_features),
+                                     n_features };
+    for (auto &frequency : random_features.frequencies)
+    {
+        frequency = normal(generator);
+    }
+    for (auto &phase : random_features.phases)
+    {
+        phase = uniform(generator);
+    }
+    return random_features;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// TILE OPERATIONS
+
+// Projections omega^T * z_i of the feature vectors of a tile, N x D
+static std::vector<double> gen_tile_projections(std::size_t row,
+                                                std::size_t N,
+                                                std::size_t n_regressors,
+                                                const std::vector<double> &input,
+                                                const Random_features &random_features)
+{
+    const std::size_t D = random_features.n_features;
+    std::vector<double> projections(N * D, 0.0);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        // Feature vector i starts at entry N * row + i of the lagged input
+        const double *z_i = input.data() + N * row + i;
+        for (std::size_t d = 0; d < D; d++)
+        {
+            const double *omega_d = random_features.frequencies.data() + d * n_regressors;
+            double projection = 0.0;
+            for (std::size_t k = 0; k < n_regressors; k++)
+            {
+                projection += omega_d[k] * z_i[k];
+            }
+            projections[i * D + d] = projection;
+        }
+    }
+    return projections;
+}
+
+// Tile of features phi(z_i) = sqrt(2 * vertical_lengthscale / D) * cos(omega^T * z_i / lengthscale + b), N x D
+static std::vector<double> gen_tile_features(const std::vector<double> &projections,
+                                             std::size_t N,
+                                             const gprat_hyper::SEKParams &sek_params,
+                                             const Random_features &random_features)
+{
+    const std::size_t D = random_features.n_features;
+    const double scale = std::sqrt(2.0 * sek_params.vertical_lengthscale / static_cast<double>(D));
+    std::vector<double> features(N * D);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t d = 0; d < D; d++)
+        {
+            features[i * D + d] =
+                scale * std::cos(projections[i * D + d] / sek_params.lengthscale + random_features.phases[d]);
+        }
+    }
+    return features;
+}
+
+// Prior part noise_variance * I of the precision matrix A of the feature weights, D x D
+static std::vector<double> gen_tile_feature_prior(std::size_t D, double noise_variance)
+{
+    std::vector<double> A(D * D, 0.0);
+    for (std::size_t d = 0; d < D; d++)
+    {
+        A[d * D + d] = noise_variance;
+    }
+    return A;
+}
+
+// A = A + Phi^T * Phi for the feature tile Phi
+static std::vector<double>
+add_feature_gram(std::vector<double> A, const std::vector<double> &features, std::size_t N, std::size_t D)
+{
+    const int d = static_cast<int>(D);
+    const std::vector<double> gram = gemm_panel_inner(features, features, static_cast<int>(N), d, d);
+    for (std::size_t i = 0; i < D * D; i++)
+    {
+        A[i] += gram[i];
+    }
+    return A;
+}
+
+// Solve A * X = Phi^T for a feature tile Phi with A = L * L^T, X of size D x N
+static std::vector<double>
+solve_feature_tile(const std::vector<double> &L, const std::vector<double> &features, std::size_t N, std::size_t D)
+{
+    const int n = static_cast<int>(N);
+    const int d = static_cast<int>(D);
+    return trsm(L,
+                trsm(L, gen_tile_transpose(N, D, features), d, n, Blas_no_trans, Blas_left),
+                d,
+                n,
+                Blas_trans,
+                Blas_left);
+}
+
+// Gradients of a training tile w.r.t. lengthscale, vertical_lengthscale and noise_variance, to be summed with
+// add_gradients
+static std::vector<double> compute_feature_gradient_tile(const std::vector<double> &projections,
+                                                         const std::vector<double> &features,
+                                                         const std::vector<double> &output,
+                                                         const std::vector<double> &L,
+                                                         const std::vector<double> &weights,
+                                                         std::size_t N,
+                                                         const gprat_hyper::SEKParams &sek_params,
+                                                         const Random_features &random_features)
+{
+    /*
+     * With C = Phi * Phi^T + noise_variance * I, W = C^-1 - alpha * alpha^T and the weights m = A^-1 * Phi^T * y:
+     * alpha = C^-1 * y = (y - Phi * m) / noise_variance and Phi^T * W = A^-1 * Phi^T - m * alpha^T
+     * dloss/dtheta = 1 / N * tr(Phi^T * W * dPhi/dtheta) for lengthscale and vertical_lengthscale
+     * dloss/dnoise_variance = 0.5 / N * tr(W) with tr(C^-1) = (N - tr(A^-1 * Phi^T * Phi)) / noise_variance
+     * The derivatives of the softplus transformation are applied per tile.
+     */
+    const std::size_t D = random_features.n_features;
+    const double noise_variance = sek_params.noise_variance;
+    const double scale = std::sqrt(2.0 * sek_params.vertical_lengthscale / static_cast<double>(D));
+    const double lengthscale_squared = sek_params.lengthscale * sek_params.lengthscale;
+
+    std::vector<double> alpha = gemv(
+        features, weights, output, static_cast<int>(N), static_cast<int>(D), Blas_substract, Blas_no_trans);
+    for (auto &value : alpha)
+    {
+        value /= noise_variance;
+    }
+    const std::vector<double> X = solve_feature_tile(L, features, N, D);
+
+    double gradient_l = 0.0;
+    double gradient_v = 0.0;
+    double explained = 0.0;
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t d = 0; d < D; d++)
+        {
+            // (Phi^T * W)_di and the feature phi_id
+            const double w = X[d * N + i] - weights[d] * alpha[i];
+            const double phi = features[i * D + d];
+            const double argument = projections[i * D + d] / sek_params.lengthscale + random_features.phases[d];
+            gradient_l += w * scale * std::sin(argument) * projections[i * D + d] / lengthscale_squared;
+            gradient_v += w * phi;
+            explained += X[d * N + i] * phi;
+        }
+    }
+    gradient_v /= 2.0 * sek_params.vertical_lengthscale;
+    const double gradient_n =
+        (static_cast<double>(N) - explained) / noise_variance - dot(alpha, alpha, static_cast<int>(N));
+
+    // add_gradients scales by 0.5 / N, the lengthscale and vertical_lengthscale terms appear twice in tr(W * dC)
+    return { 2.0 * gradient_l * compute_sigmoid(to_unconstrained(sek_params.lengthscale, false)),
+             2.0 * gradient_v * compute_sigmoid(to_unconstrained(sek_params.vertical_lengthscale, false)),
+             gradient_n * compute_sigmoid(to_unconstrained(sek_params.noise_variance, true)) };
+}
+
+// Uncertainty noise_variance * diag(Phi_* * A^-1 * Phi_*^T) of a test tile with A = L * L^T
+static std::vector<double> compute_feature_variance(const std::vector<double> &L,
+                                                    const std::vector<double> &features,
+                                                    std::size_t M,
+                                                    std::size_t D,
+                                                    double noise_variance)
+{
+    const int m = static_cast<int>(M);
+    const int d = static_cast<int>(D);
+    std::vector<double> variance = dot_diag_syrk(
+        trsm(L, gen_tile_transpose(M, D, features), d, m, Blas_no_trans, Blas_left), std::vector<double>(M, 0.0), d, m);
+    for (auto &value : variance)
+    {
+        value *= noise_variance;
+    }
+    return variance;
+}
+
+// Log-determinant of A = L * L^T
+static double compute_feature_log_det(const std::vector<double> &L, std::size_t D)
+{
+    double log_det = 0.0;
+    for (std::size_t d = 0; d < D; d++)
+    {
+        log_det += 2.0 * std::log(L[d * D + d]);
+    }
+    return log_det;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// FEATURE SPACE FACTORIZATION
+
+/**
+ * @brief Bayesian linear regression on the random features of the training data
+ */
+struct Feature_factorization
+{
+    /** @brief Random frequencies and phases */
+    Random_features random_features;
+
+    /** @brief Tiled projections omega^T * z of the training input */
+    Tiles<double> projection_tiles;
+
+    /** @brief Tiled features Phi of the training input */
+    Tiles<double> feature_tiles;
+
+    /** @brief Tiled training output y */
+    Tiles<double> output_tiles;
+
+    /** @brief Cholesky factor L of A = Phi^T * Phi + noise_variance * I */
+    hpx::shared_future<std::vector<double>> L;
+
+    /** @brief Projected output Phi^T * y */
+    hpx::shared_future<std::vector<double>> projected_output;
+
+    /** @brief Feature weights m = A^-1 * Phi^T * y */
+    hpx::shared_future<std::vector<double>> weights;
+};
+
+// Launch the assembly of the feature tiles, the accumulation of A and Phi^T * y and the factorization of A
+static Feature_factorization factorize_features(const std::vector<double> &training_input,
+                                                const std::vector<double> &training_output,
+                                                int n_tiles,
+                                                int n_tile_size,
+                                                int n_regressors,
+                                                const gprat_hyper::SEKParams &sek_params,
+                                                const gprat_hyper::RFFParams &rff_params)
+{
+    if (rff_params.n_features <= 0)
+    {
+        throw std::invalid_argument("The number of random features must be positive");
+    }
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t D = static_cast<std::size_t>(rff_params.n_features);
+    const int d = rff_params.n_features;
+
+    Feature_factorization factorization;
+    factorization.random_features =
+        draw_random_features(D, static_cast<std::size_t>(n_regressors), rff_params.seed);
+    hpx::shared_future<std::vector<double>> A =
+        hpx::async(hpx::annotated_function(&gen_tile_feature_prior, "assemble_rff"), D, sek_params.noise_variance);
+    hpx::shared_future<std::vector<double>> projected_output =
+        hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_rff"), D);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        factorization.projection_tiles.push_back(
+            hpx::async(hpx::annotated_function(&gen_tile_projections, "assemble_rff"),
+                       i,
+                       N,
+                       static_cast<std::size_t>(n_regressors),
+                       training_input,
+                       factorization.random_features));
+        factorization.feature_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gen_tile_features), "assemble_rff"),
+                          factorization.projection_tiles[i],
+                          N,
+                          sek_params,
+                          factorization.random_features));
+        factorization.output_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_rff"), i, N, training_output));
+
+        // A = A + Phi_i^T * Phi_i
+        A = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_feature_gram), "factorize_rff"),
+                          A,
+                          factorization.feature_tiles[i],
+                          N,
+                          D);
+        // GEMV: Phi^T * y = Phi^T * y + Phi_i^T * y_i
+        projected_output = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv), "factorize_rff"),
+                                         factorization.feature_tiles[i],
+                                         factorization.output_tiles[i],
+                                         projected_output,
+                                         n_tile_size,
+                                         d,
+                                         Blas_add,
+                                         Blas_trans);
+    }
+
+    // POTRF: A = L * L^T, TRSV: m = L^-T * L^-1 * Phi^T * y
+    factorization.L = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&potrf), "factorize_rff"), A, d);
+    factorization.projected_output = projected_output;
+    factorization.weights = hpx::dataflow(
+        hpx::annotated_function(hpx::unwrapping(&trsv), "factorize_rff"),
+        factorization.L,
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "factorize_rff"),
+                      factorization.L,
+                      projected_output,
+                      d,
+                      Blas_no_trans),
+        d,
+        Blas_trans);
+    return factorization;
+}
+
+// Loss 0.5 / N * ( y^T * C^-1 * y + log(det(C)) + N * log(2 * pi) ) with C = Phi * Phi^T + noise_variance * I
+static double compute_feature_loss(const Feature_factorization &factorization,
+                                   std::size_t n_samples,
+                                   std::size_t N,
+                                   const gprat_hyper::SEKParams &sek_params)
+{
+    /*
+     * Woodbury identity and matrix determinant lemma:
+     * y^T * C^-1 * y = (y^T * y - (Phi^T * y)^T * m) / noise_variance
+     * log(det(C)) = log(det(A)) + (N - D) * log(noise_variance)
+     */
+    const std::size_t D = factorization.random_features.n_features;
+    double output_norm = 0.0;
+    for (const auto &output_tile : factorization.output_tiles)
+    {
+        output_norm += dot(output_tile.get(), output_tile.get(), static_cast<int>(N));
+    }
+    const double explained =
+        dot(factorization.projected_output.get(), factorization.weights.get(), static_cast<int>(D));
+    const double n = static_cast<double>(n_samples);
+    const double log_det = compute_feature_log_det(factorization.L.get(), D)
+                           + (n - static_cast<double>(D)) * std::log(sek_params.noise_variance);
+    const double quadratic = (output_norm - explained) / sek_params.noise_variance;
+    return 0.5 * (quadratic + log_det + n * std::log(2.0 * std::numbers::pi)) / n;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// LOSS AND OPTIMIZATION
+
+double compute_rff_loss(const std::vector<double> &training_input,
+                        const std::vector<double> &training_output,
+                        int n_tiles,
+                        int n_tile_size,
+                        int n_regressors,
+                        const gprat_hyper::SEKParams &sek_params,
+                        const gprat_hyper::RFFParams &rff_params)
+{
+    const Feature_factorization factorization = factorize_features(
+        training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, rff_params);
+    return compute_feature_loss(factorization,
+                                static_cast<std::size_t>(n_tiles) * static_cast<std::size_t>(n_tile_size),
+                                static_cast<std::size_t>(n_tile_size),
+                                sek_params);
+}
+
+std::pair<double, std::vector<double>>
+compute_rff_loss_and_gradient(const std::vector<double> &training_input,
+                              const std::vector<double> &training_output,
+                              int n_tiles,
+                              int n_tile_size,
+                              int n_regressors,
+                              const gprat_hyper::SEKParams &sek_params,
+                              const gprat_hyper::RFFParams &rff_params)
+{
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const Feature_factorization factorization = factorize_features(
+        training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, rff_params);
+
+    std::vector<hpx::shared_future<std::vector<double>>> gradient_tiles;
+    gradient_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        gradient_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_feature_gradient_tile), "gradient_rff"),
+                          factorization.projection_tiles[i],
+                          factorization.feature_tiles[i],
+                          factorization.output_tiles[i],
+                          factorization.L,
+                          factorization.weights,
+                          N,
+                          sek_params,
+                          factorization.random_features));
+    }
+
+    hpx::shared_future<std::vector<double>> gradient =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_gradients), "gradient_rff"),
+                      gradient_tiles,
+                      N,
+                      static_cast<std::size_t>(n_tiles));
+    const double loss =
+        compute_feature_loss(factorization, static_cast<std::size_t>(n_tiles) * N, N, sek_params);
+    return { loss, gradient.get() };
+}
+
+std::vector<double> optimize_rff(const std::vector<double> &training_input,
+                                 const std::vector<double> &training_output,
+                                 int n_tiles,
+                                 int n_tile_size,
+                                 int n_regressors,
+                                 const gprat_hyper::AdamParams &adam_params,
+                                 gprat_hyper::SEKParams &sek_params,
+                                 const std::vector<bool> &trainable_params,
+                                 const gprat_hyper::RFFParams &rff_params)
+{
+    std::vector<double> losses;
+    losses.reserve(static_cast<std::size_t>(adam_params.opt_iter));
+    for (std::size_t iter = 0; iter < static_cast<std::size_t>(adam_params.opt_iter); iter++)
+    {
+        auto [loss, gradient] = compute_rff_loss_and_gradient(
+            training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, rff_params);
+        losses.push_back(loss);
+        sek_params = update_hyperparameters(gradient, adam_params, sek_params, trainable_params, iter);
+    }
+    return losses;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// PREDICTION
+
+// Launch the assembly of the feature tiles of the test input
+static Tiles<double> assemble_test_features(const std::vector<double> &test_input,
+                                            int m_tiles,
+                                            int m_tile_size,
+                                            int n_regressors,
+                                            const gprat_hyper::SEKParams &sek_params,
+                                            const Random_features &random_features)
+{
+    Tiles<double> feature_tiles;
+    feature_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        feature_tiles.push_back(hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&gen_tile_features), "assemble_rff"),
+            hpx::async(hpx::annotated_function(&gen_tile_projections, "assemble_rff"),
+                       i,
+                       static_cast<std::size_t>(m_tile_size),
+                       static_cast<std::size_t>(n_regressors),
+                       test_input,
+                       random_features),
+            static_cast<std::size_t>(m_tile_size),
+            sek_params,
+            random_features));
+    }
+    return feature_tiles;
+}
+
+// Launch the predictions hat(y) = Phi_* * m of the test tiles
+static Tiles<double> predict_feature_tiles(const Feature_factorization &factorization,
+                                           const Tiles<double> &test_feature_tiles,
+                                           int m_tile_size)
+{
+    Tiles<double> prediction_tiles;
+    prediction_tiles.reserve(test_feature_tiles.size());
+    for (const auto &feature_tile : test_feature_tiles)
+    {
+        // GEMV: hat(y)_i = Phi_*,i * m
+        prediction_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv), "predict_rff"),
+                          feature_tile,
+                          factorization.weights,
+                          hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_rff"),
+                                     static_cast<std::size_t>(m_tile_size)),
+                          m_tile_size,
+                          static_cast<int>(factorization.random_features.n_features),
+                          Blas_add,
+                          Blas_no_trans));
+    }
+    return prediction_tiles;
+}
+
+// Gather the tiled results
+static std::vector<double> gather_tiles(const Tiles<double> &tiles, int m_tile_size)
+{
+    std::vector<double> result;
+    result.reserve(tiles.size() * static_cast<std::size_t>(m_tile_size));
+    for (const auto &tile : tiles)
+    {
+        const std::vector<double> &values = tile.get();
+        result.insert(result.end(), values.begin(), values.end());
+    }
+    return result;
+}
+
+std::vector<double> predict_rff(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const gprat_hyper::RFFParams &rff_params)
+{
+    const Feature_factorization factorization = factorize_features(
+        training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, rff_params);
+    const Tiles<double> test_feature_tiles = assemble_test_features(
+        test_input, m_tiles, m_tile_size, n_regressors, sek_params, factorization.random_features);
+    return gather_tiles(predict_feature_tiles(factorization, test_feature_tiles, m_tile_size), m_tile_size);
+}
+
+std::vector<std::vector<double>> predict_rff_with_uncertainty(const std::vector<double> &training_input,
+                                                              const std::vector<double> &training_output,
+                                                              const std::vector<double> &test_input,
+                                                              int n_tiles,
+                                                              int n_tile_size,
+                                                              int m_tiles,
+                                                              int m_tile_size,
+                                                              int n_regressors,
+                                                              const gprat_hyper::SEKParams &sek_params,
+                                                              const gprat_hyper::RFFParams &rff_params)
+{
+    /*
+     * Posterior of the feature weights N(m, noise_variance * A^-1):
+     * hat(y) = Phi_* * m, uncertainty = noise_variance * diag(Phi_* * A^-1 * Phi_*^T)
+     */
+    const Feature_factorization factorization = factorize_features(
+        training_input, training_output, n_tiles, n_tile_size, n_regressors, sek_params, rff_params);
+    const Tiles<double> test_feature_tiles = assemble_test_features(
+        test_input, m_tiles, m_tile_size, n_regressors, sek_params, factorization.random_features);
+    const Tiles<double> prediction_tiles = predict_feature_tiles(factorization, test_feature_tiles, m_tile_size);
+
+    Tiles<double> uncertainty_tiles;
+    uncertainty_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    for (const auto &feature_tile : test_feature_tiles)
+    {
+        uncertainty_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_feature_variance), "predict_rff"),
+                          factorization.L,
+                          feature_tile,
+                          static_cast<std::size_t>(m_tile_size),
+                          factorization.random_features.n_features,
+                          sek_params.noise_variance));
+    }
+    return { gather_tiles(prediction_tiles, m_tile_size), gather_tiles(uncertainty_tiles, m_tile_size) };
+}
+
+}  // end of namespace cpu
@@ -0,0 +1,923 @@
+#include "cpu/gp_sparse.hpp"
+
+#include "cpu/adapter_cblas_fp64.hpp"
+#include "cpu/gp_algorithms.hpp"
+#include "cpu/gp_optimizer.hpp"
+#include "cpu/tiled_algorithms.hpp"
+#include <algorithm>
+#include <cmath>
+#include <hpx/future.hpp>
+#include <hpx/runtime.hpp>
+#include <limits>
+#include <numbers>
+
+namespace cpu
+{
+
+///////////////////////////////////////////////////////////////////////////
+// INDUCING POINTS
+
+// Sums of the feature vectors [begin, end) assigned to their nearest inducing point, followed by the number of
+// assigned feature vectors per inducing point
+static std::vector<double> assign_feature_vectors(const std::vector<double> &training_input,
+                                                  const std::vector<double> &inducing_points,
+                                                  std::size_t begin,
+                                                  std::size_t end,
+                                                  std::size_t M,
+                                                  std::size_t n_regressors)
+{
+    std::vector<double> sums(M * n_regressors + M, 0.0);
+    for (std::size_t i = begin; i < end; i++)
+    {
+        std::size_t nearest = 0;
+        double nearest_distance = std::numeric_limits<double>::infinity();
+        for (std::size_t m = 0; m < M; m++)
+        {
+            double distance = 0.0;
+            for (std::size_t k = 0; k < n_regressors; k++)
+            {
+                const double z_ik_minus_u_mk = training_input[i + k] - inducing_points[m * n_regressors + k];
+                distance += z_ik_minus_u_mk * z_ik_minus_u_mk;
+            }
+            if (distance < nearest_distance)
+            {
+                nearest = m;
+                nearest_distance = distance;
+            }
+        }
+        for (std::size_t k = 0; k < n_regressors; k++)
+        {
+            sums[nearest * n_regressors + k] += training_input[i + k];
+        }
+        sums[M * n_regressors + nearest] += 1.0;
+    }
+    return sums;
+}
+
+std::vector<double> select_inducing_points(const std::vector<double> &training_input,
+                                           int n_samples,
+                                           int n_regressors,
+                                           int n_inducing,
+                                           int kmeans_iterations)
+{
+    const std::size_t N = static_cast<std::size_t>(n_samples);
+    const std::size_t M = static_cast<std::size_t>(n_inducing);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+
+    // Evenly strided feature vectors, feature vector i starts at entry i of the training input
+    std::vector<double> inducing_points(M * R);
+    for (std::size_t m = 0; m < M; m++)
+    {
+        const std::size_t i = (2 * m + 1) * N / (2 * M);
+        std::copy(training_input.begin() + static_cast<std::ptrdiff_t>(i),
+                  training_input.begin() + static_cast<std::ptrdiff_t>(i + R),
+                  inducing_points.begin() + static_cast<std::ptrdiff_t>(m * R));
+    }
+
+    // Lloyd iterations, the assignment of the feature vectors is split into one chunk per worker thread
+    const std::size_t n_chunks = std::max<std::size_t>(1, std::min<std::size_t>(N, hpx::get_num_worker_threads()));
+    for (int iter = 0; iter < kmeans_iterations; iter++)
+    {
+        std::vector<hpx::future<std::vector<double>>> chunk_sums;
+        chunk_sums.reserve(n_chunks);
+        for (std::size_t c = 0; c < n_chunks; c++)
+        {
+            chunk_sums.push_back(hpx::async(hpx::annotated_function(&assign_feature_vectors, "select_inducing"),
+                                            std::cref(training_input),
+                                            std::cref(inducing_points),
+                                            c * N / n_chunks,
+                                            (c + 1) * N / n_chunks,
+                                            M,
+                                            R));
+        }
+        std::vector<double> sums(M * R + M, 0.0);
+        for (auto &chunk : chunk_sums)
+        {
+            const std::vector<double> chunk_sum = chunk.get();
+            for (std::size_t k = 0; k < sums.size(); k++)
+            {
+                sums[k] += chunk_sum[k];
+            }
+        }
+        // Move each inducing point to the mean of its feature vectors, inducing points without any stay in place
+        for (std::size_t m = 0; m < M; m++)
+        {
+            const double count = sums[M * R + m];
+            if (count > 0.0)
+            {
+                for (std::size_t k = 0; k < R; k++)
+                {
+                    inducing_points[m * R + k] = sums[m * R + k] / count;
+                }
+            }
+        }
+    }
+    return inducing_points;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// TILE OPERATIONS
+
+// Diagonal matrix Lambda of a training tile with V = L_u^-1 * K_MN, the noise variance for SoR and DTC and
+// additionally diag(K_NN - Q_NN) for FITC
+static std::vector<double> gen_tile_sparse_lambda(const std::vector<double> &V,
+                                                  std::size_t M,
+                                                  std::size_t N,
+                                                  const gprat_hyper::SEKParams &sek_params,
+                                                  gprat::Approximation approximation)
+{
+    std::vector<double> lambda(N, sek_params.noise_variance);
+    if (approximation == gprat::Approximation::fitc)
+    {
+        // diag(Q_NN) = diag(V^T * V) is bounded by the prior variance up to roundoff
+        const std::vector<double> q_diag =
+            dot_diag_syrk(V, std::vector<double>(N, 0.0), static_cast<int>(M), static_cast<int>(N));
+        for (std::size_t i = 0; i < N; i++)
+        {
+            lambda[i] += std::max(sek_params.vertical_lengthscale - q_diag[i], 0.0);
+        }
+    }
+    return lambda;
+}
+
+// V * Lambda^-1/2 of a training tile
+static std::vector<double>
+scale_sparse_tile(std::vector<double> V, const std::vector<double> &lambda, std::size_t M, std::size_t N)
+{
+    for (std::size_t m = 0; m < M; m++)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            V[m * N + i] /= std::sqrt(lambda[i]);
+        }
+    }
+    return V;
+}
+
+// Lambda^-1/2 * y of a training tile
+static std::vector<double> scale_sparse_output(std::vector<double> y, const std::vector<double> &lambda)
+{
+    for (std::size_t i = 0; i < y.size(); i++)
+    {
+        y[i] /= std::sqrt(lambda[i]);
+    }
+    return y;
+}
+
+// log(det(Lambda)) + y^T * Lambda^-1 * y of a training tile
+static double compute_sparse_tile_loss(const std::vector<double> &lambda, const std::vector<double> &scaled_output)
+{
+    double l = 0.0;
+    for (std::size_t i = 0; i < lambda.size(); i++)
+    {
+        l += std::log(lambda[i]) + scaled_output[i] * scaled_output[i];
+    }
+    return l;
+}
+
+// Sum of the partial results of the accumulation chains
+static std::vector<double> add_sparse_partials(const std::vector<std::vector<double>> &partials)
+{
+    std::vector<double> sum = partials.front();
+    for (std::size_t c = 1; c < partials.size(); c++)
+    {
+        for (std::size_t k = 0; k < sum.size(); k++)
+        {
+            sum[k] += partials[c][k];
+        }
+    }
+    return sum;
+}
+
+// B = I + V * Lambda^-1 * V^T from the partial sums of the accumulation chains
+static std::vector<double> assemble_sparse_B(const std::vector<std::vector<double>> &partials, std::size_t M)
+{
+    std::vector<double> B = add_sparse_partials(partials);
+    for (std::size_t m = 0; m < M; m++)
+    {
+        B[m * M + m] += 1.0;
+    }
+    return B;
+}
+
+static double compute_sparse_loss_value(const std::vector<double> &L_B,
+                                        const std::vector<double> &c,
+                                        const std::vector<double> &tile_losses,
+                                        std::size_t M,
+                                        std::size_t N)
+{
+    // loss = 0.5 / N * ( log(det(B)) + log(det(Lambda)) + y^T * Lambda^-1 * y - c^T * c + N * log(2 * pi) )
+    double l = 0.0;
+    for (std::size_t m = 0; m < M; m++)
+    {
+        l += std::log(L_B[m * M + m] * L_B[m * M + m]) - c[m] * c[m];
+    }
+    for (double tile_loss : tile_losses)
+    {
+        l += tile_loss;
+    }
+    const double Nn = static_cast<double>(N);
+    l += Nn * std::log(2.0 * std::numbers::pi);
+    return 0.5 * l / Nn;
+}
+
+// Predictive variance of a test tile with V = L_u^-1 * K_MT and U = L_B^-1 * V
+static std::vector<double> compute_sparse_variance(const std::vector<double> &V,
+                                                   const std::vector<double> &U,
+                                                   std::size_t M,
+                                                   std::size_t N,
+                                                   const gprat_hyper::SEKParams &sek_params,
+                                                   gprat::Approximation approximation)
+{
+    // SoR: diag(U^T * U), DTC and FITC: prior variance - diag(V^T * V) + diag(U^T * U)
+    std::vector<double> variance =
+        dot_diag_syrk(U, std::vector<double>(N, 0.0), static_cast<int>(M), static_cast<int>(N));
+    if (approximation != gprat::Approximation::sor)
+    {
+        const std::vector<double> q_diag =
+            dot_diag_syrk(V, std::vector<double>(N, 0.0), static_cast<int>(M), static_cast<int>(N));
+        for (std::size_t i = 0; i < N; i++)
+        {
+            variance[i] += sek_params.vertical_lengthscale - q_diag[i];
+        }
+    }
+    return variance;
+}
+
+// alpha = C^-1 * y = Lambda^-1 * (y - V^T * b) of a training tile with b = B^-1 * V * Lambda^-1 * y
+static std::vector<double> compute_sparse_alpha(const std::vector<double> &V,
+                                                const std::vector<double> &lambda,
+                                                const std::vector<double> &y,
+                                                const std::vector<double> &b,
+                                                std::size_t M,
+                                                std::size_t N)
+{
+    std::vector<double> alpha = gemv(V, b, y, static_cast<int>(M), static_cast<int>(N), Blas_substract, Blas_trans);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        alpha[i] /= lambda[i];
+    }
+    return alpha;
+}
+
+// diag(W) = diag(C^-1) - alpha^2 of a training tile with diag(C^-1) = Lambda^-1 - Lambda^-2 * diag(V^T * X) and
+// X = B^-1 * V
+static std::vector<double> compute_sparse_weights(const std::vector<double> &V,
+                                                  const std::vector<double> &X,
+                                                  const std::vector<double> &lambda,
+                                                  const std::vector<double> &alpha,
+                                                  std::size_t M,
+                                                  std::size_t N)
+{
+    std::vector<double> q_diag(N, 0.0);
+    for (std::size_t m = 0; m < M; m++)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            q_diag[i] += V[m * N + i] * X[m * N + i];
+        }
+    }
+    std::vector<double> weights(N);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        weights[i] = 1.0 / lambda[i] - q_diag[i] / (lambda[i] * lambda[i]) - alpha[i] * alpha[i];
+    }
+    return weights;
+}
+
+// Z = Z + V * diag(W) * V^T of a training tile
+static std::vector<double> accumulate_sparse_weighted_gram(std::vector<double> Z,
+                                                          const std::vector<double> &V,
+                                                          const std::vector<double> &weights,
+                                                          std::size_t M,
+                                                          std::size_t N)
+{
+    std::vector<double> weighted_V(V);
+    for (std::size_t m = 0; m < M; m++)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            weighted_V[m * N + i] *= weights[i];
+        }
+    }
+    return gemm_panel_add(weighted_V, V, std::move(Z), static_cast<int>(M), static_cast<int>(M), static_cast<int>(N));
+}
+
+// Traces of W times the derivatives of C w.r.t. lengthscale, vertical lengthscale and noise variance that
+// depend on a training tile, K_MN and its squared distances are the tiles of the training tile
+static std::vector<double> compute_sparse_tile_gradient(const std::vector<double> &K_MN,
+                                                        const std::vector<double> &distance,
+                                                        const std::vector<double> &V,
+                                                        const std::vector<double> &X,
+                                                        const std::vector<double> &lambda,
+                                                        const std::vector<double> &alpha,
+                                                        const std::vector<double> &weights,
+                                                        const std::vector<double> &gamma,
+                                                        const std::vector<double> &L_u,
+                                                        std::size_t M,
+                                                        std::size_t N,
+                                                        const gprat_hyper::SEKParams &sek_params,
+                                                        gprat::Approximation approximation)
+{
+    const bool fitc = approximation == gprat::Approximation::fitc;
+    // Derivative of tr(W * dC) w.r.t. K_MN:
+    // 2 * L_u^-T * ( X * Lambda^-1 - gamma * alpha^T ) for SoR and DTC, FITC subtracts 2 * L_u^-T * V * diag(W)
+    std::vector<double> R(M * N);
+    for (std::size_t m = 0; m < M; m++)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            R[m * N + i] = X[m * N + i] / lambda[i] - gamma[m] * alpha[i] - (fitc ? V[m * N + i] * weights[i] : 0.0);
+        }
+    }
+    R = trsm(L_u, std::move(R), static_cast<int>(M), static_cast<int>(N), Blas_trans, Blas_left);
+
+    // dK/dl = K * distance / lengthscale^3, dK/dv = K / vertical_lengthscale
+    double trace_l = 0.0;
+    double trace_v = 0.0;
+    double trace_n = 0.0;
+    for (std::size_t k = 0; k < M * N; k++)
+    {
+        trace_l += R[k] * K_MN[k] * distance[k];
+        trace_v += R[k] * K_MN[k];
+    }
+    trace_l *= 2.0 / (sek_params.lengthscale * sek_params.lengthscale * sek_params.lengthscale);
+    trace_v *= 2.0 / sek_params.vertical_lengthscale;
+    // derivative of Lambda w.r.t. noise_variance is the identity
+    for (std::size_t i = 0; i < N; i++)
+    {
+        trace_n += weights[i];
+    }
+    if (fitc)
+    {
+        // derivative of diag(K_NN) in Lambda w.r.t. vertical_lengthscale is the identity
+        trace_v += trace_n;
+    }
+    return { trace_l, trace_v, trace_n };
+}
+
+// Gradient of the loss w.r.t. the unconstrained hyperparameters from the traces of all training tiles and the
+// trace of W times the derivatives of C w.r.t. K_MM
+static std::vector<double> compute_sparse_gradient(const std::vector<std::vector<double>> &tile_gradients,
+                                                   const std::vector<double> &Z,
+                                                   const std::vector<double> &gamma,
+                                                   const std::vector<double> &L_u,
+                                                   const std::vector<double> &L_B,
+                                                   const std::vector<double> &K_MM,
+                                                   const std::vector<double> &distance,
+                                                   std::size_t M,
+                                                   std::size_t N,
+                                                   const gprat_hyper::SEKParams &sek_params)
+{
+    // Derivative of tr(W * dC) w.r.t. K_MM: S = L_u^-T * ( B^-1 - I + gamma * gamma^T + Z ) * L_u^-1
+    const std::vector<double> B_inv =
+        lauum(trtri(L_B, std::vector<double>(M * M), static_cast<int>(M)), static_cast<int>(M));
+    std::vector<double> S(M * M);
+    for (std::size_t i = 0; i < M; i++)
+    {
+        for (std::size_t j = 0; j <= i; j++)
+        {
+            const double s_ij = B_inv[i * M + j] - (i == j ? 1.0 : 0.0) + gamma[i] * gamma[j] + Z[i * M + j];
+            S[i * M + j] = s_ij;
+            S[j * M + i] = s_ij;
+        }
+    }
+    S = trsm(L_u, std::move(S), static_cast<int>(M), static_cast<int>(M), Blas_trans, Blas_left);
+    S = trsm(L_u, std::move(S), static_cast<int>(M), static_cast<int>(M), Blas_no_trans, Blas_right);
+
+    // The jitter of K_MM scales with the vertical lengthscale and vanishes in the distance
+    double trace_l = 0.0;
+    double trace_v = 0.0;
+    for (std::size_t k = 0; k < M * M; k++)
+    {
+        trace_l += S[k] * K_MM[k] * distance[k];
+        trace_v += S[k] * K_MM[k];
+    }
+    std::vector<double> gradient = {
+        trace_l / (sek_params.lengthscale * sek_params.lengthscale * sek_params.lengthscale),
+        trace_v / sek_params.vertical_lengthscale,
+        0.0
+    };
+    for (const auto &tile_gradient : tile_gradients)
+    {
+        for (std::size_t p = 0; p < gradient.size(); p++)
+        {
+            gradient[p] += tile_gradient[p];
+        }
+    }
+
+    // 0.5 / N * tr(W * dC) w.r.t. the unconstrained hyperparameters
+    for (std::size_t param_idx = 0; param_idx < gradient.size(); param_idx++)
+    {
+        gradient[param_idx] *= 0.5 / static_cast<double>(N)
+                               * compute_sigmoid(to_unconstrained(sek_params.get_param(param_idx), param_idx == 2));
+    }
+    return gradient;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// FACTORIZATION
+
+/**
+ * @brief Tiles of an inducing point approximation C = Q_NN + Lambda of the covariance matrix
+ *
+ * With V = L_u^-1 * K_MN for the Cholesky factor L_u of K_MM, C^-1 and det(C) follow from the
+ * M x M matrix B = I + V * Lambda^-1 * V^T.
+ */
+struct Sparse_factorization
+{
+    /** @brief Tiled cross-covariance K_MN between inducing points and training data, M x n_tile_size each */
+    Tiles<double> K_MN_tiles;
+
+    /** @brief Tiled V = L_u^-1 * K_MN */
+    Tiles<double> V_tiles;
+
+    /** @brief Tiled diagonal of Lambda */
+    Tiles<double> lambda_tiles;
+
+    /** @brief Tiled training output y */
+    Tiles<double> y_tiles;
+
+    /** @brief Covariance matrix K_MM of the inducing points */
+    hpx::shared_future<std::vector<double>> K_MM;
+
+    /** @brief Cholesky factor L_u of K_MM */
+    hpx::shared_future<std::vector<double>> L_u;
+
+    /** @brief Cholesky factor L_B of B */
+    hpx::shared_future<std::vector<double>> L_B;
+
+    /** @brief c = L_B^-1 * V * Lambda^-1 * y */
+    hpx::shared_future<std::vector<double>> c;
+
+    /** @brief Loss of the approximation */
+    hpx::shared_future<double> loss;
+};
+
+// Number of accumulation chains of the reductions over the training tiles, the chains run concurrently
+static std::size_t sparse_reduction_chains(std::size_t n_tiles)
+{
+    return std::max<std::size_t>(1, std::min<std::size_t>(n_tiles, hpx::get_num_worker_threads()));
+}
+
+// Launch the asynchronous assembly of C = Q_NN + Lambda, the Cholesky decompositions of K_MM and B and the loss
+static Sparse_factorization factorize_sparse(const std::vector<double> &training_input,
+                                             const std::vector<double> &training_output,
+                                             const std::vector<double> &inducing_points,
+                                             int n_tiles,
+                                             int n_tile_size,
+                                             int n_regressors,
+                                             const gprat_hyper::SEKParams &sek_params,
+                                             gprat::Approximation approximation)
+{
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t M = inducing_points.size() / R;
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t n_chains = sparse_reduction_chains(static_cast<std::size_t>(n_tiles));
+
+    Sparse_factorization factorization;
+    factorization.K_MN_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    factorization.V_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    factorization.lambda_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    factorization.y_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    std::vector<hpx::shared_future<double>> tile_losses;
+    tile_losses.reserve(static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous Cholesky decomposition K_MM = L_u * L_u^T
+    factorization.K_MM = hpx::async(
+        hpx::annotated_function(&gen_tile_inducing_covariance, "assemble_sparse"), M, R, sek_params, inducing_points);
+    factorization.L_u = hpx::dataflow(
+        hpx::annotated_function(hpx::unwrapping(&potrf), "cholesky_sparse"), factorization.K_MM, static_cast<int>(M));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous reductions B - I = V * Lambda^-1 * V^T and r = V * Lambda^-1 * y over the training tiles
+    std::vector<hpx::shared_future<std::vector<double>>> B_chains;
+    std::vector<hpx::shared_future<std::vector<double>>> r_chains;
+    for (std::size_t k = 0; k < n_chains; k++)
+    {
+        B_chains.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_sparse"), M * M));
+        r_chains.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_sparse"), M));
+    }
+    for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+    {
+        factorization.K_MN_tiles.push_back(
+            hpx::async(hpx::annotated_function(&gen_tile_inducing_cross_covariance, "assemble_sparse"),
+                       j,
+                       M,
+                       N,
+                       R,
+                       sek_params,
+                       inducing_points,
+                       training_input));
+        factorization.y_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_sparse"), j, N, training_output));
+        // TRSM: Solve L_u * V = K_MN
+        factorization.V_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm), "reduce_sparse"),
+                          factorization.L_u,
+                          factorization.K_MN_tiles[j],
+                          static_cast<int>(M),
+                          static_cast<int>(N),
+                          Blas_no_trans,
+                          Blas_left));
+        factorization.lambda_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gen_tile_sparse_lambda), "reduce_sparse"),
+                          factorization.V_tiles[j],
+                          M,
+                          N,
+                          sek_params,
+                          approximation));
+        hpx::shared_future<std::vector<double>> scaled_V =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&scale_sparse_tile), "reduce_sparse"),
+                          factorization.V_tiles[j],
+                          factorization.lambda_tiles[j],
+                          M,
+                          N);
+        hpx::shared_future<std::vector<double>> scaled_y =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&scale_sparse_output), "reduce_sparse"),
+                          factorization.y_tiles[j],
+                          factorization.lambda_tiles[j]);
+        tile_losses.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_tile_loss), "loss_sparse"),
+                          factorization.lambda_tiles[j],
+                          scaled_y));
+        // SYRK: B = B + V * Lambda^-1 * V^T, GEMV: r = r + V * Lambda^-1 * y
+        const std::size_t k = j % n_chains;
+        B_chains[k] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&syrk_panel_add), "reduce_sparse"),
+                                    B_chains[k],
+                                    scaled_V,
+                                    static_cast<int>(M),
+                                    static_cast<int>(N));
+        r_chains[k] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv), "reduce_sparse"),
+                                    scaled_V,
+                                    scaled_y,
+                                    r_chains[k],
+                                    static_cast<int>(M),
+                                    static_cast<int>(N),
+                                    Blas_add,
+                                    Blas_no_trans);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous Cholesky decomposition B = L_B * L_B^T and forward solve L_B * c = r
+    hpx::shared_future<std::vector<double>> B =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&assemble_sparse_B), "reduce_sparse"), B_chains, M);
+    hpx::shared_future<std::vector<double>> r =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_sparse_partials), "reduce_sparse"), r_chains);
+    factorization.L_B =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&potrf), "cholesky_sparse"), B, static_cast<int>(M));
+    factorization.c = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "cholesky_sparse"),
+                                    factorization.L_B,
+                                    r,
+                                    static_cast<int>(M),
+                                    Blas_no_trans);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous loss computation
+    factorization.loss =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_loss_value), "loss_sparse"),
+                      factorization.L_B,
+                      factorization.c,
+                      tile_losses,
+                      M,
+                      N * static_cast<std::size_t>(n_tiles));
+    return factorization;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// LOSS AND GRADIENT
+
+double compute_sparse_loss(const std::vector<double> &training_input,
+                           const std::vector<double> &training_output,
+                           const std::vector<double> &inducing_points,
+                           int n_tiles,
+                           int n_tile_size,
+                           int n_regressors,
+                           const gprat_hyper::SEKParams &sek_params,
+                           gprat::Approximation approximation)
+{
+    return factorize_sparse(training_input,
+                            training_output,
+                            inducing_points,
+                            n_tiles,
+                            n_tile_size,
+                            n_regressors,
+                            sek_params,
+                            approximation)
+        .loss.get();
+}
+
+std::pair<double, std::vector<double>>
+compute_sparse_loss_and_gradient(const std::vector<double> &training_input,
+                                 const std::vector<double> &training_output,
+                                 const std::vector<double> &inducing_points,
+                                 int n_tiles,
+                                 int n_tile_size,
+                                 int n_regressors,
+                                 const gprat_hyper::SEKParams &sek_params,
+                                 gprat::Approximation approximation)
+{
+    /*
+     * Gradient of the loss 0.5 / N * ( log(det(C)) + y^T * C^-1 * y ) is 0.5 / N * tr(W * dC)
+     * with W = C^-1 - alpha * alpha^T and alpha = C^-1 * y, where
+     * dC = dK_NM * P + P^T * dK_MN - P^T * dK_MM * P + dLambda and P = K_MM^-1 * K_MN.
+     * All products with C^-1 reduce to products with B^-1, the traces are accumulated
+     * tile by tile from the derivatives of K_MN, K_MM and Lambda.
+     */
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t M = inducing_points.size() / R;
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t n_chains = sparse_reduction_chains(static_cast<std::size_t>(n_tiles));
+    const bool fitc = approximation == gprat::Approximation::fitc;
+
+    Sparse_factorization factorization = factorize_sparse(training_input,
+                                                          training_output,
+                                                          inducing_points,
+                                                          n_tiles,
+                                                          n_tile_size,
+                                                          n_regressors,
+                                                          sek_params,
+                                                          approximation);
+
+    // Tiled future data structures
+    Tiles<double> alpha_tiles;   // Tiled alpha = C^-1 * y
+    Tiles<double> X_tiles;       // Tiled X = B^-1 * V
+    Tiles<double> weight_tiles;  // Tiled diagonal of W
+    std::vector<hpx::shared_future<std::vector<double>>> tile_gradients;
+    alpha_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    X_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    weight_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    tile_gradients.reserve(static_cast<std::size_t>(n_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous backward solve L_B^T * b = c and computation of alpha = Lambda^-1 * (y - V^T * b)
+    hpx::shared_future<std::vector<double>> b =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "gradient_sparse"),
+                      factorization.L_B,
+                      factorization.c,
+                      static_cast<int>(M),
+                      Blas_trans);
+    std::vector<hpx::shared_future<std::vector<double>>> gamma_chains;
+    std::vector<hpx::shared_future<std::vector<double>>> Z_chains;
+    for (std::size_t k = 0; k < n_chains; k++)
+    {
+        gamma_chains.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_sparse"), M));
+        Z_chains.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_sparse"), M * M));
+    }
+    for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+    {
+        alpha_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_alpha), "gradient_sparse"),
+                          factorization.V_tiles[j],
+                          factorization.lambda_tiles[j],
+                          factorization.y_tiles[j],
+                          b,
+                          M,
+                          N));
+        // GEMV: gamma = gamma + V * alpha, such that beta = K_MM^-1 * K_MN * alpha = L_u^-T * gamma
+        const std::size_t k = j % n_chains;
+        gamma_chains[k] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv), "gradient_sparse"),
+                                        factorization.V_tiles[j],
+                                        alpha_tiles[j],
+                                        gamma_chains[k],
+                                        static_cast<int>(M),
+                                        static_cast<int>(N),
+                                        Blas_add,
+                                        Blas_no_trans);
+        // TRSM: Solve L_B * L_B^T * X = V
+        hpx::shared_future<std::vector<double>> U =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm), "gradient_sparse"),
+                          factorization.L_B,
+                          factorization.V_tiles[j],
+                          static_cast<int>(M),
+                          static_cast<int>(N),
+                          Blas_no_trans,
+                          Blas_left);
+        X_tiles.push_back(hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm), "gradient_sparse"),
+                                        factorization.L_B,
+                                        U,
+                                        static_cast<int>(M),
+                                        static_cast<int>(N),
+                                        Blas_trans,
+                                        Blas_left));
+        weight_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_weights), "gradient_sparse"),
+                          factorization.V_tiles[j],
+                          X_tiles[j],
+                          factorization.lambda_tiles[j],
+                          alpha_tiles[j],
+                          M,
+                          N));
+        if (fitc)
+        {
+            // Z = Z + V * diag(W) * V^T from the derivative of diag(Q_NN) in Lambda
+            Z_chains[k] = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&accumulate_sparse_weighted_gram), "gradient_sparse"),
+                Z_chains[k],
+                factorization.V_tiles[j],
+                weight_tiles[j],
+                M,
+                N);
+        }
+    }
+    hpx::shared_future<std::vector<double>> gamma =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_sparse_partials), "gradient_sparse"), gamma_chains);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous computation of the traces, the squared distances are recomputed on the fly
+    for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+    {
+        hpx::shared_future<std::vector<double>> distance =
+            hpx::async(hpx::annotated_function(&gen_tile_inducing_distance, "gradient_sparse"),
+                       j,
+                       M,
+                       N,
+                       R,
+                       inducing_points,
+                       training_input);
+        tile_gradients.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_tile_gradient), "gradient_sparse"),
+                          factorization.K_MN_tiles[j],
+                          distance,
+                          factorization.V_tiles[j],
+                          X_tiles[j],
+                          factorization.lambda_tiles[j],
+                          alpha_tiles[j],
+                          weight_tiles[j],
+                          gamma,
+                          factorization.L_u,
+                          M,
+                          N,
+                          sek_params,
+                          approximation));
+    }
+    hpx::shared_future<std::vector<double>> Z =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_sparse_partials), "gradient_sparse"), Z_chains);
+    hpx::shared_future<std::vector<double>> distance_MM = hpx::async(
+        hpx::annotated_function(&gen_tile_inducing_self_distance, "gradient_sparse"), M, R, inducing_points);
+    hpx::shared_future<std::vector<double>> gradient =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_gradient), "gradient_sparse"),
+                      tile_gradients,
+                      Z,
+                      gamma,
+                      factorization.L_u,
+                      factorization.L_B,
+                      factorization.K_MM,
+                      distance_MM,
+                      M,
+                      N * static_cast<std::size_t>(n_tiles),
+                      sek_params);
+
+    return { factorization.loss.get(), gradient.get() };
+}
+
+///////////////////////////////////////////////////////////////////////////
+// OPTIMIZATION
+
+std::vector<double> optimize_sparse(const std::vector<double> &training_input,
+                                    const std::vector<double> &training_output,
+                                    const std::vector<double> &inducing_points,
+                                    int n_tiles,
+                                    int n_tile_size,
+                                    int n_regressors,
+                                    const gprat_hyper::AdamParams &adam_params,
+                                    gprat_hyper::SEKParams &sek_params,
+                                    const std::vector<bool> &trainable_params,
+                                    gprat::Approximation approximation)
+{
+    std::vector<double> losses;
+    losses.reserve(static_cast<std::size_t>(adam_params.opt_iter));
+    for (std::size_t iter = 0; iter < static_cast<std::size_t>(adam_params.opt_iter); iter++)
+    {
+        auto [loss, gradient] = compute_sparse_loss_and_gradient(training_input,
+                                                                 training_output,
+                                                                 inducing_points,
+                                                                 n_tiles,
+                                                                 n_tile_size,
+                                                                 n_regressors,
+                                                                 sek_params,
+                                                                 approximation);
+        losses.push_back(loss);
+        sek_params = update_hyperparameters(gradient, adam_params, sek_params, trainable_params, iter);
+    }
+    return losses;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// PREDICTION
+
+std::vector<std::vector<double>>
+predict_sparse_with_uncertainty(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &inducing_points,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                gprat::Approximation approximation)
+{
+    /*
+     * Prediction: hat(y) = K_TM * L_u^-T * B^-1 * V * Lambda^-1 * y
+     * Uncertainty: diag(Sigma) = diag(U^T * U) for SoR and additionally diag(prior(K)) - diag(V^T * V)
+     * for DTC and FITC, where V = L_u^-1 * K_MT and U = L_B^-1 * V
+     */
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+    const std::size_t M = inducing_points.size() / R;
+    const std::size_t N = static_cast<std::size_t>(m_tile_size);
+
+    Sparse_factorization factorization = factorize_sparse(training_input,
+                                                          training_output,
+                                                          inducing_points,
+                                                          n_tiles,
+                                                          n_tile_size,
+                                                          n_regressors,
+                                                          sek_params,
+                                                          approximation);
+
+    // Tiled future data structures
+    Tiles<double> prediction_tiles;   // Tiled solution
+    Tiles<double> uncertainty_tiles;  // Tiled uncertainty solution
+    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    uncertainty_tiles.reserve(static_cast<std::size_t>(m_tiles));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Launch asynchronous backward solves L_u^T * L_B^T * w = c
+    hpx::shared_future<std::vector<double>> w =
+        hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "predict_sparse"),
+                      factorization.L_u,
+                      hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "predict_sparse"),
+                                    factorization.L_B,
+                                    factorization.c,
+                                    static_cast<int>(M),
+                                    Blas_trans),
+                      static_cast<int>(M),
+                      Blas_trans);
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        hpx::shared_future<std::vector<double>> K_MT =
+            hpx::async(hpx::annotated_function(&gen_tile_inducing_cross_covariance, "assemble_pred"),
+                       i,
+                       M,
+                       N,
+                       R,
+                       sek_params,
+                       inducing_points,
+                       test_input);
+        // GEMV: hat(y) = K_TM * w
+        prediction_tiles.push_back(hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&gemv), "predict_sparse"),
+            K_MT,
+            w,
+            hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), N),
+            static_cast<int>(M),
+            static_cast<int>(N),
+            Blas_add,
+            Blas_trans));
+        // TRSM: Solve L_u * V = K_MT and L_B * U = V
+        hpx::shared_future<std::vector<double>> V =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm), "predict_sparse"),
+                          factorization.L_u,
+                          K_MT,
+                          static_cast<int>(M),
+                          static_cast<int>(N),
+                          Blas_no_trans,
+                          Blas_left);
+        hpx::shared_future<std::vector<double>> U =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm), "predict_sparse"),
+                          factorization.L_B,
+                          V,
+                          static_cast<int>(M),
+                          static_cast<int>(N),
+                          Blas_no_trans,
+                          Blas_left);
+        uncertainty_tiles.push_back(
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_sparse_variance), "predict_sparse"),
+                          V,
+                          U,
+                          M,
+                          N,
+                          sek_params,
+                          approximation));
+    }
+
+    // Get & return predictions and uncertainty
+    std::vector<double> prediction_result;
+    std::vector<double> uncertainty_result;
+    prediction_result.reserve(static_cast<std::size_t>(m_tiles) * N);
+    uncertainty_result.reserve(static_cast<std::size_t>(m_tiles) * N);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        const std::vector<double> &prediction = prediction_tiles[i].get();
+        const std::vector<double> &uncertainty = uncertainty_tiles[i].get();
+        prediction_result.insert(prediction_result.end(), prediction.begin(), prediction.end());
+        uncertainty_result.insert(uncertainty_result.end(), uncertainty.begin(), uncertainty.end());
+    }
+    return std::vector<std::vector<double>>{ prediction_result, uncertainty_result };
+}
+
+}  // end of namespace cpu
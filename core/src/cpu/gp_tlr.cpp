@@ -0,0 +1,560 @@
+#include "cpu/gp_tlr.hpp"
+
+#include "cpu/adapter_cblas_fp64.hpp"
+#include "cpu/gp_algorithms.hpp"
+#include "cpu/tiled_algorithms.hpp"
+#include <algorithm>
+#include <cmath>
+#include <hpx/future.hpp>
+
+namespace cpu
+{
+
+/**
+ * @brief Off-diagonal tile in low-rank form A = U * V^T
+ */
+struct Low_rank_tile
+{
+    /** @brief Left factor of size N x rank */
+    std::vector<double> U;
+
+    /** @brief Right factor of size N x rank */
+    std::vector<double> V;
+
+    /** @brief Rank of the tile */
+    std::size_t rank;
+};
+
+///////////////////////////////////////////////////////////////////////////
+// COMPRESSION
+
+// Maximum rank of a compressed tile
+static std::size_t max_tile_rank(std::size_t N, const gprat_hyper::TLRParams &tlr_params)
+{
+    return tlr_params.max_rank > 0 ? std::min(N, static_cast<std::size_t>(tlr_params.max_rank)) : N;
+}
+
+// Recompress A = U * V^T with rank columns to the tolerance: QR decompositions U = Q_U * R_U and V = Q_V * R_V,
+// truncated singular value decomposition R_U * R_V^T = W * diag(sigma) * Z^T, U' = Q_U * W * diag(sigma) and
+// V' = Q_V * Z
+static Low_rank_tile recompress_low_rank(const std::vector<double> &U,
+                                         const std::vector<double> &V,
+                                         std::size_t N,
+                                         std::size_t rank,
+                                         const gprat_hyper::TLRParams &tlr_params)
+{
+    if (rank == 0)
+    {
+        return { {}, {}, 0 };
+    }
+    const std::size_t r = std::min(N, rank);
+    const int n = static_cast<int>(N);
+    const int k = static_cast<int>(rank);
+    const int r_int = static_cast<int>(r);
+
+    const std::vector<double> QR_U = geqrf_panel(U, n, k);
+    const std::vector<double> QR_V = geqrf_panel(V, n, k);
+    const std::vector<double> Q_U(QR_U.begin(), QR_U.begin() + static_cast<std::ptrdiff_t>(N * r));
+    const std::vector<double> Q_V(QR_V.begin(), QR_V.begin() + static_cast<std::ptrdiff_t>(N * r));
+    const std::vector<double> R_U(QR_U.begin() + static_cast<std::ptrdiff_t>(N * r), QR_U.end());
+    const std::vector<double> R_V(QR_V.begin() + static_cast<std::ptrdiff_t>(N * r), QR_V.end());
+
+    // Singular values sigma followed by W (r x r) and Z^T (r x r)
+    const std::vector<double> svd =
+        gesvd(gemm_panel_add(R_U, R_V, std::vector<double>(r * r, 0.0), r_int, r_int, k), r_int, r_int);
+    std::size_t truncated_rank = 0;
+    while (truncated_rank < std::min(r, max_tile_rank(N, tlr_params))
+           && svd[truncated_rank] > tlr_params.tolerance * svd[0])
+    {
+        truncated_rank++;
+    }
+    if (truncated_rank == 0)
+    {
+        return { {}, {}, 0 };
+    }
+
+    // U' = Q_U * (diag(sigma) * W^T)^T and V' = Q_V * (Z^T)^T with the leading truncated_rank rows
+    std::vector<double> scaled_W(truncated_rank * r);
+    std::vector<double> Z_T(truncated_rank * r);
+    for (std::size_t l = 0; l < truncated_rank; l++)
+    {
+        for (std::size_t j = 0; j < r; j++)
+        {
+            scaled_W[l * r + j] = svd[l] * svd[r + j * r + l];
+            Z_T[l * r + j] = svd[r + r * r + l * r + j];
+        }
+    }
+    const int t = static_cast<int>(truncated_rank);
+    return { gemm_panel_add(Q_U, scaled_W, std::vector<double>(N * truncated_rank, 0.0), n, t, r_int),
+             gemm_panel_add(Q_V, Z_T, std::vector<double>(N * truncated_rank, 0.0), n, t, r_int),
+             truncated_rank };
+}
+
+// Compress an off-diagonal covariance tile with adaptive cross approximation with partial pivoting, which only
+// evaluates the kernel on the pivot rows and columns, and recompress it
+static Low_rank_tile gen_tile_covariance_low_rank(std::size_t row,
+                                                  std::size_t col,
+                                                  std::size_t N,
+                                                  std::size_t n_regressors,
+                                                  const gprat_hyper::SEKParams &sek_params,
+                                                  const std::vector<double> &input,
+                                                  const gprat_hyper::TLRParams &tlr_params)
+{
+    /*
+     * Residual S_k = A - sum_l u_l * v_l^T, in step k:
+     * v = S_k(i*, :) / S_k(i*, j*) with j* = argmax |S_k(i*, :)|, u = S_k(:, j*)
+     * next pivot row i* = argmax |u| over the unused rows
+     * ||A_k||_F^2 = ||A_k-1||_F^2 + 2 * sum_l (u^T * u_l) * (v^T * v_l) + ||u||^2 * ||v||^2
+     * stop if ||u|| * ||v|| <= tolerance * ||A_k||_F
+     * skip row i* if |S_k(i*, j*)| <= tolerance * vertical_lengthscale, the largest kernel value
+     */
+    std::vector<std::vector<double>> U_columns;
+    std::vector<std::vector<double>> V_columns;
+    std::vector<bool> used_rows(N, false);
+    const std::size_t max_rank = max_tile_rank(N, tlr_params);
+    const double pivot_threshold = tlr_params.tolerance * sek_params.vertical_lengthscale;
+    double squared_norm = 0.0;
+    std::size_t pivot_row = 0;
+    auto kernel = [&](std::size_t i, std::size_t j)
+    { return compute_covariance_function(N * row + i, N * col + j, n_regressors, sek_params, input, input); };
+
+    while (U_columns.size() < max_rank)
+    {
+        used_rows[pivot_row] = true;
+        std::vector<double> v(N);
+        for (std::size_t j = 0; j < N; j++)
+        {
+            v[j] = kernel(pivot_row, j);
+            for (std::size_t l = 0; l < U_columns.size(); l++)
+            {
+                v[j] -= U_columns[l][pivot_row] * V_columns[l][j];
+            }
+        }
+        const std::size_t pivot_col = static_cast<std::size_t>(
+            std::distance(v.begin(),
+                          std::max_element(v.begin(),
+                                           v.end(),
+                                           [](double a, double b) { return std::fabs(a) < std::fabs(b); })));
+        const double pivot = v[pivot_col];
+        const bool negligible_row = std::fabs(pivot) <= pivot_threshold;
+        if (!negligible_row)
+        {
+            std::vector<double> u(N);
+            for (std::size_t i = 0; i < N; i++)
+            {
+                u[i] = kernel(i, pivot_col);
+                for (std::size_t l = 0; l < U_columns.size(); l++)
+                {
+                    u[i] -= U_columns[l][i] * V_columns[l][pivot_col];
+                }
+            }
+            for (auto &value : v)
+            {
+                value /= pivot;
+            }
+            const int n = static_cast<int>(N);
+            const double u_norm = dot(u, u, n);
+            const double v_norm = dot(v, v, n);
+            for (std::size_t l = 0; l < U_columns.size(); l++)
+            {
+                squared_norm += 2.0 * dot(u, U_columns[l], n) * dot(v, V_columns[l], n);
+            }
+            squared_norm += u_norm * v_norm;
+            U_columns.push_back(std::move(u));
+            V_columns.push_back(std::move(v));
+            if (std::sqrt(u_norm * v_norm) <= tlr_params.tolerance * std::sqrt(std::max(squared_norm, 0.0)))
+            {
+                break;
+            }
+        }
+
+        // Next pivot row: largest entry of the last column among the unused rows
+        double pivot_value = -1.0;
+        for (std::size_t i = 0; i < N; i++)
+        {
+            const double value = U_columns.empty() || negligible_row ? 0.0 : std::fabs(U_columns.back()[i]);
+            if (!used_rows[i] && value > pivot_value)
+            {
+                pivot_value = value;
+                pivot_row = i;
+            }
+        }
+        if (pivot_value < 0.0)
+        {
+            break;
+        }
+    }
+
+    // Pack the columns into N x rank factors
+    const std::size_t rank = U_columns.size();
+    std::vector<double> U(N * rank);
+    std::vector<double> V(N * rank);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t l = 0; l < rank; l++)
+        {
+            U[i * rank + l] = U_columns[l][i];
+            V[i * rank + l] = V_columns[l][i];
+        }
+    }
+    return recompress_low_rank(U, V, N, rank, tlr_params);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// TILE OPERATIONS
+
+// TRSM: L_mk = A_mk * L_kk^-T = U * (L_kk^-1 * V)^T
+static Low_rank_tile trsm_low_rank(const std::vector<double> &L, Low_rank_tile A, std::size_t N)
+{
+    if (A.rank > 0)
+    {
+        A.V = trsm(L, std::move(A.V), static_cast<int>(N), static_cast<int>(A.rank), Blas_no_trans, Blas_left);
+    }
+    return A;
+}
+
+// SYRK: A = A - B * B^T = A - U * (V^T * V) * U^T with dense A
+static std::vector<double> syrk_low_rank(std::vector<double> A, const Low_rank_tile &B, std::size_t N)
+{
+    if (B.rank == 0)
+    {
+        return A;
+    }
+    const int n = static_cast<int>(N);
+    const int k = static_cast<int>(B.rank);
+    std::vector<double> UG = gemm_panel_add(
+        B.U, gemm_panel_inner(B.V, B.V, n, k, k), std::vector<double>(N * B.rank, 0.0), n, k, k);
+    for (auto &value : UG)
+    {
+        value = -value;
+    }
+    return gemm_panel_add(UG, B.U, std::move(A), n, n, k);
+}
+
+// GEMM: C = C - A * B^T = C - U_A * (U_B * (V_A^T * V_B)^T)^T, recompressed to the tolerance
+static Low_rank_tile gemm_low_rank(const Low_rank_tile &A,
+                                   const Low_rank_tile &B,
+                                   const Low_rank_tile &C,
+                                   std::size_t N,
+                                   const gprat_hyper::TLRParams &tlr_params)
+{
+    if (A.rank == 0 || B.rank == 0)
+    {
+        return C;
+    }
+    const int n = static_cast<int>(N);
+    const int k_A = static_cast<int>(A.rank);
+    const int k_B = static_cast<int>(B.rank);
+    const std::vector<double> W = gemm_panel_add(
+        B.U, gemm_panel_inner(A.V, B.V, n, k_A, k_B), std::vector<double>(N * A.rank, 0.0), n, k_A, k_B);
+
+    // Concatenated factors [U_C, -U_A] and [V_C, W]
+    const std::size_t rank = C.rank + A.rank;
+    std::vector<double> U(N * rank);
+    std::vector<double> V(N * rank);
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t l = 0; l < C.rank; l++)
+        {
+            U[i * rank + l] = C.U[i * C.rank + l];
+            V[i * rank + l] = C.V[i * C.rank + l];
+        }
+        for (std::size_t l = 0; l < A.rank; l++)
+        {
+            U[i * rank + C.rank + l] = -A.U[i * A.rank + l];
+            V[i * rank + C.rank + l] = W[i * A.rank + l];
+        }
+    }
+    return recompress_low_rank(U, V, N, rank, tlr_params);
+}
+
+// GEMV: b = b - A(^T) * a = b - U * (V^T * a) or b - V * (U^T * a)
+static std::vector<double> gemv_low_rank(const Low_rank_tile &A,
+                                         const std::vector<double> &a,
+                                         std::vector<double> b,
+                                         std::size_t N,
+                                         BLAS_TRANSPOSE transpose_A)
+{
+    if (A.rank == 0)
+    {
+        return b;
+    }
+    const int n = static_cast<int>(N);
+    const int k = static_cast<int>(A.rank);
+    const bool transposed = transpose_A == Blas_trans;
+    const std::vector<double> projection =
+        gemv(transposed ? A.U : A.V, a, std::vector<double>(A.rank, 0.0), n, k, Blas_add, Blas_trans);
+    return gemv(transposed ? A.V : A.U, projection, std::move(b), n, k, Blas_substract, Blas_no_trans);
+}
+
+// Rank of a low-rank tile
+static int get_rank(const Low_rank_tile &A)
+{
+    return static_cast<int>(A.rank);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// TLR CHOLESKY
+
+/**
+ * @brief TLR Cholesky decomposition K = L * L^T
+ */
+struct Tlr_factorization
+{
+    /** @brief Dense Cholesky factors of the diagonal tiles at the indices k * n_tiles + k */
+    Tiles<double> diagonal_tiles;
+
+    /** @brief Low-rank tiles of L at the indices m * n_tiles + k with m > k */
+    std::vector<hpx::shared_future<Low_rank_tile>> low_rank_tiles;
+};
+
+// Assemble the compressed covariance matrix and launch the right-looking TLR Cholesky decomposition
+static Tlr_factorization factorize_tlr(const std::vector<double> &training_input,
+                                       int n_tiles,
+                                       int n_tile_size,
+                                       int n_regressors,
+                                       const gprat_hyper::SEKParams &sek_params,
+                                       const gprat_hyper::TLRParams &tlr_params)
+{
+    const std::size_t n = static_cast<std::size_t>(n_tiles);
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    const std::size_t R = static_cast<std::size_t>(n_regressors);
+
+    Tlr_factorization factorization{ Tiles<double>(n * n), std::vector<hpx::shared_future<Low_rank_tile>>(n * n) };
+    Tiles<double> &D = factorization.diagonal_tiles;
+    std::vector<hpx::shared_future<Low_rank_tile>> &L = factorization.low_rank_tiles;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        D[i * n + i] = hpx::async(hpx::annotated_function(gen_tile_covariance<double>, "assemble_tlr"),
+                                  i,
+                                  i,
+                                  N,
+                                  R,
+                                  sek_params,
+                                  training_input);
+        for (std::size_t j = 0; j < i; j++)
+        {
+            L[i * n + j] = hpx::async(hpx::annotated_function(&gen_tile_covariance_low_rank, "assemble_tlr"),
+                                      i,
+                                      j,
+                                      N,
+                                      R,
+                                      sek_params,
+                                      training_input,
+                                      tlr_params);
+        }
+    }
+
+    for (std::size_t k = 0; k < n; k++)
+    {
+        // POTRF: Compute dense Cholesky factor L_kk
+        D[k * n + k] = hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&potrf), "cholesky_tlr"), D[k * n + k], n_tile_size);
+        for (std::size_t m = k + 1; m < n; m++)
+        {
+            // TRSM: Solve X * L_kk^T = A on the right factor
+            L[m * n + k] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsm_low_rank), "cholesky_tlr"),
+                                         D[k * n + k],
+                                         L[m * n + k],
+                                         N);
+        }
+        for (std::size_t m = k + 1; m < n; m++)
+        {
+            // SYRK: A = A - B * B^T on the dense diagonal tile
+            D[m * n + m] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&syrk_low_rank), "cholesky_tlr"),
+                                         D[m * n + m],
+                                         L[m * n + k],
+                                         N);
+            for (std::size_t j = k + 1; j < m; j++)
+            {
+                // GEMM: C = C - A * B^T with recompression
+                L[m * n + j] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemm_low_rank), "cholesky_tlr"),
+                                             L[m * n + k],
+                                             L[j * n + k],
+                                             L[m * n + j],
+                                             N,
+                                             tlr_params);
+            }
+        }
+    }
+    return factorization;
+}
+
+// Launch the triangular solves L * beta = y and L^T * alpha = beta in-place on the tiled right-hand side
+static void solve_tlr(const Tlr_factorization &factorization, Tiles<double> &rhs_tiles, int n_tile_size)
+{
+    const std::size_t n = rhs_tiles.size();
+    const std::size_t N = static_cast<std::size_t>(n_tile_size);
+    for (std::size_t k = 0; k < n; k++)
+    {
+        // TRSV: Solve L_kk * x = a
+        rhs_tiles[k] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "solve_tlr"),
+                                     factorization.diagonal_tiles[k * n + k],
+                                     rhs_tiles[k],
+                                     n_tile_size,
+                                     Blas_no_trans);
+        for (std::size_t m = k + 1; m < n; m++)
+        {
+            // GEMV: b_m = b_m - L_mk * a_k
+            rhs_tiles[m] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv_low_rank), "solve_tlr"),
+                                         factorization.low_rank_tiles[m * n + k],
+                                         rhs_tiles[k],
+                                         rhs_tiles[m],
+                                         N,
+                                         Blas_no_trans);
+        }
+    }
+    for (std::size_t k = n; k-- > 0;)
+    {
+        // TRSV: Solve L_kk^T * x = a
+        rhs_tiles[k] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&trsv), "solve_tlr"),
+                                     factorization.diagonal_tiles[k * n + k],
+                                     rhs_tiles[k],
+                                     n_tile_size,
+                                     Blas_trans);
+        for (std::size_t m = 0; m < k; m++)
+        {
+            // GEMV: b_m = b_m - L_km^T * a_k
+            rhs_tiles[m] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&gemv_low_rank), "solve_tlr"),
+                                         factorization.low_rank_tiles[k * n + m],
+                                         rhs_tiles[k],
+                                         rhs_tiles[m],
+                                         N,
+                                         Blas_trans);
+        }
+    }
+}
+
+// Assemble the tiled training output
+static Tiles<double> assemble_output_tiles(const std::vector<double> &training_output, int n_tiles, int n_tile_size)
+{
+    Tiles<double> output_tiles;
+    output_tiles.reserve(static_cast<std::size_t>(n_tiles));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n_tiles); i++)
+    {
+        output_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_output<double>, "assemble_tlr"),
+                                          i,
+                                          static_cast<std::size_t>(n_tile_size),
+                                          training_output));
+    }
+    return output_tiles;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// LOSS AND PREDICTION
+
+double compute_tlr_loss(const std::vector<double> &training_input,
+                        const std::vector<double> &training_output,
+                        int n_tiles,
+                        int n_tile_size,
+                        int n_regressors,
+                        const gprat_hyper::SEKParams &sek_params,
+                        const gprat_hyper::TLRParams &tlr_params)
+{
+    // Loss: 0.5 / N * ( y^T * alpha + log(det(K)) + N * log(2 * pi) ) with log(det(K)) from the dense diagonal tiles
+    const Tlr_factorization factorization =
+        factorize_tlr(training_input, n_tiles, n_tile_size, n_regressors, sek_params, tlr_params);
+    const Tiles<double> output_tiles = assemble_output_tiles(training_output, n_tiles, n_tile_size);
+    Tiles<double> alpha_tiles = output_tiles;
+    solve_tlr(factorization, alpha_tiles, n_tile_size);
+
+    hpx::shared_future<double> loss;
+    compute_loss_tiled(factorization.diagonal_tiles,
+                       alpha_tiles,
+                       output_tiles,
+                       loss,
+                       n_tile_size,
+                       static_cast<std::size_t>(n_tiles));
+    return loss.get();
+}
+
+std::vector<double> predict_tlr(const std::vector<double> &training_input,
+                                const std::vector<double> &training_output,
+                                const std::vector<double> &test_input,
+                                int n_tiles,
+                                int n_tile_size,
+                                int m_tiles,
+                                int m_tile_size,
+                                int n_regressors,
+                                const gprat_hyper::SEKParams &sek_params,
+                                const gprat_hyper::TLRParams &tlr_params)
+{
+    // Prediction: hat(y) = cross(K) * alpha with alpha from the TLR Cholesky decomposition
+    const Tlr_factorization factorization =
+        factorize_tlr(training_input, n_tiles, n_tile_size, n_regressors, sek_params, tlr_params);
+    Tiles<double> alpha_tiles = assemble_output_tiles(training_output, n_tiles, n_tile_size);
+    solve_tlr(factorization, alpha_tiles, n_tile_size);
+
+    Tiles<double> cross_covariance_tiles;
+    Tiles<double> prediction_tiles;
+    cross_covariance_tiles.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(n_tiles));
+    prediction_tiles.reserve(static_cast<std::size_t>(m_tiles));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        for (std::size_t j = 0; j < static_cast<std::size_t>(n_tiles); j++)
+        {
+            cross_covariance_tiles.push_back(
+                hpx::async(hpx::annotated_function(gen_tile_cross_covariance<double>, "assemble_pred"),
+                           i,
+                           j,
+                           m_tile_size,
+                           n_tile_size,
+                           n_regressors,
+                           sek_params,
+                           test_input,
+                           training_input));
+        }
+        prediction_tiles.push_back(
+            hpx::async(hpx::annotated_function(gen_tile_zeros<double>, "assemble_tiled"), m_tile_size));
+    }
+    matrix_vector_tiled(cross_covariance_tiles,
+                        alpha_tiles,
+                        prediction_tiles,
+                        m_tile_size,
+                        n_tile_size,
+                        static_cast<std::size_t>(n_tiles),
+                        static_cast<std::size_t>(m_tiles));
+
+    std::vector<double> prediction_result;
+    prediction_result.reserve(static_cast<std::size_t>(m_tiles) * static_cast<std::size_t>(m_tile_size));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(m_tiles); i++)
+    {
+        const std::vector<double> &prediction = prediction_tiles[i].get();
+        prediction_result.insert(prediction_result.end(), prediction.begin(), prediction.end());
+    }
+    return prediction_result;
+}
+
+std::vector<int> compute_tlr_ranks(const std::vector<double> &training_input,
+                                   int n_tiles,
+                                   int n_tile_size,
+                                   int n_regressors,
+                                   const gprat_hyper::SEKParams &sek_params,
+                                   const gprat_hyper::TLRParams &tlr_params)
+{
+    const Tlr_factorization factorization =
+        factorize_tlr(training_input, n_tiles, n_tile_size, n_regressors, sek_params, tlr_params);
+    const std::size_t n = static_cast<std::size_t>(n_tiles);
+    std::vector<hpx::shared_future<int>> rank_futures(n * n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            rank_futures[i * n + j] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&get_rank), "ranks_tlr"),
+                                                    factorization.low_rank_tiles[i * n + j]);
+        }
+    }
+    std::vector<int> ranks(n * n, 0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        factorization.diagonal_tiles[i * n + i].wait();
+        ranks[i * n + i] = n_tile_size;
+        for (std::size_t j = 0; j < i; j++)
+        {
+            ranks[i * n + j] = rank_futures[i * n + j].get();
+        }
+    }
+    return ranks;
+}
+
+}  // end of namespace cpu
@@ -3,11 +3,12 @@
 namespace cpu
 {
 
-hpx::shared_future<std::vector<double>> get_matrix_diagonal(hpx::shared_future<std::vector<double>> f_A, std::size_t M)
+template <typename T>
+hpx::shared_future<std::vector<T>> get_matrix_diagonal(hpx::shared_future<std::vector<T>> f_A, std::size_t M)
 {
-    auto A = f_A.get();
+    const auto &A = f_A.get();
     // Preallocate memory
-    std::vector<double> tile;
+    std::vector<T> tile;
     tile.reserve(M);
     // Add elements
     for (std::size_t i = 0; i < M; ++i)
@@ -18,4 +19,10 @@ hpx::shared_future<std::vector<double>> get_matrix_diagonal(hpx::shared_future<s
     return hpx::make_ready_future(std::move(tile));
 }
 
+// Explicit instantiations for FP64 and FP32 tiles
+template hpx::shared_future<std::vector<double>>
+get_matrix_diagonal<double>(hpx::shared_future<std::vector<double>>, std::size_t);
+template hpx::shared_future<std::vector<float>>
+get_matrix_diagonal<float>(hpx::shared_future<std::vector<float>>, std::size_t);
+
 }  // end of namespace cpu
@@ -1,235 +1,1008 @@
 #include "cpu/tiled_algorithms.hpp"
 
+#include "cpu/adapter_cblas_fp32.hpp"
 #include "cpu/adapter_cblas_fp64.hpp"
 #include "cpu/gp_algorithms.hpp"
 #include "cpu/gp_optimizer.hpp"
 #include "cpu/gp_uncertainty.hpp"
+#include <hpx/execution.hpp>
 #include <hpx/future.hpp>
 
 namespace cpu
 {
 
+// Tile ownership
+
+// Tile version with a single consumer
+template <typename T>
+using Tile_future = hpx::future<std::vector<T>>;
+
+/**
+ * @brief Launch an update of a tile, in-place on its pending intermediate version if there is one
+ *
+ * Tile versions that are only consumed by the next update of the same tile are kept as
+ * unique futures, so that the update takes over their storage. Otherwise the update
+ * receives the shared tile and copies it.
+ *
+ * @param ft_pending Pending intermediate tile versions, the one at index is moved into the update.
+ * @param ft_tiles Shared tiles, used if no intermediate version of the tile is pending.
+ * @param index Index of the tile.
+ * @param update Callable launching the update task for the passed tile future.
+ *
+ * @return Future of the updated tile.
+ */
+template <typename T, typename Update>
+static hpx::future<T> update_tile(std::vector<hpx::future<T>> &ft_pending,
+                                  const std::vector<hpx::shared_future<T>> &ft_tiles,
+                                  std::size_t index,
+                                  Update &&update)
+{
+    if (ft_pending[index].valid())
+    {
+        return update(std::move(ft_pending[index]));
+    }
+    return update(ft_tiles[index]);
+}
+
+// BLAS operations on tiles with elements of type T
+template <typename T>
+struct Blas;
+
+template <>
+struct Blas<double>
+{
+    static constexpr auto potrf = &::potrf;
+    static constexpr auto trsm = &::trsm;
+    static constexpr auto syrk = &::syrk;
+    static constexpr auto gemm = &::gemm;
+    static constexpr auto trtri = &::trtri;
+    static constexpr auto lauum = &::lauum;
+    static constexpr auto trmm = &::trmm;
+    static constexpr auto syrk_trans_add = &::syrk_trans_add;
+    static constexpr auto gemm_trans_add = &::gemm_trans_add;
+    static constexpr auto trsv = &::trsv;
+    static constexpr auto gemv = &::gemv;
+    static constexpr auto symv = &::symv;
+    static constexpr auto dot_diag_syrk = &::dot_diag_syrk;
+    static constexpr auto dot_diag_gemm = &::dot_diag_gemm;
+    static constexpr auto axpy = &::axpy;
+};
+
+template <>
+struct Blas<float>
+{
+    static constexpr auto potrf = &fp32::potrf;
+    static constexpr auto trsm = &fp32::trsm;
+    static constexpr auto syrk = &fp32::syrk;
+    static constexpr auto gemm = &fp32::gemm;
+    static constexpr auto trtri = &fp32::trtri;
+    static constexpr auto lauum = &fp32::lauum;
+    static constexpr auto trmm = &fp32::trmm;
+    static constexpr auto syrk_trans_add = &fp32::syrk_trans_add;
+    static constexpr auto gemm_trans_add = &fp32::gemm_trans_add;
+    static constexpr auto trsv = &fp32::trsv;
+    static constexpr auto gemv = &fp32::gemv;
+    static constexpr auto symv = &fp32::symv;
+    static constexpr auto dot_diag_syrk = &fp32::dot_diag_syrk;
+    static constexpr auto dot_diag_gemm = &fp32::dot_diag_gemm;
+    static constexpr auto axpy = &fp32::axpy;
+};
+
 // Tiled Cholesky Algorithm
 
-void right_looking_cholesky_tiled(Tiled_matrix &ft_tiles, int N, std::size_t n_tiles)
+// Number of trailing tile columns whose updates are prioritized together with the next panel
+static constexpr std::size_t CHOLESKY_LOOKAHEAD = GPRAT_CHOLESKY_LOOKAHEAD;
+
+/**
+ * @brief Get the executor for a task of the tiled Cholesky decomposition
+ *
+ * Tasks on the critical path, i.e. the panel factorization and the updates of the
+ * next CHOLESKY_LOOKAHEAD tile columns, run with high thread priority so that the
+ * next panel is not delayed by the remaining trailing updates.
+ *
+ * @param critical Whether the task is on the critical path.
+ *
+ * @return The executor to launch the task with.
+ */
+static hpx::execution::parallel_executor cholesky_executor(bool critical)
+{
+    return hpx::execution::parallel_executor(critical && CHOLESKY_LOOKAHEAD > 0
+                                                 ? hpx::threads::thread_priority::high
+                                                 : hpx::threads::thread_priority::default_);
+}
+
+// Cholesky decomposition of the tile rows n_tiles_old to n_tiles - 1, where the pending tile
+// versions are updated in-place
+template <typename T>
+static void extend_cholesky_pending(std::vector<Tile_future<T>> &ft_pending,
+                                    Tiles<T> &ft_tiles,
+                                    int N,
+                                    std::size_t n_tiles_old,
+                                    std::size_t n_tiles)
 {
     for (std::size_t k = 0; k < n_tiles; k++)
     {
-        // POTRF: Compute Cholesky factor L
-        ft_tiles[k * n_tiles + k] =
-            hpx::dataflow(hpx::annotated_function(potrf, "cholesky_tiled"), ft_tiles[k * n_tiles + k], N);
-        for (std::size_t m = k + 1; m < n_tiles; m++)
+        // Only the new tile rows are updated, previous columns are already factorized
+        std::size_t m_begin = std::max(k + 1, n_tiles_old);
+        if (k >= n_tiles_old)
+        {
+            // POTRF: Compute Cholesky factor L
+            ft_tiles[k * n_tiles + k] = update_tile(
+                ft_pending,
+                ft_tiles,
+                k * n_tiles + k,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(cholesky_executor(true),
+                                         hpx::annotated_function(hpx::unwrapping(Blas<T>::potrf), "cholesky_tiled"),
+                                         std::forward<decltype(ft_A)>(ft_A),
+                                         N);
+                });
+        }
+        for (std::size_t m = m_begin; m < n_tiles; m++)
         {
             // TRSM:  Solve X * L^T = A
-            ft_tiles[m * n_tiles + k] = hpx::dataflow(
-                hpx::annotated_function(trsm, "cholesky_tiled"),
-                ft_tiles[k * n_tiles + k],
-                ft_tiles[m * n_tiles + k],
-                N,
-                N,
-                Blas_trans,
-                Blas_right);
+            ft_tiles[m * n_tiles + k] = update_tile(
+                ft_pending,
+                ft_tiles,
+                m * n_tiles + k,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(cholesky_executor(true),
+                                         hpx::annotated_function(hpx::unwrapping(Blas<T>::trsm), "cholesky_tiled"),
+                                         ft_tiles[k * n_tiles + k],
+                                         std::forward<decltype(ft_A)>(ft_A),
+                                         N,
+                                         N,
+                                         Blas_trans,
+                                         Blas_right);
+                });
+        }
+        for (std::size_t m = m_begin; m < n_tiles; m++)
+        {
+            // SYRK:  A = A - B * B^T, critical within the lookahead tile columns
+            ft_pending[m * n_tiles + m] = update_tile(
+                ft_pending,
+                ft_tiles,
+                m * n_tiles + m,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(cholesky_executor(m <= k + CHOLESKY_LOOKAHEAD),
+                                         hpx::annotated_function(hpx::unwrapping(Blas<T>::syrk), "cholesky_tiled"),
+                                         std::forward<decltype(ft_A)>(ft_A),
+                                         ft_tiles[m * n_tiles + k],
+                                         N);
+                });
+            for (std::size_t n = k + 1; n < m; n++)
+            {
+                // GEMM: C = C - A * B^T, critical within the lookahead tile columns
+                ft_pending[m * n_tiles + n] = update_tile(
+                    ft_pending,
+                    ft_tiles,
+                    m * n_tiles + n,
+                    [&](auto &&ft_C)
+                    {
+                        return hpx::dataflow(cholesky_executor(n <= k + CHOLESKY_LOOKAHEAD),
+                                             hpx::annotated_function(hpx::unwrapping(Blas<T>::gemm), "cholesky_tiled"),
+                                             ft_tiles[m * n_tiles + k],
+                                             ft_tiles[n * n_tiles + k],
+                                             std::forward<decltype(ft_C)>(ft_C),
+                                             N,
+                                             N,
+                                             N,
+                                             Blas_no_trans,
+                                             Blas_trans);
+                    });
+            }
+        }
+    }
+}
+
+template <typename T>
+void right_looking_cholesky_tiled(Tiles<T> &ft_tiles, int N, std::size_t n_tiles)
+{
+    extend_cholesky_tiled(ft_tiles, N, 0, n_tiles);
+}
+
+template <typename T>
+void right_looking_cholesky_tiled(Owned_tiles<T> &ft_owned, Tiles<T> &ft_tiles, int N, std::size_t n_tiles)
+{
+    // The owned tiles are the pending versions of all tiles
+    extend_cholesky_pending(ft_owned, ft_tiles, N, 0, n_tiles);
+}
+
+// FP64 update of a diagonal tile with an FP32 tile: A = A - B * B^T
+static std::vector<double> syrk_fp32(std::vector<double> A, const std::vector<float> &B, const int N)
+{
+    // Widening B is exact, so the update is accumulated in FP64
+    return syrk(std::move(A), gen_tile_fp64(B), N);
+}
+
+void right_looking_cholesky_tiled_mixed(Tiled_matrix &ft_tiles, Tiles<float> &ft_single, int N, std::size_t n_tiles)
+{
+    // Pending versions of the FP64 diagonal and FP32 off-diagonal tiles between their SYRK/GEMM updates
+    std::vector<Tile_future<float>> ft_single_pending(n_tiles * n_tiles);
+    std::vector<Tile_future<double>> ft_pending(n_tiles * n_tiles);
+    for (std::size_t k = 0; k < n_tiles; k++)
+    {
+        // POTRF: Compute FP64 Cholesky factor L
+        ft_tiles[k * n_tiles + k] = update_tile(
+            ft_pending,
+            ft_tiles,
+            k * n_tiles + k,
+            [&](auto &&ft_A)
+            {
+                return hpx::dataflow(cholesky_executor(true),
+                                     hpx::annotated_function(hpx::unwrapping(&potrf), "cholesky_tiled_mixed"),
+                                     std::forward<decltype(ft_A)>(ft_A),
+                                     N);
+            });
+        hpx::shared_future<std::vector<float>> ft_diagonal_single =
+            hpx::dataflow(cholesky_executor(true),
+                          hpx::annotated_function(hpx::unwrapping(&gen_tile_fp32), "cholesky_tiled_mixed"),
+                          ft_tiles[k * n_tiles + k]);
+        for (std::size_t m = k + 1; m < n_tiles; m++)
+        {
+            // TRSM:  Solve X * L^T = A in FP32
+            ft_single[m * n_tiles + k] = update_tile(
+                ft_single_pending,
+                ft_single,
+                m * n_tiles + k,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(cholesky_executor(true),
+                                         hpx::annotated_function(hpx::unwrapping(&fp32::trsm), "cholesky_tiled_mixed"),
+                                         ft_diagonal_single,
+                                         std::forward<decltype(ft_A)>(ft_A),
+                                         N,
+                                         N,
+                                         Blas_trans,
+                                         Blas_right);
+                });
         }
         for (std::size_t m = k + 1; m < n_tiles; m++)
         {
-            // SYRK:  A = A - B * B^T
-            ft_tiles[m * n_tiles + m] = hpx::dataflow(
-                hpx::annotated_function(syrk, "cholesky_tiled"),
-                ft_tiles[m * n_tiles + m],
-                ft_tiles[m * n_tiles + k],
-                N);
+            // SYRK:  A = A - B * B^T in FP64, critical within the lookahead tile columns
+            ft_pending[m * n_tiles + m] = update_tile(
+                ft_pending,
+                ft_tiles,
+                m * n_tiles + m,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(cholesky_executor(m <= k + CHOLESKY_LOOKAHEAD),
+                                         hpx::annotated_function(hpx::unwrapping(&syrk_fp32), "cholesky_tiled_mixed"),
+                                         std::forward<decltype(ft_A)>(ft_A),
+                                         ft_single[m * n_tiles + k],
+                                         N);
+                });
             for (std::size_t n = k + 1; n < m; n++)
             {
-                // GEMM: C = C - A * B^T
-                ft_tiles[m * n_tiles + n] = hpx::dataflow(
-                    hpx::annotated_function(gemm, "cholesky_tiled"),
-                    ft_tiles[m * n_tiles + k],
-                    ft_tiles[n * n_tiles + k],
-                    ft_tiles[m * n_tiles + n],
-                    N,
-                    N,
-                    N,
-                    Blas_no_trans,
-                    Blas_trans);
+                // GEMM: C = C - A * B^T in FP32, critical within the lookahead tile columns
+                ft_single_pending[m * n_tiles + n] = update_tile(
+                    ft_single_pending,
+                    ft_single,
+                    m * n_tiles + n,
+                    [&](auto &&ft_C)
+                    {
+                        return hpx::dataflow(
+                            cholesky_executor(n <= k + CHOLESKY_LOOKAHEAD),
+                            hpx::annotated_function(hpx::unwrapping(&fp32::gemm), "cholesky_tiled_mixed"),
+                            ft_single[m * n_tiles + k],
+                            ft_single[n * n_tiles + k],
+                            std::forward<decltype(ft_C)>(ft_C),
+                            N,
+                            N,
+                            N,
+                            Blas_no_trans,
+                            Blas_trans);
+                    });
             }
         }
     }
 }
 
-// Tiled Triangular Solve Algorithms
+template <typename T>
+void extend_cholesky_tiled(Tiles<T> &ft_tiles, int N, std::size_t n_tiles_old, std::size_t n_tiles)
+{
+    // Trailing tiles between their SYRK/GEMM updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles * n_tiles);
+    extend_cholesky_pending(ft_pending, ft_tiles, N, n_tiles_old, n_tiles);
+}
 
-void forward_solve_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_rhs, int N, std::size_t n_tiles)
+void update_cholesky_tiled(Tiled_matrix &ft_tiles, Tiled_matrix &ft_update, int N, std::size_t n_tiles)
 {
     for (std::size_t k = 0; k < n_tiles; k++)
     {
-        // TRSM: Solve L * x = a
-        ft_rhs[k] = hpx::dataflow(
-            hpx::annotated_function(trsv, "triangular_solve_tiled"),
+        // GEQRF: [L_kk^T; W_k^T] = Q * [R; 0]
+        hpx::shared_future<std::vector<double>> ft_qr = hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&geqrf_update), "cholesky_update_tiled"),
             ft_tiles[k * n_tiles + k],
-            ft_rhs[k],
-            N,
-            Blas_no_trans);
+            ft_update[k],
+            N);
+        // L_kk' = R^T
+        ft_tiles[k * n_tiles + k] = hpx::dataflow(
+            hpx::annotated_function(hpx::unwrapping(&qr_update_factor), "cholesky_update_tiled"), ft_qr, N);
         for (std::size_t m = k + 1; m < n_tiles; m++)
         {
-            // GEMV: b = b - A * a
-            ft_rhs[m] = hpx::dataflow(
-                hpx::annotated_function(gemv, "triangular_solve_tiled"),
+            // ORMQR: [L_mk' W_m'] = [L_mk W_m] * Q
+            hpx::shared_future<std::vector<double>> ft_packed = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&ormqr_update), "cholesky_update_tiled"),
+                ft_qr,
                 ft_tiles[m * n_tiles + k],
-                ft_rhs[k],
-                ft_rhs[m],
-                N,
-                N,
-                Blas_substract,
-                Blas_no_trans);
+                ft_update[m],
+                N);
+            ft_tiles[m * n_tiles + k] = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&gen_tile_unpack), "cholesky_update_tiled"),
+                std::size_t{ 0 },
+                static_cast<std::size_t>(N),
+                ft_packed);
+            ft_update[m] = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&gen_tile_unpack), "cholesky_update_tiled"),
+                std::size_t{ 1 },
+                static_cast<std::size_t>(N),
+                ft_packed);
         }
     }
 }
 
-void backward_solve_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_rhs, int N, std::size_t n_tiles)
+// Tiled Triangular Solve Algorithms
+
+template <typename T>
+void forward_solve_tiled(const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, std::size_t n_tiles)
+{
+    extend_forward_solve_tiled(ft_tiles, ft_rhs, N, 0, n_tiles);
+}
+
+template <typename T>
+void backward_solve_tiled(const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, std::size_t n_tiles)
 {
+    // Right-hand side tiles between their GEMV updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles);
     for (int k_ = static_cast<int>(n_tiles) - 1; k_ >= 0; k_--)  // int instead of std::size_t for last comparison
     {
         std::size_t k = static_cast<std::size_t>(k_);
         // TRSM: Solve L^T * x = a
-        ft_rhs[k] = hpx::dataflow(
-            hpx::annotated_function(trsv, "triangular_solve_tiled"),
-            ft_tiles[k * n_tiles + k],
-            ft_rhs[k],
-            N,
-            Blas_trans);
+        ft_rhs[k] = update_tile(
+            ft_pending,
+            ft_rhs,
+            k,
+            [&](auto &&ft_a)
+            {
+                return hpx::dataflow(hpx::annotated_function(hpx::unwrapping(Blas<T>::trsv), "triangular_solve_tiled"),
+                                     ft_tiles[k * n_tiles + k],
+                                     std::forward<decltype(ft_a)>(ft_a),
+                                     N,
+                                     Blas_trans);
+            });
         for (int m_ = k_ - 1; m_ >= 0; m_--)  // int instead of std::size_t for last comparison
         {
             std::size_t m = static_cast<std::size_t>(m_);
             // GEMV:b = b - A^T * a
-            ft_rhs[m] = hpx::dataflow(
-                hpx::annotated_function(gemv, "triangular_solve_tiled"),
-                ft_tiles[k * n_tiles + m],
-                ft_rhs[k],
-                ft_rhs[m],
-                N,
-                N,
-                Blas_substract,
-                Blas_trans);
+            ft_pending[m] = update_tile(
+                ft_pending,
+                ft_rhs,
+                m,
+                [&](auto &&ft_b)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::gemv), "triangular_solve_tiled"),
+                        ft_tiles[k * n_tiles + m],
+                        ft_rhs[k],
+                        std::forward<decltype(ft_b)>(ft_b),
+                        N,
+                        N,
+                        Blas_substract,
+                        Blas_trans);
+                });
         }
     }
 }
 
-void forward_solve_tiled_matrix(
-    Tiled_matrix &ft_tiles, Tiled_matrix &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
+// FP64 update of a vector tile with an FP32 matrix tile: b = b - A(^T) * a
+static std::vector<double> gemv_fp32(const std::vector<float> &A,
+                                     const std::vector<double> &a,
+                                     std::vector<double> b,
+                                     const int N,
+                                     const BLAS_TRANSPOSE transpose_A)
+{
+    // Each entry of A is widened once when it is read, the products are accumulated in FP64
+    const std::size_t n = static_cast<std::size_t>(N);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const float *A_row = A.data() + i * n;
+        if (transpose_A == Blas_trans)
+        {
+            for (std::size_t j = 0; j < n; j++)
+            {
+                b[j] -= static_cast<double>(A_row[j]) * a[i];
+            }
+        }
+        else
+        {
+            double sum = 0.0;
+            for (std::size_t j = 0; j < n; j++)
+            {
+                sum += static_cast<double>(A_row[j]) * a[j];
+            }
+            b[i] -= sum;
+        }
+    }
+    return b;
+}
+
+void forward_solve_tiled_mixed(const Tiled_matrix &ft_tiles,
+                               const Tiles<float> &ft_single,
+                               Tiled_vector &ft_rhs,
+                               int N,
+                               std::size_t n_tiles)
+{
+    // Right-hand side tiles between their GEMV updates, updated in-place
+    std::vector<Tile_future<double>> ft_pending(n_tiles);
+    for (std::size_t k = 0; k < n_tiles; k++)
+    {
+        // TRSV: Solve L * x = a with the FP64 diagonal tile
+        ft_rhs[k] = update_tile(
+            ft_pending,
+            ft_rhs,
+            k,
+            [&](auto &&ft_a)
+            {
+                return hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(Blas<double>::trsv), "triangular_solve_tiled_mixed"),
+                    ft_tiles[k * n_tiles + k],
+                    std::forward<decltype(ft_a)>(ft_a),
+                    N,
+                    Blas_no_trans);
+            });
+        for (std::size_t m = k + 1; m < n_tiles; m++)
+        {
+            // GEMV: b = b - A * a with the FP32 off-diagonal tile
+            ft_pending[m] = update_tile(
+                ft_pending,
+                ft_rhs,
+                m,
+                [&](auto &&ft_b)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(&gemv_fp32), "triangular_solve_tiled_mixed"),
+                        ft_single[m * n_tiles + k],
+                        ft_rhs[k],
+                        std::forward<decltype(ft_b)>(ft_b),
+                        N,
+                        Blas_no_trans);
+                });
+        }
+    }
+}
+
+void backward_solve_tiled_mixed(const Tiled_matrix &ft_tiles,
+                                const Tiles<float> &ft_single,
+                                Tiled_vector &ft_rhs,
+                                int N,
+                                std::size_t n_tiles)
+{
+    // Right-hand side tiles between their GEMV updates, updated in-place
+    std::vector<Tile_future<double>> ft_pending(n_tiles);
+    for (int k_ = static_cast<int>(n_tiles) - 1; k_ >= 0; k_--)  // int instead of std::size_t for last comparison
+    {
+        std::size_t k = static_cast<std::size_t>(k_);
+        // TRSV: Solve L^T * x = a with the FP64 diagonal tile
+        ft_rhs[k] = update_tile(
+            ft_pending,
+            ft_rhs,
+            k,
+            [&](auto &&ft_a)
+            {
+                return hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(Blas<double>::trsv), "triangular_solve_tiled_mixed"),
+                    ft_tiles[k * n_tiles + k],
+                    std::forward<decltype(ft_a)>(ft_a),
+                    N,
+                    Blas_trans);
+            });
+        for (int m_ = k_ - 1; m_ >= 0; m_--)  // int instead of std::size_t for last comparison
+        {
+            std::size_t m = static_cast<std::size_t>(m_);
+            // GEMV: b = b - A^T * a with the FP32 off-diagonal tile
+            ft_pending[m] = update_tile(
+                ft_pending,
+                ft_rhs,
+                m,
+                [&](auto &&ft_b)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(&gemv_fp32), "triangular_solve_tiled_mixed"),
+                        ft_single[k * n_tiles + m],
+                        ft_rhs[k],
+                        std::forward<decltype(ft_b)>(ft_b),
+                        N,
+                        Blas_trans);
+                });
+        }
+    }
+}
+
+template <typename T>
+void extend_forward_solve_tiled(
+    const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, std::size_t n_tiles_old, std::size_t n_tiles)
+{
+    // Right-hand side tiles between their GEMV updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles);
+    for (std::size_t k = 0; k < n_tiles; k++)
+    {
+        if (k >= n_tiles_old)
+        {
+            // TRSM: Solve L * x = a
+            ft_rhs[k] = update_tile(
+                ft_pending,
+                ft_rhs,
+                k,
+                [&](auto &&ft_a)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::trsv), "triangular_solve_tiled"),
+                        ft_tiles[k * n_tiles + k],
+                        std::forward<decltype(ft_a)>(ft_a),
+                        N,
+                        Blas_no_trans);
+                });
+        }
+        for (std::size_t m = std::max(k + 1, n_tiles_old); m < n_tiles; m++)
+        {
+            // GEMV: b = b - A * a
+            ft_pending[m] = update_tile(
+                ft_pending,
+                ft_rhs,
+                m,
+                [&](auto &&ft_b)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::gemv), "triangular_solve_tiled"),
+                        ft_tiles[m * n_tiles + k],
+                        ft_rhs[k],
+                        std::forward<decltype(ft_b)>(ft_b),
+                        N,
+                        N,
+                        Blas_substract,
+                        Blas_no_trans);
+                });
+        }
+    }
+}
+
+// Forward triangular matrix-matrix solve, where the pending right-hand side tile versions are updated in-place
+template <typename T>
+static void forward_solve_pending(const Tiles<T> &ft_tiles,
+                                  std::vector<Tile_future<T>> &ft_pending,
+                                  Tiles<T> &ft_rhs,
+                                  int N,
+                                  int M,
+                                  std::size_t n_tiles,
+                                  std::size_t m_tiles)
 {
     for (std::size_t c = 0; c < m_tiles; c++)
     {
         for (std::size_t k = 0; k < n_tiles; k++)
         {
             // TRSM: solve L * X = A
-            ft_rhs[k * m_tiles + c] = hpx::dataflow(
-                hpx::annotated_function(trsm, "triangular_solve_tiled_matrix"),
-                ft_tiles[k * n_tiles + k],
-                ft_rhs[k * m_tiles + c],
-                N,
-                M,
-                Blas_no_trans,
-                Blas_left);
+            ft_rhs[k * m_tiles + c] = update_tile(
+                ft_pending,
+                ft_rhs,
+                k * m_tiles + c,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::trsm), "triangular_solve_tiled_matrix"),
+                        ft_tiles[k * n_tiles + k],
+                        std::forward<decltype(ft_A)>(ft_A),
+                        N,
+                        M,
+                        Blas_no_trans,
+                        Blas_left);
+                });
             for (std::size_t m = k + 1; m < n_tiles; m++)
             {
                 // GEMM: C = C - A * B
-                ft_rhs[m * m_tiles + c] = hpx::dataflow(
-                    hpx::annotated_function(gemm, "triangular_solve_tiled_matrix"),
-                    ft_tiles[m * n_tiles + k],
-                    ft_rhs[k * m_tiles + c],
-                    ft_rhs[m * m_tiles + c],
-                    N,
-                    M,
-                    N,
-                    Blas_no_trans,
-                    Blas_no_trans);
+                ft_pending[m * m_tiles + c] = update_tile(
+                    ft_pending,
+                    ft_rhs,
+                    m * m_tiles + c,
+                    [&](auto &&ft_C)
+                    {
+                        return hpx::dataflow(
+                            hpx::annotated_function(hpx::unwrapping(Blas<T>::gemm), "triangular_solve_tiled_matrix"),
+                            ft_tiles[m * n_tiles + k],
+                            ft_rhs[k * m_tiles + c],
+                            std::forward<decltype(ft_C)>(ft_C),
+                            N,
+                            M,
+                            N,
+                            Blas_no_trans,
+                            Blas_no_trans);
+                    });
             }
         }
     }
 }
 
+template <typename T>
+void forward_solve_tiled_matrix(
+    const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
+{
+    // Right-hand side tiles between their GEMM updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles * m_tiles);
+    forward_solve_pending(ft_tiles, ft_pending, ft_rhs, N, M, n_tiles, m_tiles);
+}
+
+template <typename T>
+void forward_solve_tiled_matrix(const Tiles<T> &ft_tiles,
+                                Owned_tiles<T> &ft_owned_rhs,
+                                Tiles<T> &ft_rhs,
+                                int N,
+                                int M,
+                                std::size_t n_tiles,
+                                std::size_t m_tiles)
+{
+    // The owned tiles are the pending versions of all right-hand side tiles
+    forward_solve_pending(ft_tiles, ft_owned_rhs, ft_rhs, N, M, n_tiles, m_tiles);
+}
+
+template <typename T>
 void backward_solve_tiled_matrix(
-    Tiled_matrix &ft_tiles, Tiled_matrix &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
+    const Tiles<T> &ft_tiles, Tiles<T> &ft_rhs, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
 {
+    // Right-hand side tiles between their GEMM updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles * m_tiles);
     for (std::size_t c = 0; c < m_tiles; c++)
     {
         for (int k_ = static_cast<int>(n_tiles) - 1; k_ >= 0; k_--)  // int instead of std::size_t for last comparison
         {
             std::size_t k = static_cast<std::size_t>(k_);
             // TRSM: solve L^T * X = A
-            ft_rhs[k * m_tiles + c] = hpx::dataflow(
-                hpx::annotated_function(trsm, "triangular_solve_tiled_matrix"),
-                ft_tiles[k * n_tiles + k],
-                ft_rhs[k * m_tiles + c],
-                N,
-                M,
-                Blas_trans,
-                Blas_left);
+            ft_rhs[k * m_tiles + c] = update_tile(
+                ft_pending,
+                ft_rhs,
+                k * m_tiles + c,
+                [&](auto &&ft_A)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::trsm), "triangular_solve_tiled_matrix"),
+                        ft_tiles[k * n_tiles + k],
+                        std::forward<decltype(ft_A)>(ft_A),
+                        N,
+                        M,
+                        Blas_trans,
+                        Blas_left);
+                });
             for (int m_ = k_ - 1; m_ >= 0; m_--)  // int instead of std::size_t for last comparison
             {
                 std::size_t m = static_cast<std::size_t>(m_);
                 // GEMM: C = C - A^T * B
-                ft_rhs[m * m_tiles + c] = hpx::dataflow(
-                    hpx::annotated_function(gemm, "triangular_solve_tiled_matrix"),
-                    ft_tiles[k * n_tiles + m],
-                    ft_rhs[k * m_tiles + c],
-                    ft_rhs[m * m_tiles + c],
+                ft_pending[m * m_tiles + c] = update_tile(
+                    ft_pending,
+                    ft_rhs,
+                    m * m_tiles + c,
+                    [&](auto &&ft_C)
+                    {
+                        return hpx::dataflow(
+                            hpx::annotated_function(hpx::unwrapping(Blas<T>::gemm), "triangular_solve_tiled_matrix"),
+                            ft_tiles[k * n_tiles + m],
+                            ft_rhs[k * m_tiles + c],
+                            std::forward<decltype(ft_C)>(ft_C),
+                            N,
+                            M,
+                            N,
+                            Blas_trans,
+                            Blas_no_trans);
+                    });
+            }
+        }
+    }
+}
+
+template <typename T>
+void triangular_inverse_tiled(
+    const Tiles<T> &ft_tiles, Owned_tiles<T> &ft_owned, Tiles<T> &ft_inv, int N, std::size_t n_tiles)
+{
+    for (std::size_t n = 0; n < n_tiles; n++)
+    {
+        // TRTRI: X_nn = L_nn^-1
+        ft_inv[n * n_tiles + n] =
+            hpx::dataflow(hpx::annotated_function(hpx::unwrapping(Blas<T>::trtri), "triangular_inverse_tiled"),
+                          ft_tiles[n * n_tiles + n],
+                          std::move(ft_owned[n * n_tiles + n]),
+                          N);
+        for (std::size_t m = n + 1; m < n_tiles; m++)
+        {
+            for (std::size_t k = n; k < m; k++)
+            {
+                // GEMM: C = C - A * B
+                ft_owned[m * n_tiles + n] = update_tile(
+                    ft_owned,
+                    ft_inv,
+                    m * n_tiles + n,
+                    [&](auto &&ft_C)
+                    {
+                        return hpx::dataflow(
+                            hpx::annotated_function(hpx::unwrapping(Blas<T>::gemm), "triangular_inverse_tiled"),
+                            ft_tiles[m * n_tiles + k],
+                            ft_inv[k * n_tiles + n],
+                            std::forward<decltype(ft_C)>(ft_C),
+                            N,
+                            N,
+                            N,
+                            Blas_no_trans,
+                            Blas_no_trans);
+                    });
+            }
+            // TRSM: solve L_mm * X_mn = C
+            ft_inv[m * n_tiles + n] = update_tile(
+                ft_owned,
+                ft_inv,
+                m * n_tiles + n,
+                [&](auto &&ft_C)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::trsm), "triangular_inverse_tiled"),
+                        ft_tiles[m * n_tiles + m],
+                        std::forward<decltype(ft_C)>(ft_C),
+                        N,
+                        N,
+                        Blas_no_trans,
+                        Blas_left);
+                });
+        }
+    }
+}
+
+template <typename T>
+void triangular_transpose_product_tiled(Tiles<T> &ft_tiles, int N, std::size_t n_tiles)
+{
+    // Result tiles between their updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles * n_tiles);
+    for (std::size_t n = 0; n < n_tiles; n++)
+    {
+        for (std::size_t m = n; m < n_tiles; m++)
+        {
+            if (m == n)
+            {
+                // LAUUM: C_nn = X_nn^T * X_nn
+                ft_pending[n * n_tiles + n] = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(Blas<T>::lauum), "triangular_product_tiled"),
+                    ft_tiles[n * n_tiles + n],
+                    N);
+            }
+            else
+            {
+                // TRMM: C_mn = X_mm^T * X_mn
+                ft_pending[m * n_tiles + n] = hpx::dataflow(
+                    hpx::annotated_function(hpx::unwrapping(Blas<T>::trmm), "triangular_product_tiled"),
+                    ft_tiles[m * n_tiles + m],
+                    ft_tiles[m * n_tiles + n],
                     N,
-                    M,
                     N,
                     Blas_trans,
-                    Blas_no_trans);
+                    Blas_left);
+            }
+            for (std::size_t k = m + 1; k < n_tiles; k++)
+            {
+                if (m == n)
+                {
+                    // SYRK: C_nn = C_nn + X_kn^T * X_kn
+                    ft_pending[n * n_tiles + n] = hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::syrk_trans_add), "triangular_product_tiled"),
+                        std::move(ft_pending[n * n_tiles + n]),
+                        ft_tiles[k * n_tiles + n],
+                        N);
+                }
+                else
+                {
+                    // GEMM: C_mn = C_mn + X_km^T * X_kn
+                    ft_pending[m * n_tiles + n] = hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::gemm_trans_add), "triangular_product_tiled"),
+                        ft_tiles[k * n_tiles + m],
+                        ft_tiles[k * n_tiles + n],
+                        std::move(ft_pending[m * n_tiles + n]),
+                        N);
+                }
             }
         }
     }
+    // All reads of the triangular matrix are launched, replace it by the product
+    for (std::size_t n = 0; n < n_tiles; n++)
+    {
+        for (std::size_t m = n; m < n_tiles; m++)
+        {
+            ft_tiles[m * n_tiles + n] = std::move(ft_pending[m * n_tiles + n]);
+        }
+    }
 }
 
-void matrix_vector_tiled(Tiled_matrix &ft_tiles,
-                         Tiled_vector &ft_vector,
-                         Tiled_vector &ft_rhs,
+// GEMV with a covariance tile that is generated within the task instead of stored: b = b + K_ij * a
+static std::vector<double> gemv_covariance(std::size_t row,
+                                           std::size_t col,
+                                           int N,
+                                           int n_regressors,
+                                           const gprat_hyper::SEKParams &sek_params,
+                                           const std::vector<double> &input,
+                                           const std::vector<double> &a,
+                                           std::vector<double> b)
+{
+    return gemv(gen_tile_covariance<double>(row,
+                                            col,
+                                            static_cast<std::size_t>(N),
+                                            static_cast<std::size_t>(n_regressors),
+                                            sek_params,
+                                            input),
+                a,
+                std::move(b),
+                N,
+                N,
+                Blas_add,
+                Blas_no_trans);
+}
+
+void covariance_vector_tiled(const std::vector<double> &input,
+                             const gprat_hyper::SEKParams &sek_params,
+                             int n_regressors,
+                             const Tiled_vector &ft_vector,
+                             Tiled_vector &ft_rhs,
+                             int N,
+                             std::size_t n_tiles)
+{
+    // Result tiles between their GEMV updates, updated in-place
+    std::vector<Tile_future<double>> ft_pending(n_tiles);
+    for (std::size_t k = 0; k < n_tiles; k++)
+    {
+        for (std::size_t m = 0; m < n_tiles; m++)
+        {
+            ft_pending[k] = update_tile(
+                ft_pending,
+                ft_rhs,
+                k,
+                [&](auto &&ft_b)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(&gemv_covariance), "covariance_vector_tiled"),
+                        k,
+                        m,
+                        N,
+                        n_regressors,
+                        sek_params,
+                        input,
+                        ft_vector[m],
+                        std::forward<decltype(ft_b)>(ft_b));
+                });
+        }
+        if (ft_pending[k].valid())
+        {
+            ft_rhs[k] = std::move(ft_pending[k]);
+        }
+    }
+}
+
+template <typename T>
+void matrix_vector_tiled(const Tiles<T> &ft_tiles,
+                         const Tiles<T> &ft_vector,
+                         Tiles<T> &ft_rhs,
                          int N_row,
                          int N_col,
                          std::size_t n_tiles,
                          std::size_t m_tiles)
 {
+    // Result tiles between their GEMV updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(m_tiles);
     for (std::size_t k = 0; k < m_tiles; k++)
     {
         for (std::size_t m = 0; m < n_tiles; m++)
         {
-            ft_rhs[k] = hpx::dataflow(
-                hpx::annotated_function(gemv, "prediction_tiled"),
-                ft_tiles[k * n_tiles + m],
-                ft_vector[m],
-                ft_rhs[k],
-                N_row,
-                N_col,
-                Blas_add,
-                Blas_no_trans);
+            ft_pending[k] = update_tile(
+                ft_pending,
+                ft_rhs,
+                k,
+                [&](auto &&ft_b)
+                {
+                    return hpx::dataflow(hpx::annotated_function(hpx::unwrapping(Blas<T>::gemv), "prediction_tiled"),
+                                         ft_tiles[k * n_tiles + m],
+                                         ft_vector[m],
+                                         std::forward<decltype(ft_b)>(ft_b),
+                                         N_row,
+                                         N_col,
+                                         Blas_add,
+                                         Blas_no_trans);
+                });
+        }
+        if (ft_pending[k].valid())
+        {
+            ft_rhs[k] = std::move(ft_pending[k]);
+        }
+    }
+}
+
+template <typename T>
+void symmetric_matrix_vector_tiled(
+    const Tiles<T> &ft_tiles, const Tiles<T> &ft_vector, Tiles<T> &ft_rhs, int N, std::size_t n_tiles)
+{
+    // Result tiles between their updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(n_tiles);
+    for (std::size_t k = 0; k < n_tiles; k++)
+    {
+        for (std::size_t m = 0; m < n_tiles; m++)
+        {
+            ft_pending[k] = update_tile(
+                ft_pending,
+                ft_rhs,
+                k,
+                [&](auto &&ft_b)
+                {
+                    if (m == k)
+                    {
+                        // SYMV: b = b + A_kk * a with the lower triangle of A_kk
+                        return hpx::dataflow(
+                            hpx::annotated_function(hpx::unwrapping(Blas<T>::symv), "symmetric_matrix_vector_tiled"),
+                            ft_tiles[k * n_tiles + k],
+                            ft_vector[m],
+                            std::forward<decltype(ft_b)>(ft_b),
+                            N,
+                            Blas_add);
+                    }
+                    // GEMV: b = b + A_km * a with the stored tile A_km or A_mk^T
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::gemv), "symmetric_matrix_vector_tiled"),
+                        m < k ? ft_tiles[k * n_tiles + m] : ft_tiles[m * n_tiles + k],
+                        ft_vector[m],
+                        std::forward<decltype(ft_b)>(ft_b),
+                        N,
+                        N,
+                        Blas_add,
+                        m < k ? Blas_no_trans : Blas_trans);
+                });
+        }
+        if (ft_pending[k].valid())
+        {
+            ft_rhs[k] = std::move(ft_pending[k]);
         }
     }
 }
 
+template <typename T>
 void symmetric_matrix_matrix_diagonal_tiled(
-    Tiled_matrix &ft_tiles, Tiled_vector &ft_vector, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
+    Tiles<T> &ft_tiles, Tiles<T> &ft_vector, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
 {
+    // Result tiles between their updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(m_tiles);
     for (std::size_t i = 0; i < m_tiles; ++i)
     {
         for (std::size_t n = 0; n < n_tiles; ++n)
         {  // Compute inner product to obtain diagonal elements of
            // V^T * V  <=> cross(K) * K^-1 * cross(K)^T
-            ft_vector[i] = hpx::dataflow(
-                hpx::annotated_function(dot_diag_syrk, "posterior_tiled"),
-                ft_tiles[n * m_tiles + i],
-                ft_vector[i],
-                N,
-                M);
+            ft_pending[i] = update_tile(
+                ft_pending,
+                ft_vector,
+                i,
+                [&](auto &&ft_r)
+                {
+                    return hpx::dataflow(
+                        hpx::annotated_function(hpx::unwrapping(Blas<T>::dot_diag_syrk), "posterior_tiled"),
+                        ft_tiles[n * m_tiles + i],
+                        std::forward<decltype(ft_r)>(ft_r),
+                        N,
+                        M);
+                });
+        }
+        if (ft_pending[i].valid())
+        {
+            ft_vector[i] = std::move(ft_pending[i]);
         }
     }
 }
 
+template <typename T>
 void symmetric_matrix_matrix_tiled(
-    Tiled_matrix &ft_tiles, Tiled_matrix &ft_result, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
+    Tiles<T> &ft_tiles, Tiles<T> &ft_result, int N, int M, std::size_t n_tiles, std::size_t m_tiles)
 {
+    // Result tiles between their updates, updated in-place
+    std::vector<Tile_future<T>> ft_pending(m_tiles * m_tiles);
     for (std::size_t c = 0; c < m_tiles; c++)
     {
         for (std::size_t k = 0; k < m_tiles; k++)
@@ -238,42 +1011,58 @@ void symmetric_matrix_matrix_tiled(
             {
                 // (SYRK for (c == k) possible)
                 // GEMM:  C = C - A^T * B
-                ft_result[c * m_tiles + k] = hpx::dataflow(
-                    hpx::annotated_function(&gemm, "triangular_solve_tiled_matrix"),
-                    ft_tiles[m * m_tiles + c],
-                    ft_tiles[m * m_tiles + k],
-                    ft_result[c * m_tiles + k],
-                    N,
-                    M,
-                    M,
-                    Blas_trans,
-                    Blas_no_trans);
+                ft_pending[c * m_tiles + k] = update_tile(
+                    ft_pending,
+                    ft_result,
+                    c * m_tiles + k,
+                    [&](auto &&ft_C)
+                    {
+                        return hpx::dataflow(
+                            hpx::annotated_function(hpx::unwrapping(Blas<T>::gemm), "triangular_solve_tiled_matrix"),
+                            ft_tiles[m * m_tiles + c],
+                            ft_tiles[m * m_tiles + k],
+                            std::forward<decltype(ft_C)>(ft_C),
+                            N,
+                            M,
+                            M,
+                            Blas_trans,
+                            Blas_no_trans);
+                    });
+            }
+            if (ft_pending[c * m_tiles + k].valid())
+            {
+                ft_result[c * m_tiles + k] = std::move(ft_pending[c * m_tiles + k]);
             }
         }
     }
 }
 
-void vector_difference_tiled(Tiled_vector &ft_minuend, Tiled_vector &ft_subtrahend, int M, std::size_t m_tiles)
+template <typename T>
+void vector_difference_tiled(Tiles<T> &ft_minuend, Tiles<T> &ft_subtrahend, int M, std::size_t m_tiles)
 {
     for (std::size_t i = 0; i < m_tiles; i++)
     {
-        ft_subtrahend[i] =
-            hpx::dataflow(hpx::annotated_function(&axpy, "uncertainty_tiled"), ft_minuend[i], ft_subtrahend[i], M);
+        ft_subtrahend[i] = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(Blas<T>::axpy), "uncertainty_tiled"),
+                                         ft_minuend[i],
+                                         ft_subtrahend[i],
+                                         M);
     }
 }
 
-void matrix_diagonal_tiled(Tiled_matrix &ft_tiles, Tiled_vector &ft_vector, int M, std::size_t m_tiles)
+template <typename T>
+void matrix_diagonal_tiled(Tiles<T> &ft_tiles, Tiles<T> &ft_vector, int M, std::size_t m_tiles)
 {
     for (std::size_t i = 0; i < m_tiles; i++)
     {
         ft_vector[i] = hpx::dataflow(
-            hpx::annotated_function(get_matrix_diagonal, "uncertainty_tiled"), ft_tiles[i * m_tiles + i], M);
+            hpx::annotated_function(get_matrix_diagonal<T>, "uncertainty_tiled"), ft_tiles[i * m_tiles + i], M);
     }
 }
 
-void compute_loss_tiled(Tiled_matrix &ft_tiles,
-                        Tiled_vector &ft_alpha,
-                        Tiled_vector &ft_y,
+template <typename T>
+void compute_loss_tiled(const Tiles<T> &ft_tiles,
+                        const Tiles<T> &ft_alpha,
+                        const Tiles<T> &ft_y,
                         hpx::shared_future<double> &loss,
                         int N,
                         std::size_t n_tiles)
@@ -283,7 +1072,7 @@ void compute_loss_tiled(Tiled_matrix &ft_tiles,
     for (std::size_t k = 0; k < n_tiles; k++)
     {
         loss_tiled.push_back(hpx::dataflow(
-            hpx::annotated_function(hpx::unwrapping(&compute_loss), "loss_tiled"),
+            hpx::annotated_function(hpx::unwrapping(&compute_loss<T>), "loss_tiled"),
             ft_tiles[k * n_tiles + k],
             ft_alpha[k],
             ft_y[k],
@@ -293,158 +1082,83 @@ void compute_loss_tiled(Tiled_matrix &ft_tiles,
     loss = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&add_losses), "loss_tiled"), loss_tiled, N, n_tiles);
 }
 
-void update_hyperparameter_tiled(
-    const Tiled_matrix &ft_invK,
-    const Tiled_matrix &ft_gradK_param,
-    const Tiled_vector &ft_alpha,
-    const gprat_hyper::AdamParams &adam_params,
-    gprat_hyper::SEKParams &sek_params,
-    int N,
-    std::size_t n_tiles,
-    std::size_t iter,
-    std::size_t param_idx)
+template <typename T>
+void gradient_tiled(const Tiles<T> &ft_invK,
+                    const Tiles<T> &ft_alpha,
+                    const Tiles<T> &ft_distances,
+                    const hpx::shared_future<gprat_hyper::SEKParams> &sek_params,
+                    bool exp_distance,
+                    hpx::shared_future<std::vector<double>> &gradient,
+                    int N,
+                    std::size_t n_tiles)
 {
     /*
-     * PART 1:
-     * Compute gradient = 0.5 * ( trace(inv(K) * grad(K)_param) + y^T * inv(K) * grad(K)_param * inv(K) * y )
-     *
-     * 1: Compute   trace(inv(K) * grad(K)_param)
-     * 2: Compute   y^T * inv(K) * grad(K)_param * inv(K) * y
-     *
-     * Update parameter:
-     * 3: Update moments
-     *      - m_T = beta1 * m_T-1 + (1 - beta1) * g_T
-     *      - w_T = beta2 + w_T-1 + (1 - beta2) * g_T^2
-     * 4: Adam step:
-     *      - nu_T = nu * sqrt(1 - beta2_T) / (1 - beta1_T)
-     *      - theta_T = theta_T-1 - nu_T * m_T / (sqrt(w_T) + epsilon)
+     * Compute gradient_i = 0.5 * trace(W * delta(K)/delta(theta_i)) with W = K^-1 - alpha * alpha^T
+     * for all hyperparameters in one pass over the lower triangle of K^-1
      */
-    hpx::shared_future<double> trace = hpx::make_ready_future(0.0);
-    hpx::shared_future<double> dot = hpx::make_ready_future(0.0);
-    bool jitter = false;
-    double factor = 1.0;
-    if (param_idx == 0 || param_idx == 1)  // 0: lengthscale; 1: vertical_lengthscale
+    std::vector<hpx::shared_future<std::vector<double>>> gradient_tiled;
+    gradient_tiled.reserve(n_tiles);
+    for (std::size_t i = 0; i < n_tiles; i++)
     {
-        Tiled_vector diag_tiles;   // Diagonal tiles
-        Tiled_vector inter_alpha;  // Intermediate result
-        // Preallocate memory
-        inter_alpha.reserve(n_tiles);
-        diag_tiles.reserve(n_tiles);
-        // Asynchrnonous initialization
-        for (std::size_t d = 0; d < n_tiles; d++)
+        // Gradients w.r.t. lengthscale, vertical_lengthscale and noise_variance accumulated over the tile row
+        hpx::shared_future<std::vector<double>> row_gradient = hpx::make_ready_future(std::vector<double>(3, 0.0));
+        for (std::size_t j = 0; j <= i; j++)
         {
-            diag_tiles.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble"), N));
-            inter_alpha.push_back(hpx::async(hpx::annotated_function(gen_tile_zeros, "assemble"), N));
-        }
-
-        ////////////////////////////////////
-        // PART 1: Compute gradient
-        // Step 1: Compute trace(inv(K)*grad_K_param)
-        // Compute diagonal tiles of inv(K) * grad(K)_param
-        for (std::size_t i = 0; i < n_tiles; ++i)
-        {
-            for (std::size_t j = 0; j < n_tiles; ++j)
-            {
-                diag_tiles[i] = hpx::dataflow(
-                    hpx::annotated_function(dot_diag_gemm, "trace"),
-                    ft_invK[i * n_tiles + j],
-                    ft_gradK_param[j * n_tiles + i],
-                    diag_tiles[i],
-                    N,
-                    N);
-            }
-        }
-        // Compute the trace of the diagonal tiles
-        for (std::size_t j = 0; j < n_tiles; ++j)
-        {
-            trace =
-                hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_trace), "trace"), diag_tiles[j], trace);
-        }
-        // Not sure if can be done this way
-        // Step 2: Compute alpha^T * grad(K)_param * alpha (with alpha = inv(K) * y)
-        // Compute inter_alpha = grad(K)_param * alpha
-        for (std::size_t k = 0; k < n_tiles; k++)
-        {
-            for (std::size_t m = 0; m < n_tiles; m++)
-            {
-                inter_alpha[k] = hpx::dataflow(
-                    hpx::annotated_function(gemv, "gemv"),
-                    ft_gradK_param[k * n_tiles + m],
-                    ft_alpha[m],
-                    inter_alpha[k],
-                    N,
-                    N,
-                    Blas_add,
-                    Blas_no_trans);
-            }
-        }
-        // Compute alpha^T * inter_alpha
-        for (std::size_t j = 0; j < n_tiles; ++j)
-        {
-            dot = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_dot), "grad_right_tiled"),
-                                inter_alpha[j],
-                                ft_alpha[j],
-                                dot);
-        }
-    }
-    else if (param_idx == 2)  // @2: noise_variance
-    {
-        jitter = true;
-        ////////////////////////////////////
-        // PART 1: Compute gradient
-        // Step 1: Compute the trace of inv(K) * noise_variance
-        for (std::size_t j = 0; j < n_tiles; ++j)
-        {
-            trace = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_trace_diag), "grad_left_tiled"),
-                                  ft_invK[j * n_tiles + j],
-                                  trace,
-                                  N);
-        }
-        ////////////////////////////////////
-        // Step 2: Compute the alpha^T * alpha * noise_variance
-        for (std::size_t j = 0; j < n_tiles; ++j)
-        {
-            dot = hpx::dataflow(hpx::annotated_function(hpx::unwrapping(&compute_dot), "grad_right_tiled"),
-                                ft_alpha[j],
-                                ft_alpha[j],
-                                dot);
+            row_gradient = hpx::dataflow(
+                hpx::annotated_function(hpx::unwrapping(&compute_gradient_tile<T>), "gradient_tiled"),
+                row_gradient,
+                ft_invK[i * n_tiles + j],
+                ft_alpha[i],
+                ft_alpha[j],
+                ft_distances[i * n_tiles + j],
+                N,
+                sek_params,
+                exp_distance,
+                i == j);
         }
-
-        factor = compute_sigmoid(to_unconstrained(sek_params.noise_variance, true));
-    }
-    else
-    {
-        // Throw an exception for invalid param_idx
-        throw std::invalid_argument("Invalid param_idx");
+        gradient_tiled.push_back(row_gradient);
     }
 
-    // Compute gradient = trace + dot
-    double gradient =
-        factor
-        * hpx::dataflow(
-              hpx::annotated_function(hpx::unwrapping(&compute_gradient), "update_hyperparam"), trace, dot, N, n_tiles)
-              .get();
-
-    ////////////////////////////////////
-    // PART 2: Update parameter
-    // Update moments
-    // m_T = beta1 * m_T-1 + (1 - beta1) * g_T
-    sek_params.m_T[param_idx] = update_first_moment(gradient, sek_params.m_T[param_idx], adam_params.beta1);
-    // w_T = beta2 + w_T-1 + (1 - beta2) * g_T^2
-    sek_params.w_T[param_idx] = update_second_moment(gradient, sek_params.w_T[param_idx], adam_params.beta2);
-
-    // Transform hyperparameter to unconstrained form
-    double unconstrained_param = to_unconstrained(sek_params.get_param(param_idx), jitter);
-    // Adam step update with unconstrained parameter
-    // compute beta_t inside
-    double updated_param = adam_step(
-        unconstrained_param,
-        adam_params,
-        sek_params.m_T[param_idx],
-        sek_params.w_T[param_idx],
-        static_cast<std::size_t>(iter));
-    // Transform hyperparameter back to constrained form
-    sek_params.set_param(param_idx, to_constrained(updated_param, jitter));
+    gradient = hpx::dataflow(
+        hpx::annotated_function(hpx::unwrapping(&add_gradients), "gradient_tiled"), gradient_tiled, N, n_tiles);
 }
 
+// Explicit instantiations for FP64 and FP32 tiles
+#define GPRAT_INSTANTIATE_TILED_ALGORITHMS(T)                                                                          \
+    template void right_looking_cholesky_tiled<T>(Tiles<T> &, int, std::size_t);                                       \
+    template void right_looking_cholesky_tiled<T>(Owned_tiles<T> &, Tiles<T> &, int, std::size_t);                     \
+    template void extend_cholesky_tiled<T>(Tiles<T> &, int, std::size_t, std::size_t);                                 \
+    template void forward_solve_tiled<T>(const Tiles<T> &, Tiles<T> &, int, std::size_t);                              \
+    template void backward_solve_tiled<T>(const Tiles<T> &, Tiles<T> &, int, std::size_t);                             \
+    template void extend_forward_solve_tiled<T>(const Tiles<T> &, Tiles<T> &, int, std::size_t, std::size_t);          \
+    template void forward_solve_tiled_matrix<T>(const Tiles<T> &, Tiles<T> &, int, int, std::size_t, std::size_t);     \
+    template void forward_solve_tiled_matrix<T>(                                                                       \
+        const Tiles<T> &, Owned_tiles<T> &, Tiles<T> &, int, int, std::size_t, std::size_t);                           \
+    template void backward_solve_tiled_matrix<T>(const Tiles<T> &, Tiles<T> &, int, int, std::size_t, std::size_t);    \
+    template void triangular_inverse_tiled<T>(const Tiles<T> &, Owned_tiles<T> &, Tiles<T> &, int, std::size_t);       \
+    template void triangular_transpose_product_tiled<T>(Tiles<T> &, int, std::size_t);                                 \
+    template void matrix_vector_tiled<T>(                                                                              \
+        const Tiles<T> &, const Tiles<T> &, Tiles<T> &, int, int, std::size_t, std::size_t);                           \
+    template void symmetric_matrix_vector_tiled<T>(const Tiles<T> &, const Tiles<T> &, Tiles<T> &, int, std::size_t);  \
+    template void symmetric_matrix_matrix_diagonal_tiled<T>(                                                           \
+        Tiles<T> &, Tiles<T> &, int, int, std::size_t, std::size_t);                                                   \
+    template void symmetric_matrix_matrix_tiled<T>(Tiles<T> &, Tiles<T> &, int, int, std::size_t, std::size_t);        \
+    template void vector_difference_tiled<T>(Tiles<T> &, Tiles<T> &, int, std::size_t);                                \
+    template void matrix_diagonal_tiled<T>(Tiles<T> &, Tiles<T> &, int, std::size_t);                                  \
+    template void compute_loss_tiled<T>(                                                                               \
+        const Tiles<T> &, const Tiles<T> &, const Tiles<T> &, hpx::shared_future<double> &, int, std::size_t);         \
+    template void gradient_tiled<T>(const Tiles<T> &,                                                                  \
+                                    const Tiles<T> &,                                                                  \
+                                    const Tiles<T> &,                                                                  \
+                                    const hpx::shared_future<gprat_hyper::SEKParams> &,                                \
+                                    bool,                                                                              \
+                                    hpx::shared_future<std::vector<double>> &,                                         \
+                                    int,                                                                               \
+                                    std::size_t);
+
+GPRAT_INSTANTIATE_TILED_ALGORITHMS(double)
+GPRAT_INSTANTIATE_TILED_ALGORITHMS(float)
+
+#undef GPRAT_INSTANTIATE_TILED_ALGORITHMS
+
 }  // end of namespace cpu
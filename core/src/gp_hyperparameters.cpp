@@ -30,4 +30,109 @@ std::string AdamParams::repr() const
     return oss.str();
 }
 
+LBFGSParams::LBFGSParams(int max_i, int history, double grad_tol, double c1, int max_ls) :
+    max_iter(max_i),
+    history_size(history),
+    gradient_tolerance(grad_tol),
+    armijo(c1),
+    max_line_search(max_ls)
+{ }
+
+std::string LBFGSParams::repr() const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8);
+
+    // clang-format off
+    oss << "LBFGSParams: [max_iter=" << max_iter
+                    << ", history_size=" << history_size
+                    << ", gradient_tolerance=" << gradient_tolerance
+                    << ", armijo=" << armijo
+                    << ", max_line_search=" << max_line_search << "]";
+    // clang-format on
+
+    return oss.str();
+}
+
+PCGParams::PCGParams(int max_i, double tol, int rank, bool regenerate) :
+    max_iter(max_i),
+    tolerance(tol),
+    preconditioner_rank(rank),
+    regenerate_tiles(regenerate)
+{ }
+
+std::string PCGParams::repr() const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8);
+
+    // clang-format off
+    oss << "PCGParams: [max_iter=" << max_iter
+                  << ", tolerance=" << tolerance
+                  << ", preconditioner_rank=" << preconditioner_rank
+                  << ", regenerate_tiles=" << regenerate_tiles << "]";
+    // clang-format on
+
+    return oss.str();
+}
+
+StochasticParams::StochasticParams(int probes, int max_i, double tol, bool regenerate, unsigned int s) :
+    n_probes(probes),
+    max_iter(max_i),
+    tolerance(tol),
+    regenerate_tiles(regenerate),
+    seed(s)
+{ }
+
+std::string StochasticParams::repr() const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8);
+
+    // clang-format off
+    oss << "StochasticParams: [n_probes=" << n_probes
+                         << ", max_iter=" << max_iter
+                         << ", tolerance=" << tolerance
+                         << ", regenerate_tiles=" << regenerate_tiles
+                         << ", seed=" << seed << "]";
+    // clang-format on
+
+    return oss.str();
+}
+
+TLRParams::TLRParams(double tol, int max_r) :
+    tolerance(tol),
+    max_rank(max_r)
+{ }
+
+std::string TLRParams::repr() const
+{
+    std::ostringstream oss;
+    oss << std::scientific << std::setprecision(2);
+
+    // clang-format off
+    oss << "TLRParams: [tolerance=" << tolerance
+                  << ", max_rank=" << max_rank << "]";
+    // clang-format on
+
+    return oss.str();
+}
+
+RFFParams::RFFParams(int features, unsigned int s) :
+    n_features(features),
+    seed(s)
+{ }
+
+std::string RFFParams::repr() const
+{
+    std::ostringstream oss;
+
+    // clang-format off
+    oss << "RFFParams: [n_features=" << n_features
+                  << ", seed=" << seed << "]";
+    // clang-format on
+
+    return oss.str();
+}
+
 }  // namespace gprat_hyper
@@ -1,6 +1,12 @@
 #include "gprat_c.hpp"
 
 #include "cpu/gp_functions.hpp"
+#include "cpu/gp_optimizer.hpp"
+#include "cpu/gp_experts.hpp"
+#include "cpu/gp_iterative.hpp"
+#include "cpu/gp_rff.hpp"
+#include "cpu/gp_sparse.hpp"
+#include "cpu/gp_tlr.hpp"
 #include "utils_c.hpp"
 #include <cstdio>
 
@@ -33,13 +39,19 @@ GP::GP(std::vector<double> input,
        int n_regressors,
        std::vector<double> kernel_hyperparams,
        std::vector<bool> trainable_bool,
-       std::shared_ptr<Target> target) :
+       std::shared_ptr<Target> target,
+       Precision precision) :
     training_input_(input),
     training_output_(output),
     n_tiles_(n_tiles),
     n_tile_size_(n_tile_size),
     trainable_params_(trainable_bool),
     target_(target),
+    precision_(precision),
+    n_inducing_(0),
+    rff_params_(0),
+    local_experts_(false),
+    expert_combination_(Expert_combination::rbcm),
     n_reg(n_regressors),
     kernel_params(kernel_hyperparams[0], kernel_hyperparams[1], kernel_hyperparams[2])
 { }
@@ -51,13 +63,19 @@ GP::GP(std::vector<double> input,
        int n_tile_size,
        int n_regressors,
        std::vector<double> kernel_hyperparams,
-       std::vector<bool> trainable_bool) :
+       std::vector<bool> trainable_bool,
+       Precision precision) :
     training_input_(input),
     training_output_(output),
     n_tiles_(n_tiles),
     n_tile_size_(n_tile_size),
     trainable_params_(trainable_bool),
     target_(std::make_shared<CPU>()),
+    precision_(precision),
+    n_inducing_(0),
+    rff_params_(0),
+    local_experts_(false),
+    expert_combination_(Expert_combination::rbcm),
     n_reg(n_regressors),
     kernel_params(kernel_hyperparams[0], kernel_hyperparams[1], kernel_hyperparams[2])
 { }
@@ -88,6 +106,11 @@ GP::GP(std::vector<double> input,
     target_(std::make_shared<CPU>()),
 
 #endif
+    precision_(Precision::fp64),
+    n_inducing_(0),
+    rff_params_(0),
+    local_experts_(false),
+    expert_combination_(Expert_combination::rbcm),
     n_reg(n_regressors),
     kernel_params(kernel_hyperparams[0], kernel_hyperparams[1], kernel_hyperparams[2])
 {
@@ -117,9 +140,207 @@ std::vector<double> GP::get_training_input() const { return training_input_; }
 
 std::vector<double> GP::get_training_output() const { return training_output_; }
 
+// cpu_factorization //////////////////////////////////////////////////////////////////////////////////////////////////
+const cpu::Factorization &GP::cpu_factorization()
+{
+    if (!factorization_ || !factorization_->matches(kernel_params, n_reg))
+    {
+        factorization_ = std::make_shared<const cpu::Factorization>(cpu::factorize(
+            training_input_, training_output_, kernel_params, n_tiles_, n_tile_size_, n_reg, precision_));
+    }
+    return *factorization_;
+}
+
+// cpu_factorization_fp32 /////////////////////////////////////////////////////////////////////////////////////////////
+const cpu::Factorization_fp32 &GP::cpu_factorization_fp32()
+{
+    if (!factorization_fp32_ || !factorization_fp32_->matches(kernel_params, n_reg))
+    {
+        factorization_fp32_ = std::make_shared<const cpu::Factorization_fp32>(cpu::factorize_fp32(
+            training_input_, training_output_, kernel_params, n_tiles_, n_tile_size_, n_reg));
+    }
+    return *factorization_fp32_;
+}
+
+// with_cpu_factorization /////////////////////////////////////////////////////////////////////////////////////////////
+template <typename F>
+auto GP::with_cpu_factorization(F &&f)
+{
+    if (precision_ == Precision::fp32)
+    {
+        return f(cpu_factorization_fp32());
+    }
+    return f(cpu_factorization());
+}
+
+// cpu_distances //////////////////////////////////////////////////////////////////////////////////////////////////////
+cpu::DistanceTiles &GP::cpu_distances()
+{
+    if (!distances_ || distances_->n_regressors != n_reg)
+    {
+        distances_ = std::make_shared<cpu::DistanceTiles>(
+            cpu::gen_distance_tiles<double>(training_input_, n_tiles_, n_tile_size_, n_reg));
+    }
+    return *distances_;
+}
+
+// cpu_distances_fp32 /////////////////////////////////////////////////////////////////////////////////////////////////
+cpu::DistanceTiles_fp32 &GP::cpu_distances_fp32()
+{
+    if (!distances_fp32_ || distances_fp32_->n_regressors != n_reg)
+    {
+        distances_fp32_ = std::make_shared<cpu::DistanceTiles_fp32>(
+            cpu::gen_distance_tiles<float>(training_input_, n_tiles_, n_tile_size_, n_reg));
+    }
+    return *distances_fp32_;
+}
+
+// append_observations ////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks that new observations fill whole tiles
+static void check_new_observations(const std::vector<double> &new_input,
+                                   const std::vector<double> &new_output,
+                                   int n_tile_size)
+{
+    if (new_input.size() != new_output.size())
+    {
+        throw std::invalid_argument("Number of new input values (" + std::to_string(new_input.size())
+                                    + ") does not match number of new output values ("
+                                    + std::to_string(new_output.size()) + ")");
+    }
+    if (new_output.empty() || new_output.size() % static_cast<std::size_t>(n_tile_size) != 0)
+    {
+        throw std::invalid_argument("Number of new observations (" + std::to_string(new_output.size())
+                                    + ") must be a positive multiple of the tile size ("
+                                    + std::to_string(n_tile_size) + ")");
+    }
+}
+
+// Removes unused trailing values, such that new observations directly follow the used ones
+static void trim_training_data(std::vector<double> &input, std::vector<double> &output, int n_samples, int n_regressors)
+{
+    const auto n_input = static_cast<std::size_t>(n_samples + n_regressors - 1);
+    if (input.size() > n_input)
+    {
+        input.resize(n_input);
+    }
+    if (output.size() > static_cast<std::size_t>(n_samples))
+    {
+        output.resize(static_cast<std::size_t>(n_samples));
+    }
+}
+
+void GP::append_observations(const std::vector<double> &new_input, const std::vector<double> &new_output)
+{
+    check_new_observations(new_input, new_output, n_tile_size_);
+
+    int n_tiles_old = n_tiles_;
+    trim_training_data(training_input_, training_output_, n_tiles_ * n_tile_size_, n_reg);
+    distances_.reset();
+    distances_fp32_.reset();
+    factorization_fp32_.reset();
+    training_input_.insert(training_input_.end(), new_input.begin(), new_input.end());
+    training_output_.insert(training_output_.end(), new_output.begin(), new_output.end());
+    n_tiles_ += static_cast<int>(new_output.size()) / n_tile_size_;
+
+    // A mixed precision factorization is recomputed, the extension would not refine alpha
+    if (factorization_ && factorization_->matches(kernel_params, n_reg) && precision_ == Precision::fp64)
+    {
+        factorization_ = hpx::async(
+                             [this, n_tiles_old]()
+                             {
+                                 return std::make_shared<const cpu::Factorization>(cpu::extend_factorization(
+                                     *factorization_,
+                                     training_input_,
+                                     training_output_,
+                                     n_tiles_old,
+                                     n_tiles_,
+                                     n_tile_size_));
+                             })
+                             .get();
+    }
+    else
+    {
+        factorization_.reset();
+    }
+}
+
+// slide_window ///////////////////////////////////////////////////////////////////////////////////////////////////////
+void GP::slide_window(const std::vector<double> &new_input, const std::vector<double> &new_output)
+{
+    check_new_observations(new_input, new_output, n_tile_size_);
+
+    int n_shift_tiles = static_cast<int>(new_output.size()) / n_tile_size_;
+    auto n_shift = static_cast<std::ptrdiff_t>(new_output.size());
+
+    // Append the new observations and drop the oldest ones, the input series is shifted accordingly
+    trim_training_data(training_input_, training_output_, n_tiles_ * n_tile_size_, n_reg);
+    distances_.reset();
+    distances_fp32_.reset();
+    factorization_fp32_.reset();
+    training_input_.insert(training_input_.end(), new_input.begin(), new_input.end());
+    training_output_.insert(training_output_.end(), new_output.begin(), new_output.end());
+    training_input_.erase(training_input_.begin(), training_input_.begin() + n_shift);
+    training_output_.erase(training_output_.begin(), training_output_.begin() + n_shift);
+
+    // A mixed precision factorization is recomputed, the update would not refine alpha
+    if (factorization_ && factorization_->matches(kernel_params, n_reg) && n_shift_tiles < n_tiles_
+        && precision_ == Precision::fp64)
+    {
+        factorization_ = hpx::async(
+                             [this, n_shift_tiles]()
+                             {
+                                 int n_tiles_kept = n_tiles_ - n_shift_tiles;
+                                 return std::make_shared<const cpu::Factorization>(cpu::extend_factorization(
+                                     cpu::drop_factorization(
+                                         *factorization_, training_output_, n_tiles_, n_shift_tiles, n_tile_size_),
+                                     training_input_,
+                                     training_output_,
+                                     n_tiles_kept,
+                                     n_tiles_,
+                                     n_tile_size_));
+                             })
+                             .get();
+    }
+    else
+    {
+        factorization_.reset();
+    }
+}
+
 // predict ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::vector<double> GP::predict(const std::vector<double> &test_input, int m_tiles, int m_tile_size)
 {
+    if (local_experts_)
+    {
+        return predict_experts_with_uncertainty(test_input, m_tiles, m_tile_size)[0];
+    }
+    if (rff_params_.n_features > 0)
+    {
+        return hpx::async(
+                   [this, &test_input, m_tiles, m_tile_size]()
+                   {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                       if (target_->is_gpu())
+                       {
+                           std::cerr << "Random features have not been implemented for the GPU.\n"
+                                     << "Instead, this operation executes the CPU implementation." << std::endl;
+                       }
+#endif
+                       return cpu::predict_rff(
+                           training_input_,
+                           training_output_,
+                           test_input,
+                           n_tiles_,
+                           n_tile_size_,
+                           m_tiles,
+                           m_tile_size,
+                           n_reg,
+                           kernel_params,
+                           rff_params_);
+                   })
+            .get();
+    }
+
 #if !GPRAT_WITH_SYCL
 
     return hpx::async(
@@ -143,29 +364,33 @@ std::vector<double> GP::predict(const std::vector<double> &test_input, int m_til
                    }
                    else
                    {
-                       return cpu::predict(
-                           training_input_,
-                           training_output_,
-                           test_input,
-                           kernel_params,
-                           n_tiles_,
-                           n_tile_size_,
-                           m_tiles,
-                           m_tile_size,
-                           n_reg);
+                       return with_cpu_factorization(
+                           [&](const auto &factorization)
+                           {
+                               return cpu::predict(
+                                   factorization,
+                                   training_input_,
+                                   test_input,
+                                   n_tiles_,
+                                   n_tile_size_,
+                                   m_tiles,
+                                   m_tile_size);
+                           });
                    }
 
 #else
-                   return cpu::predict(
-                       training_input_,
-                       training_output_,
-                       test_input,
-                       kernel_params,
-                       n_tiles_,
-                       n_tile_size_,
-                       m_tiles,
-                       m_tile_size,
-                       n_reg);
+                   return with_cpu_factorization(
+                       [&](const auto &factorization)
+                       {
+                           return cpu::predict(
+                               factorization,
+                               training_input_,
+                               test_input,
+                               n_tiles_,
+                               n_tile_size_,
+                               m_tiles,
+                               m_tile_size);
+                       });
 
 #endif
                })
@@ -189,16 +414,12 @@ std::vector<double> GP::predict(const std::vector<double> &test_input, int m_til
     }
     else
     {
-        return cpu::predict(
-            training_input_,
-            training_output_,
-            test_input,
-            kernel_params,
-            n_tiles_,
-            n_tile_size_,
-            m_tiles,
-            m_tile_size,
-            n_reg);
+        return with_cpu_factorization(
+            [&](const auto &factorization)
+            {
+                return cpu::predict(
+                    factorization, training_input_, test_input, n_tiles_, n_tile_size_, m_tiles, m_tile_size);
+            });
     }
 
 #endif
@@ -208,6 +429,37 @@ std::vector<double> GP::predict(const std::vector<double> &test_input, int m_til
 std::vector<std::vector<double>>
 GP::predict_with_uncertainty(const std::vector<double> &test_input, int m_tiles, int m_tile_size)
 {
+    if (local_experts_)
+    {
+        return predict_experts_with_uncertainty(test_input, m_tiles, m_tile_size);
+    }
+    if (rff_params_.n_features > 0)
+    {
+        return hpx::async(
+                   [this, &test_input, m_tiles, m_tile_size]()
+                   {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                       if (target_->is_gpu())
+                       {
+                           std::cerr << "Random features have not been implemented for the GPU.\n"
+                                     << "Instead, this operation executes the CPU implementation." << std::endl;
+                       }
+#endif
+                       return cpu::predict_rff_with_uncertainty(
+                           training_input_,
+                           training_output_,
+                           test_input,
+                           n_tiles_,
+                           n_tile_size_,
+                           m_tiles,
+                           m_tile_size,
+                           n_reg,
+                           kernel_params,
+                           rff_params_);
+                   })
+            .get();
+    }
+
 #if !GPRAT_WITH_SYCL
 
     return hpx::async(
@@ -231,29 +483,33 @@ GP::predict_with_uncertainty(const std::vector<double> &test_input, int m_tiles,
                    }
                    else
                    {
-                       return cpu::predict_with_uncertainty(
-                           training_input_,
-                           training_output_,
-                           test_input,
-                           kernel_params,
-                           n_tiles_,
-                           n_tile_size_,
-                           m_tiles,
-                           m_tile_size,
-                           n_reg);
+                       return with_cpu_factorization(
+                           [&](const auto &factorization)
+                           {
+                               return cpu::predict_with_uncertainty(
+                                   factorization,
+                                   training_input_,
+                                   test_input,
+                                   n_tiles_,
+                                   n_tile_size_,
+                                   m_tiles,
+                                   m_tile_size);
+                           });
                    }
 
 #else
-                   return cpu::predict_with_uncertainty(
-                       training_input_,
-                       training_output_,
-                       test_input,
-                       kernel_params,
-                       n_tiles_,
-                       n_tile_size_,
-                       m_tiles,
-                       m_tile_size,
-                       n_reg);
+                   return with_cpu_factorization(
+                       [&](const auto &factorization)
+                       {
+                           return cpu::predict_with_uncertainty(
+                               factorization,
+                               training_input_,
+                               test_input,
+                               n_tiles_,
+                               n_tile_size_,
+                               m_tiles,
+                               m_tile_size);
+                       });
 
 #endif
                })
@@ -276,16 +532,12 @@ GP::predict_with_uncertainty(const std::vector<double> &test_input, int m_tiles,
     }
     else
     {
-        return cpu::predict_with_uncertainty(
-            training_input_,
-            training_output_,
-            test_input,
-            kernel_params,
-            n_tiles_,
-            n_tile_size_,
-            m_tiles,
-            m_tile_size,
-            n_reg);
+        return with_cpu_factorization(
+            [&](const auto &factorization)
+            {
+                return cpu::predict_with_uncertainty(
+                    factorization, training_input_, test_input, n_tiles_, n_tile_size_, m_tiles, m_tile_size);
+            });
     }
 
 #endif
@@ -295,6 +547,7 @@ GP::predict_with_uncertainty(const std::vector<double> &test_input, int m_tiles,
 std::vector<std::vector<double>>
 GP::predict_with_full_cov(const std::vector<double> &test_input, int m_tiles, int m_tile_size)
 {
+    require_exact_model("GP::predict_with_full_cov");
 #if !GPRAT_WITH_SYCL
 
     return hpx::async(
@@ -318,29 +571,33 @@ GP::predict_with_full_cov(const std::vector<double> &test_input, int m_tiles, in
                    }
                    else
                    {
-                       return cpu::predict_with_full_cov(
-                           training_input_,
-                           training_output_,
-                           test_input,
-                           kernel_params,
-                           n_tiles_,
-                           n_tile_size_,
-                           m_tiles,
-                           m_tile_size,
-                           n_reg);
+                       return with_cpu_factorization(
+                           [&](const auto &factorization)
+                           {
+                               return cpu::predict_with_full_cov(
+                                   factorization,
+                                   training_input_,
+                                   test_input,
+                                   n_tiles_,
+                                   n_tile_size_,
+                                   m_tiles,
+                                   m_tile_size);
+                           });
                    }
 
 #else
-                   return cpu::predict_with_full_cov(
-                       training_input_,
-                       training_output_,
-                       test_input,
-                       kernel_params,
-                       n_tiles_,
-                       n_tile_size_,
-                       m_tiles,
-                       m_tile_size,
-                       n_reg);
+                   return with_cpu_factorization(
+                       [&](const auto &factorization)
+                       {
+                           return cpu::predict_with_full_cov(
+                               factorization,
+                               training_input_,
+                               test_input,
+                               n_tiles_,
+                               n_tile_size_,
+                               m_tiles,
+                               m_tile_size);
+                       });
 
 #endif
                })
@@ -363,16 +620,12 @@ GP::predict_with_full_cov(const std::vector<double> &test_input, int m_tiles, in
     }
     else
     {
-        return cpu::predict_with_full_cov(
-            training_input_,
-            training_output_,
-            test_input,
-            kernel_params,
-            n_tiles_,
-            n_tile_size_,
-            m_tiles,
-            m_tile_size,
-            n_reg);
+        return with_cpu_factorization(
+            [&](const auto &factorization)
+            {
+                return cpu::predict_with_full_cov(
+                    factorization, training_input_, test_input, n_tiles_, n_tile_size_, m_tiles, m_tile_size);
+            });
     }
 
 #endif
@@ -381,6 +634,9 @@ GP::predict_with_full_cov(const std::vector<double> &test_input, int m_tiles, in
 // optimize ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::vector<double> GP::optimize(const gprat_hyper::AdamParams &adam_params)
 {
+    // Hyperparameters change, release the stale factorizations
+    factorization_.reset();
+    factorization_fp32_.reset();
     return hpx::async(
                [this, &adam_params]()
                {
@@ -391,12 +647,47 @@ std::vector<double> GP::optimize(const gprat_hyper::AdamParams &adam_params)
                                  << "Instead, this operation executes the CPU implementation." << std::endl;
                    }
 #endif
+                   if (local_experts_)
+                   {
+                       return cpu::optimize_experts(
+                           training_input_,
+                           training_output_,
+                           n_tiles_,
+                           n_tile_size_,
+                           n_reg,
+                           adam_params,
+                           kernel_params,
+                           trainable_params_);
+                   }
+                   if (rff_params_.n_features > 0)
+                   {
+                       return cpu::optimize_rff(
+                           training_input_,
+                           training_output_,
+                           n_tiles_,
+                           n_tile_size_,
+                           n_reg,
+                           adam_params,
+                           kernel_params,
+                           trainable_params_,
+                           rff_params_);
+                   }
+                   if (precision_ == Precision::fp32)
+                   {
+                       return cpu::optimize(
+                           cpu_distances_fp32(),
+                           training_output_,
+                           n_tiles_,
+                           n_tile_size_,
+                           adam_params,
+                           kernel_params,
+                           trainable_params_);
+                   }
                    return cpu::optimize(
-                       training_input_,
+                       cpu_distances(),
                        training_output_,
                        n_tiles_,
                        n_tile_size_,
-                       n_reg,
                        adam_params,
                        kernel_params,
                        trainable_params_);
@@ -404,9 +695,132 @@ std::vector<double> GP::optimize(const gprat_hyper::AdamParams &adam_params)
         .get();
 }
 
+// optimize_multistart ////////////////////////////////////////////////////////////////////////////////////////////////
+// Converts lengthscale, vertical lengthscale and noise variance to kernel hyperparameters
+static gprat_hyper::SEKParams to_sek_params(const std::vector<double> &params)
+{
+    if (params.size() != 3)
+    {
+        throw std::invalid_argument("Number of hyperparameters (" + std::to_string(params.size())
+                                    + ") must be 3: lengthscale, vertical lengthscale, noise variance");
+    }
+    return gprat_hyper::SEKParams(params[0], params[1], params[2]);
+}
+
+Multistart_result GP::optimize_multistart(const std::vector<std::vector<double>> &initial_params_list,
+                                          const gprat_hyper::AdamParams &adam_params)
+{
+    if (initial_params_list.empty())
+    {
+        throw std::invalid_argument("At least one set of initial hyperparameters is required");
+    }
+    require_exact_model("GP::optimize_multistart");
+    std::vector<gprat_hyper::SEKParams> sek_params_list;
+    sek_params_list.reserve(initial_params_list.size());
+    for (const auto &params : initial_params_list)
+    {
+        sek_params_list.push_back(to_sek_params(params));
+    }
+
+    // Hyperparameters change, release the stale factorizations
+    factorization_.reset();
+    factorization_fp32_.reset();
+    Multistart_result result;
+    result.losses = hpx::async(
+                        [this, &adam_params, &sek_params_list]()
+                        {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                            if (target_->is_gpu())
+                            {
+                                std::cerr << "GP::optimize_multistart has not been implemented for the GPU.\n"
+                                          << "Instead, this operation executes the CPU implementation." << std::endl;
+                            }
+#endif
+                            if (precision_ == Precision::fp32)
+                            {
+                                return cpu::optimize_multistart(cpu_distances_fp32(),
+                                                                training_output_,
+                                                                n_tiles_,
+                                                                n_tile_size_,
+                                                                adam_params,
+                                                                sek_params_list,
+                                                                trainable_params_);
+                            }
+                            return cpu::optimize_multistart(cpu_distances(),
+                                                            training_output_,
+                                                            n_tiles_,
+                                                            n_tile_size_,
+                                                            adam_params,
+                                                            sek_params_list,
+                                                            trainable_params_);
+                        })
+                        .get();
+
+    // Select the optimization with the lowest final loss
+    result.best_index = 0;
+    for (std::size_t i = 1; i < result.losses.size(); i++)
+    {
+        const auto &best_losses = result.losses[result.best_index];
+        const auto &losses = result.losses[i];
+        if (!losses.empty() && (best_losses.empty() || losses.back() < best_losses.back()))
+        {
+            result.best_index = i;
+        }
+    }
+    kernel_params = sek_params_list[result.best_index];
+    result.best_params = {
+        kernel_params.lengthscale, kernel_params.vertical_lengthscale, kernel_params.noise_variance
+    };
+    return result;
+}
+
+// optimize_lbfgs /////////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<double> GP::optimize_lbfgs(const gprat_hyper::LBFGSParams &lbfgs_params)
+{
+    require_exact_model("GP::optimize_lbfgs");
+    // Hyperparameters change, release the stale factorizations
+    factorization_.reset();
+    factorization_fp32_.reset();
+    return hpx::async(
+               [this, &lbfgs_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::optimize_lbfgs has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   if (precision_ == Precision::fp32)
+                   {
+                       return cpu::optimize_lbfgs(
+                           cpu_distances_fp32(),
+                           training_output_,
+                           n_tiles_,
+                           n_tile_size_,
+                           lbfgs_params,
+                           kernel_params,
+                           trainable_params_);
+                   }
+                   return cpu::optimize_lbfgs(
+                       cpu_distances(),
+                       training_output_,
+                       n_tiles_,
+                       n_tile_size_,
+                       lbfgs_params,
+                       kernel_params,
+                       trainable_params_);
+               })
+        .get();
+}
+
 // optimize_step //////////////////////////////////////////////////////////////////////////////////////////////////////
 double GP::optimize_step(gprat_hyper::AdamParams &adam_params, int iter)
 {
+    require_exact_model("GP::optimize_step");
+    // Hyperparameters change, release the stale factorizations
+    factorization_.reset();
+    factorization_fp32_.reset();
     return hpx::async(
                [this, &adam_params, iter]()
                {
@@ -418,12 +832,23 @@ double GP::optimize_step(gprat_hyper::AdamParams &adam_params, int iter)
                    }
 
 #endif
+                   if (precision_ == Precision::fp32)
+                   {
+                       return cpu::optimize_step(
+                           cpu_distances_fp32(),
+                           training_output_,
+                           n_tiles_,
+                           n_tile_size_,
+                           adam_params,
+                           kernel_params,
+                           trainable_params_,
+                           iter);
+                   }
                    return cpu::optimize_step(
-                       training_input_,
+                       cpu_distances(),
                        training_output_,
                        n_tiles_,
                        n_tile_size_,
-                       n_reg,
                        adam_params,
                        kernel_params,
                        trainable_params_,
@@ -432,28 +857,128 @@ double GP::optimize_step(gprat_hyper::AdamParams &adam_params, int iter)
         .get();
 }
 
-// calculate_loss /////////////////////////////////////////////////////////////////////////////////////////////////////
-double GP::calculate_loss()
+// OptimizerSession ///////////////////////////////////////////////////////////////////////////////////////////////////
+OptimizerSession::OptimizerSession(GP &gp, const gprat_hyper::AdamParams &adam) :
+    gp_(gp),
+    adam_params(adam)
 {
+    gp_.require_exact_model("OptimizerSession");
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+    if (gp_.target_->is_gpu())
+    {
+        std::cerr << "OptimizerSession has not been implemented for the GPU.\n"
+                  << "Instead, this operation executes the CPU implementation." << std::endl;
+    }
+#endif
+    hpx::async(
+        [this]()
+        {
+            if (gp_.precision_ == Precision::fp32)
+            {
+                gp_.cpu_distances_fp32();
+                optimizer_fp32_ = std::make_shared<cpu::Optimizer_fp32>(cpu::start_optimizer(
+                    gp_.distances_fp32_, gp_.training_output_, gp_.n_tiles_, gp_.n_tile_size_, gp_.trainable_params_));
+                return;
+            }
+            gp_.cpu_distances();
+            optimizer_ = std::make_shared<cpu::Optimizer>(cpu::start_optimizer(
+                gp_.distances_, gp_.training_output_, gp_.n_tiles_, gp_.n_tile_size_, gp_.trainable_params_));
+        })
+        .get();
+}
+
+std::vector<double> OptimizerSession::run(int n_iterations)
+{
+    gp_.require_exact_model("OptimizerSession");
+    // Hyperparameters change, release the stale factorizations
+    gp_.factorization_.reset();
+    gp_.factorization_fp32_.reset();
     return hpx::async(
-               [this]()
+               [this, n_iterations]()
                {
-#if GPRAT_WITH_CUDA
-                   if (target_->is_gpu())
+                   if (optimizer_fp32_)
                    {
-                       return gpu::compute_loss(
-                           training_input_,
-                           training_output_,
-                           kernel_params,
-                           n_tiles_,
+                       return cpu::optimize(*optimizer_fp32_, adam_params, gp_.kernel_params, n_iterations);
+                   }
+                   return cpu::optimize(*optimizer_, adam_params, gp_.kernel_params, n_iterations);
+               })
+        .get();
+}
+
+double OptimizerSession::step() { return run(1).front(); }
+
+int OptimizerSession::iteration() const
+{
+    return static_cast<int>(optimizer_fp32_ ? optimizer_fp32_->iter : optimizer_->iter);
+}
+
+// calculate_loss /////////////////////////////////////////////////////////////////////////////////////////////////////
+double GP::calculate_loss()
+{
+    if (local_experts_)
+    {
+        return hpx::async(
+                   [this]()
+                   {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                       if (target_->is_gpu())
+                       {
+                           std::cerr << "Local experts have not been implemented for the GPU.\n"
+                                     << "Instead, this operation executes the CPU implementation." << std::endl;
+                       }
+#endif
+                       return cpu::compute_experts_loss(
+                           training_input_, training_output_, n_tiles_, n_tile_size_, n_reg, kernel_params);
+                   })
+            .get();
+    }
+
+    if (rff_params_.n_features > 0)
+    {
+        return hpx::async(
+                   [this]()
+                   {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                       if (target_->is_gpu())
+                       {
+                           std::cerr << "Random features have not been implemented for the GPU.\n"
+                                     << "Instead, this operation executes the CPU implementation." << std::endl;
+                       }
+#endif
+                       return cpu::compute_rff_loss(
+                           training_input_,
+                           training_output_,
+                           n_tiles_,
+                           n_tile_size_,
+                           n_reg,
+                           kernel_params,
+                           rff_params_);
+                   })
+            .get();
+    }
+
+    return hpx::async(
+               [this]()
+               {
+#if GPRAT_WITH_CUDA
+                   if (target_->is_gpu())
+                   {
+                       return gpu::compute_loss(
+                           training_input_,
+                           training_output_,
+                           kernel_params,
+                           n_tiles_,
                            n_tile_size_,
                            n_reg,
                            *std::dynamic_pointer_cast<gprat::CUDA_GPU>(target_));
                    }
                    else
                    {
-                       return cpu::compute_loss(
-                           training_input_, training_output_, kernel_params, n_tiles_, n_tile_size_, n_reg);
+                       return with_cpu_factorization(
+                           [&](const auto &factorization)
+                           {
+                               return cpu::compute_loss(factorization, training_output_, n_tiles_, n_tile_size_);
+                           });
                    }
 
 #elif GPRAT_WITH_SYCL
@@ -470,21 +995,432 @@ double GP::calculate_loss()
                    }
                    else
                    {
-                       return cpu::compute_loss(
-                           training_input_, training_output_, kernel_params, n_tiles_, n_tile_size_, n_reg);
+                       return with_cpu_factorization(
+                           [&](const auto &factorization)
+                           {
+                               return cpu::compute_loss(factorization, training_output_, n_tiles_, n_tile_size_);
+                           });
                    }
 
 #else
-                   return cpu::compute_loss(
-                       training_input_, training_output_, kernel_params, n_tiles_, n_tile_size_, n_reg);
+                   return with_cpu_factorization(
+                       [&](const auto &factorization)
+                       {
+                           return cpu::compute_loss(factorization, training_output_, n_tiles_, n_tile_size_);
+                       });
+#endif
+               })
+        .get();
+}
+
+// evaluate_loss_grid /////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<double> GP::evaluate_loss_grid(const std::vector<std::vector<double>> &params_list)
+{
+    require_exact_model("GP::evaluate_loss_grid");
+    std::vector<gprat_hyper::SEKParams> sek_params_list;
+    sek_params_list.reserve(params_list.size());
+    for (const auto &params : params_list)
+    {
+        sek_params_list.push_back(to_sek_params(params));
+    }
+    return hpx::async(
+               [this, &sek_params_list]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::evaluate_loss_grid has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   if (precision_ == Precision::fp32)
+                   {
+                       return cpu::evaluate_loss_grid(
+                           cpu_distances_fp32(), training_output_, n_tiles_, n_tile_size_, sek_params_list);
+                   }
+                   return cpu::evaluate_loss_grid(
+                       cpu_distances(), training_output_, n_tiles_, n_tile_size_, sek_params_list);
+               })
+        .get();
+}
+
+// loss_and_gradient //////////////////////////////////////////////////////////////////////////////////////////////////
+std::pair<double, std::vector<double>> GP::loss_and_gradient(const std::vector<double> &params, bool unconstrained)
+{
+    require_exact_model("GP::loss_and_gradient");
+    gprat_hyper::SEKParams sek_params = to_sek_params(params);
+    if (unconstrained)
+    {
+        for (std::size_t param_idx = 0; param_idx < params.size(); param_idx++)
+        {
+            sek_params.set_param(param_idx, cpu::to_constrained(params[param_idx], param_idx == 2));
+        }
+    }
+    else if (!(params[0] > 0.0 && params[1] > 0.0 && params[2] > 1e-6))
+    {
+        throw std::invalid_argument("The lengthscales must be positive and the noise variance must exceed 1e-6");
+    }
+    return hpx::async(
+               [this, &sek_params, unconstrained]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::loss_and_gradient has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   if (precision_ == Precision::fp32)
+                   {
+                       return cpu::compute_loss_and_gradient(
+                           cpu_distances_fp32(), training_output_, n_tiles_, n_tile_size_, sek_params, unconstrained);
+                   }
+                   return cpu::compute_loss_and_gradient(
+                       cpu_distances(), training_output_, n_tiles_, n_tile_size_, sek_params, unconstrained);
+               })
+        .get();
+}
+
+// sparse approximations //////////////////////////////////////////////////////////////////////////////////////////////
+void GP::set_inducing_points(int n_inducing, int kmeans_iterations)
+{
+    const int n_samples = n_tiles_ * n_tile_size_;
+    if (n_inducing < 1 || n_inducing > n_samples)
+    {
+        throw std::invalid_argument("Number of inducing points (" + std::to_string(n_inducing)
+                                    + ") must be between 1 and the number of training samples ("
+                                    + std::to_string(n_samples) + ")");
+    }
+    if (kmeans_iterations < 0)
+    {
+        throw std::invalid_argument("Number of k-means iterations must not be negative");
+    }
+    inducing_points_ = hpx::async(
+                           [this, n_samples, n_inducing, kmeans_iterations]()
+                           {
+                               return cpu::select_inducing_points(
+                                   training_input_, n_samples, n_reg, n_inducing, kmeans_iterations);
+                           })
+                           .get();
+    n_inducing_ = n_inducing;
+}
+
+std::vector<double> GP::get_inducing_points() const { return inducing_points_; }
+
+const std::vector<double> &GP::sparse_inducing_points() const
+{
+    if (n_inducing_ == 0
+        || inducing_points_.size() != static_cast<std::size_t>(n_inducing_) * static_cast<std::size_t>(n_reg))
+    {
+        throw std::logic_error("No inducing points for the current number of regressors, call set_inducing_points");
+    }
+    return inducing_points_;
+}
+
+double GP::calculate_sparse_loss(Approximation approximation)
+{
+    const std::vector<double> &inducing_points = sparse_inducing_points();
+    return hpx::async(
+               [this, &inducing_points, approximation]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::calculate_sparse_loss has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::compute_sparse_loss(
+                       training_input_,
+                       training_output_,
+                       inducing_points,
+                       n_tiles_,
+                       n_tile_size_,
+                       n_reg,
+                       kernel_params,
+                       approximation);
+               })
+        .get();
+}
+
+std::vector<double> GP::optimize_sparse(const gprat_hyper::AdamParams &adam_params, Approximation approximation)
+{
+    const std::vector<double> &inducing_points = sparse_inducing_points();
+    // Hyperparameters change, release the stale factorizations
+    factorization_.reset();
+    factorization_fp32_.reset();
+    return hpx::async(
+               [this, &inducing_points, &adam_params, approximation]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::optimize_sparse has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::optimize_sparse(
+                       training_input_,
+                       training_output_,
+                       inducing_points,
+                       n_tiles_,
+                       n_tile_size_,
+                       n_reg,
+                       adam_params,
+                       kernel_params,
+                       trainable_params_,
+                       approximation);
+               })
+        .get();
+}
+
+std::vector<std::vector<double>> GP::predict_sparse_with_uncertainty(
+    const std::vector<double> &test_data, int m_tiles, int m_tile_size, Approximation approximation)
+{
+    const std::vector<double> &inducing_points = sparse_inducing_points();
+    return hpx::async(
+               [this, &inducing_points, &test_data, m_tiles, m_tile_size, approximation]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::predict_sparse_with_uncertainty has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::predict_sparse_with_uncertainty(
+                       training_input_,
+                       training_output_,
+                       inducing_points,
+                       test_data,
+                       n_tiles_,
+                       n_tile_size_,
+                       m_tiles,
+                       m_tile_size,
+                       n_reg,
+                       kernel_params,
+                       approximation);
+               })
+        .get();
+}
+
+// local experts //////////////////////////////////////////////////////////////////////////////////////////////////////
+void GP::set_local_experts(bool enabled, Expert_combination combination)
+{
+    if (enabled && rff_params_.n_features > 0)
+    {
+        throw std::invalid_argument("The local experts cannot be combined with the random feature approximation");
+    }
+    local_experts_ = enabled;
+    expert_combination_ = combination;
+}
+
+std::vector<std::vector<double>>
+GP::predict_experts_with_uncertainty(const std::vector<double> &test_data, int m_tiles, int m_tile_size)
+{
+    return hpx::async(
+               [this, &test_data, m_tiles, m_tile_size]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "Local experts have not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::predict_experts_with_uncertainty(
+                       training_input_,
+                       training_output_,
+                       test_data,
+                       n_tiles_,
+                       n_tile_size_,
+                       m_tiles,
+                       m_tile_size,
+                       n_reg,
+                       kernel_params,
+                       expert_combination_);
+               })
+        .get();
+}
+
+// iterative solver ///////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<double> GP::predict_pcg(
+    const std::vector<double> &test_data, int m_tiles, int m_tile_size, const gprat_hyper::PCGParams &pcg_params)
+{
+    return hpx::async(
+               [this, &test_data, m_tiles, m_tile_size, &pcg_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::predict_pcg has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::predict_pcg(
+                       training_input_,
+                       training_output_,
+                       test_data,
+                       n_tiles_,
+                       n_tile_size_,
+                       m_tiles,
+                       m_tile_size,
+                       n_reg,
+                       kernel_params,
+                       pcg_params);
+               })
+        .get();
+}
+
+double GP::calculate_stochastic_loss(const gprat_hyper::StochasticParams &stochastic_params)
+{
+    return hpx::async(
+               [this, &stochastic_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::calculate_stochastic_loss has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::compute_stochastic_loss(
+                       training_input_,
+                       training_output_,
+                       n_tiles_,
+                       n_tile_size_,
+                       n_reg,
+                       kernel_params,
+                       stochastic_params);
+               })
+        .get();
+}
+
+std::vector<double> GP::optimize_stochastic(const gprat_hyper::AdamParams &adam_params,
+                                            const gprat_hyper::StochasticParams &stochastic_params)
+{
+    // Hyperparameters change, release the stale factorizations
+    factorization_.reset();
+    factorization_fp32_.reset();
+    return hpx::async(
+               [this, &adam_params, &stochastic_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::optimize_stochastic has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::optimize_stochastic(
+                       training_input_,
+                       training_output_,
+                       n_tiles_,
+                       n_tile_size_,
+                       n_reg,
+                       adam_params,
+                       kernel_params,
+                       trainable_params_,
+                       stochastic_params);
+               })
+        .get();
+}
+
+// tile low-rank ///////////////////////////////////////////////////////////////////////////////////////////////////////
+double GP::calculate_tlr_loss(const gprat_hyper::TLRParams &tlr_params)
+{
+    return hpx::async(
+               [this, &tlr_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::calculate_tlr_loss has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
 #endif
+                   return cpu::compute_tlr_loss(
+                       training_input_, training_output_, n_tiles_, n_tile_size_, n_reg, kernel_params, tlr_params);
                })
         .get();
 }
 
+std::vector<double> GP::predict_tlr(
+    const std::vector<double> &test_data, int m_tiles, int m_tile_size, const gprat_hyper::TLRParams &tlr_params)
+{
+    return hpx::async(
+               [this, &test_data, m_tiles, m_tile_size, &tlr_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::predict_tlr has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::predict_tlr(
+                       training_input_,
+                       training_output_,
+                       test_data,
+                       n_tiles_,
+                       n_tile_size_,
+                       m_tiles,
+                       m_tile_size,
+                       n_reg,
+                       kernel_params,
+                       tlr_params);
+               })
+        .get();
+}
+
+std::vector<int> GP::tlr_ranks(const gprat_hyper::TLRParams &tlr_params)
+{
+    return hpx::async(
+               [this, &tlr_params]()
+               {
+#if GPRAT_WITH_CUDA || GPRAT_WITH_SYCL
+                   if (target_->is_gpu())
+                   {
+                       std::cerr << "GP::tlr_ranks has not been implemented for the GPU.\n"
+                                 << "Instead, this operation executes the CPU implementation." << std::endl;
+                   }
+#endif
+                   return cpu::compute_tlr_ranks(
+                       training_input_, n_tiles_, n_tile_size_, n_reg, kernel_params, tlr_params);
+               })
+        .get();
+}
+
+// random Fourier features /////////////////////////////////////////////////////////////////////////////////////////////
+void GP::set_random_features(const gprat_hyper::RFFParams &rff_params)
+{
+    if (rff_params.n_features < 0)
+    {
+        throw std::invalid_argument("The number of random features must not be negative");
+    }
+    if (rff_params.n_features > 0 && local_experts_)
+    {
+        throw std::invalid_argument("The random feature approximation cannot be combined with the local experts");
+    }
+    rff_params_ = rff_params;
+}
+
+void GP::require_exact_model(const std::string &operation) const
+{
+    if (rff_params_.n_features > 0)
+    {
+        throw std::invalid_argument(operation + " is not available for the random feature approximation");
+    }
+    if (local_experts_)
+    {
+        throw std::invalid_argument(operation + " is not available for the local experts approximation");
+    }
+}
+
 // cholesky ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::vector<std::vector<double>> GP::cholesky()
 {
+    require_exact_model("GP::cholesky");
 #if !GPRAT_WITH_SYCL
     return hpx::async(
                [this]()
@@ -502,10 +1438,18 @@ std::vector<std::vector<double>> GP::cholesky()
                    }
                    else
                    {
-                       return cpu::cholesky(training_input_, kernel_params, n_tiles_, n_tile_size_, n_reg);
+                       return with_cpu_factorization(
+                           [&](const auto &factorization)
+                           {
+                               return cpu::cholesky(factorization, n_tiles_);
+                           });
                    }
 #else
-                   return cpu::cholesky(training_input_, kernel_params, n_tiles_, n_tile_size_, n_reg);
+                   return with_cpu_factorization(
+                       [&](const auto &factorization)
+                       {
+                           return cpu::cholesky(factorization, n_tiles_);
+                       });
 #endif
                })
         .get();
@@ -523,7 +1467,11 @@ std::vector<std::vector<double>> GP::cholesky()
     }
     else
     {
-        return cpu::cholesky(training_input_, kernel_params, n_tiles_, n_tile_size_, n_reg);
+        return with_cpu_factorization(
+            [&](const auto &factorization)
+            {
+                return cpu::cholesky(factorization, n_tiles_);
+            });
     }
 
 #endif
@@ -12,13 +12,17 @@
 // Catch2
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+using Catch::Matchers::WithinAbs;
 using Catch::Matchers::WithinRel;
+using Catch::Matchers::WithinULP;
 
 // Boost
 #include <boost/json/src.hpp>
 
 // Standard library
+#include <cmath>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
@@ -106,6 +110,28 @@ GpratResults tag_invoke(boost::json::value_to_tag<GpratResults>, const boost::js
     return results;
 }
 
+/**
+ * @brief Tries to read the contents of the specified filename to set them as the basis of the
+ *        test for correctness.
+ *
+ * @param filename the filename to read from
+ * @param results the results object to fill up with the content of the file in case of success
+ *
+ * @return `true` if reading the specified file is successful, and `false` otherwise
+ */
+bool load_expected_results(const std::string &filename, GpratResults &results)
+{
+    std::ifstream ifs(filename);
+    if (ifs.fail())
+    {
+        return false;
+    }
+    using iterator_type = std::istreambuf_iterator<char>;
+    const std::string content(iterator_type{ ifs }, iterator_type{});
+    results = boost::json::value_to<GpratResults>(boost::json::parse(content));
+    return true;
+}
+
 /**
  * @brief Tries to read the contents of the specified filename to set them as the basis of the
  *        test for correctness. If that is not possible, a file with the specified name is created
@@ -122,15 +148,9 @@ bool load_or_create_expected_results(
     const std::string &filename, const GpratResults &fallback_results, GpratResults &results)
 {
     // First try to read our expected results file
+    if (load_expected_results(filename, results))
     {
-        std::ifstream ifs(filename);
-        if (!ifs.fail())
-        {
-            using iterator_type = std::istreambuf_iterator<char>;
-            const std::string content(iterator_type{ ifs }, iterator_type{});
-            results = boost::json::value_to<GpratResults>(boost::json::parse(content));
-            return true;
-        }
+        return true;
     }
 
     // If that does not work, just write out the results we want
@@ -214,6 +234,119 @@ GpratResults run_on_data_cpu(const std::string &train_path, const std::string &o
     return results_cpu;
 }
 
+/**
+ * @brief Generates the predictions and losses of a test configuration using the CPU with a
+ *        reduced precision.
+ *
+ * @param train_path path to the text file containing the training data
+ * @param out_path path to the text file containing the output data of the test
+ * @param test_path path to the text file containing the input data for the test
+ * @param precision precision of the tiles of the covariance matrix
+ *
+ * @return a GpratResults object holding only the sum, pred and losses results
+ */
+GpratResults run_on_data_cpu_precision(const std::string &train_path,
+                                       const std::string &out_path,
+                                       const std::string &test_path,
+                                       gprat::Precision precision)
+{
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat_hyper::AdamParams hpar = { 0.1, 0.9, 0.999, 1e-8, OPT_ITER };
+
+    gprat::GP_data training_input(train_path, n_train, n_reg);
+    gprat::GP_data training_output(out_path, n_train, n_reg);
+    gprat::GP_data test_input(test_path, n_test, n_reg);
+
+    const std::vector<bool> trainable = { true, true, true };
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, trainable, precision);
+
+    utils::start_hpx_runtime(0, nullptr);
+
+    GpratResults results_cpu;
+
+    results_cpu.sum = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    results_cpu.pred = gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    results_cpu.losses = gp_cpu.optimize(hpar);
+
+    utils::stop_hpx_runtime();
+
+    return results_cpu;
+}
+
+/**
+ * @brief Generates the losses of a test configuration using an optimizer session on the CPU.
+ *
+ * The first iteration is performed as a single step, the remaining iterations are pipelined.
+ *
+ * @param train_path path to the text file containing the training data
+ * @param out_path path to the text file containing the output data of the test
+ *
+ * @return a GpratResults object holding only the losses
+ */
+GpratResults run_on_data_cpu_session(const std::string &train_path, const std::string &out_path)
+{
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+
+    gprat_hyper::AdamParams hpar = { 0.1, 0.9, 0.999, 1e-8, OPT_ITER };
+
+    gprat::GP_data training_input(train_path, n_train, n_reg);
+    gprat::GP_data training_output(out_path, n_train, n_reg);
+
+    const std::vector<bool> trainable = { true, true, true };
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, trainable);
+
+    utils::start_hpx_runtime(0, nullptr);
+
+    GpratResults results_cpu;
+
+    gprat::OptimizerSession session(gp_cpu, hpar);
+    results_cpu.losses.push_back(session.step());
+    const auto losses = session.run(static_cast<int>(OPT_ITER) - 1);
+    results_cpu.losses.insert(results_cpu.losses.end(), losses.begin(), losses.end());
+
+    utils::stop_hpx_runtime();
+
+    return results_cpu;
+}
+
+/**
+ * @brief Generates the losses of an L-BFGS optimization of a test configuration on the CPU.
+ *
+ * @param train_path path to the text file containing the training data
+ * @param out_path path to the text file containing the output data of the test
+ *
+ * @return a GpratResults object holding only the losses
+ */
+GpratResults run_on_data_cpu_lbfgs(const std::string &train_path, const std::string &out_path)
+{
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+
+    gprat_hyper::LBFGSParams lbfgs_params = { 10, 6, 1e-5, 1e-4, 20 };
+
+    gprat::GP_data training_input(train_path, n_train, n_reg);
+    gprat::GP_data training_output(out_path, n_train, n_reg);
+
+    const std::vector<bool> trainable = { true, true, true };
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, trainable);
+
+    utils::start_hpx_runtime(0, nullptr);
+
+    GpratResults results_cpu;
+    results_cpu.losses = gp_cpu.optimize_lbfgs(lbfgs_params);
+
+    utils::stop_hpx_runtime();
+
+    return results_cpu;
+}
+
 /**
  * @brief Generates results for a test configuration using a CUDA GPU or a SYCL device for
  *        computations, depending on how GPRat was compiled.
@@ -352,6 +485,772 @@ TEST_CASE("GP CPU results match known-good values", "[integration][cpu]")
     }
 }
 
+TEST_CASE("GP CPU appended observations match a GP built on the combined data", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    // The first half of the tiles is used for training, the second half is appended
+    const std::size_t n_first = n_train / 2;
+    const auto input_split = training_input.data.begin() + static_cast<std::ptrdiff_t>(n_first + n_reg - 1);
+    const auto input_end = training_input.data.begin() + static_cast<std::ptrdiff_t>(n_train + n_reg - 1);
+    const auto output_split = training_output.data.begin() + static_cast<std::ptrdiff_t>(n_first);
+    const auto output_end = training_output.data.begin() + static_cast<std::ptrdiff_t>(n_train);
+
+    gprat::GP gp_cpu(std::vector<double>(training_input.data.begin(), input_split),
+                     std::vector<double>(training_output.data.begin(), output_split),
+                     n_tiles / 2,
+                     tile_size,
+                     n_reg,
+                     { 1.0, 1.0, 0.1 },
+                     { true, true, true });
+    gprat::GP gp_combined(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    // Predict first, such that the cached factorization is extended instead of recomputed
+    gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    gp_cpu.append_observations(std::vector<double>(input_split, input_end),
+                               std::vector<double>(output_split, output_end));
+    const auto pred = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const double loss = gp_cpu.calculate_loss();
+    const auto pred_combined =
+        gp_combined.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const double loss_combined = gp_combined.calculate_loss();
+    utils::stop_hpx_runtime();
+
+    REQUIRE_THAT(loss, WithinRel(loss_combined, 1e-10));
+    REQUIRE(pred[0].size() == pred_combined[0].size());
+    for (std::size_t i = 0, n = pred[0].size(); i != n; ++i)
+    {
+        INFO("CPU appended pred " << i);
+        REQUIRE_THAT(pred[0][i], WithinRel(pred_combined[0][i], 1e-8));
+        REQUIRE_THAT(pred[1][i], WithinRel(pred_combined[1][i], 1e-8));
+    }
+}
+
+TEST_CASE("GP CPU sliding window matches a GP built on the windowed data", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+    const auto n_shift = static_cast<std::size_t>(tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train + n_shift, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train + n_shift, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    // The window slides over the observations of one tile, such that the kept tiles update the factor
+    const auto input_begin = training_input.data.begin();
+    const auto output_begin = training_output.data.begin();
+    const auto input_window_end = input_begin + static_cast<std::ptrdiff_t>(n_train + n_reg - 1);
+    const auto output_window_end = output_begin + static_cast<std::ptrdiff_t>(n_train);
+    const auto shift = static_cast<std::ptrdiff_t>(n_shift);
+
+    gprat::GP gp_cpu(std::vector<double>(input_begin, input_window_end),
+                     std::vector<double>(output_begin, output_window_end),
+                     n_tiles,
+                     tile_size,
+                     n_reg,
+                     { 1.0, 1.0, 0.1 },
+                     { true, true, true });
+    gprat::GP gp_windowed(std::vector<double>(input_begin + shift, input_window_end + shift),
+                          std::vector<double>(output_begin + shift, output_window_end + shift),
+                          n_tiles,
+                          tile_size,
+                          n_reg,
+                          { 1.0, 1.0, 0.1 },
+                          { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    // Predict first, such that the cached factorization is updated instead of recomputed
+    gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    gp_cpu.slide_window(std::vector<double>(input_window_end, input_window_end + shift),
+                        std::vector<double>(output_window_end, output_window_end + shift));
+    const auto pred = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const double loss = gp_cpu.calculate_loss();
+    const auto pred_windowed =
+        gp_windowed.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const double loss_windowed = gp_windowed.calculate_loss();
+    utils::stop_hpx_runtime();
+
+    REQUIRE_THAT(loss, WithinRel(loss_windowed, 1e-10));
+    REQUIRE(pred[0].size() == pred_windowed[0].size());
+    for (std::size_t i = 0, n = pred[0].size(); i != n; ++i)
+    {
+        INFO("CPU sliding window pred " << i);
+        REQUIRE_THAT(pred[0][i], WithinRel(pred_windowed[0][i], 1e-8));
+        REQUIRE_THAT(pred[1][i], WithinRel(pred_windowed[1][i], 1e-8));
+    }
+}
+
+/**
+ * @brief Computes the loss and the predictions of the exact GP with dense matrices and the squared distances summed
+ *        over all regressors, as reference for the tiled implementation.
+ *
+ * @return the loss followed by the predictions
+ */
+std::vector<double> dense_reference(const std::vector<double> &training_input,
+                                    const std::vector<double> &training_output,
+                                    const std::vector<double> &test_input,
+                                    std::size_t n_samples,
+                                    std::size_t n_predictions,
+                                    std::size_t n_regressors,
+                                    const gprat_hyper::SEKParams &params)
+{
+    auto covariance = [&](const std::vector<double> &a, std::size_t i, const std::vector<double> &b, std::size_t j)
+    {
+        double distance = 0.0;
+        for (std::size_t k = 0; k < n_regressors; ++k)
+        {
+            distance += (a[i + k] - b[j + k]) * (a[i + k] - b[j + k]);
+        }
+        return params.vertical_lengthscale * std::exp(-0.5 * distance / (params.lengthscale * params.lengthscale));
+    };
+
+    // Cholesky factor L of K in the lower triangle
+    std::vector<double> L(n_samples * n_samples, 0.0);
+    for (std::size_t i = 0; i < n_samples; ++i)
+    {
+        for (std::size_t j = 0; j <= i; ++j)
+        {
+            double value = covariance(training_input, i, training_input, j) + (i == j ? params.noise_variance : 0.0);
+            for (std::size_t k = 0; k < j; ++k)
+            {
+                value -= L[i * n_samples + k] * L[j * n_samples + k];
+            }
+            L[i * n_samples + j] = i == j ? std::sqrt(value) : value / L[j * n_samples + j];
+        }
+    }
+
+    // alpha = K^-1 * y with L * beta = y and L^T * alpha = beta
+    std::vector<double> alpha(training_output.begin(),
+                              training_output.begin() + static_cast<std::ptrdiff_t>(n_samples));
+    for (std::size_t i = 0; i < n_samples; ++i)
+    {
+        for (std::size_t k = 0; k < i; ++k)
+        {
+            alpha[i] -= L[i * n_samples + k] * alpha[k];
+        }
+        alpha[i] /= L[i * n_samples + i];
+    }
+    for (std::size_t i = n_samples; i-- > 0;)
+    {
+        for (std::size_t k = i + 1; k < n_samples; ++k)
+        {
+            alpha[i] -= L[k * n_samples + i] * alpha[k];
+        }
+        alpha[i] /= L[i * n_samples + i];
+    }
+
+    // loss = 0.5 * (y^T * alpha + log(det(K)) + N * log(2 * pi)) / N
+    double loss = static_cast<double>(n_samples) * std::log(2.0 * std::acos(-1.0));
+    for (std::size_t i = 0; i < n_samples; ++i)
+    {
+        loss += training_output[i] * alpha[i] + 2.0 * std::log(L[i * n_samples + i]);
+    }
+    std::vector<double> results = { 0.5 * loss / static_cast<double>(n_samples) };
+
+    // Predictions K_*^T * alpha
+    for (std::size_t i = 0; i < n_predictions; ++i)
+    {
+        double prediction = 0.0;
+        for (std::size_t j = 0; j < n_samples; ++j)
+        {
+            prediction += covariance(test_input, i, training_input, j) * alpha[j];
+        }
+        results.push_back(prediction);
+    }
+    return results;
+}
+
+/*
+ * CPU test case for the lagged distance recurrence, which is used from 16 regressors on and recomputed exactly
+ * every 32 rows of a tile
+ */
+TEST_CASE("GP CPU lagged distance recurrence matches dense exact distances", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const std::size_t n_reg_lagged = 16;
+    const std::size_t n_tiles_lagged = 2;
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles_lagged);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles_lagged, tile_size);
+    const gprat_hyper::SEKParams params(2.0, 1.0, 0.1);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg_lagged);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg_lagged);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg_lagged);
+
+    gprat::GP gp_cpu(training_input.data,
+                     training_output.data,
+                     n_tiles_lagged,
+                     tile_size,
+                     n_reg_lagged,
+                     { params.lengthscale, params.vertical_lengthscale, params.noise_variance },
+                     { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const double loss = gp_cpu.calculate_loss();
+    const auto losses = gp_cpu.evaluate_loss_grid(
+        { { params.lengthscale, params.vertical_lengthscale, params.noise_variance } });
+    const auto pred = gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    utils::stop_hpx_runtime();
+
+    const auto reference = dense_reference(
+        training_input.data, training_output.data, test_input.data, n_train, n_test, n_reg_lagged, params);
+
+    // The tiles have more rows than the interval of the exact recomputation
+    REQUIRE(tile_size > 32);
+    REQUIRE_THAT(loss, WithinRel(reference[0], 1e-10));
+    REQUIRE_THAT(losses[0], WithinRel(reference[0], 1e-10));
+    REQUIRE(pred.size() == n_test);
+    for (std::size_t i = 0; i != n_test; ++i)
+    {
+        INFO("CPU lagged pred " << i);
+        REQUIRE_THAT(pred[i], WithinAbs(reference[i + 1], 1e-10));
+    }
+}
+
+/*
+ * CPU test case for the mixed-precision factorization
+ */
+TEST_CASE("GP CPU mixed precision predictions match known-good values", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+
+    const auto results = run_on_data_cpu_precision(root + "/data_1024/training_input.txt",
+                                                   root + "/data_1024/training_output.txt",
+                                                   root + "/data_1024/test_input.txt",
+                                                   gprat::Precision::mixed);
+
+    GpratResults expected_results;
+
+    // The FP64 test case creates the reference file, mixed results must not replace it
+    if (!load_expected_results(root + "/data_1024/output.json", expected_results))
+    {
+        std::cerr << "No previous results to compare to.\n";
+        return;
+    }
+
+    /*
+     * Iterative refinement recovers the predictive mean to nearly FP64 accuracy, while the
+     * uncertainty is computed from the FP32 accurate Cholesky factor
+     */
+    double eps_mean = 1e-8;
+    double eps_variance = 1e-4;
+
+    for (std::size_t i = 0, n = results.pred.size(); i != n; ++i)
+    {
+        INFO("CPU mixed pred " << i);
+        REQUIRE_THAT(results.pred[i], WithinRel(expected_results.pred[i], eps_mean));
+    }
+
+    for (std::size_t j = 0, m = results.sum[0].size(); j != m; ++j)
+    {
+        INFO("CPU mixed sum " << j);
+        REQUIRE_THAT(results.sum[0][j], WithinRel(expected_results.sum[0][j], eps_mean));
+        REQUIRE_THAT(results.sum[1][j], WithinRel(expected_results.sum[1][j], eps_variance));
+    }
+}
+
+/*
+ * CPU test case for the FP32 pipeline
+ */
+TEST_CASE("GP CPU FP32 results match known-good values", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+
+    const auto results = run_on_data_cpu_precision(root + "/data_1024/training_input.txt",
+                                                   root + "/data_1024/training_output.txt",
+                                                   root + "/data_1024/test_input.txt",
+                                                   gprat::Precision::fp32);
+
+    GpratResults expected_results;
+
+    // The FP64 test case creates the reference file, FP32 results must not replace it
+    if (!load_expected_results(root + "/data_1024/output.json", expected_results))
+    {
+        std::cerr << "No previous results to compare to.\n";
+        return;
+    }
+
+    /*
+     * Predictions close to zero have large relative FP32 errors, hence predictions are compared
+     * with an absolute tolerance
+     */
+    double eps_abs = 1e-5;
+    double eps_loss = 1e-4;
+
+    for (std::size_t i = 0, n = results.pred.size(); i != n; ++i)
+    {
+        INFO("CPU FP32 pred " << i);
+        REQUIRE_THAT(results.pred[i], WithinAbs(expected_results.pred[i], eps_abs));
+    }
+
+    for (std::size_t j = 0, m = results.sum[0].size(); j != m; ++j)
+    {
+        INFO("CPU FP32 sum " << j);
+        REQUIRE_THAT(results.sum[0][j], WithinAbs(expected_results.sum[0][j], eps_abs));
+        REQUIRE_THAT(results.sum[1][j], WithinAbs(expected_results.sum[1][j], eps_abs));
+    }
+
+    for (std::size_t i = 0, n = results.losses.size(); i != n; ++i)
+    {
+        INFO("CPU FP32 losses " << i);
+        REQUIRE_THAT(results.losses[i], WithinRel(expected_results.losses[i], eps_loss));
+    }
+}
+
+/*
+ * CPU test case for an optimizer session continued over several calls
+ */
+TEST_CASE("GP CPU optimizer session losses match known-good values", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+
+    const auto results =
+        run_on_data_cpu_session(root + "/data_1024/training_input.txt", root + "/data_1024/training_output.txt");
+
+    GpratResults expected_results;
+
+    if (!load_expected_results(root + "/data_1024/output.json", expected_results))
+    {
+        std::cerr << "No previous results to compare to.\n";
+        return;
+    }
+
+    double eps = std::numeric_limits<double>::epsilon() * 1'000'000;
+
+    REQUIRE(results.losses.size() == expected_results.losses.size());
+    for (std::size_t i = 0, n = results.losses.size(); i != n; ++i)
+    {
+        INFO("CPU session losses " << i);
+        REQUIRE_THAT(results.losses[i], WithinRel(expected_results.losses[i], eps));
+    }
+}
+
+/*
+ * CPU test case for the L-BFGS optimizer
+ */
+TEST_CASE("GP CPU L-BFGS decreases the loss below the Adam losses", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+
+    const auto results =
+        run_on_data_cpu_lbfgs(root + "/data_1024/training_input.txt", root + "/data_1024/training_output.txt");
+
+    GpratResults expected_results;
+
+    if (!load_expected_results(root + "/data_1024/output.json", expected_results))
+    {
+        std::cerr << "No previous results to compare to.\n";
+        return;
+    }
+
+    double eps = std::numeric_limits<double>::epsilon() * 1'000'000;
+
+    // The loss of the initial hyperparameters equals the first Adam loss
+    REQUIRE(results.losses.size() > 1);
+    REQUIRE_THAT(results.losses.front(), WithinRel(expected_results.losses.front(), eps));
+
+    // Each iteration satisfies the Armijo condition and thereby does not increase the loss
+    for (std::size_t i = 1, n = results.losses.size(); i != n; ++i)
+    {
+        INFO("CPU L-BFGS losses " << i);
+        REQUIRE(results.losses[i] <= results.losses[i - 1]);
+    }
+    REQUIRE(results.losses.back() < expected_results.losses.back());
+}
+
+/*
+ * CPU test case for the loss and its gradients
+ */
+TEST_CASE("GP CPU loss gradients match finite differences", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+
+    const std::vector<double> params = { 0.8, 1.3, 0.05 };
+    const auto [loss, gradient] = gp_cpu.loss_and_gradient(params);
+    const auto [loss_unconstrained, gradient_unconstrained] = gp_cpu.loss_and_gradient({ 0.3, -0.2, -1.5 }, true);
+
+    // Central differences of the loss
+    const double h = 1e-5;
+    std::vector<double> finite_differences;
+    for (std::size_t i = 0; i != params.size(); ++i)
+    {
+        auto params_forward = params;
+        auto params_backward = params;
+        params_forward[i] += h;
+        params_backward[i] -= h;
+        finite_differences.push_back(
+            (gp_cpu.loss_and_gradient(params_forward).first - gp_cpu.loss_and_gradient(params_backward).first)
+            / (2 * h));
+    }
+
+    // The stored hyperparameters are not changed
+    const double loss_stored = gp_cpu.calculate_loss();
+
+    utils::stop_hpx_runtime();
+
+    REQUIRE(gradient.size() == 3);
+    REQUIRE(gradient_unconstrained.size() == 3);
+    REQUIRE(std::isfinite(loss_unconstrained));
+    REQUIRE_THAT(gp_cpu.kernel_params.lengthscale, WithinULP(1.0, 0));
+    REQUIRE_THAT(loss, !WithinRel(loss_stored, 1e-6));
+    for (std::size_t i = 0; i != params.size(); ++i)
+    {
+        INFO("CPU gradient " << i);
+        REQUIRE_THAT(gradient[i], WithinRel(finite_differences[i], 1e-6));
+    }
+}
+
+/*
+ * CPU test case for concurrent optimizations from several initial hyperparameters
+ */
+TEST_CASE("GP CPU multistart losses match known-good values", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+
+    gprat_hyper::AdamParams hpar = { 0.1, 0.9, 0.999, 1e-8, OPT_ITER };
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const auto result = gp_cpu.optimize_multistart({ { 0.2, 2.0, 0.3 }, { 1.0, 1.0, 0.1 } }, hpar);
+    utils::stop_hpx_runtime();
+
+    GpratResults expected_results;
+
+    if (!load_expected_results(root + "/data_1024/output.json", expected_results))
+    {
+        std::cerr << "No previous results to compare to.\n";
+        return;
+    }
+
+    double eps = std::numeric_limits<double>::epsilon() * 1'000'000;
+
+    // The optimization from the default hyperparameters equals `optimize`
+    REQUIRE(result.losses.size() == 2);
+    REQUIRE(result.losses[1].size() == expected_results.losses.size());
+    for (std::size_t i = 0, n = expected_results.losses.size(); i != n; ++i)
+    {
+        INFO("CPU multistart losses " << i);
+        REQUIRE_THAT(result.losses[1][i], WithinRel(expected_results.losses[i], eps));
+    }
+
+    // The GP continues with the hyperparameters of the best optimization
+    REQUIRE(result.losses[result.best_index].back() <= result.losses[1 - result.best_index].back());
+    REQUIRE_THAT(result.best_params[0], WithinULP(gp_cpu.kernel_params.lengthscale, 0));
+    REQUIRE_THAT(result.best_params[2], WithinULP(gp_cpu.kernel_params.noise_variance, 0));
+}
+
+/*
+ * CPU test case for the loss of several hyperparameters
+ */
+TEST_CASE("GP CPU loss grid matches single loss evaluations", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const auto losses = gp_cpu.evaluate_loss_grid({ { 1.0, 1.0, 0.1 }, { 0.8, 1.3, 0.05 }, { 2.0, 0.5, 0.01 } });
+    const double loss_default = gp_cpu.calculate_loss();
+    gp_cpu.kernel_params = gprat_hyper::SEKParams(0.8, 1.3, 0.05);
+    const double loss_second = gp_cpu.calculate_loss();
+    utils::stop_hpx_runtime();
+
+    double eps = std::numeric_limits<double>::epsilon() * 1'000'000;
+
+    REQUIRE(losses.size() == 3);
+    REQUIRE_THAT(losses[0], WithinRel(loss_default, eps));
+    REQUIRE_THAT(losses[1], WithinRel(loss_second, eps));
+    REQUIRE(std::isfinite(losses[2]));
+}
+
+/*
+ * CPU test case for the inducing point approximations
+ */
+TEST_CASE("GP CPU sparse approximations with all inducing points match the exact GP", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    // With every feature vector as inducing point, Q_NN = K_NN up to the jitter of K_MM
+    gp_cpu.set_inducing_points(n_train);
+    const double loss = gp_cpu.calculate_loss();
+    const double loss_dtc = gp_cpu.calculate_sparse_loss(gprat::Approximation::dtc);
+    const double loss_fitc = gp_cpu.calculate_sparse_loss(gprat::Approximation::fitc);
+    const auto pred = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const auto pred_dtc = gp_cpu.predict_sparse_with_uncertainty(
+        test_input.data, test_tiles.first, test_tiles.second, gprat::Approximation::dtc);
+    // Few inducing points, the loss decreases
+    gp_cpu.set_inducing_points(16, 3);
+    const auto losses = gp_cpu.optimize_sparse(gprat_hyper::AdamParams(0.1, 0.9, 0.999, 1e-8, OPT_ITER),
+                                               gprat::Approximation::fitc);
+    utils::stop_hpx_runtime();
+
+    REQUIRE_THAT(loss_dtc, WithinRel(loss, 1e-4));
+    REQUIRE_THAT(loss_fitc, WithinRel(loss, 1e-4));
+    REQUIRE(pred_dtc.size() == 2);
+    for (std::size_t i = 0, n = pred[0].size(); i != n; ++i)
+    {
+        INFO("CPU sparse pred " << i);
+        REQUIRE_THAT(pred_dtc[0][i], WithinRel(pred[0][i], 1e-2));
+        REQUIRE_THAT(pred_dtc[1][i], WithinRel(pred[1][i], 1e-2));
+    }
+    REQUIRE(losses.size() == OPT_ITER);
+    for (std::size_t i = 1; i < losses.size(); i++)
+    {
+        REQUIRE(losses[i] < losses[i - 1]);
+    }
+}
+
+TEST_CASE("GP CPU local experts match the exact GP for a single expert", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+    // A single training tile is a single expert with the exact covariance matrix
+    gprat::GP gp_single(
+        training_input.data, training_output.data, 1, n_train, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const double loss = gp_single.calculate_loss();
+    const auto pred = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    gp_single.set_local_experts(true, gprat::Expert_combination::poe);
+    const double loss_single = gp_single.calculate_loss();
+    const auto pred_poe = gp_single.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    gp_single.set_local_experts(true, gprat::Expert_combination::bcm);
+    const auto pred_bcm = gp_single.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    // One expert per training tile
+    gp_cpu.set_local_experts(true, gprat::Expert_combination::rbcm);
+    const auto pred_rbcm = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const auto pred_rbcm_mean = gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    REQUIRE_THROWS_AS(gp_cpu.cholesky(), std::invalid_argument);
+    const auto losses = gp_cpu.optimize(gprat_hyper::AdamParams(0.1, 0.9, 0.999, 1e-8, OPT_ITER));
+    utils::stop_hpx_runtime();
+
+    REQUIRE_THAT(loss_single, WithinRel(loss, 1e-8));
+    double squared_error = 0.0;
+    double squared_norm = 0.0;
+    for (std::size_t i = 0, n = pred[0].size(); i != n; ++i)
+    {
+        INFO("CPU experts pred " << i);
+        REQUIRE_THAT(pred_poe[0][i], WithinRel(pred[0][i], 1e-6));
+        REQUIRE_THAT(pred_poe[1][i], WithinRel(pred[1][i], 1e-6));
+        REQUIRE_THAT(pred_bcm[0][i], WithinRel(pred[0][i], 1e-6));
+        REQUIRE_THAT(pred_bcm[1][i], WithinRel(pred[1][i], 1e-6));
+        REQUIRE(pred_rbcm[1][i] > 0.0);
+        REQUIRE_THAT(pred_rbcm_mean[i], WithinULP(pred_rbcm[0][i], 0));
+        squared_error += (pred_rbcm[0][i] - pred[0][i]) * (pred_rbcm[0][i] - pred[0][i]);
+        squared_norm += pred[0][i] * pred[0][i];
+    }
+    // Accuracy of the robust Bayesian committee machine w.r.t. the exact GP
+    const double relative_error = std::sqrt(squared_error / squared_norm);
+    INFO("CPU rBCM relative error " << relative_error);
+    REQUIRE(relative_error < 0.25);
+    REQUIRE(losses.size() == OPT_ITER);
+    for (std::size_t i = 1; i < losses.size(); i++)
+    {
+        REQUIRE(losses[i] < losses[i - 1]);
+    }
+}
+
+TEST_CASE("GP CPU conjugate gradient predictions match the Cholesky predictions", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const auto pred = gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    const auto pred_cg = gp_cpu.predict_pcg(
+        test_input.data, test_tiles.first, test_tiles.second, gprat_hyper::PCGParams(1000, 1e-12, 0, false));
+    const auto pred_pcg_stored = gp_cpu.predict_pcg(
+        test_input.data, test_tiles.first, test_tiles.second, gprat_hyper::PCGParams(1000, 1e-12, 20, false));
+    const auto pred_pcg_regenerated = gp_cpu.predict_pcg(
+        test_input.data, test_tiles.first, test_tiles.second, gprat_hyper::PCGParams(1000, 1e-12, 20, true));
+    utils::stop_hpx_runtime();
+
+    REQUIRE(pred_cg.size() == pred.size());
+    for (std::size_t i = 0, n = pred.size(); i != n; ++i)
+    {
+        INFO("CPU pcg pred " << i);
+        REQUIRE_THAT(pred_cg[i], WithinRel(pred[i], 1e-6));
+        REQUIRE_THAT(pred_pcg_stored[i], WithinRel(pred[i], 1e-6));
+        REQUIRE_THAT(pred_pcg_regenerated[i], WithinRel(pred[i], 1e-6));
+    }
+}
+
+TEST_CASE("GP CPU stochastic loss estimates the exact loss", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const double loss = gp_cpu.calculate_loss();
+    const double loss_stored = gp_cpu.calculate_stochastic_loss(gprat_hyper::StochasticParams(256, 200, 1e-8, false));
+    const double loss_regenerated =
+        gp_cpu.calculate_stochastic_loss(gprat_hyper::StochasticParams(256, 200, 1e-8, true));
+    const auto losses = gp_cpu.optimize_stochastic(gprat_hyper::AdamParams(0.1, 0.9, 0.999, 1e-8, 20),
+                                                   gprat_hyper::StochasticParams());
+    utils::stop_hpx_runtime();
+
+    // The log-determinant is estimated from 256 probes, the quadratic term is solved to the tolerance
+    REQUIRE_THAT(loss_stored, WithinAbs(loss, 5e-2));
+    REQUIRE_THAT(loss_regenerated, WithinRel(loss_stored, 1e-12));
+    REQUIRE(losses.size() == 20);
+    REQUIRE(losses.back() < losses.front());
+}
+
+TEST_CASE("GP CPU tile low-rank results match the dense Cholesky results", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const double loss = gp_cpu.calculate_loss();
+    const auto pred = gp_cpu.predict(test_input.data, test_tiles.first, test_tiles.second);
+    const gprat_hyper::TLRParams tlr_params(1e-12);
+    const double loss_tlr = gp_cpu.calculate_tlr_loss(tlr_params);
+    const auto pred_tlr = gp_cpu.predict_tlr(test_input.data, test_tiles.first, test_tiles.second, tlr_params);
+    const auto ranks = gp_cpu.tlr_ranks(tlr_params);
+    utils::stop_hpx_runtime();
+
+    REQUIRE_THAT(loss_tlr, WithinRel(loss, 1e-9));
+    REQUIRE(pred_tlr.size() == pred.size());
+    for (std::size_t i = 0, n = pred.size(); i != n; ++i)
+    {
+        INFO("CPU tlr pred " << i);
+        REQUIRE_THAT(pred_tlr[i], WithinRel(pred[i], 1e-6));
+    }
+    // The off-diagonal tiles of the smooth kernel are compressed
+    for (std::size_t i = 0; i < n_tiles; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            REQUIRE(ranks[i * n_tiles + j] < tile_size);
+        }
+    }
+}
+
+TEST_CASE("GP CPU random Fourier features approximate the exact GP", "[integration][cpu]")
+{
+    const std::string root = get_data_directory();
+    const int tile_size = utils::compute_train_tile_size(n_train, n_tiles);
+    const auto test_tiles = utils::compute_test_tiles(n_test, n_tiles, tile_size);
+
+    gprat::GP_data training_input(root + "/data_1024/training_input.txt", n_train, n_reg);
+    gprat::GP_data training_output(root + "/data_1024/training_output.txt", n_train, n_reg);
+    gprat::GP_data test_input(root + "/data_1024/test_input.txt", n_test, n_reg);
+
+    gprat::GP gp_cpu(
+        training_input.data, training_output.data, n_tiles, tile_size, n_reg, { 1.0, 1.0, 0.1 }, { true, true, true });
+
+    utils::start_hpx_runtime(0, nullptr);
+    const double loss = gp_cpu.calculate_loss();
+    const auto pred = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    gp_cpu.set_random_features(gprat_hyper::RFFParams(1024, 1));
+    const double loss_rff = gp_cpu.calculate_loss();
+    const auto pred_rff = gp_cpu.predict_with_uncertainty(test_input.data, test_tiles.first, test_tiles.second);
+    const auto losses = gp_cpu.optimize(gprat_hyper::AdamParams(0.1, 0.9, 0.999, 1e-8, 20));
+    // The operations of the exact GP do not silently ignore the random features
+    gprat_hyper::AdamParams adam_step(0.1, 0.9, 0.999, 1e-8, 1);
+    REQUIRE_THROWS_AS(gp_cpu.optimize_step(adam_step, 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(gp_cpu.predict_with_full_cov(test_input.data, test_tiles.first, test_tiles.second),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(gp_cpu.cholesky(), std::invalid_argument);
+    gp_cpu.set_random_features(gprat_hyper::RFFParams(0));
+    const double loss_exact = gp_cpu.calculate_loss();
+    gprat::GP gp_optimized(training_input.data,
+                           training_output.data,
+                           n_tiles,
+                           tile_size,
+                           n_reg,
+                           { gp_cpu.kernel_params.lengthscale,
+                             gp_cpu.kernel_params.vertical_lengthscale,
+                             gp_cpu.kernel_params.noise_variance },
+                           { true, true, true });
+    const double loss_optimized = gp_optimized.calculate_loss();
+    utils::stop_hpx_runtime();
+
+    // The Monte Carlo error of the kernel approximation decreases with the square root of the number of features
+    REQUIRE_THAT(loss_rff, WithinAbs(loss, 2e-2));
+    REQUIRE(pred_rff[0].size() == pred[0].size());
+    for (std::size_t i = 0, n = pred[0].size(); i != n; ++i)
+    {
+        INFO("CPU rff pred " << i);
+        REQUIRE_THAT(pred_rff[0][i], WithinAbs(pred[0][i], 2e-2));
+        REQUIRE_THAT(pred_rff[1][i], WithinAbs(pred[1][i], 2e-3));
+    }
+    REQUIRE(losses.size() == 20);
+    REQUIRE(losses.back() < losses.front());
+    // Zero features switch back to the exact GP with the optimized hyperparameters
+    REQUIRE_THAT(loss_exact, WithinRel(loss_optimized, 1e-12));
+}
+
 /*
  * GPU test case for CUDA and SYCL
  */